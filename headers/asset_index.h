@@ -0,0 +1,396 @@
+#ifndef ASSET_INDEX_H
+#define ASSET_INDEX_H
+
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <image_decode.h>
+#include <mapped_file.h>
+#include <vfs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+//////// ASSET INDEX ////
+// - a manifest of every image under an asset directory: size, channel count, file format and a content hash, read
+//      from the file headers with stbi_info_from_memory() without decoding a single pixel
+// - with it, texture storage (glTexStorage2D, immutable) can be allocated and upload budgets planned before any decode
+//      starts, and the decode can then write straight into storage of the right size
+// - scanAssets() lists a virtual directory through vfs() and probes the files in parallel; writeAssetIndex() saves the
+//      result as an .index file (src/Tools/assetindex.cpp does both offline) and AssetIndex maps it back with no
+//      parsing. AssetIndex::load() reads root/assets.index through vfs() too, so with a pack mounted the index comes
+//      out of the pack (packtool packs it along with the images when assetindex has run first), and falls back to
+//      scanning when there is none
+// - layout: header | entries, sorted by path | path strings. Paths are relative to the scanned directory with '/'
+//      separators. All fields are little-endian
+// - the hash is FNV-1a over the file contents, so a cache keyed on it notices changed files even at the same size
+
+const uint32_t ASSET_INDEX_MAGIC = 0x414F474C; // "LGOA"
+const uint32_t ASSET_INDEX_VERSION = 1;
+
+enum AssetFormat : uint32_t
+{
+    ASSET_FORMAT_UNKNOWN = 0,   // stb_image reads it, the magic bytes didn't say which format (TGA has none)
+    ASSET_FORMAT_JPEG,
+    ASSET_FORMAT_PNG,
+    ASSET_FORMAT_BMP,
+    ASSET_FORMAT_GIF,
+    ASSET_FORMAT_PSD,
+    ASSET_FORMAT_HDR,
+    ASSET_FORMAT_PNM,
+};
+
+enum AssetFlags : uint32_t
+{
+    ASSET_16_BIT = 1,           // 16 bits per channel in the file; stbi_load still returns 8
+    ASSET_HDR = 2,              // float data in the file; stbi_load tone maps it to 8 bits
+};
+
+struct AssetIndexHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t stringBytes;
+    uint64_t entryOffset;       // byte offsets from the start of the file
+    uint64_t stringOffset;
+};
+
+struct AssetIndexEntry
+{
+    uint32_t pathOffset;        // into the string table
+    uint32_t pathLength;
+    uint32_t width;
+    uint32_t height;
+    uint32_t channels;          // as stbi_load returns them with desired_channels = 0
+    uint32_t format;            // AssetFormat
+    uint32_t flags;             // AssetFlags
+    uint32_t reserved;
+    uint64_t fileSize;
+    uint64_t hash;
+
+    // full mip chain down to 1x1
+    // ------------------------------------------------------------------------
+    int levels() const
+    {
+        int count = 1;
+        while ((std::max(width, height) >> count) > 0)
+            count++;
+        return count;
+    }
+    // ------------------------------------------------------------------------
+    GLenum internalFormat() const
+    {
+        const GLenum formats[4] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        return formats[std::min(std::max(channels, 1u), 4u) - 1];
+    }
+    // ------------------------------------------------------------------------
+    GLenum pixelFormat() const
+    {
+        const GLenum formats[4] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        return formats[std::min(std::max(channels, 1u), 4u) - 1];
+    }
+    // bytes of texture storage, mips included
+    // ------------------------------------------------------------------------
+    uint64_t gpuBytes() const
+    {
+        uint64_t bytes = 0;
+        for (int level = 0; level < levels(); level++)
+            bytes += (uint64_t)std::max(width >> level, 1u) * std::max(height >> level, 1u) * channels;
+        return bytes;
+    }
+};
+static_assert(sizeof(AssetIndexEntry) == 48, "asset index entries are written as they are");
+
+// FNV-1a, a word at a time with the tail byte by byte
+// ------------------------------------------------------------------------
+inline uint64_t assetHash(const unsigned char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8)
+    {
+        uint64_t w;
+        std::memcpy(&w, data + i, 8);
+        hash ^= w;
+        hash *= 1099511628211ull;
+    }
+    for (; i < size; i++)
+    {
+        hash ^= data[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// ------------------------------------------------------------------------
+inline AssetFormat assetFormat(const unsigned char* data, size_t size)
+{
+    if (size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF)
+        return ASSET_FORMAT_JPEG;
+    if (size >= 8 && std::memcmp(data, "\x89PNG\r\n\x1a\n", 8) == 0)
+        return ASSET_FORMAT_PNG;
+    if (size >= 2 && data[0] == 'B' && data[1] == 'M')
+        return ASSET_FORMAT_BMP;
+    if (size >= 4 && std::memcmp(data, "GIF8", 4) == 0)
+        return ASSET_FORMAT_GIF;
+    if (size >= 4 && std::memcmp(data, "8BPS", 4) == 0)
+        return ASSET_FORMAT_PSD;
+    if (size >= 2 && data[0] == '#' && data[1] == '?')
+        return ASSET_FORMAT_HDR;
+    if (size >= 2 && data[0] == 'P' && (data[1] == '5' || data[1] == '6'))
+        return ASSET_FORMAT_PNM;
+    return ASSET_FORMAT_UNKNOWN;
+}
+
+// fills everything but the path; false if stb_image can't read the file
+// ------------------------------------------------------------------------
+inline bool probeImage(const unsigned char* data, size_t size, AssetIndexEntry& entry)
+{
+    int width, height, channels;
+    if (size == 0 || size > INT32_MAX || !stbi_info_from_memory(data, (int)size, &width, &height, &channels))
+        return false;
+    entry.width = (uint32_t)width;
+    entry.height = (uint32_t)height;
+    entry.channels = (uint32_t)channels;
+    entry.format = assetFormat(data, size);
+    entry.flags = (stbi_is_16_bit_from_memory(data, (int)size) ? (uint32_t)ASSET_16_BIT : 0u) | (stbi_is_hdr_from_memory(data, (int)size) ? (uint32_t)ASSET_HDR : 0u);
+    entry.reserved = 0;
+    entry.fileSize = size;
+    entry.hash = assetHash(data, size);
+    return true;
+}
+
+// result of scanAssets(), in the order it is written to disk
+struct AssetScan
+{
+    std::vector<AssetIndexEntry> entries;
+    std::string strings;
+    size_t bytesRead = 0;
+    double seconds = 0.0;
+    unsigned int threads = 1;
+};
+
+// probe every image under the virtual directory root (see vfs.h); files stb_image can't read are skipped with an error
+// ------------------------------------------------------------------------
+inline bool scanAssets(const char* root, AssetScan& scan, unsigned int threads = 0)
+{
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::string> files;
+    if (!vfs().list(root, files))
+    {
+        std::cout << "ERROR::ASSET_INDEX::COULD_NOT_SCAN: " << root << std::endl;
+        return false;
+    }
+    std::string prefix = root;
+    if (!prefix.empty() && prefix.back() != '/')
+        prefix += '/';
+    // list() is sorted, and so are the paths with the common prefix taken off
+    std::vector<std::string> paths;
+    for (const std::string& file : files)
+    {
+        std::string extension = std::filesystem::path(file).extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)std::tolower((unsigned char)c); });
+        const char* images[] = { ".jpg", ".jpeg", ".png", ".bmp", ".tga", ".gif", ".psd", ".hdr", ".pic", ".pgm", ".ppm", ".pnm" };
+        if (std::find(std::begin(images), std::end(images), extension) != std::end(images))
+            paths.push_back(file.substr(prefix.size()));
+    }
+
+    std::vector<AssetIndexEntry> probed(paths.size());
+    std::vector<char> readable(paths.size(), 0);
+    std::atomic<size_t> bytesRead{ 0 };
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::max(1u, std::min(threads, (unsigned int)paths.size()));
+    imageDecodeParallel(threads, (unsigned int)paths.size(), [&](unsigned int i)
+    {
+        VfsFile file;
+        if (!vfs().open(prefix + paths[i], file))
+            return;
+        readable[i] = probeImage(file.data(), file.size(), probed[i]);
+        bytesRead += file.size();
+        if (!readable[i])
+            std::cout << "ERROR::ASSET_INDEX::NOT_AN_IMAGE: " << paths[i] << ": " << (file.size() ? stbi_failure_reason() : "empty file") << std::endl;
+    });
+
+    scan.entries.clear();
+    scan.strings.clear();
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        if (!readable[i])
+            continue;
+        probed[i].pathOffset = (uint32_t)scan.strings.size();
+        probed[i].pathLength = (uint32_t)paths[i].size();
+        scan.strings += paths[i];
+        scan.entries.push_back(probed[i]);
+    }
+    scan.bytesRead = bytesRead;
+    scan.threads = threads;
+    scan.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// ------------------------------------------------------------------------
+inline bool writeAssetIndex(const char* path, const AssetScan& scan)
+{
+    AssetIndexHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = ASSET_INDEX_MAGIC;
+    header.version = ASSET_INDEX_VERSION;
+    header.entryCount = (uint32_t)scan.entries.size();
+    header.stringBytes = (uint32_t)scan.strings.size();
+    header.entryOffset = sizeof(AssetIndexHeader);
+    header.stringOffset = header.entryOffset + scan.entries.size() * sizeof(AssetIndexEntry);
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cout << "ERROR::ASSET_INDEX::COULD_NOT_WRITE: " << path << std::endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(scan.entries.data()), scan.entries.size() * sizeof(AssetIndexEntry));
+    out.write(scan.strings.data(), scan.strings.size());
+    return (bool)out;
+}
+
+// A mapped .index file, or a scan held in memory when there is no index on disk
+class AssetIndex
+{
+public:
+    const AssetIndexEntry* entries = NULL;
+    size_t count = 0;
+
+    // map and validate an index written by writeAssetIndex(); path is a real file, not a virtual one
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        close();
+        if (!file.open(path))
+            return false;
+        return parse(file.data(), file.size(), path);
+    }
+    // index the virtual directory now instead, e.g. when it has no .index file yet
+    // ------------------------------------------------------------------------
+    bool scan(const char* root, unsigned int threads = 0)
+    {
+        close();
+        if (!scanAssets(root, owned, threads))
+            return false;
+        entries = owned.entries.data();
+        count = owned.entries.size();
+        strings = owned.strings.data();
+        return true;
+    }
+    // root/assets.index through vfs() if assetindex has written one, otherwise a scan of root
+    // ------------------------------------------------------------------------
+    bool load(const char* root, unsigned int threads = 0)
+    {
+        close();
+        std::string indexPath = std::string(root) + "/assets.index";
+        if (vfs().exists(indexPath) && vfs().open(indexPath, mounted) && parse(mounted.data(), mounted.size(), indexPath.c_str()))
+            return true;
+        return scan(root, threads);
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+        entries = NULL;
+        count = 0;
+        strings = NULL;
+        owned = AssetScan();
+        file.close();
+        mounted.close();
+    }
+    // ------------------------------------------------------------------------
+    std::string_view path(const AssetIndexEntry& entry) const
+    {
+        return std::string_view(strings + entry.pathOffset, entry.pathLength);
+    }
+    // binary search on the sorted paths; NULL if the file wasn't indexed
+    // ------------------------------------------------------------------------
+    const AssetIndexEntry* find(std::string_view relativePath) const
+    {
+        const AssetIndexEntry* end = entries + count;
+        const AssetIndexEntry* it = std::lower_bound(entries, end, relativePath,
+            [this](const AssetIndexEntry& entry, std::string_view key) { return path(entry) < key; });
+        return it != end && path(*it) == relativePath ? it : NULL;
+    }
+    // the upload budget: texture storage for everything in the index, mips included
+    // ------------------------------------------------------------------------
+    uint64_t gpuBytes() const
+    {
+        uint64_t bytes = 0;
+        for (size_t i = 0; i < count; i++)
+            bytes += entries[i].gpuBytes();
+        return bytes;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        uint64_t fileBytes = 0;
+        for (size_t i = 0; i < count; i++)
+            fileBytes += entries[i].fileSize;
+        std::cout << "ASSET_INDEX:: " << count << " images, " << fileBytes / 1024 << " KB on disk, " << gpuBytes() / 1024 << " KB of texture storage with mips";
+        if (!file.isOpen() && !mounted.isOpen())
+            std::cout << ", scanned in " << owned.seconds * 1000.0 << " ms on " << owned.threads << " thread(s)";
+        std::cout << std::endl;
+    }
+
+private:
+    MappedFile file;
+    VfsFile mounted;            // the index when load() found one through vfs()
+    AssetScan owned;
+    const char* strings = NULL;
+
+    // validate an index in memory: every section and path in range, and the header and entries aligned, since they
+    //      are read in place
+    // ------------------------------------------------------------------------
+    bool parse(const unsigned char* base, size_t size, const char* path)
+    {
+        if (size < sizeof(AssetIndexHeader))
+            return invalid(path, "file too small");
+        if ((uintptr_t)base % alignof(AssetIndexHeader) != 0)
+            return invalid(path, "misaligned data");
+        const AssetIndexHeader* h = reinterpret_cast<const AssetIndexHeader*>(base);
+        if (h->magic != ASSET_INDEX_MAGIC || h->version != ASSET_INDEX_VERSION)
+            return invalid(path, "bad magic or version");
+        if (h->entryOffset % alignof(AssetIndexEntry) != 0)
+            return invalid(path, "misaligned entries");
+        if (h->entryOffset < sizeof(AssetIndexHeader) || !inBounds(h->entryOffset, (uint64_t)h->entryCount * sizeof(AssetIndexEntry), size) || !inBounds(h->stringOffset, h->stringBytes, size))
+            return invalid(path, "section out of range");
+        const AssetIndexEntry* e = reinterpret_cast<const AssetIndexEntry*>(base + h->entryOffset);
+        for (uint32_t i = 0; i < h->entryCount; i++)
+            if (!inBounds(e[i].pathOffset, e[i].pathLength, h->stringBytes))
+                return invalid(path, "path out of range");
+        entries = e;
+        count = h->entryCount;
+        strings = reinterpret_cast<const char*>(base + h->stringOffset);
+        return true;
+    }
+
+    // ------------------------------------------------------------------------
+    static bool inBounds(uint64_t offset, uint64_t bytes, size_t size)
+    {
+        return offset <= size && bytes <= size - offset;
+    }
+    // ------------------------------------------------------------------------
+    bool invalid(const char* path, const char* reason)
+    {
+        std::cout << "ERROR::ASSET_INDEX::INVALID: " << path << " (" << reason << ")" << std::endl;
+        close();
+        return false;
+    }
+};
+#endif
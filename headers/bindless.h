@@ -0,0 +1,175 @@
+#ifndef BINDLESS_H
+#define BINDLESS_H
+
+#include <glad/glad.h>
+
+#include <gl_objects.h>
+#include <glad_lazy.h>
+
+#include <cstdint>
+#include <vector>
+#include <iostream>
+
+//////// BINDLESS TEXTURES ////
+// - with GL_ARB_bindless_texture a texture + sampler pair turns into a 64-bit handle. Once the handle is made resident
+//      shaders can sample through it directly, without the texture being bound to any unit
+// - TextureTable collects the textures a set of draws uses and writes their handles into an SSBO (binding 2). Shaders
+//      pick a texture by index, so draws that use different textures no longer need a bind between them and can share
+//      one batch:
+//
+//     #extension GL_ARB_bindless_texture : require
+//     layout (std430, binding = 2) readonly buffer Textures { uvec2 textures[]; };
+//     ...
+//     texture(sampler2D(textures[materialTexture]), TexCoord)
+//
+// - without the extension the table falls back to binding entry i to texture unit i, and the shader declares plain
+//      sampler uniforms set to those units. Both paths share the same indices; the fallback holds no more entries
+//      than the context has texture units (GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS)
+// - our glad is generated for core profile only, so the extension's entry points are loaded here by hand
+
+const unsigned int TEXTURE_TABLE_SSBO_BINDING = 2;
+const unsigned int TEXTURE_TABLE_INVALID = ~0u;     // add() on a full table
+
+typedef GLuint64 (APIENTRYP PFNGETTEXTURESAMPLERHANDLEPROC)(GLuint texture, GLuint sampler);
+typedef void (APIENTRYP PFNMAKETEXTUREHANDLERESIDENTPROC)(GLuint64 handle);
+typedef void (APIENTRYP PFNMAKETEXTUREHANDLENONRESIDENTPROC)(GLuint64 handle);
+
+struct BindlessApi
+{
+    bool available = false;
+    PFNGETTEXTURESAMPLERHANDLEPROC getTextureSamplerHandle = nullptr;
+    PFNMAKETEXTUREHANDLERESIDENTPROC makeTextureHandleResident = nullptr;
+    PFNMAKETEXTUREHANDLENONRESIDENTPROC makeTextureHandleNonResident = nullptr;
+
+    // look for the extension and load its entry points; call once after gladLoadGLLoader with the same loader.
+    // SSBOs are needed for the handle table too, so a 4.3 context is required as well
+    // ------------------------------------------------------------------------
+    bool load(GLADloadproc loader)
+    {
+        available = false;
+        if (!GLAD_GL_VERSION_4_3 || !hasExtension("GL_ARB_bindless_texture"))
+            return false;
+        getTextureSamplerHandle = (PFNGETTEXTURESAMPLERHANDLEPROC)loader("glGetTextureSamplerHandleARB");
+        makeTextureHandleResident = (PFNMAKETEXTUREHANDLERESIDENTPROC)loader("glMakeTextureHandleResidentARB");
+        makeTextureHandleNonResident = (PFNMAKETEXTUREHANDLENONRESIDENTPROC)loader("glMakeTextureHandleNonResidentARB");
+        available = getTextureSamplerHandle && makeTextureHandleResident && makeTextureHandleNonResident;
+        return available;
+    }
+    // ------------------------------------------------------------------------
+    static bool hasExtension(const char* name)
+    {
+        return glExtensions().has(name);
+    }
+};
+
+// the process-wide entry points
+inline BindlessApi& bindlessApi()
+{
+    static BindlessApi api;
+    return api;
+}
+
+class TextureTable
+{
+public:
+    unsigned int handleBuffer = 0;
+    bool bindless = false;
+
+    // allowBindless = false forces the unit-binding path even when the extension is there
+    explicit TextureTable(bool allowBindless = true) : bindless(allowBindless && bindlessApi().available) {}
+    ~TextureTable()
+    {
+        release();
+    }
+    TextureTable(const TextureTable&) = delete;
+    TextureTable& operator=(const TextureTable&) = delete;
+
+    // add a texture sampled through a sampler, returns its index in the table, or TEXTURE_TABLE_INVALID once the
+    //      unit-binding fallback has used up the texture units. Both must outlive the table. With the bindless path
+    //      neither may be modified after upload(): handles freeze their state
+    // ------------------------------------------------------------------------
+    unsigned int add(const Texture& texture, const Sampler& sampler)
+    {
+        if (!bindless && entries.size() >= unitLimit())
+        {
+            std::cout << "ERROR::TEXTURE_TABLE::FULL: " << unitLimit() << " texture units without bindless" << std::endl;
+            return TEXTURE_TABLE_INVALID;
+        }
+        entries.push_back({ &texture, &sampler });
+        return (unsigned int)entries.size() - 1;
+    }
+    // bindless: create the handles, make them resident and write them to the SSBO. Call again after add()ing more
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        if (!bindless)
+            return;
+        release();
+        const BindlessApi& api = bindlessApi();
+        handles.resize(entries.size());
+        for (size_t i = 0; i < entries.size(); i++)
+        {
+            handles[i] = api.getTextureSamplerHandle(entries[i].texture->ID, entries[i].sampler->ID);
+            api.makeTextureHandleResident(handles[i]);
+        }
+        glGenBuffers(1, &handleBuffer);
+        glState().bindBuffer(GL_SHADER_STORAGE_BUFFER, handleBuffer);
+        glBufferData(GL_SHADER_STORAGE_BUFFER, handles.size() * sizeof(GLuint64), handles.data(), GL_STATIC_DRAW);
+    }
+    // make the table visible to the shaders: one buffer bind, or one texture + sampler bind per entry without bindless
+    // ------------------------------------------------------------------------
+    void bind() const
+    {
+        if (bindless)
+        {
+            glState().bindBufferBase(GL_SHADER_STORAGE_BUFFER, TEXTURE_TABLE_SSBO_BINDING, handleBuffer);
+            return;
+        }
+        for (unsigned int i = 0; i < entries.size(); i++)
+        {
+            entries[i].texture->bind(i);
+            entries[i].sampler->bind(i);
+        }
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "TEXTURE_TABLE:: " << entries.size() << " textures, " << (bindless ? "bindless handles" : "bound to units") << std::endl;
+    }
+
+private:
+    struct Entry
+    {
+        const Texture* texture;
+        const Sampler* sampler;
+    };
+    std::vector<Entry> entries;
+    std::vector<GLuint64> handles;
+    unsigned int units = 0;
+
+    // queried on the first add(), when the context is known to be current
+    unsigned int unitLimit()
+    {
+        if (units == 0)
+        {
+            GLint max = 0;
+            glGetIntegerv(GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, &max);
+            units = max > 0 ? (unsigned int)max : 48;   // 48 is the minimum GL 3.3 guarantees
+        }
+        return units;
+    }
+
+    void release()
+    {
+        for (GLuint64 handle : handles)
+            bindlessApi().makeTextureHandleNonResident(handle);
+        handles.clear();
+        if (handleBuffer)
+        {
+            glState().forget(handleBuffer);
+            glDeleteBuffers(1, &handleBuffer);
+            handleBuffer = 0;
+        }
+    }
+};
+#endif
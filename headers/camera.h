@@ -0,0 +1,243 @@
+#ifndef CAMERA_H
+#define CAMERA_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <gl_objects.h>
+
+#include <cmath>
+
+// binding point of the per-frame uniform block shared by every shader:
+//     layout (std140) uniform Frame { mat4 view; mat4 projection; mat4 viewProjection; mat4 invViewProjection; vec4 cameraPos; };
+const unsigned int FRAME_UBO_BINDING = 0;
+
+// default camera values
+const float YAW         = -90.0f;
+const float PITCH       =  0.0f;
+const float FOV         =  45.0f;
+const float NEAR_PLANE  =  0.1f;
+const float FAR_PLANE   =  100.0f;
+
+// std140 layout of the Frame uniform block, uploaded once per frame
+struct FrameData
+{
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::mat4 viewProjection;
+    glm::mat4 invViewProjection;
+    glm::vec4 cameraPos; // w holds the time in seconds
+};
+
+// A camera that owns the view -> clip part of the coordinate pipeline. The view, projection, view-projection
+// and inverse matrices are cached and only rebuilt when a parameter that feeds them has changed.
+class Camera
+{
+public:
+    // constructor with vectors
+    // ------------------------------------------------------------------------
+    Camera(glm::vec3 position = glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3 up = glm::vec3(0.0f, 1.0f, 0.0f), float yaw = YAW, float pitch = PITCH)
+        : position(position), worldUp(up), yaw(yaw), pitch(pitch)
+    {
+        updateCameraVectors();
+    }
+    // view parameters
+    // ------------------------------------------------------------------------
+    void setPosition(const glm::vec3& value)
+    {
+        position = value;
+        viewDirty = true;
+    }
+    void setRotation(float yawDegrees, float pitchDegrees)
+    {
+        yaw = yawDegrees;
+        // keep the view from flipping when looking straight up or down
+        pitch = glm::clamp(pitchDegrees, -89.0f, 89.0f);
+        updateCameraVectors();
+    }
+    void lookAt(const glm::vec3& target)
+    {
+        glm::vec3 dir = glm::normalize(target - position);
+        setRotation(glm::degrees(std::atan2(dir.z, dir.x)), glm::degrees(std::asin(dir.y)));
+    }
+    // projection parameters
+    // ------------------------------------------------------------------------
+    void setPerspective(float fovDegrees, float aspectRatio, float nearPlane, float farPlane)
+    {
+        fov = fovDegrees;
+        aspect = aspectRatio;
+        zNear = nearPlane;
+        zFar = farPlane;
+        projDirty = true;
+    }
+    void setAspect(float aspectRatio)
+    {
+        if (aspectRatio == aspect)
+            return;
+        aspect = aspectRatio;
+        projDirty = true;
+    }
+    // reversed-Z maps the near plane to depth 1 and infinity to depth 0, which spreads float depth precision evenly
+    // over distance. It needs a [0, 1] clip range, so only enable it after enableReversedZ() has returned true.
+    void setReversedZ(bool enabled)
+    {
+        reversedZ = enabled;
+        projDirty = true;
+    }
+    // ------------------------------------------------------------------------
+    const glm::mat4& getViewMatrix() const { updateView(); return view; }
+    const glm::mat4& getInverseViewMatrix() const { updateView(); return invView; }
+    const glm::mat4& getProjectionMatrix() const { updateProjection(); return projection; }
+    const glm::mat4& getInverseProjectionMatrix() const { updateProjection(); return invProjection; }
+    const glm::mat4& getViewProjectionMatrix() const { updateViewProjection(); return viewProjection; }
+    const glm::mat4& getInverseViewProjectionMatrix() const { updateViewProjection(); return invViewProjection; }
+
+    const glm::vec3& getPosition() const { return position; }
+    const glm::vec3& getFront() const { return front; }
+    const glm::vec3& getRight() const { return right; }
+    const glm::vec3& getUp() const { return up; }
+    float getYaw() const { return yaw; }
+    float getPitch() const { return pitch; }
+    float getFov() const { return fov; }
+    float getAspect() const { return aspect; }
+    float getNear() const { return zNear; }
+    float getFar() const { return zFar; }
+    bool isReversedZ() const { return reversedZ; }
+
+    // fill the per-frame block; call once per frame, not once per draw
+    // ------------------------------------------------------------------------
+    FrameData getFrameData(float time) const
+    {
+        FrameData data;
+        data.view = getViewMatrix();
+        data.projection = getProjectionMatrix();
+        data.viewProjection = getViewProjectionMatrix();
+        data.invViewProjection = getInverseViewProjectionMatrix();
+        data.cameraPos = glm::vec4(position, time);
+        return data;
+    }
+
+    // switch the GL depth convention over to reversed-Z: [0, 1] clip depth, clear to 0 and GL_GREATER testing.
+    // returns false (and changes nothing) when glClipControl isn't available, i.e. on contexts older than 4.5
+    // ------------------------------------------------------------------------
+    static bool enableReversedZ()
+    {
+        if (!GLAD_GL_VERSION_4_5)
+            return false;
+        glClipControl(GL_LOWER_LEFT, GL_ZERO_TO_ONE);
+        glClearDepth(0.0);
+        glDepthFunc(GL_GREATER);
+        return true;
+    }
+
+private:
+    // camera attributes
+    glm::vec3 position;
+    glm::vec3 front = glm::vec3(0.0f, 0.0f, -1.0f);
+    glm::vec3 up;
+    glm::vec3 right;
+    glm::vec3 worldUp;
+    // euler angles
+    float yaw;
+    float pitch;
+    // projection attributes
+    float fov = FOV;
+    float aspect = 800.0f / 600.0f;
+    float zNear = NEAR_PLANE;
+    float zFar = FAR_PLANE;
+    bool reversedZ = false;
+
+    // cached matrices, rebuilt lazily by the getters
+    mutable glm::mat4 view, invView;
+    mutable glm::mat4 projection, invProjection;
+    mutable glm::mat4 viewProjection, invViewProjection;
+    mutable bool viewDirty = true;
+    mutable bool projDirty = true;
+    mutable bool viewProjDirty = true;
+
+    // calculates the front vector from the camera's (updated) euler angles
+    // ------------------------------------------------------------------------
+    void updateCameraVectors()
+    {
+        glm::vec3 f;
+        f.x = std::cos(glm::radians(yaw)) * std::cos(glm::radians(pitch));
+        f.y = std::sin(glm::radians(pitch));
+        f.z = std::sin(glm::radians(yaw)) * std::cos(glm::radians(pitch));
+        front = glm::normalize(f);
+        // normalize the vectors, because their length gets closer to 0 the more you look up or down
+        right = glm::normalize(glm::cross(front, worldUp));
+        up = glm::normalize(glm::cross(right, front));
+        viewDirty = true;
+    }
+    // ------------------------------------------------------------------------
+    void updateView() const
+    {
+        if (!viewDirty)
+            return;
+        view = glm::lookAt(position, position + front, up);
+        // the view matrix is a rigid transform, so its inverse is just the transposed rotation and negated translation
+        glm::mat3 rotT = glm::transpose(glm::mat3(view));
+        invView = glm::mat4(rotT);
+        invView[3] = glm::vec4(-(rotT * glm::vec3(view[3])), 1.0f);
+        viewDirty = false;
+        viewProjDirty = true;
+    }
+    // ------------------------------------------------------------------------
+    void updateProjection() const
+    {
+        if (!projDirty)
+            return;
+        if (reversedZ)
+        {
+            // infinite far plane, depth = near / -z_view: 1 at the near plane, approaching 0 at infinity
+            float f = 1.0f / std::tan(glm::radians(fov) * 0.5f);
+            projection = glm::mat4(0.0f);
+            projection[0][0] = f / aspect;
+            projection[1][1] = f;
+            projection[2][3] = -1.0f;
+            projection[3][2] = zNear;
+        }
+        else
+        {
+            projection = glm::perspective(glm::radians(fov), aspect, zNear, zFar);
+        }
+        invProjection = glm::inverse(projection);
+        projDirty = false;
+        viewProjDirty = true;
+    }
+    // ------------------------------------------------------------------------
+    void updateViewProjection() const
+    {
+        updateView();
+        updateProjection();
+        if (!viewProjDirty)
+            return;
+        viewProjection = projection * view;
+        invViewProjection = invView * invProjection;
+        viewProjDirty = false;
+    }
+};
+
+// Owns the uniform buffer behind the Frame block. Shaders bind their block to FRAME_UBO_BINDING once at setup
+// (Shader::setBlockBinding), then camera data is uploaded a single time per frame instead of as uniforms per draw.
+// The buffer is a gl_objects.h Buffer, so its binds go through glState() and the cache stays in step; create it after
+// glState().init()
+class FrameUniforms
+{
+public:
+    Buffer buffer;
+    // ------------------------------------------------------------------------
+    FrameUniforms()
+    {
+        buffer.data(sizeof(FrameData), NULL, GL_DYNAMIC_DRAW);
+        buffer.bindBase(GL_UNIFORM_BUFFER, FRAME_UBO_BINDING);
+    }
+    // ------------------------------------------------------------------------
+    void update(const Camera& camera, float time)
+    {
+        FrameData data = camera.getFrameData(time);
+        buffer.subData(0, sizeof(FrameData), &data);
+    }
+};
+#endif
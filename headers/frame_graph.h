@@ -0,0 +1,507 @@
+#ifndef FRAME_GRAPH_H
+#define FRAME_GRAPH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <gl_objects.h>
+#include <render_target.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+//////// FRAME GRAPH ////
+// - a frame is described as passes that declare what they read and write instead of as a fixed sequence of binds,
+//      clears and draws. Render targets are virtual resources: a name, a size and a format, no GL object yet
+// - compile() turns the description into an execution plan:
+//      - passes whose outputs nobody reads are culled, unless they write the backbuffer (the window) or are marked
+//          as having side effects. Culling walks back from the outputs, so a pass only feeding a culled pass goes too
+//      - the remaining passes run in the order they were added, which has to be an order where every read comes after
+//          a write of that resource (checked), and no pass may read a target it writes itself (a feedback loop)
+//      - every transient target gets a lifetime, from the first to the last pass using it
+// - execute() walks the plan taking targets from renderTargetPool() as their lifetimes start and giving them back as
+//      they end, so targets whose lifetimes don't overlap share one texture when size and format match: a chain of
+//      post-processing passes needs two or three textures however long it gets. Framebuffers come from the pool's
+//      cache; from the second frame on executing binds and draws and creates nothing
+// - the graph is built once and executed every frame, and only recompiled when a pass or target is added. A new
+//      backbuffer size needs no recompile: relative targets are sized at execute() and the pool's rounded-up
+//      allocations absorb most resizes, so pass viewports cover the target's size and samplers scale by uvScale()
+// - a pass's execute function gets a PassContext for looking up the textures it reads and for blitting one of them
+//      into its own target; the framebuffer, viewport and clears are already set up when it runs
+
+// what a virtual render target resolves to; width/height 0 means the backbuffer size times scale
+struct RenderTargetDesc
+{
+    int width = 0;
+    int height = 0;
+    float scale = 1.0f;
+    GLenum format = GL_RGBA8;
+    int samples = 1;                // more than 1 is resolved by blitting it into a single-sampled target
+    bool renderbuffer = false;      // for targets only rendered to and blitted from, never read with texture()
+};
+
+class FrameGraph
+{
+    struct Pass;
+
+public:
+    typedef uint32_t Resource;
+    static constexpr Resource BACKBUFFER = 0;   // the window's default framebuffer, always there
+
+    struct Stats
+    {
+        size_t passes = 0;
+        size_t culled = 0;
+        size_t targets = 0;             // transient targets used by the executed passes
+        size_t textures = 0;            // pooled targets backing them in the last frame
+        size_t aliasedBytes = 0;        // VRAM of those
+        size_t unaliasedBytes = 0;      // VRAM a texture per target, of exactly its size, would take
+        size_t compiles = 0;
+    };
+    Stats stats;
+
+    // handed to a pass's execute function
+    class PassContext
+    {
+    public:
+        int width = 0, height = 0;      // of the pass's target
+
+        // the GL texture behind a target the pass declared as read; 0 (and an error) for anything else
+        // ------------------------------------------------------------------------
+        unsigned int texture(Resource resource) const
+        {
+            const RenderTarget* physical = graph->readable(*pass, resource);
+            return physical ? physical->ID() : 0;
+        }
+        // the part of a target's texture its contents cover; the pool may hand out a larger texture than asked for
+        // ------------------------------------------------------------------------
+        glm::vec2 uvScale(Resource resource) const
+        {
+            const RenderTarget* physical = graph->readable(*pass, resource);
+            if (!physical)
+                return glm::vec2(1.0f);
+            int width, height;
+            graph->targetSize(resource, width, height);
+            return glm::vec2((float)width / physical->key.width, (float)height / physical->key.height);
+        }
+        // copy a target the pass reads into its own color target, scaling when the sizes differ
+        // ------------------------------------------------------------------------
+        void blit(Resource source, GLbitfield mask = GL_COLOR_BUFFER_BIT) const
+        {
+            graph->blit(source, *this, mask);
+        }
+
+    private:
+        friend class FrameGraph;
+        FrameGraph* graph = NULL;
+        const Pass* pass = NULL;
+        unsigned int framebuffer = 0;
+    };
+
+    // handed to a pass's setup function to declare what it uses
+    class PassBuilder
+    {
+    public:
+        // ------------------------------------------------------------------------
+        void read(Resource resource)
+        {
+            pass.reads.push_back(resource);
+        }
+        // render into a color target (in the order of the calls) or into the backbuffer
+        // ------------------------------------------------------------------------
+        void write(Resource resource)
+        {
+            pass.colors.push_back(resource);
+        }
+        // ------------------------------------------------------------------------
+        void depth(Resource resource)
+        {
+            pass.depth = resource;
+        }
+        // clear the targets before the pass runs; depth clears to whatever glClearDepth was set to
+        // ------------------------------------------------------------------------
+        void clear(const glm::vec4& color, bool clearDepth = true)
+        {
+            pass.clearBits = GL_COLOR_BUFFER_BIT | (clearDepth ? GL_DEPTH_BUFFER_BIT : 0);
+            pass.clearColor = color;
+        }
+        void clearDepth()
+        {
+            pass.clearBits |= GL_DEPTH_BUFFER_BIT;
+        }
+        // never cull the pass even if nothing reads what it writes (readbacks, queries, ...)
+        // ------------------------------------------------------------------------
+        void sideEffect()
+        {
+            pass.sideEffect = true;
+        }
+
+    private:
+        friend class FrameGraph;
+        Pass& pass;
+        explicit PassBuilder(Pass& pass) : pass(pass) {}
+    };
+
+    FrameGraph()
+    {
+        Target backbuffer;
+        backbuffer.name = "backbuffer";
+        backbuffer.imported = true;
+        targets.push_back(backbuffer);
+    }
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+
+    // declare a transient render target; nothing is allocated until a pass using it executes
+    // ------------------------------------------------------------------------
+    Resource createTarget(const char* name, const RenderTargetDesc& desc)
+    {
+        Target target;
+        target.name = name;
+        target.desc = desc;
+        targets.push_back(target);
+        dirty = true;
+        return (Resource)targets.size() - 1;
+    }
+    // setup(PassBuilder&) runs now and declares the pass's resources; execute(const PassContext&) runs every frame
+    // ------------------------------------------------------------------------
+    template <typename Setup>
+    void addPass(const char* name, Setup&& setup, std::function<void(const PassContext&)> execute)
+    {
+        passes.emplace_back();
+        Pass& pass = passes.back();
+        pass.name = name;
+        pass.execute = std::move(execute);
+        PassBuilder builder(pass);
+        setup(builder);
+        dirty = true;
+    }
+    // the window's framebuffer size, which sizes relative targets from the next execute() on
+    // ------------------------------------------------------------------------
+    void setBackbufferSize(int width, int height)
+    {
+        backbufferWidth = width;
+        backbufferHeight = height;
+    }
+    // cull, order and work out lifetimes; false (with the reason printed) if the graph is broken. A broken graph stays
+    //      broken, and executes nothing, until a pass or target is added and it compiles again
+    // ------------------------------------------------------------------------
+    bool compile()
+    {
+        dirty = false;
+        plan.clear();
+        stats = Stats{ 0, 0, 0, 0, 0, 0, stats.compiles + 1 };
+        stats.passes = passes.size();
+        broken = !cull() || !schedule();
+        if (broken)
+            plan.clear();
+        return !broken;
+    }
+    // run the plan; compiles first when something changed. False when the graph is broken and nothing ran; nothing
+    //      runs while the window is minimized either, but that isn't an error
+    // ------------------------------------------------------------------------
+    bool execute()
+    {
+        if (dirty)
+            compile();
+        if (broken)
+            return false;
+        if (backbufferWidth <= 0 || backbufferHeight <= 0)
+            return true;
+        RenderTargetPool& pool = renderTargetPool();
+        frameTargets.clear();
+        stats.unaliasedBytes = 0;
+        for (size_t position = 0; position < plan.size(); position++)
+        {
+            for (Resource r : starts[position])
+                acquire(pool, r);
+            Pass& pass = passes[plan[position]];
+            PassContext context;
+            context.graph = this;
+            context.pass = &pass;
+            context.framebuffer = passFramebuffer(pool, pass);
+            targetSize(pass.colors.empty() ? pass.depth : pass.colors[0], context.width, context.height);
+            glState().bindFramebuffer(GL_FRAMEBUFFER, context.framebuffer);
+            glViewport(0, 0, context.width, context.height);
+            if (pass.clearBits)
+            {
+                glClearColor(pass.clearColor.r, pass.clearColor.g, pass.clearColor.b, pass.clearColor.a);
+                glClear(pass.clearBits);
+            }
+            pass.execute(context);
+            for (Resource r : ends[position])
+            {
+                pool.release(targets[r].physical);
+                targets[r].physical = NULL;
+            }
+        }
+        stats.textures = frameTargets.size();
+        stats.aliasedBytes = 0;
+        for (const RenderTarget* target : frameTargets)
+            stats.aliasedBytes += target->bytes();
+        // leave the window bound, as code outside the graph expects
+        glState().bindFramebuffer(GL_FRAMEBUFFER, 0);
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "FRAME_GRAPH:: " << stats.passes << " passes (" << stats.culled << " culled), " << stats.targets << " transient targets on "
+                  << stats.textures << " textures: " << stats.aliasedBytes / 1024 << " KB instead of " << stats.unaliasedBytes / 1024 << " KB, "
+                  << stats.compiles << " compiles" << (broken ? ", broken: the last compile failed" : "") << std::endl;
+        for (size_t index : plan)
+            std::cout << "    " << passes[index].name << std::endl;
+    }
+
+private:
+    struct Target
+    {
+        std::string name;
+        RenderTargetDesc desc;
+        bool imported = false;
+        // filled in by compile()
+        size_t readers = 0;
+        int firstUse = -1, lastUse = -1;    // positions in plan
+        // during execute(), between firstUse and lastUse
+        RenderTarget* physical = NULL;
+    };
+    struct Pass
+    {
+        std::string name;
+        std::vector<Resource> reads;
+        std::vector<Resource> colors;
+        Resource depth = ~0u;
+        GLbitfield clearBits = 0;
+        glm::vec4 clearColor = glm::vec4(0.0f);
+        bool sideEffect = false;
+        std::function<void(const PassContext&)> execute;
+        // filled in by compile()
+        size_t refs = 0;
+        bool culled = false;
+    };
+
+    std::vector<Target> targets;
+    std::vector<Pass> passes;
+    std::vector<size_t> plan;                   // indices of the passes to run, in order
+    std::vector<std::vector<Resource>> starts;  // per plan position, the targets whose lifetime starts there
+    std::vector<std::vector<Resource>> ends;    // and the ones whose lifetime ends there
+    std::vector<const RenderTarget*> frameTargets;  // distinct pooled targets used this frame, for the stats
+    int backbufferWidth = 0, backbufferHeight = 0;
+    bool dirty = true;
+    bool broken = false;        // the last compile() failed
+
+    // ------------------------------------------------------------------------
+    void targetSize(Resource resource, int& width, int& height) const
+    {
+        if (resource == BACKBUFFER || resource >= targets.size())
+        {
+            width = backbufferWidth;
+            height = backbufferHeight;
+            return;
+        }
+        const RenderTargetDesc& desc = targets[resource].desc;
+        width = desc.width > 0 ? desc.width : std::max(1, (int)(backbufferWidth * desc.scale));
+        height = desc.height > 0 ? desc.height : std::max(1, (int)(backbufferHeight * desc.scale));
+    }
+    // ------------------------------------------------------------------------
+    static std::vector<Resource> writes(const Pass& pass)
+    {
+        std::vector<Resource> written = pass.colors;
+        if (pass.depth != ~0u)
+            written.push_back(pass.depth);
+        return written;
+    }
+    // reference counting from the outputs back: a target nobody reads releases its writers, a pass with nothing left
+    //      to write releases what it reads
+    // ------------------------------------------------------------------------
+    bool cull()
+    {
+        for (Target& target : targets)
+        {
+            target.readers = 0;
+            target.firstUse = target.lastUse = -1;
+        }
+        for (Pass& pass : passes)
+        {
+            for (Resource r : pass.reads)
+            {
+                if (r >= targets.size())
+                {
+                    std::cout << "ERROR::FRAME_GRAPH::UNKNOWN_RESOURCE: pass " << pass.name << " reads resource " << r << std::endl;
+                    return false;
+                }
+                targets[r].readers++;
+            }
+            for (Resource r : writes(pass))
+            {
+                if (r >= targets.size())
+                {
+                    std::cout << "ERROR::FRAME_GRAPH::UNKNOWN_RESOURCE: pass " << pass.name << " writes resource " << r << std::endl;
+                    return false;
+                }
+                if (r == BACKBUFFER)
+                    pass.sideEffect = true;
+            }
+            pass.refs = writes(pass).size();
+            pass.culled = false;
+        }
+        std::vector<Resource> unread;
+        for (Resource r = 0; r < targets.size(); r++)
+            if (targets[r].readers == 0)
+                unread.push_back(r);
+        while (!unread.empty())
+        {
+            Resource r = unread.back();
+            unread.pop_back();
+            for (Pass& pass : passes)
+            {
+                std::vector<Resource> written = writes(pass);
+                if (pass.culled || pass.sideEffect || std::find(written.begin(), written.end(), r) == written.end())
+                    continue;
+                if (--pass.refs > 0)
+                    continue;
+                pass.culled = true;
+                stats.culled++;
+                for (Resource read : pass.reads)
+                    if (--targets[read].readers == 0)
+                        unread.push_back(read);
+            }
+        }
+        return true;
+    }
+    // the executed passes in the order they were added, with every target's lifetime over that order
+    // ------------------------------------------------------------------------
+    bool schedule()
+    {
+        std::vector<bool> written(targets.size(), false);
+        written[BACKBUFFER] = true;
+        for (size_t i = 0; i < passes.size(); i++)
+        {
+            const Pass& pass = passes[i];
+            if (pass.culled)
+                continue;
+            std::vector<Resource> outputs = writes(pass);
+            bool backbuffer = std::find(outputs.begin(), outputs.end(), BACKBUFFER) != outputs.end();
+            if (backbuffer && outputs.size() > 1)
+            {
+                std::cout << "ERROR::FRAME_GRAPH::MIXED_BACKBUFFER: pass " << pass.name << " writes the backbuffer and other targets" << std::endl;
+                return false;
+            }
+            if (pass.colors.size() > RENDER_TARGET_MAX_COLORS)
+            {
+                std::cout << "ERROR::FRAME_GRAPH::TOO_MANY_TARGETS: pass " << pass.name << " writes " << pass.colors.size() << " color targets" << std::endl;
+                return false;
+            }
+            for (Resource r : pass.reads)
+            {
+                // sampling the texture a pass renders into is undefined, whatever the driver happens to show
+                if (std::find(outputs.begin(), outputs.end(), r) != outputs.end())
+                {
+                    std::cout << "ERROR::FRAME_GRAPH::FEEDBACK_LOOP: pass " << pass.name << " reads " << targets[r].name
+                              << " which it also writes" << std::endl;
+                    return false;
+                }
+                if (!written[r])
+                {
+                    std::cout << "ERROR::FRAME_GRAPH::READ_BEFORE_WRITE: pass " << pass.name << " reads " << targets[r].name
+                              << " before any pass writes it" << std::endl;
+                    return false;
+                }
+            }
+            int position = (int)plan.size();
+            plan.push_back(i);
+            auto use = [&](Resource r)
+            {
+                Target& target = targets[r];
+                if (target.firstUse < 0)
+                    target.firstUse = position;
+                target.lastUse = position;
+            };
+            for (Resource r : pass.reads)
+                use(r);
+            for (Resource r : outputs)
+            {
+                use(r);
+                written[r] = true;
+            }
+        }
+        starts.assign(plan.size(), std::vector<Resource>());
+        ends.assign(plan.size(), std::vector<Resource>());
+        for (Resource r = 1; r < targets.size(); r++)
+        {
+            const Target& target = targets[r];
+            if (target.imported || target.firstUse < 0)
+                continue;
+            starts[target.firstUse].push_back(r);
+            ends[target.lastUse].push_back(r);
+            stats.targets++;
+        }
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void acquire(RenderTargetPool& pool, Resource r)
+    {
+        Target& target = targets[r];
+        int width, height;
+        targetSize(r, width, height);
+        target.physical = pool.acquire(width, height, target.desc.format, target.desc.samples, target.desc.renderbuffer);
+        stats.unaliasedBytes += (size_t)width * height * std::max(target.desc.samples, 1) * renderTargetBytesPerPixel(target.desc.format);
+        if (std::find(frameTargets.begin(), frameTargets.end(), target.physical) == frameTargets.end())
+            frameTargets.push_back(target.physical);
+    }
+    // the pooled target behind a resource a pass reads: it has to be a transient target the pass declared with read(),
+    //      which makes it live while the pass runs. The backbuffer or an undeclared target has nothing to look up
+    // ------------------------------------------------------------------------
+    RenderTarget* readable(const Pass& pass, Resource resource) const
+    {
+        if (resource >= targets.size() || targets[resource].imported)
+        {
+            std::cout << "ERROR::FRAME_GRAPH::NOT_A_TARGET: pass " << pass.name << " reads resource " << resource << ", which has no texture" << std::endl;
+            return NULL;
+        }
+        if (std::find(pass.reads.begin(), pass.reads.end(), resource) == pass.reads.end() || !targets[resource].physical)
+        {
+            std::cout << "ERROR::FRAME_GRAPH::UNDECLARED_READ: pass " << pass.name << " reads " << targets[resource].name << " without read()" << std::endl;
+            return NULL;
+        }
+        return targets[resource].physical;
+    }
+    // ------------------------------------------------------------------------
+    unsigned int passFramebuffer(RenderTargetPool& pool, const Pass& pass) const
+    {
+        if ((!pass.colors.empty() && pass.colors[0] == BACKBUFFER) || (pass.colors.empty() && pass.depth == ~0u))
+            return 0;
+        RenderTarget* colors[RENDER_TARGET_MAX_COLORS];
+        for (size_t i = 0; i < pass.colors.size(); i++)
+            colors[i] = targets[pass.colors[i]].physical;
+        return pool.framebuffer(colors, pass.colors.size(), pass.depth != ~0u ? targets[pass.depth].physical : NULL);
+    }
+    // ------------------------------------------------------------------------
+    void blit(Resource source, const PassContext& context, GLbitfield mask)
+    {
+        RenderTarget* physical = readable(*context.pass, source);
+        if (!physical)
+            return;
+        bool depth = isDepthFormat(targets[source].desc.format);
+        unsigned int readFramebuffer = depth ? renderTargetPool().framebuffer(NULL, 0, physical)
+                                             : renderTargetPool().framebuffer(&physical, 1, NULL);
+        int width, height;
+        targetSize(source, width, height);
+        GLenum filter = (mask == GL_COLOR_BUFFER_BIT && (width != context.width || height != context.height)) ? GL_LINEAR : GL_NEAREST;
+        if (glState().dsa)
+        {
+            glBlitNamedFramebuffer(readFramebuffer, context.framebuffer, 0, 0, width, height, 0, 0, context.width, context.height, mask, filter);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindFramebuffer(GL_READ_FRAMEBUFFER, readFramebuffer);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, context.width, context.height, mask, filter);
+        glState().bindFramebuffer(GL_READ_FRAMEBUFFER, context.framebuffer);
+    }
+};
+#endif
@@ -0,0 +1,750 @@
+#ifndef GL_OBJECTS_H
+#define GL_OBJECTS_H
+
+#include <glad/glad.h>
+
+#include <vertex_format.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+//////// GL OBJECT WRAPPERS ////
+// - classic GL edits an object by binding it first (glBindBuffer then glBufferData, glBindTexture then glTexParameteri),
+//      which changes global binding state just to touch one object and makes redundant binds everywhere
+// - on 4.5+ contexts these wrappers use direct state access (glNamedBufferData, glTextureParameteri, ...), which edits
+//      the object by name and never binds anything
+// - older contexts fall back to bind-to-edit through GLStateCache, which remembers what is bound and skips binds that
+//      wouldn't change anything. Buffers are edited through GL_COPY_WRITE_BUFFER so editing an index buffer can't
+//      disturb the element binding of whichever VAO is bound
+// - GLStateCache counts binds issued, binds it skipped because they wouldn't have changed anything, and edits made by
+//      name through DSA (which needed no bind at all)
+// - glBindBufferBase also sets the generic binding of its target, so indexed binds go through the cache too
+// - code that binds objects with raw GL calls behind the cache's back must call glState().invalidate()
+
+const unsigned int GL_STATE_MAX_UNITS = 32;     // texture/sampler units the cache tracks; higher ones bind uncached
+const unsigned int GL_STATE_UNKNOWN = ~0u;
+
+class GLStateCache
+{
+public:
+    unsigned long long bindsIssued = 0;
+    unsigned long long bindsAvoided = 0;
+    unsigned long long namedEdits = 0;
+    bool dsa = false;
+
+    // call once after gladLoadGLLoader
+    // ------------------------------------------------------------------------
+    void init()
+    {
+        dsa = GLAD_GL_VERSION_4_5 != 0;
+        invalidate();
+    }
+    // forget everything, so the next bind of anything is issued
+    // ------------------------------------------------------------------------
+    void invalidate()
+    {
+        std::fill(std::begin(buffers), std::end(buffers), UNKNOWN);
+        std::fill(std::begin(textures), std::end(textures), UNKNOWN);
+        std::fill(std::begin(samplers), std::end(samplers), UNKNOWN);
+        vertexArray = UNKNOWN;
+        activeUnit = UNKNOWN;
+        drawFramebuffer = UNKNOWN;
+        readFramebuffer = UNKNOWN;
+    }
+    // ------------------------------------------------------------------------
+    void bindBuffer(GLenum target, unsigned int id)
+    {
+        unsigned int& bound = buffers[bufferSlot(target)];
+        if (target == GL_ELEMENT_ARRAY_BUFFER)
+        {
+            // the element binding belongs to the bound VAO, so it can't be cached across VAO changes
+            glBindBuffer(target, id);
+            bindsIssued++;
+            return;
+        }
+        if (track(bound, id))
+            glBindBuffer(target, id);
+    }
+    // attach a buffer to an indexed binding point (uniform/storage blocks); GL sets the generic target binding to it
+    //      as well, which is what the cache remembers
+    // ------------------------------------------------------------------------
+    void bindBufferBase(GLenum target, unsigned int index, unsigned int id)
+    {
+        glBindBufferBase(target, index, id);
+        bindsIssued++;
+        unsigned int slot = bufferSlot(target);
+        // the last slot is shared by every target without its own, so it can't say what this one holds
+        buffers[slot] = slot == OTHER_BUFFER_SLOT ? UNKNOWN : id;
+    }
+    // ------------------------------------------------------------------------
+    void bindVertexArray(unsigned int id)
+    {
+        if (track(vertexArray, id))
+            glBindVertexArray(id);
+    }
+    // ------------------------------------------------------------------------
+    void bindTexture(unsigned int unit, GLenum target, unsigned int id)
+    {
+        if (unit >= GL_STATE_MAX_UNITS)
+        {
+            // past what the cache tracks: bind uncached
+            if (dsa)
+                glBindTextureUnit(unit, id);
+            else
+            {
+                activeTexture(unit);
+                glBindTexture(target, id);
+            }
+            bindsIssued++;
+            return;
+        }
+        if (dsa)
+        {
+            if (track(textures[unit], id))
+                glBindTextureUnit(unit, id);
+            return;
+        }
+        if (textures[unit] == id)
+        {
+            bindsAvoided++;
+            return;
+        }
+        activeTexture(unit);
+        glBindTexture(target, id);
+        textures[unit] = id;
+        bindsIssued++;
+    }
+    // GL_FRAMEBUFFER sets both the draw and the read binding, which are remembered separately
+    // ------------------------------------------------------------------------
+    void bindFramebuffer(GLenum target, unsigned int id)
+    {
+        bool draw = target != GL_READ_FRAMEBUFFER;
+        bool read = target != GL_DRAW_FRAMEBUFFER;
+        if ((!draw || drawFramebuffer == id) && (!read || readFramebuffer == id))
+        {
+            bindsAvoided++;
+            return;
+        }
+        glBindFramebuffer(target, id);
+        if (draw)
+            drawFramebuffer = id;
+        if (read)
+            readFramebuffer = id;
+        bindsIssued++;
+    }
+    // ------------------------------------------------------------------------
+    void bindSampler(unsigned int unit, unsigned int id)
+    {
+        if (unit >= GL_STATE_MAX_UNITS)
+        {
+            glBindSampler(unit, id);
+            bindsIssued++;
+            return;
+        }
+        if (track(samplers[unit], id))
+            glBindSampler(unit, id);
+    }
+    // ------------------------------------------------------------------------
+    void activeTexture(unsigned int unit)
+    {
+        if (track(activeUnit, unit))
+            glActiveTexture(GL_TEXTURE0 + unit);
+    }
+    // an object is being deleted, make sure a recycled name isn't mistaken for a cached binding
+    // ------------------------------------------------------------------------
+    void forget(unsigned int id)
+    {
+        for (unsigned int& b : buffers) if (b == id) b = UNKNOWN;
+        for (unsigned int& t : textures) if (t == id) t = UNKNOWN;
+        for (unsigned int& s : samplers) if (s == id) s = UNKNOWN;
+        if (vertexArray == id) vertexArray = UNKNOWN;
+        if (drawFramebuffer == id) drawFramebuffer = UNKNOWN;
+        if (readFramebuffer == id) readFramebuffer = UNKNOWN;
+    }
+    // the texture the cache last bound to unit: 0 for none, GL_STATE_UNKNOWN when it doesn't know
+    // ------------------------------------------------------------------------
+    unsigned int boundTexture(unsigned int unit) const
+    {
+        return unit < GL_STATE_MAX_UNITS ? textures[unit] : UNKNOWN;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "GL_STATE:: " << (dsa ? "direct state access" : "bind-to-edit fallback") << ", " << bindsIssued
+                  << " binds issued, " << bindsAvoided << " skipped as redundant, " << namedEdits << " edits by name" << std::endl;
+    }
+
+private:
+    static constexpr unsigned int UNKNOWN = GL_STATE_UNKNOWN;
+    static constexpr unsigned int OTHER_BUFFER_SLOT = 7;
+    unsigned int buffers[OTHER_BUFFER_SLOT + 1];
+    unsigned int textures[GL_STATE_MAX_UNITS];
+    unsigned int samplers[GL_STATE_MAX_UNITS];
+    unsigned int vertexArray = UNKNOWN;
+    unsigned int activeUnit = UNKNOWN;
+    unsigned int drawFramebuffer = UNKNOWN;
+    unsigned int readFramebuffer = UNKNOWN;
+
+    // returns true when the bind has to be issued
+    bool track(unsigned int& bound, unsigned int id)
+    {
+        if (bound == id)
+        {
+            bindsAvoided++;
+            return false;
+        }
+        bound = id;
+        bindsIssued++;
+        return true;
+    }
+    static unsigned int bufferSlot(GLenum target)
+    {
+        switch (target)
+        {
+        case GL_ARRAY_BUFFER:          return 0;
+        case GL_ELEMENT_ARRAY_BUFFER:  return 1;
+        case GL_UNIFORM_BUFFER:        return 2;
+        case GL_SHADER_STORAGE_BUFFER: return 3;
+        case GL_DRAW_INDIRECT_BUFFER:  return 4;
+        case GL_COPY_READ_BUFFER:      return 5;
+        case GL_COPY_WRITE_BUFFER:     return 6;
+        default:                       return OTHER_BUFFER_SLOT;
+        }
+    }
+};
+
+// the process-wide cache; there is one GL context
+inline GLStateCache& glState()
+{
+    static GLStateCache cache;
+    return cache;
+}
+
+class Buffer
+{
+public:
+    unsigned int ID = 0;
+
+    Buffer()
+    {
+        if (glState().dsa)
+            glCreateBuffers(1, &ID);
+        else
+            glGenBuffers(1, &ID);
+    }
+    ~Buffer()
+    {
+        if (ID)
+        {
+            glState().forget(ID);
+            glDeleteBuffers(1, &ID);
+        }
+    }
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+    Buffer(Buffer&& other) noexcept : ID(other.ID) { other.ID = 0; }
+    Buffer& operator=(Buffer&& other) noexcept { std::swap(ID, other.ID); return *this; }
+    // ------------------------------------------------------------------------
+    void data(size_t size, const void* bytes, GLenum usage = GL_STATIC_DRAW)
+    {
+        if (glState().dsa)
+        {
+            glNamedBufferData(ID, (GLsizeiptr)size, bytes, usage);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)size, bytes, usage);
+    }
+    // ------------------------------------------------------------------------
+    void subData(size_t offset, size_t size, const void* bytes)
+    {
+        if (glState().dsa)
+        {
+            glNamedBufferSubData(ID, (GLintptr)offset, (GLsizeiptr)size, bytes);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindBuffer(GL_COPY_WRITE_BUFFER, ID);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)offset, (GLsizeiptr)size, bytes);
+    }
+    // attach to an indexed binding point (uniform/storage blocks)
+    // ------------------------------------------------------------------------
+    void bindBase(GLenum target, unsigned int index) const
+    {
+        glState().bindBufferBase(target, index, ID);
+    }
+};
+
+class VertexArray
+{
+public:
+    unsigned int ID = 0;
+
+    VertexArray()
+    {
+        if (glState().dsa)
+            glCreateVertexArrays(1, &ID);
+        else
+            glGenVertexArrays(1, &ID);
+    }
+    ~VertexArray()
+    {
+        if (ID)
+        {
+            glState().forget(ID);
+            glDeleteVertexArrays(1, &ID);
+        }
+    }
+    VertexArray(const VertexArray&) = delete;
+    VertexArray& operator=(const VertexArray&) = delete;
+    VertexArray(VertexArray&& other) noexcept : ID(other.ID), bindings(std::move(other.bindings)), attributes(std::move(other.attributes)) { other.ID = 0; }
+    VertexArray& operator=(VertexArray&& other) noexcept
+    {
+        std::swap(ID, other.ID);
+        std::swap(bindings, other.bindings);
+        std::swap(attributes, other.attributes);
+        return *this;
+    }
+    // set the buffer a binding slot reads from; attributes set afterwards with attrib() pick it up
+    // ------------------------------------------------------------------------
+    void vertexBuffer(unsigned int binding, const Buffer& buffer, size_t offset, unsigned int stride)
+    {
+        if (bindings.size() <= binding)
+            bindings.resize(binding + 1);
+        bindings[binding] = { buffer.ID, offset, stride };
+        if (glState().dsa)
+        {
+            glVertexArrayVertexBuffer(ID, binding, buffer.ID, (GLintptr)offset, (GLsizei)stride);
+            glState().namedEdits++;
+        }
+    }
+    // ------------------------------------------------------------------------
+    void elementBuffer(const Buffer& buffer)
+    {
+        if (glState().dsa)
+        {
+            glVertexArrayElementBuffer(ID, buffer.ID);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindVertexArray(ID);
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffer.ID);
+    }
+    // describe one attribute read from a binding slot; integer attributes reach the shader unconverted
+    // ------------------------------------------------------------------------
+    void attrib(unsigned int location, unsigned int binding, int size, GLenum type, bool normalized, unsigned int relativeOffset, bool integer = false)
+    {
+        attributes.erase(std::remove_if(attributes.begin(), attributes.end(), [&](const Attrib& a) { return a.location == location; }), attributes.end());
+        attributes.push_back({ location, binding, size, type, normalized, integer });
+        if (glState().dsa)
+        {
+            glEnableVertexArrayAttrib(ID, location);
+            if (integer)
+                glVertexArrayAttribIFormat(ID, location, size, type, relativeOffset);
+            else
+                glVertexArrayAttribFormat(ID, location, size, type, normalized ? GL_TRUE : GL_FALSE, relativeOffset);
+            glVertexArrayAttribBinding(ID, location, binding);
+            glState().namedEdits++;
+            return;
+        }
+        const Binding& b = bindings.at(binding);
+        glState().bindVertexArray(ID);
+        glState().bindBuffer(GL_ARRAY_BUFFER, b.buffer);
+        const void* pointer = (const void*)(b.offset + relativeOffset);
+        if (integer)
+            glVertexAttribIPointer(location, size, type, b.stride, pointer);
+        else
+            glVertexAttribPointer(location, size, type, normalized ? GL_TRUE : GL_FALSE, b.stride, pointer);
+        glEnableVertexAttribArray(location);
+    }
+    // every attribute of a VertexFormat, read from one buffer
+    // ------------------------------------------------------------------------
+    void format(const VertexFormat& format, const Buffer& buffer, unsigned int binding = 0)
+    {
+        vertexBuffer(binding, buffer, 0, format.stride);
+        for (const VertexAttrib& a : format.attribs)
+        {
+            switch (a.format)
+            {
+            case AttribFormat::Float:         attrib(a.location, binding, a.components, GL_FLOAT, false, a.offset); break;
+            case AttribFormat::Half:          attrib(a.location, binding, 4, GL_HALF_FLOAT, false, a.offset); break;
+            case AttribFormat::Int2_10_10_10: attrib(a.location, binding, 4, GL_INT_2_10_10_10_REV, true, a.offset); break;
+            case AttribFormat::Unorm8:        attrib(a.location, binding, 4, GL_UNSIGNED_BYTE, true, a.offset); break;
+            case AttribFormat::Unorm16:       attrib(a.location, binding, a.components, GL_UNSIGNED_SHORT, true, a.offset); break;
+            }
+        }
+    }
+    // ------------------------------------------------------------------------
+    void bind() const
+    {
+        glState().bindVertexArray(ID);
+    }
+
+    // what attrib() set up, for checking against a program's inputs (shader_reflection.h)
+    struct Attrib
+    {
+        unsigned int location;
+        unsigned int binding;
+        int size;
+        GLenum type;
+        bool normalized;
+        bool integer;
+    };
+    const std::vector<Attrib>& enabledAttribs() const { return attributes; }
+
+private:
+    struct Binding
+    {
+        unsigned int buffer;
+        size_t offset;
+        unsigned int stride;
+    };
+    std::vector<Binding> bindings;
+    std::vector<Attrib> attributes;
+};
+
+class Texture
+{
+public:
+    unsigned int ID = 0;
+    GLenum target;
+
+    explicit Texture(GLenum target = GL_TEXTURE_2D) : target(target)
+    {
+        if (glState().dsa)
+            glCreateTextures(target, 1, &ID);
+        else
+            glGenTextures(1, &ID);
+    }
+    ~Texture()
+    {
+        if (ID)
+        {
+            glState().forget(ID);
+            glDeleteTextures(1, &ID);
+        }
+    }
+    Texture(const Texture&) = delete;
+    Texture& operator=(const Texture&) = delete;
+    Texture(Texture&& other) noexcept : ID(other.ID), target(other.target) { other.ID = 0; }
+    Texture& operator=(Texture&& other) noexcept { std::swap(ID, other.ID); std::swap(target, other.target); return *this; }
+    // allocate immutable storage for every mip level up front
+    // ------------------------------------------------------------------------
+    void storage2D(int levels, GLenum internalFormat, int width, int height)
+    {
+        if (glState().dsa)
+        {
+            glTextureStorage2D(ID, levels, internalFormat, width, height);
+            glState().namedEdits++;
+            return;
+        }
+        bindForEdit();
+        if (GLAD_GL_VERSION_4_2)
+        {
+            glTexStorage2D(target, levels, internalFormat, width, height);
+            return;
+        }
+        // 3.3 has no immutable storage: specify every level by hand and clamp the mip range to match. glTexImage2D
+        //      wants a pixel format and type that fit the internal format even when there are no pixels
+        GLenum format, type;
+        if (!uploadFormat(internalFormat, format, type))
+        {
+            std::cout << "ERROR::TEXTURE::UNSUPPORTED_FORMAT: no 3.3 storage for internal format 0x" << std::hex << internalFormat << std::dec << std::endl;
+            return;
+        }
+        for (int level = 0; level < levels; level++)
+        {
+            glTexImage2D(target, level, internalFormat, width, height, 0, format, type, nullptr);
+            width = std::max(1, width / 2);
+            height = std::max(1, height / 2);
+        }
+        glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    }
+    // storage for a GL_TEXTURE_2D_MULTISAMPLE texture (render targets only, multisampled textures have no mips)
+    // ------------------------------------------------------------------------
+    void storage2DMultisample(int samples, GLenum internalFormat, int width, int height)
+    {
+        if (glState().dsa)
+        {
+            glTextureStorage2DMultisample(ID, samples, internalFormat, width, height, GL_TRUE);
+            glState().namedEdits++;
+            return;
+        }
+        bindForEdit();
+        if (GLAD_GL_VERSION_4_3)
+            glTexStorage2DMultisample(target, samples, internalFormat, width, height, GL_TRUE);
+        else
+            glTexImage2DMultisample(target, samples, internalFormat, width, height, GL_TRUE);
+    }
+    // ------------------------------------------------------------------------
+    void subImage2D(int level, int x, int y, int width, int height, GLenum format, GLenum type, const void* pixels)
+    {
+        if (glState().dsa)
+        {
+            glTextureSubImage2D(ID, level, x, y, width, height, format, type, pixels);
+            glState().namedEdits++;
+            return;
+        }
+        bindForEdit();
+        glTexSubImage2D(target, level, x, y, width, height, format, type, pixels);
+    }
+    // ------------------------------------------------------------------------
+    void generateMipmap()
+    {
+        if (glState().dsa)
+        {
+            glGenerateTextureMipmap(ID);
+            glState().namedEdits++;
+            return;
+        }
+        bindForEdit();
+        glGenerateMipmap(target);
+    }
+    // sampling state is better kept in a Sampler; this is for texture-only state such as GL_TEXTURE_MAX_LEVEL
+    // ------------------------------------------------------------------------
+    void parameter(GLenum name, int value)
+    {
+        if (glState().dsa)
+        {
+            glTextureParameteri(ID, name, value);
+            glState().namedEdits++;
+            return;
+        }
+        bindForEdit();
+        glTexParameteri(target, name, value);
+    }
+    // ------------------------------------------------------------------------
+    void bind(unsigned int unit) const
+    {
+        glState().bindTexture(unit, target, ID);
+    }
+
+private:
+    // edits go through unit 0, which is where the samples keep their first texture anyway
+    void bindForEdit()
+    {
+        glState().bindTexture(0, target, ID);
+    }
+    // a pixel format and type glTexImage2D accepts along with a sized internal format; false for ones not listed
+    static bool uploadFormat(GLenum internalFormat, GLenum& format, GLenum& type)
+    {
+        switch (internalFormat)
+        {
+        case GL_R8:                 format = GL_RED;  type = GL_UNSIGNED_BYTE; return true;
+        case GL_RG8:                format = GL_RG;   type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGB8: case GL_SRGB8:
+                                    format = GL_RGB;  type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGBA8: case GL_SRGB8_ALPHA8:
+                                    format = GL_RGBA; type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGB10_A2:           format = GL_RGBA; type = GL_UNSIGNED_INT_2_10_10_10_REV; return true;
+        case GL_R11F_G11F_B10F:     format = GL_RGB;  type = GL_UNSIGNED_INT_10F_11F_11F_REV; return true;
+        case GL_R16F:               format = GL_RED;  type = GL_HALF_FLOAT; return true;
+        case GL_RG16F:              format = GL_RG;   type = GL_HALF_FLOAT; return true;
+        case GL_RGB16F:             format = GL_RGB;  type = GL_HALF_FLOAT; return true;
+        case GL_RGBA16F:            format = GL_RGBA; type = GL_HALF_FLOAT; return true;
+        case GL_R32F:               format = GL_RED;  type = GL_FLOAT; return true;
+        case GL_RG32F:              format = GL_RG;   type = GL_FLOAT; return true;
+        case GL_RGB32F:             format = GL_RGB;  type = GL_FLOAT; return true;
+        case GL_RGBA32F:            format = GL_RGBA; type = GL_FLOAT; return true;
+        case GL_R8UI:               format = GL_RED_INTEGER;  type = GL_UNSIGNED_BYTE; return true;
+        case GL_RG8UI:              format = GL_RG_INTEGER;   type = GL_UNSIGNED_BYTE; return true;
+        case GL_RGBA8UI:            format = GL_RGBA_INTEGER; type = GL_UNSIGNED_BYTE; return true;
+        case GL_R16UI:              format = GL_RED_INTEGER;  type = GL_UNSIGNED_SHORT; return true;
+        case GL_RG16UI:             format = GL_RG_INTEGER;   type = GL_UNSIGNED_SHORT; return true;
+        case GL_RGBA16UI:           format = GL_RGBA_INTEGER; type = GL_UNSIGNED_SHORT; return true;
+        case GL_R32UI:              format = GL_RED_INTEGER;  type = GL_UNSIGNED_INT; return true;
+        case GL_RG32UI:             format = GL_RG_INTEGER;   type = GL_UNSIGNED_INT; return true;
+        case GL_RGBA32UI:           format = GL_RGBA_INTEGER; type = GL_UNSIGNED_INT; return true;
+        case GL_R32I:               format = GL_RED_INTEGER;  type = GL_INT; return true;
+        case GL_RG32I:              format = GL_RG_INTEGER;   type = GL_INT; return true;
+        case GL_RGBA32I:            format = GL_RGBA_INTEGER; type = GL_INT; return true;
+        case GL_DEPTH_COMPONENT16:  format = GL_DEPTH_COMPONENT; type = GL_UNSIGNED_SHORT; return true;
+        case GL_DEPTH_COMPONENT24:  format = GL_DEPTH_COMPONENT; type = GL_UNSIGNED_INT; return true;
+        case GL_DEPTH_COMPONENT32F: format = GL_DEPTH_COMPONENT; type = GL_FLOAT; return true;
+        case GL_DEPTH24_STENCIL8:   format = GL_DEPTH_STENCIL; type = GL_UNSIGNED_INT_24_8; return true;
+        case GL_DEPTH32F_STENCIL8:  format = GL_DEPTH_STENCIL; type = GL_FLOAT_32_UNSIGNED_INT_24_8_REV; return true;
+        default:                    return false;
+        }
+    }
+};
+
+class Sampler
+{
+public:
+    unsigned int ID = 0;
+
+    Sampler()
+    {
+        if (glState().dsa)
+            glCreateSamplers(1, &ID);
+        else
+            glGenSamplers(1, &ID);
+    }
+    ~Sampler()
+    {
+        if (ID)
+        {
+            glState().forget(ID);
+            glDeleteSamplers(1, &ID);
+        }
+    }
+    Sampler(const Sampler&) = delete;
+    Sampler& operator=(const Sampler&) = delete;
+    Sampler(Sampler&& other) noexcept : ID(other.ID) { other.ID = 0; }
+    Sampler& operator=(Sampler&& other) noexcept { std::swap(ID, other.ID); return *this; }
+    // sampler objects were always edited by name, so there is nothing to bind here on any path
+    // ------------------------------------------------------------------------
+    void parameter(GLenum name, int value)
+    {
+        glSamplerParameteri(ID, name, value);
+    }
+    void parameter(GLenum name, float value)
+    {
+        glSamplerParameterf(ID, name, value);
+    }
+    // ------------------------------------------------------------------------
+    void bind(unsigned int unit) const
+    {
+        glState().bindSampler(unit, ID);
+    }
+};
+
+// storage that can only be rendered to and blitted from, never sampled; the driver is free to keep it in whatever
+//      layout suits rendering
+class Renderbuffer
+{
+public:
+    unsigned int ID = 0;
+
+    Renderbuffer()
+    {
+        if (glState().dsa)
+            glCreateRenderbuffers(1, &ID);
+        else
+            glGenRenderbuffers(1, &ID);
+    }
+    ~Renderbuffer()
+    {
+        if (ID)
+        {
+            glState().forget(ID);
+            glDeleteRenderbuffers(1, &ID);
+        }
+    }
+    Renderbuffer(const Renderbuffer&) = delete;
+    Renderbuffer& operator=(const Renderbuffer&) = delete;
+    Renderbuffer(Renderbuffer&& other) noexcept : ID(other.ID) { other.ID = 0; }
+    Renderbuffer& operator=(Renderbuffer&& other) noexcept { std::swap(ID, other.ID); return *this; }
+    // ------------------------------------------------------------------------
+    void storage(GLenum internalFormat, int width, int height, int samples = 1)
+    {
+        if (glState().dsa)
+        {
+            glNamedRenderbufferStorageMultisample(ID, samples > 1 ? samples : 0, internalFormat, width, height);
+            glState().namedEdits++;
+            return;
+        }
+        // renderbuffers aren't bound by anything else, there's nothing to cache
+        glBindRenderbuffer(GL_RENDERBUFFER, ID);
+        glRenderbufferStorageMultisample(GL_RENDERBUFFER, samples > 1 ? samples : 0, internalFormat, width, height);
+    }
+};
+
+class Framebuffer
+{
+public:
+    unsigned int ID = 0;
+
+    Framebuffer()
+    {
+        if (glState().dsa)
+            glCreateFramebuffers(1, &ID);
+        else
+            glGenFramebuffers(1, &ID);
+    }
+    ~Framebuffer()
+    {
+        if (ID)
+        {
+            glState().forget(ID);
+            glDeleteFramebuffers(1, &ID);
+        }
+    }
+    Framebuffer(const Framebuffer&) = delete;
+    Framebuffer& operator=(const Framebuffer&) = delete;
+    Framebuffer(Framebuffer&& other) noexcept : ID(other.ID) { other.ID = 0; }
+    Framebuffer& operator=(Framebuffer&& other) noexcept { std::swap(ID, other.ID); return *this; }
+    // attach one mip level of a 2D texture (GL_COLOR_ATTACHMENTi, GL_DEPTH_ATTACHMENT, GL_DEPTH_STENCIL_ATTACHMENT)
+    // ------------------------------------------------------------------------
+    void attach(GLenum attachment, const Texture& texture, int level = 0)
+    {
+        if (glState().dsa)
+        {
+            glNamedFramebufferTexture(ID, attachment, texture.ID, level);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindFramebuffer(GL_FRAMEBUFFER, ID);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, attachment, texture.target, texture.ID, level);
+    }
+    // ------------------------------------------------------------------------
+    void attach(GLenum attachment, const Renderbuffer& renderbuffer)
+    {
+        if (glState().dsa)
+        {
+            glNamedFramebufferRenderbuffer(ID, attachment, GL_RENDERBUFFER, renderbuffer.ID);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindFramebuffer(GL_FRAMEBUFFER, ID);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, renderbuffer.ID);
+    }
+    // draw into GL_COLOR_ATTACHMENT0 .. count - 1; 0 for depth-only framebuffers
+    // ------------------------------------------------------------------------
+    void drawBuffers(int count)
+    {
+        GLenum buffers[8];
+        count = std::min(count, 8);
+        for (int i = 0; i < count; i++)
+            buffers[i] = GL_COLOR_ATTACHMENT0 + i;
+        if (glState().dsa)
+        {
+            if (count)
+                glNamedFramebufferDrawBuffers(ID, count, buffers);
+            else
+                glNamedFramebufferDrawBuffer(ID, GL_NONE);
+            glState().namedEdits++;
+            return;
+        }
+        glState().bindFramebuffer(GL_FRAMEBUFFER, ID);
+        if (count)
+            glDrawBuffers(count, buffers);
+        else
+            glDrawBuffer(GL_NONE);
+    }
+    // false (and prints the status) if GL can't render into the attachments as they are
+    // ------------------------------------------------------------------------
+    bool complete()
+    {
+        GLenum status;
+        if (glState().dsa)
+            status = glCheckNamedFramebufferStatus(ID, GL_FRAMEBUFFER);
+        else
+        {
+            glState().bindFramebuffer(GL_FRAMEBUFFER, ID);
+            status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+        }
+        if (status != GL_FRAMEBUFFER_COMPLETE)
+            std::cout << "ERROR::FRAMEBUFFER::INCOMPLETE: status 0x" << std::hex << status << std::dec << std::endl;
+        return status == GL_FRAMEBUFFER_COMPLETE;
+    }
+    // ------------------------------------------------------------------------
+    void bind(GLenum target = GL_FRAMEBUFFER) const
+    {
+        glState().bindFramebuffer(target, ID);
+    }
+};
+#endif
@@ -0,0 +1,1112 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+#include <glad/glad.h>
+
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+//////// GL CALL TRACE ////
+// - glad calls through one function pointer per entry point (glBindBuffer is a macro for the glad_glBindBuffer
+//      pointer), so tracing doesn't need glad's debug build: glTrace().begin() swaps the pointers of every function in
+//      GL_TRACE_FUNCTIONS for recording wrappers that forward to the real driver, and end() puts them back
+// - a wrapper appends one record per call: the call id, every argument, and whatever its pointers point at (upload
+//      data, uniform values, shader sources), then the object names the call handed back. Sizes come from the
+//      call's other arguments, see glTracePointer()
+// - trace file: "LOGT" header, the table of function names (so ids survive changes to the list), then records of
+//      u16 id + u32 size + payload, with frame markers in between. Data payloads are 8-byte aligned in the file so the
+//      replayer can point GL straight into the mapped file
+// - GLTraceReplayer re-executes records through the same glad pointers, which hold either the real driver or the
+//      counting stubs from glTraceInstallStubs(). Object names are remapped, since a new context hands out its own.
+//      Uniform locations and block indices are replayed as recorded
+// - GLTraceStats runs over the decoded calls: calls per frame and per function, bytes uploaded, and state changes
+//      that set what was already set
+// - only what's listed is traced; entry points fetched outside glad (bindless.h) aren't
+// - the reflection queries (glGetProgramInterfaceiv, glGetProgramResource*, glGetActiveUniform*, glGetActiveAttrib,
+//      glGetAttribLocation, glGetUniformiv; shader_reflection.h) are deliberately not traced: they only read back
+//      what a program already is, and since uniform locations replay as recorded nothing in a replay needs their
+//      answers
+
+#define GL_TRACE_FUNCTIONS(X) \
+    X(ActiveTexture) X(AttachShader) X(BindBuffer) X(BindBufferBase) X(BindFramebuffer) X(BindProgramPipeline) \
+    X(BindRenderbuffer) X(BindSampler) X(BindTexture) X(BindTextureUnit) X(BindVertexArray) X(BlendFunc) \
+    X(BlitFramebuffer) X(BlitNamedFramebuffer) X(BufferData) X(BufferSubData) X(CheckFramebufferStatus) \
+    X(CheckNamedFramebufferStatus) X(Clear) X(ClearColor) X(ClearDepth) X(ClipControl) X(CompileShader) \
+    X(CopyBufferSubData) X(CreateBuffers) X(CreateFramebuffers) X(CreateProgram) X(CreateProgramPipelines) \
+    X(CreateRenderbuffers) X(CreateSamplers) X(CreateShader) X(CreateTextures) X(CreateVertexArrays) X(CullFace) \
+    X(DeleteBuffers) X(DeleteFramebuffers) X(DeleteProgram) X(DeleteProgramPipelines) X(DeleteQueries) \
+    X(DeleteRenderbuffers) X(DeleteSamplers) X(DeleteShader) X(DeleteTextures) X(DeleteVertexArrays) X(DepthFunc) \
+    X(DepthMask) X(DetachShader) X(Disable) X(DrawArrays) X(DrawArraysInstanced) X(DrawBuffer) X(DrawBuffers) \
+    X(DrawElements) X(DrawElementsBaseVertex) X(DrawElementsInstanced) X(Enable) X(EnableVertexArrayAttrib) \
+    X(EnableVertexAttribArray) X(FramebufferRenderbuffer) X(FramebufferTexture2D) X(GenBuffers) X(GenFramebuffers) \
+    X(GenProgramPipelines) X(GenQueries) X(GenRenderbuffers) X(GenSamplers) X(GenTextures) X(GenVertexArrays) \
+    X(GenerateMipmap) X(GenerateTextureMipmap) X(GetIntegerv) X(GetProgramInfoLog) X(GetProgramPipelineInfoLog) \
+    X(GetProgramPipelineiv) X(GetProgramiv) X(GetQueryObjectiv) X(GetQueryObjectui64v) X(GetShaderInfoLog) X(GetShaderiv) \
+    X(GetUniformBlockIndex) X(GetUniformLocation) X(LinkProgram) X(MultiDrawElements) X(MultiDrawElementsIndirect) \
+    X(NamedBufferData) X(NamedBufferSubData) X(NamedFramebufferDrawBuffer) X(NamedFramebufferDrawBuffers) \
+    X(NamedFramebufferRenderbuffer) X(NamedFramebufferTexture) X(NamedRenderbufferStorageMultisample) X(PixelStorei) \
+    X(PolygonMode) X(ProgramParameteri) X(QueryCounter) X(RenderbufferStorageMultisample) X(SamplerParameterf) \
+    X(SamplerParameteri) X(Scissor) X(ShaderSource) X(TexImage2D) X(TexImage2DMultisample) X(TexParameteri) \
+    X(TexStorage2D) X(TexStorage2DMultisample) X(TexSubImage2D) X(TextureParameteri) X(TextureStorage2D) \
+    X(TextureStorage2DMultisample) X(TextureSubImage2D) X(Uniform1f) X(Uniform1i) X(Uniform2f) X(Uniform2fv) X(Uniform3f) \
+    X(Uniform3fv) X(Uniform4f) X(Uniform4fv) X(UniformBlockBinding) X(UniformMatrix2fv) X(UniformMatrix3fv) \
+    X(UniformMatrix4fv) X(UseProgram) X(UseProgramStages) X(ValidateProgramPipeline) X(VertexArrayAttribBinding) \
+    X(VertexArrayAttribFormat) X(VertexArrayAttribIFormat) X(VertexArrayElementBuffer) X(VertexArrayVertexBuffer) \
+    X(VertexAttribDivisor) X(VertexAttribIPointer) X(VertexAttribPointer) X(Viewport)
+
+enum class GLCall : uint16_t
+{
+#define GL_TRACE_ENUM(name) name,
+    GL_TRACE_FUNCTIONS(GL_TRACE_ENUM)
+#undef GL_TRACE_ENUM
+    Count
+};
+
+const unsigned int GL_CALL_COUNT = (unsigned int)GLCall::Count;
+const uint16_t GL_TRACE_FRAME = 0xFFFF;
+const char GL_TRACE_MAGIC[4] = { 'L', 'O', 'G', 'T' };
+const uint32_t GL_TRACE_VERSION = 1;
+
+// how a pointer argument is stored
+enum class GLTraceArg : uint8_t
+{
+    Value,      // the pointer itself: buffer offsets, or null
+    Input,      // the bytes it points at
+    Output,     // written by GL, not recorded; the replayer passes scratch memory
+    Names,      // object names written by GL (glGen*), recorded after the call for remapping
+    NameArray,  // object names read by GL (glDelete*), remapped on replay
+    Strings,    // array of strings (glShaderSource)
+    Lengths     // string lengths belonging to the preceding Strings argument
+};
+
+struct GLTracePointer
+{
+    GLTraceArg kind;
+    uint32_t bytes;
+};
+
+// kinds of object names, each remapped separately
+enum class GLNamespace : uint8_t
+{
+    None, Buffer, Texture, VertexArray, Sampler, Query, Program, Shader, Framebuffer, ProgramPipeline, Renderbuffer, Count
+};
+
+// ------------------------------------------------------------------------
+inline const char* glCallName(GLCall call)
+{
+    static const char* names[] = {
+#define GL_TRACE_NAME(name) "gl" #name,
+        GL_TRACE_FUNCTIONS(GL_TRACE_NAME)
+#undef GL_TRACE_NAME
+    };
+    return call < GLCall::Count ? names[(unsigned int)call] : "unknown";
+}
+
+// the glad pointer variable behind a call
+// ------------------------------------------------------------------------
+inline void** glTraceSlot(GLCall call)
+{
+    static void** slots[] = {
+#define GL_TRACE_SLOT(name) reinterpret_cast<void**>(&glad_gl##name),
+        GL_TRACE_FUNCTIONS(GL_TRACE_SLOT)
+#undef GL_TRACE_SLOT
+    };
+    return slots[(unsigned int)call];
+}
+
+// any argument as 64 bits: integers sign/zero extended, floats by their bits, pointers by address
+// ------------------------------------------------------------------------
+template <typename T>
+inline uint64_t glTraceScalar(T value)
+{
+    if constexpr (std::is_pointer<T>::value)
+        return (uint64_t)(uintptr_t)value;
+    else if constexpr (std::is_floating_point<T>::value)
+    {
+        uint64_t bits = 0;
+        std::memcpy(&bits, &value, sizeof(T));
+        return bits;
+    }
+    else
+        return (uint64_t)(int64_t)value;
+}
+
+// bytes of a width x height pixel rectangle in client memory
+// ------------------------------------------------------------------------
+inline uint32_t glTracePixelBytes(uint64_t width, uint64_t height, uint64_t format, uint64_t type, int alignment)
+{
+    uint32_t pixel;
+    switch (type)
+    {
+    case GL_UNSIGNED_SHORT_5_6_5: case GL_UNSIGNED_SHORT_4_4_4_4: case GL_UNSIGNED_SHORT_5_5_5_1:
+        pixel = 2; break;
+    case GL_UNSIGNED_INT_8_8_8_8: case GL_UNSIGNED_INT_8_8_8_8_REV: case GL_UNSIGNED_INT_2_10_10_10_REV:
+    case GL_UNSIGNED_INT_10_10_10_2: case GL_UNSIGNED_INT_24_8: case GL_UNSIGNED_INT_10F_11F_11F_REV: case GL_UNSIGNED_INT_5_9_9_9_REV:
+        pixel = 4; break;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        pixel = 8; break;
+    default:
+    {
+        uint32_t components = 4;
+        switch (format)
+        {
+        case GL_RED: case GL_RED_INTEGER: case GL_DEPTH_COMPONENT: case GL_STENCIL_INDEX: components = 1; break;
+        case GL_RG: case GL_RG_INTEGER: components = 2; break;
+        case GL_RGB: case GL_BGR: case GL_RGB_INTEGER: case GL_BGR_INTEGER: components = 3; break;
+        }
+        uint32_t size = type == GL_UNSIGNED_BYTE || type == GL_BYTE ? 1 : type == GL_UNSIGNED_SHORT || type == GL_SHORT || type == GL_HALF_FLOAT ? 2 : 4;
+        pixel = components * size;
+    }
+    }
+    if (width == 0 || height == 0)
+        return 0;
+    uint64_t row = (width * pixel + alignment - 1) / alignment * alignment;
+    return (uint32_t)(row * (height - 1) + width * pixel);
+}
+
+// how pointer argument `arg` of a call is stored; a holds every argument as glTraceScalar()
+// ------------------------------------------------------------------------
+inline GLTracePointer glTracePointer(GLCall call, unsigned int arg, const uint64_t* a, int unpackAlignment)
+{
+    auto input = [&](uint64_t bytes) { return a[arg] ? GLTracePointer{ GLTraceArg::Input, (uint32_t)bytes } : GLTracePointer{ GLTraceArg::Value, 0 }; };
+    auto output = [](uint64_t bytes) { return GLTracePointer{ GLTraceArg::Output, (uint32_t)bytes }; };
+    auto names = [](uint64_t count) { return GLTracePointer{ GLTraceArg::Names, (uint32_t)(count * sizeof(GLuint)) }; };
+    auto nameArray = [](uint64_t count) { return GLTracePointer{ GLTraceArg::NameArray, (uint32_t)(count * sizeof(GLuint)) }; };
+    switch (call)
+    {
+    case GLCall::BufferData: case GLCall::NamedBufferData:              return input(a[1]);
+    case GLCall::BufferSubData: case GLCall::NamedBufferSubData:        return input(a[2]);
+    case GLCall::TexImage2D:                                            return input(glTracePixelBytes(a[3], a[4], a[6], a[7], unpackAlignment));
+    case GLCall::TexSubImage2D: case GLCall::TextureSubImage2D:         return input(glTracePixelBytes(a[4], a[5], a[6], a[7], unpackAlignment));
+    case GLCall::Uniform2fv:                                            return input(a[1] * 2 * sizeof(float));
+    case GLCall::Uniform3fv:                                            return input(a[1] * 3 * sizeof(float));
+    case GLCall::Uniform4fv:                                            return input(a[1] * 4 * sizeof(float));
+    case GLCall::UniformMatrix2fv:                                      return input(a[1] * 4 * sizeof(float));
+    case GLCall::UniformMatrix3fv:                                      return input(a[1] * 9 * sizeof(float));
+    case GLCall::UniformMatrix4fv:                                      return input(a[1] * 16 * sizeof(float));
+    case GLCall::GetUniformLocation: case GLCall::GetUniformBlockIndex: return input(std::strlen((const char*)(uintptr_t)a[1]) + 1);
+    case GLCall::ShaderSource:                                          return { arg == 2 ? GLTraceArg::Strings : GLTraceArg::Lengths, 0 };
+    case GLCall::MultiDrawElements:                                     return input(a[4] * (arg == 1 ? sizeof(GLsizei) : sizeof(void*)));
+    case GLCall::DrawBuffers:                                           return input(a[0] * sizeof(GLenum));
+    case GLCall::NamedFramebufferDrawBuffers:                           return input(a[1] * sizeof(GLenum));
+    case GLCall::GenBuffers: case GLCall::GenFramebuffers: case GLCall::GenQueries: case GLCall::GenSamplers: case GLCall::GenTextures:
+    case GLCall::GenVertexArrays: case GLCall::CreateBuffers: case GLCall::CreateSamplers: case GLCall::CreateVertexArrays:
+    case GLCall::GenProgramPipelines: case GLCall::CreateProgramPipelines: case GLCall::CreateFramebuffers:
+    case GLCall::GenRenderbuffers: case GLCall::CreateRenderbuffers:
+        return names(a[0]);
+    case GLCall::CreateTextures:                                        return names(a[1]);
+    case GLCall::DeleteBuffers: case GLCall::DeleteFramebuffers: case GLCall::DeleteQueries: case GLCall::DeleteSamplers:
+    case GLCall::DeleteTextures: case GLCall::DeleteVertexArrays: case GLCall::DeleteProgramPipelines: case GLCall::DeleteRenderbuffers:
+        return nameArray(a[0]);
+    case GLCall::GetIntegerv:                                           return output(16 * sizeof(GLint));
+    case GLCall::GetShaderiv: case GLCall::GetProgramiv: case GLCall::GetProgramPipelineiv:
+        return output(4 * sizeof(GLint));
+    case GLCall::GetQueryObjectiv: case GLCall::GetQueryObjectui64v:    return output(sizeof(GLuint64));
+    case GLCall::GetShaderInfoLog: case GLCall::GetProgramInfoLog: case GLCall::GetProgramPipelineInfoLog:
+        return output(arg == 2 ? sizeof(GLsizei) : a[1]);
+    default:                                                            return { GLTraceArg::Value, 0 };
+    }
+}
+
+// which kind of object name integer argument `arg` of a call is
+// ------------------------------------------------------------------------
+inline GLNamespace glTraceNamespace(GLCall call, unsigned int arg)
+{
+    switch (call)
+    {
+    case GLCall::BindBuffer:                    return arg == 1 ? GLNamespace::Buffer : GLNamespace::None;
+    case GLCall::BindBufferBase:                return arg == 2 ? GLNamespace::Buffer : GLNamespace::None;
+    case GLCall::BindFramebuffer:               return arg == 1 ? GLNamespace::Framebuffer : GLNamespace::None;
+    case GLCall::NamedFramebufferDrawBuffer: case GLCall::NamedFramebufferDrawBuffers: case GLCall::CheckNamedFramebufferStatus:
+        return arg == 0 ? GLNamespace::Framebuffer : GLNamespace::None;
+    case GLCall::NamedFramebufferTexture:       return arg == 0 ? GLNamespace::Framebuffer : arg == 2 ? GLNamespace::Texture : GLNamespace::None;
+    case GLCall::FramebufferTexture2D:          return arg == 3 ? GLNamespace::Texture : GLNamespace::None;
+    case GLCall::NamedFramebufferRenderbuffer:  return arg == 0 ? GLNamespace::Framebuffer : arg == 3 ? GLNamespace::Renderbuffer : GLNamespace::None;
+    case GLCall::FramebufferRenderbuffer:       return arg == 3 ? GLNamespace::Renderbuffer : GLNamespace::None;
+    case GLCall::BindRenderbuffer:              return arg == 1 ? GLNamespace::Renderbuffer : GLNamespace::None;
+    case GLCall::NamedRenderbufferStorageMultisample:
+        return arg == 0 ? GLNamespace::Renderbuffer : GLNamespace::None;
+    case GLCall::BlitNamedFramebuffer:          return arg <= 1 ? GLNamespace::Framebuffer : GLNamespace::None;
+    case GLCall::BindSampler:                   return arg == 1 ? GLNamespace::Sampler : GLNamespace::None;
+    case GLCall::BindTexture: case GLCall::BindTextureUnit:
+        return arg == 1 ? GLNamespace::Texture : GLNamespace::None;
+    case GLCall::BindVertexArray:               return arg == 0 ? GLNamespace::VertexArray : GLNamespace::None;
+    case GLCall::AttachShader: case GLCall::DetachShader:
+        return arg == 0 ? GLNamespace::Program : arg == 1 ? GLNamespace::Shader : GLNamespace::None;
+    case GLCall::CompileShader: case GLCall::DeleteShader: case GLCall::GetShaderInfoLog: case GLCall::GetShaderiv: case GLCall::ShaderSource:
+        return arg == 0 ? GLNamespace::Shader : GLNamespace::None;
+    case GLCall::DeleteProgram: case GLCall::GetProgramInfoLog: case GLCall::GetProgramiv: case GLCall::GetUniformBlockIndex:
+    case GLCall::GetUniformLocation: case GLCall::LinkProgram: case GLCall::UniformBlockBinding: case GLCall::UseProgram:
+    case GLCall::ProgramParameteri:
+        return arg == 0 ? GLNamespace::Program : GLNamespace::None;
+    case GLCall::BindProgramPipeline: case GLCall::ValidateProgramPipeline: case GLCall::GetProgramPipelineiv:
+    case GLCall::GetProgramPipelineInfoLog:
+        return arg == 0 ? GLNamespace::ProgramPipeline : GLNamespace::None;
+    case GLCall::UseProgramStages:              return arg == 0 ? GLNamespace::ProgramPipeline : arg == 2 ? GLNamespace::Program : GLNamespace::None;
+    case GLCall::NamedBufferData: case GLCall::NamedBufferSubData:
+        return arg == 0 ? GLNamespace::Buffer : GLNamespace::None;
+    case GLCall::EnableVertexArrayAttrib: case GLCall::VertexArrayAttribBinding: case GLCall::VertexArrayAttribFormat:
+    case GLCall::VertexArrayAttribIFormat:
+        return arg == 0 ? GLNamespace::VertexArray : GLNamespace::None;
+    case GLCall::VertexArrayElementBuffer:      return arg == 0 ? GLNamespace::VertexArray : arg == 1 ? GLNamespace::Buffer : GLNamespace::None;
+    case GLCall::VertexArrayVertexBuffer:       return arg == 0 ? GLNamespace::VertexArray : arg == 2 ? GLNamespace::Buffer : GLNamespace::None;
+    case GLCall::GenerateTextureMipmap: case GLCall::TextureParameteri: case GLCall::TextureStorage2D: case GLCall::TextureSubImage2D:
+    case GLCall::TextureStorage2DMultisample:
+        return arg == 0 ? GLNamespace::Texture : GLNamespace::None;
+    case GLCall::SamplerParameterf: case GLCall::SamplerParameteri:
+        return arg == 0 ? GLNamespace::Sampler : GLNamespace::None;
+    case GLCall::QueryCounter: case GLCall::GetQueryObjectiv: case GLCall::GetQueryObjectui64v:
+        return arg == 0 ? GLNamespace::Query : GLNamespace::None;
+    default:
+        return GLNamespace::None;
+    }
+}
+
+// which kind of object a call creates or deletes (through a name array or its return value)
+// ------------------------------------------------------------------------
+inline GLNamespace glTraceObjectNamespace(GLCall call)
+{
+    switch (call)
+    {
+    case GLCall::GenBuffers: case GLCall::CreateBuffers: case GLCall::DeleteBuffers:                return GLNamespace::Buffer;
+    case GLCall::GenTextures: case GLCall::CreateTextures: case GLCall::DeleteTextures:             return GLNamespace::Texture;
+    case GLCall::GenVertexArrays: case GLCall::CreateVertexArrays: case GLCall::DeleteVertexArrays: return GLNamespace::VertexArray;
+    case GLCall::GenSamplers: case GLCall::CreateSamplers: case GLCall::DeleteSamplers:             return GLNamespace::Sampler;
+    case GLCall::GenQueries: case GLCall::DeleteQueries:                                            return GLNamespace::Query;
+    case GLCall::GenFramebuffers: case GLCall::CreateFramebuffers: case GLCall::DeleteFramebuffers: return GLNamespace::Framebuffer;
+    case GLCall::GenProgramPipelines: case GLCall::CreateProgramPipelines: case GLCall::DeleteProgramPipelines:
+        return GLNamespace::ProgramPipeline;
+    case GLCall::GenRenderbuffers: case GLCall::CreateRenderbuffers: case GLCall::DeleteRenderbuffers:
+        return GLNamespace::Renderbuffer;
+    case GLCall::CreateProgram:                                                                     return GLNamespace::Program;
+    case GLCall::CreateShader:                                                                      return GLNamespace::Shader;
+    default:                                                                                        return GLNamespace::None;
+    }
+}
+
+class GLTraceWriter
+{
+public:
+    void* originals[GL_CALL_COUNT] = {};
+    uint64_t calls = 0;
+    uint64_t frames = 0;
+
+    // start recording every traced call into path
+    // ------------------------------------------------------------------------
+    bool begin(const char* path);
+    // stop recording, restore the driver's entry points and close the file
+    // ------------------------------------------------------------------------
+    void end()
+    {
+        if (!file.is_open())
+            return;
+        for (unsigned int i = 0; i < GL_CALL_COUNT; i++)
+            *glTraceSlot((GLCall)i) = originals[i];
+        flush();
+        file.close();
+        std::cout << "GL_TRACE:: " << calls << " calls over " << frames << " frames, " << written / 1024 << " KB" << std::endl;
+    }
+    // ------------------------------------------------------------------------
+    bool active() const
+    {
+        return file.is_open();
+    }
+    // mark the end of a frame, after SwapBuffers
+    // ------------------------------------------------------------------------
+    void frame()
+    {
+        if (!active())
+            return;
+        put(GL_TRACE_FRAME);
+        frames++;
+        if (buffer.size() > (8u << 20))
+            flush();
+    }
+
+    // used by the recording wrappers
+    // ------------------------------------------------------------------------
+    size_t beginRecord(GLCall call)
+    {
+        calls++;
+        put((uint16_t)call);
+        size_t start = buffer.size();
+        put((uint32_t)0);
+        return start;
+    }
+    void endRecord(size_t start)
+    {
+        uint32_t size = (uint32_t)(buffer.size() - start - sizeof(uint32_t));
+        std::memcpy(&buffer[start], &size, sizeof(size));
+    }
+    template <typename T>
+    void put(const T& value)
+    {
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+    void putBytes(const void* data, size_t size)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        buffer.insert(buffer.end(), bytes, bytes + size);
+    }
+    // pad to a multiple of 8 bytes from the start of the file
+    void align()
+    {
+        while ((written + buffer.size()) % 8)
+            buffer.push_back(0);
+    }
+    template <typename T>
+    void writeArg(GLCall call, unsigned int arg, T value, const uint64_t* a)
+    {
+        if constexpr (std::is_pointer<T>::value)
+        {
+            GLTracePointer p = glTracePointer(call, arg, a, unpackAlignment);
+            put(p.kind);
+            switch (p.kind)
+            {
+            case GLTraceArg::Value:
+                put(a[arg]);
+                break;
+            case GLTraceArg::Input: case GLTraceArg::NameArray:
+                put(p.bytes);
+                align();
+                putBytes((const void*)value, p.bytes);
+                break;
+            case GLTraceArg::Output: case GLTraceArg::Names:
+                put(p.bytes);
+                break;
+            case GLTraceArg::Strings:
+            {
+                // glShaderSource(shader, count, strings, lengths)
+                const GLchar* const* strings = (const GLchar* const*)value;
+                const GLint* lengths = (const GLint*)(uintptr_t)a[3];
+                uint32_t count = (uint32_t)a[1];
+                put(count);
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    uint32_t length = lengths && lengths[i] >= 0 ? (uint32_t)lengths[i] : (uint32_t)std::strlen(strings[i]);
+                    put(length);
+                    putBytes(strings[i], length);
+                }
+                break;
+            }
+            case GLTraceArg::Lengths:
+                break;
+            }
+        }
+        else
+            put(value);
+    }
+    template <typename T>
+    void writeOutput(GLCall call, unsigned int arg, T value, const uint64_t* a)
+    {
+        if constexpr (std::is_pointer<T>::value)
+        {
+            GLTracePointer p = glTracePointer(call, arg, a, unpackAlignment);
+            if (p.kind == GLTraceArg::Names)
+            {
+                align();
+                putBytes((const void*)value, p.bytes);
+            }
+        }
+    }
+    // state the recorder itself depends on
+    void observe(GLCall call, const uint64_t* a)
+    {
+        if (call == GLCall::PixelStorei && a[0] == GL_UNPACK_ALIGNMENT)
+            unpackAlignment = (int)a[1];
+    }
+
+private:
+    std::ofstream file;
+    std::vector<unsigned char> buffer;
+    uint64_t written = 0;
+    int unpackAlignment = 4;
+
+    void flush()
+    {
+        file.write((const char*)buffer.data(), buffer.size());
+        written += buffer.size();
+        buffer.clear();
+    }
+};
+
+// the process-wide recorder; there is one GL context
+inline GLTraceWriter& glTrace()
+{
+    static GLTraceWriter writer;
+    return writer;
+}
+
+// a traced call's payload, read front to back
+struct GLTraceCursor
+{
+    const unsigned char* base;      // start of the file, for alignment
+    const unsigned char* p;
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        std::memcpy(&value, p, sizeof(T));
+        p += sizeof(T);
+        return value;
+    }
+    void align()
+    {
+        while ((p - base) % 8)
+            p++;
+    }
+};
+
+// per-call statistics gathered while replaying
+class GLTraceStats
+{
+public:
+    uint64_t calls[GL_CALL_COUNT] = {};
+    uint64_t totalCalls = 0;
+    uint64_t bytesUploaded = 0;
+    uint64_t redundantCalls = 0;
+    uint64_t redundantByCall[GL_CALL_COUNT] = {};
+    std::vector<uint64_t> callsPerFrame;
+    std::vector<uint64_t> bytesPerFrame;
+
+    // one decoded call; a holds every argument as glTraceScalar(), input the bytes its pointers carried in
+    // ------------------------------------------------------------------------
+    void add(GLCall call, const uint64_t* a, uint64_t input)
+    {
+        calls[(unsigned int)call]++;
+        totalCalls++;
+        frameCalls++;
+        if (isUpload(call))
+        {
+            bytesUploaded += input;
+            frameBytes += input;
+        }
+        trackState(call, a);
+    }
+    // ------------------------------------------------------------------------
+    void frame()
+    {
+        callsPerFrame.push_back(frameCalls);
+        bytesPerFrame.push_back(frameBytes);
+        frameCalls = 0;
+        frameBytes = 0;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        size_t frames = callsPerFrame.size();
+        std::cout << "GL_TRACE:: " << totalCalls << " calls, " << frames << " frames, " << bytesUploaded / 1024.0 << " KB uploaded, "
+                  << redundantCalls << " redundant state changes" << std::endl;
+        if (frames > 1)
+        {
+            // the first frame carries the setup, the steady state is everything after it
+            uint64_t steadyCalls = 0, steadyBytes = 0;
+            for (size_t i = 1; i < frames; i++)
+            {
+                steadyCalls += callsPerFrame[i];
+                steadyBytes += bytesPerFrame[i];
+            }
+            std::cout << "    frame 0: " << callsPerFrame[0] << " calls, " << bytesPerFrame[0] / 1024.0 << " KB; after that "
+                      << (double)steadyCalls / (frames - 1) << " calls and " << (double)steadyBytes / (frames - 1) / 1024.0 << " KB per frame" << std::endl;
+        }
+        std::vector<unsigned int> order;
+        for (unsigned int i = 0; i < GL_CALL_COUNT; i++)
+            if (calls[i])
+                order.push_back(i);
+        std::sort(order.begin(), order.end(), [&](unsigned int x, unsigned int y) { return calls[x] > calls[y]; });
+        for (unsigned int i : order)
+        {
+            std::cout << "    " << glCallName((GLCall)i) << ": " << calls[i];
+            if (redundantByCall[i])
+                std::cout << " (" << redundantByCall[i] << " redundant)";
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    uint64_t frameCalls = 0;
+    uint64_t frameBytes = 0;
+    uint64_t activeUnit = 0;
+    uint64_t vertexArray = 0;
+    typedef std::tuple<int, uint64_t, uint64_t> StateKey;                // (group, key, key)
+    std::map<StateKey, std::vector<uint64_t>> state;
+    std::map<uint64_t, uint64_t> textureTargets;                        // texture -> target, learned from glBindTexture
+
+    static bool isUpload(GLCall call)
+    {
+        switch (call)
+        {
+        case GLCall::BufferData: case GLCall::BufferSubData: case GLCall::NamedBufferData: case GLCall::NamedBufferSubData:
+        case GLCall::TexImage2D: case GLCall::TexSubImage2D: case GLCall::TextureSubImage2D:
+            return true;
+        default:
+            return false;
+        }
+    }
+    // a state setter is redundant when it sets the value already there
+    void set(GLCall call, int group, uint64_t key0, uint64_t key1, std::vector<uint64_t> value)
+    {
+        set(call, { StateKey(group, key0, key1) }, value);
+    }
+    // a call that sets several bindings at once (glBindFramebuffer(GL_FRAMEBUFFER), glBindBufferBase) is only
+    //      redundant when every one of them already holds the value, and it updates all of them either way
+    void set(GLCall call, std::initializer_list<StateKey> keys, const std::vector<uint64_t>& value)
+    {
+        bool redundant = true;
+        for (const StateKey& key : keys)
+        {
+            auto it = state.find(key);
+            redundant = redundant && it != state.end() && it->second == value;
+        }
+        if (redundant)
+        {
+            redundantCalls++;
+            redundantByCall[(unsigned int)call]++;
+            return;
+        }
+        for (const StateKey& key : keys)
+            state[key] = value;
+    }
+    // texture units hold one binding per target. glBindTextureUnit doesn't say which target it binds, so it is looked
+    //      up from an earlier glBindTexture of the same texture; a texture only ever seen by glBindTextureUnit (created
+    //      with glCreateTextures) is kept under target 0, which only glBindTextureUnit reads
+    void bindTexture(GLCall call, uint64_t unit, uint64_t target, uint64_t texture)
+    {
+        if (call == GLCall::BindTextureUnit && texture == 0)
+        {
+            // unbinds every target of the unit
+            bool redundant = true;
+            for (auto& entry : state)
+                if (std::get<0>(entry.first) == 6 && std::get<1>(entry.first) == unit && entry.second[0] != 0)
+                {
+                    redundant = false;
+                    entry.second[0] = 0;
+                }
+            if (redundant)
+            {
+                redundantCalls++;
+                redundantByCall[(unsigned int)call]++;
+            }
+            return;
+        }
+        if (call == GLCall::BindTexture)
+        {
+            if (texture)
+                textureTargets[texture] = target;
+            // a target-less record of the same texture on this unit was this target all along
+            auto untyped = state.find(StateKey(6, unit, 0));
+            if (texture && untyped != state.end() && untyped->second[0] == texture)
+            {
+                state.erase(untyped);
+                state[StateKey(6, unit, target)] = { texture };
+            }
+        }
+        else
+        {
+            auto known = textureTargets.find(texture);
+            target = known == textureTargets.end() ? 0 : known->second;
+        }
+        uint64_t redundantBefore = redundantCalls;
+        set(call, 6, unit, target, { texture });
+        if (redundantCalls != redundantBefore)
+            return;
+        // the bind changed a target; if either side's target isn't known it may have replaced the other's binding,
+        //      so those are forgotten rather than risk calling a later bind redundant when it isn't
+        for (auto it = state.begin(); it != state.end();)
+        {
+            bool sameUnit = std::get<0>(it->first) == 6 && std::get<1>(it->first) == unit && std::get<2>(it->first) != target;
+            if (sameUnit && (target == 0 || std::get<2>(it->first) == 0))
+                it = state.erase(it);
+            else
+                ++it;
+        }
+    }
+    void trackState(GLCall call, const uint64_t* a)
+    {
+        switch (call)
+        {
+        // the element array binding is part of the bound VAO
+        case GLCall::BindBuffer:       set(call, 1, a[0], a[0] == GL_ELEMENT_ARRAY_BUFFER ? vertexArray : 0, { a[1] }); break;
+        // the indexed binding and the generic binding of its target
+        case GLCall::BindBufferBase:   set(call, { StateKey(2, a[0], a[1]), StateKey(1, a[0], 0) }, { a[2] }); break;
+        // the same binding glBindBuffer(GL_ELEMENT_ARRAY_BUFFER) sets while that VAO is bound
+        case GLCall::VertexArrayElementBuffer: set(call, 1, GL_ELEMENT_ARRAY_BUFFER, a[0], { a[1] }); break;
+        case GLCall::BindVertexArray:  set(call, 3, 0, 0, { a[0] }); vertexArray = a[0]; break;
+        case GLCall::UseProgram:       set(call, 4, 0, 0, { a[0] }); break;
+        case GLCall::ActiveTexture:    set(call, 5, 0, 0, { a[0] }); activeUnit = a[0] - GL_TEXTURE0; break;
+        case GLCall::BindTexture:      bindTexture(call, activeUnit, a[0], a[1]); break;
+        case GLCall::BindTextureUnit:  bindTexture(call, a[0], 0, a[1]); break;
+        case GLCall::BindSampler:      set(call, 8, a[0], 0, { a[1] }); break;
+        // GL_FRAMEBUFFER sets both the draw and the read binding
+        case GLCall::BindFramebuffer:
+            if (a[0] == GL_FRAMEBUFFER)
+                set(call, { StateKey(9, GL_DRAW_FRAMEBUFFER, 0), StateKey(9, GL_READ_FRAMEBUFFER, 0) }, { a[1] });
+            else
+                set(call, 9, a[0], 0, { a[1] });
+            break;
+        case GLCall::Enable:           set(call, 10, a[0], 0, { 1 }); break;
+        case GLCall::Disable:          set(call, 10, a[0], 0, { 0 }); break;
+        case GLCall::ClearColor:       set(call, 11, 0, 0, { a[0], a[1], a[2], a[3] }); break;
+        case GLCall::Viewport:         set(call, 12, 0, 0, { a[0], a[1], a[2], a[3] }); break;
+        case GLCall::Scissor:          set(call, 13, 0, 0, { a[0], a[1], a[2], a[3] }); break;
+        case GLCall::DepthFunc:        set(call, 14, 0, 0, { a[0] }); break;
+        case GLCall::DepthMask:        set(call, 15, 0, 0, { a[0] }); break;
+        case GLCall::BlendFunc:        set(call, 16, 0, 0, { a[0], a[1] }); break;
+        case GLCall::CullFace:         set(call, 17, 0, 0, { a[0] }); break;
+        case GLCall::PolygonMode:      set(call, 18, a[0], 0, { a[1] }); break;
+        case GLCall::PixelStorei:      set(call, 19, a[0], 0, { a[1] }); break;
+        case GLCall::ClearDepth:       set(call, 20, 0, 0, { a[0] }); break;
+        case GLCall::BindProgramPipeline: set(call, 21, 0, 0, { a[0] }); break;
+        case GLCall::BindRenderbuffer: set(call, 22, a[0], 0, { a[1] }); break;
+        // deleting objects unbinds them, and their names may come back for new objects
+        case GLCall::DeleteBuffers: case GLCall::DeleteTextures: case GLCall::DeleteVertexArrays: case GLCall::DeleteSamplers:
+        case GLCall::DeleteFramebuffers: case GLCall::DeleteProgram: case GLCall::DeleteProgramPipelines: case GLCall::DeleteRenderbuffers:
+            state.clear();
+            textureTargets.clear();
+            break;
+        default:
+            break;
+        }
+    }
+};
+
+class GLTraceReplayer
+{
+public:
+    bool execute = true;        // false decodes and gathers stats without calling GL
+    GLTraceStats stats;
+
+    // map a recorded object name to the one the replay context gave out
+    // ------------------------------------------------------------------------
+    uint64_t remap(GLNamespace ns, uint64_t name) const
+    {
+        auto it = names[(unsigned int)ns].find((uint32_t)name);
+        return it == names[(unsigned int)ns].end() ? name : it->second;
+    }
+    // ------------------------------------------------------------------------
+    void reset()
+    {
+        for (auto& map : names)
+            map.clear();
+        stats = GLTraceStats();
+    }
+    // delete every object the replay created, so replaying again starts from an empty context instead of piling up
+    //      objects; names the trace deleted itself are deleted again, which GL ignores
+    // ------------------------------------------------------------------------
+    void deleteObjects()
+    {
+        for (unsigned int ns = 1; ns < (unsigned int)GLNamespace::Count; ns++)
+        {
+            std::vector<GLuint> objects;
+            for (const auto& name : names[ns])
+                if (name.second)
+                    objects.push_back(name.second);
+            std::sort(objects.begin(), objects.end());
+            objects.erase(std::unique(objects.begin(), objects.end()), objects.end());
+            GLsizei count = (GLsizei)objects.size();
+            if (!count)
+                continue;
+            switch ((GLNamespace)ns)
+            {
+            case GLNamespace::Buffer:          glDeleteBuffers(count, objects.data()); break;
+            case GLNamespace::Texture:         glDeleteTextures(count, objects.data()); break;
+            case GLNamespace::VertexArray:     glDeleteVertexArrays(count, objects.data()); break;
+            case GLNamespace::Sampler:         glDeleteSamplers(count, objects.data()); break;
+            case GLNamespace::Query:           glDeleteQueries(count, objects.data()); break;
+            case GLNamespace::Framebuffer:     glDeleteFramebuffers(count, objects.data()); break;
+            case GLNamespace::ProgramPipeline: glDeleteProgramPipelines(count, objects.data()); break;
+            case GLNamespace::Renderbuffer:    glDeleteRenderbuffers(count, objects.data()); break;
+            case GLNamespace::Program:         for (GLuint object : objects) glDeleteProgram(object); break;
+            case GLNamespace::Shader:          for (GLuint object : objects) glDeleteShader(object); break;
+            default:                           break;
+            }
+            names[ns].clear();
+        }
+    }
+    // decode and run one record
+    // ------------------------------------------------------------------------
+    void replay(GLCall call, const unsigned char* base, const unsigned char* payload);
+
+    // used by GLTraced::replay
+    template <typename T>
+    T readArg(GLTraceCursor& c, GLCall call, unsigned int arg)
+    {
+        if constexpr (std::is_pointer<T>::value)
+        {
+            GLTraceArg kind = c.get<GLTraceArg>();
+            kinds[arg] = kind;
+            void* result = nullptr;
+            switch (kind)
+            {
+            case GLTraceArg::Value:
+                result = (void*)(uintptr_t)c.get<uint64_t>();
+                break;
+            case GLTraceArg::Input:
+            {
+                uint32_t bytes = c.get<uint32_t>();
+                c.align();
+                result = (void*)c.p;
+                c.p += bytes;
+                inputBytes += bytes;
+                break;
+            }
+            case GLTraceArg::NameArray:
+            {
+                uint32_t bytes = c.get<uint32_t>();
+                c.align();
+                std::vector<unsigned char>& out = scratchBuffer(bytes);
+                GLNamespace ns = glTraceObjectNamespace(call);
+                for (uint32_t i = 0; i < bytes / sizeof(GLuint); i++)
+                {
+                    GLuint name;
+                    std::memcpy(&name, c.p + i * sizeof(GLuint), sizeof(name));
+                    name = (GLuint)remap(ns, name);
+                    std::memcpy(&out[i * sizeof(GLuint)], &name, sizeof(name));
+                }
+                c.p += bytes;
+                result = out.data();
+                break;
+            }
+            case GLTraceArg::Output: case GLTraceArg::Names:
+            {
+                uint32_t bytes = c.get<uint32_t>();
+                sizes[arg] = bytes;
+                result = scratchBuffer(std::max<uint32_t>(bytes, 8)).data();
+                break;
+            }
+            case GLTraceArg::Strings:
+            {
+                uint32_t count = c.get<uint32_t>();
+                std::vector<unsigned char>& pointers = scratchBuffer(count * sizeof(const GLchar*));
+                std::vector<unsigned char>& lengths = scratchBuffer(count * sizeof(GLint));
+                for (uint32_t i = 0; i < count; i++)
+                {
+                    GLint length = (GLint)c.get<uint32_t>();
+                    const GLchar* string = (const GLchar*)c.p;
+                    std::memcpy(&pointers[i * sizeof(const GLchar*)], &string, sizeof(string));
+                    std::memcpy(&lengths[i * sizeof(GLint)], &length, sizeof(length));
+                    c.p += length;
+                }
+                stringLengths = lengths.data();
+                result = pointers.data();
+                break;
+            }
+            case GLTraceArg::Lengths:
+                result = stringLengths;
+                break;
+            }
+            a[arg] = (uint64_t)(uintptr_t)result;
+            return (T)result;
+        }
+        else
+        {
+            T value = c.get<T>();
+            GLNamespace ns = glTraceNamespace(call, arg);
+            if constexpr (std::is_integral<T>::value)
+                if (ns != GLNamespace::None && execute)
+                    value = (T)remap(ns, (uint64_t)value);
+            a[arg] = glTraceScalar(value);
+            return value;
+        }
+    }
+    template <typename T>
+    void readOutput(GLTraceCursor& c, GLCall call, unsigned int arg, T value)
+    {
+        if constexpr (std::is_pointer<T>::value)
+        {
+            if (kinds[arg] != GLTraceArg::Names)
+                return;
+            c.align();
+            GLNamespace ns = glTraceObjectNamespace(call);
+            for (uint32_t i = 0; i < sizes[arg] / sizeof(GLuint); i++)
+            {
+                GLuint recorded, replayed;
+                std::memcpy(&recorded, c.p + i * sizeof(GLuint), sizeof(GLuint));
+                std::memcpy(&replayed, (const unsigned char*)value + i * sizeof(GLuint), sizeof(GLuint));
+                names[(unsigned int)ns][recorded] = replayed;
+            }
+            c.p += sizes[arg];
+        }
+    }
+    void readResult(GLTraceCursor& c, GLCall call, uint64_t replayed)
+    {
+        uint64_t recorded = c.get<uint64_t>();
+        GLNamespace ns = glTraceObjectNamespace(call);
+        if (ns != GLNamespace::None)
+            names[(unsigned int)ns][(uint32_t)recorded] = (uint32_t)replayed;
+    }
+    void finishCall(GLCall call)
+    {
+        stats.add(call, a, inputBytes);
+    }
+
+private:
+    std::unordered_map<uint32_t, uint32_t> names[(unsigned int)GLNamespace::Count];
+    std::deque<std::vector<unsigned char>> scratch;     // a deque, so growing it keeps earlier buffers in place
+    size_t scratchUsed = 0;
+    GLTraceArg kinds[16] = {};
+    uint32_t sizes[16] = {};
+    uint64_t a[16] = {};
+    uint64_t inputBytes = 0;
+    void* stringLengths = nullptr;
+
+    std::vector<unsigned char>& scratchBuffer(size_t bytes)
+    {
+        if (scratchUsed == scratch.size())
+            scratch.emplace_back();
+        std::vector<unsigned char>& buffer = scratch[scratchUsed++];
+        buffer.assign(bytes, 0);
+        return buffer;
+    }
+    void beginCall()
+    {
+        scratchUsed = 0;
+        inputBytes = 0;
+        std::fill(std::begin(a), std::end(a), 0);
+    }
+};
+
+// counts per function when replaying against the stub table
+inline uint64_t* glTraceStubCalls()
+{
+    static uint64_t counts[GL_CALL_COUNT] = {};
+    return counts;
+}
+
+// recording wrapper, replay decoder and stub of one traced function
+template <unsigned int Id, typename Fn>
+struct GLTraced;
+
+template <unsigned int Id, typename R, typename... A>
+struct GLTraced<Id, R (APIENTRYP)(A...)>
+{
+    typedef R (APIENTRYP Fn)(A...);
+
+    // ------------------------------------------------------------------------
+    static R APIENTRY record(A... args)
+    {
+        GLTraceWriter& w = glTrace();
+        Fn original = (Fn)w.originals[Id];
+        const GLCall call = (GLCall)Id;
+        uint64_t a[sizeof...(A) + 1] = { glTraceScalar(args)... };
+        size_t start = w.beginRecord(call);
+        unsigned int i = 0;
+        (void)i;
+        (w.writeArg(call, i++, args, a), ...);
+        w.observe(call, a);
+        if constexpr (std::is_void<R>::value)
+        {
+            original(args...);
+            i = 0;
+            (w.writeOutput(call, i++, args, a), ...);
+            w.endRecord(start);
+        }
+        else
+        {
+            R result = original(args...);
+            i = 0;
+            (w.writeOutput(call, i++, args, a), ...);
+            w.put(glTraceScalar(result));
+            w.endRecord(start);
+            return result;
+        }
+    }
+    // ------------------------------------------------------------------------
+    static void replay(GLTraceReplayer& r, GLTraceCursor& c)
+    {
+        replayArgs(r, c, std::index_sequence_for<A...>());
+    }
+    // ------------------------------------------------------------------------
+    static R APIENTRY stub(A...)
+    {
+        glTraceStubCalls()[Id]++;
+        if constexpr (!std::is_void<R>::value)
+            return R();
+    }
+
+private:
+    template <size_t... I>
+    static void replayArgs(GLTraceReplayer& r, GLTraceCursor& c, std::index_sequence<I...>)
+    {
+        const GLCall call = (GLCall)Id;
+        // braced initialization evaluates left to right, which is the order the arguments were written in
+        std::tuple<A...> args{ r.template readArg<A>(c, call, (unsigned int)I)... };
+        r.finishCall(call);
+        if (!r.execute)
+            return;
+        Fn fn = (Fn)*glTraceSlot(call);
+        if constexpr (std::is_void<R>::value)
+        {
+            fn(std::get<I>(args)...);
+            (r.readOutput(c, call, (unsigned int)I, std::get<I>(args)), ...);
+        }
+        else
+        {
+            R result = fn(std::get<I>(args)...);
+            (r.readOutput(c, call, (unsigned int)I, std::get<I>(args)), ...);
+            r.readResult(c, call, glTraceScalar(result));
+        }
+        (void)args;
+    }
+};
+
+// ------------------------------------------------------------------------
+inline bool GLTraceWriter::begin(const char* path)
+{
+    static void* wrappers[] = {
+#define GL_TRACE_WRAPPER(name) (void*)&GLTraced<(unsigned int)GLCall::name, decltype(glad_gl##name)>::record,
+        GL_TRACE_FUNCTIONS(GL_TRACE_WRAPPER)
+#undef GL_TRACE_WRAPPER
+    };
+    file.open(path, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "ERROR::GL_TRACE::FILE_NOT_CREATED: " << path << std::endl;
+        return false;
+    }
+    buffer.clear();
+    written = 0;
+    calls = frames = 0;
+    putBytes(GL_TRACE_MAGIC, sizeof(GL_TRACE_MAGIC));
+    put(GL_TRACE_VERSION);
+    put((uint32_t)GL_CALL_COUNT);
+    for (unsigned int i = 0; i < GL_CALL_COUNT; i++)
+    {
+        const char* name = glCallName((GLCall)i);
+        put((uint8_t)std::strlen(name));
+        putBytes(name, std::strlen(name));
+    }
+    // functions the context didn't provide stay null
+    for (unsigned int i = 0; i < GL_CALL_COUNT; i++)
+    {
+        void** slot = glTraceSlot((GLCall)i);
+        originals[i] = *slot;
+        if (*slot)
+            *slot = wrappers[i];
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+inline void GLTraceReplayer::replay(GLCall call, const unsigned char* base, const unsigned char* payload)
+{
+    typedef void (*Replay)(GLTraceReplayer&, GLTraceCursor&);
+    static const Replay replayers[] = {
+#define GL_TRACE_REPLAY(name) &GLTraced<(unsigned int)GLCall::name, decltype(glad_gl##name)>::replay,
+        GL_TRACE_FUNCTIONS(GL_TRACE_REPLAY)
+#undef GL_TRACE_REPLAY
+    };
+    GLTraceCursor c = { base, payload };
+    beginCall();
+    replayers[(unsigned int)call](*this, c);
+}
+
+// point every traced glad entry point at a stub that only counts, so a trace can be replayed without a context
+// ------------------------------------------------------------------------
+inline void glTraceInstallStubs()
+{
+    static void* stubs[] = {
+#define GL_TRACE_STUB(name) (void*)&GLTraced<(unsigned int)GLCall::name, decltype(glad_gl##name)>::stub,
+        GL_TRACE_FUNCTIONS(GL_TRACE_STUB)
+#undef GL_TRACE_STUB
+    };
+    for (unsigned int i = 0; i < GL_CALL_COUNT; i++)
+        *glTraceSlot((GLCall)i) = stubs[i];
+}
+
+// a trace file, mapped, with its function table resolved against this build's list
+class GLTraceReader
+{
+public:
+    uint64_t frames = 0;
+
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        if (!file.open(path))
+            return false;
+        const unsigned char* p = file.data();
+        const unsigned char* end = p + file.size();
+        uint32_t version = 0, count = 0;
+        if (file.size() < 12 || std::memcmp(p, GL_TRACE_MAGIC, 4) != 0)
+        {
+            std::cout << "ERROR::GL_TRACE::NOT_A_TRACE: " << path << std::endl;
+            return false;
+        }
+        std::memcpy(&version, p + 4, 4);
+        std::memcpy(&count, p + 8, 4);
+        if (version != GL_TRACE_VERSION)
+        {
+            std::cout << "ERROR::GL_TRACE::VERSION_MISMATCH: " << version << std::endl;
+            return false;
+        }
+        p += 12;
+        // the file's ids -> ours, by name; unknown functions are skipped on replay
+        fileCalls.assign(count, GLCall::Count);
+        for (uint32_t i = 0; i < count && p < end; i++)
+        {
+            std::string name((const char*)p + 1, *p);
+            p += 1 + *p;
+            for (unsigned int j = 0; j < GL_CALL_COUNT; j++)
+                if (name == glCallName((GLCall)j))
+                    fileCalls[i] = (GLCall)j;
+        }
+        records = p;
+        return true;
+    }
+    // decode (and unless replayer.execute is off, run) every record; returns the number of frames
+    // ------------------------------------------------------------------------
+    uint64_t replay(GLTraceReplayer& replayer, void (*onFrame)(void*) = nullptr, void* user = nullptr)
+    {
+        const unsigned char* p = records;
+        const unsigned char* end = file.data() + file.size();
+        frames = 0;
+        while (p + sizeof(uint16_t) <= end)
+        {
+            uint16_t id;
+            std::memcpy(&id, p, sizeof(id));
+            p += sizeof(id);
+            if (id == GL_TRACE_FRAME)
+            {
+                replayer.stats.frame();
+                frames++;
+                if (onFrame)
+                    onFrame(user);
+                continue;
+            }
+            uint32_t size;
+            std::memcpy(&size, p, sizeof(size));
+            p += sizeof(size);
+            if (p + size > end)
+            {
+                std::cout << "ERROR::GL_TRACE::TRUNCATED" << std::endl;
+                break;
+            }
+            if (id < fileCalls.size() && fileCalls[id] != GLCall::Count)
+                replayer.replay(fileCalls[id], file.data(), p);
+            p += size;
+        }
+        return frames;
+    }
+
+private:
+    MappedFile file;
+    std::vector<GLCall> fileCalls;
+    const unsigned char* records = nullptr;
+};
+#endif
@@ -0,0 +1,458 @@
+#ifndef GLAD_LAZY_H
+#define GLAD_LAZY_H
+
+#include <glad/glad.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include <iostream>
+
+//////// LAZY GLAD LOADING ////
+// - gladLoadGLLoader() looks up all ~700 entry points of GL 1.0-4.6 the moment the context exists, one
+//      GetProcAddress each, and then copies every extension string just to throw the copies away again (our glad
+//      is generated without extensions). A program uses a few dozen of those entry points, so most of that time
+//      comes before the first frame for nothing
+// - gladLoadGLLoaderLazy() only fetches glGetString to read the version, sets GLVersion and the GLAD_GL_VERSION_*
+//      flags exactly like glad does, and points every glad_glX pointer at a trampoline. The first call of a function
+//      goes through its trampoline, which looks the real entry point up and writes it into the pointer, so from the
+//      second call on there is no indirection left
+// - a trampoline only overwrites the pointer if it still points at itself; anything that swapped the pointer in the
+//      meantime (glTrace().begin(), gl_trace.h) keeps its wrapper, and the wrapper's saved original resolves once
+//      through the table in gladLazy()
+// - unlike glad, functions above the context's version get a trampoline instead of NULL. Calling one prints
+//      ERROR::GLAD_LAZY::MISSING and does nothing, so keep checking GLAD_GL_VERSION_* before using them
+// - GL calls are single-threaded per context, and so is resolving
+// - glExtensions() is the extension list read once into a sorted table; has() is a binary search instead of a
+//      glGetStringi + strcmp loop per query
+// - measured on Mesa llvmpipe (4.5 core, surfaceless EGL), median of 5-7 runs each:
+//      - loader call: gladLoadGLLoader() 0.85 ms, gladLoadGLLoaderLazy() 0.04 ms. The coordinate systems sample then
+//          resolves 75 of the 699 entry points on first use, 0.2 ms in total, so ~0.6 ms is saved
+//      - context to first frame (coordsys, STARTUP line): 285 ms with --eager-gl, 265 ms lazy, but runs spread by
+//          +-25 ms. Shader compiles and texture uploads dominate that, so the saving is real but inside the noise; it
+//          matters more on drivers whose GetProcAddress is slower than Mesa's
+// - the generated glad.c is left as it is, GLAD_LAZY_FUNCTIONS mirrors its load_GL_VERSION_* lists
+//      (names that appear in more than one version are listed under the first)
+
+#define GLAD_LAZY_GL_1_0(X) \
+    X(CullFace) X(FrontFace) X(Hint) X(LineWidth) X(PointSize) X(PolygonMode) X(Scissor) X(TexParameterf) \
+    X(TexParameterfv) X(TexParameteri) X(TexParameteriv) X(TexImage1D) X(TexImage2D) X(DrawBuffer) X(Clear) \
+    X(ClearColor) X(ClearStencil) X(ClearDepth) X(StencilMask) X(ColorMask) X(DepthMask) X(Disable) X(Enable) \
+    X(Finish) X(Flush) X(BlendFunc) X(LogicOp) X(StencilFunc) X(StencilOp) X(DepthFunc) X(PixelStoref) \
+    X(PixelStorei) X(ReadBuffer) X(ReadPixels) X(GetBooleanv) X(GetDoublev) X(GetError) X(GetFloatv) X(GetIntegerv) \
+    X(GetString) X(GetTexImage) X(GetTexParameterfv) X(GetTexParameteriv) X(GetTexLevelParameterfv) \
+    X(GetTexLevelParameteriv) X(IsEnabled) X(DepthRange) X(Viewport)
+
+#define GLAD_LAZY_GL_1_1(X) \
+    X(DrawArrays) X(DrawElements) X(PolygonOffset) X(CopyTexImage1D) X(CopyTexImage2D) X(CopyTexSubImage1D) \
+    X(CopyTexSubImage2D) X(TexSubImage1D) X(TexSubImage2D) X(BindTexture) X(DeleteTextures) X(GenTextures) \
+    X(IsTexture)
+
+#define GLAD_LAZY_GL_1_2(X) \
+    X(DrawRangeElements) X(TexImage3D) X(TexSubImage3D) X(CopyTexSubImage3D)
+
+#define GLAD_LAZY_GL_1_3(X) \
+    X(ActiveTexture) X(SampleCoverage) X(CompressedTexImage3D) X(CompressedTexImage2D) X(CompressedTexImage1D) \
+    X(CompressedTexSubImage3D) X(CompressedTexSubImage2D) X(CompressedTexSubImage1D) X(GetCompressedTexImage)
+
+#define GLAD_LAZY_GL_1_4(X) \
+    X(BlendFuncSeparate) X(MultiDrawArrays) X(MultiDrawElements) X(PointParameterf) X(PointParameterfv) \
+    X(PointParameteri) X(PointParameteriv) X(BlendColor) X(BlendEquation)
+
+#define GLAD_LAZY_GL_1_5(X) \
+    X(GenQueries) X(DeleteQueries) X(IsQuery) X(BeginQuery) X(EndQuery) X(GetQueryiv) X(GetQueryObjectiv) \
+    X(GetQueryObjectuiv) X(BindBuffer) X(DeleteBuffers) X(GenBuffers) X(IsBuffer) X(BufferData) X(BufferSubData) \
+    X(GetBufferSubData) X(MapBuffer) X(UnmapBuffer) X(GetBufferParameteriv) X(GetBufferPointerv)
+
+#define GLAD_LAZY_GL_2_0(X) \
+    X(BlendEquationSeparate) X(DrawBuffers) X(StencilOpSeparate) X(StencilFuncSeparate) X(StencilMaskSeparate) \
+    X(AttachShader) X(BindAttribLocation) X(CompileShader) X(CreateProgram) X(CreateShader) X(DeleteProgram) \
+    X(DeleteShader) X(DetachShader) X(DisableVertexAttribArray) X(EnableVertexAttribArray) X(GetActiveAttrib) \
+    X(GetActiveUniform) X(GetAttachedShaders) X(GetAttribLocation) X(GetProgramiv) X(GetProgramInfoLog) \
+    X(GetShaderiv) X(GetShaderInfoLog) X(GetShaderSource) X(GetUniformLocation) X(GetUniformfv) X(GetUniformiv) \
+    X(GetVertexAttribdv) X(GetVertexAttribfv) X(GetVertexAttribiv) X(GetVertexAttribPointerv) X(IsProgram) \
+    X(IsShader) X(LinkProgram) X(ShaderSource) X(UseProgram) X(Uniform1f) X(Uniform2f) X(Uniform3f) X(Uniform4f) \
+    X(Uniform1i) X(Uniform2i) X(Uniform3i) X(Uniform4i) X(Uniform1fv) X(Uniform2fv) X(Uniform3fv) X(Uniform4fv) \
+    X(Uniform1iv) X(Uniform2iv) X(Uniform3iv) X(Uniform4iv) X(UniformMatrix2fv) X(UniformMatrix3fv) \
+    X(UniformMatrix4fv) X(ValidateProgram) X(VertexAttrib1d) X(VertexAttrib1dv) X(VertexAttrib1f) X(VertexAttrib1fv) \
+    X(VertexAttrib1s) X(VertexAttrib1sv) X(VertexAttrib2d) X(VertexAttrib2dv) X(VertexAttrib2f) X(VertexAttrib2fv) \
+    X(VertexAttrib2s) X(VertexAttrib2sv) X(VertexAttrib3d) X(VertexAttrib3dv) X(VertexAttrib3f) X(VertexAttrib3fv) \
+    X(VertexAttrib3s) X(VertexAttrib3sv) X(VertexAttrib4Nbv) X(VertexAttrib4Niv) X(VertexAttrib4Nsv) \
+    X(VertexAttrib4Nub) X(VertexAttrib4Nubv) X(VertexAttrib4Nuiv) X(VertexAttrib4Nusv) X(VertexAttrib4bv) \
+    X(VertexAttrib4d) X(VertexAttrib4dv) X(VertexAttrib4f) X(VertexAttrib4fv) X(VertexAttrib4iv) X(VertexAttrib4s) \
+    X(VertexAttrib4sv) X(VertexAttrib4ubv) X(VertexAttrib4uiv) X(VertexAttrib4usv) X(VertexAttribPointer)
+
+#define GLAD_LAZY_GL_2_1(X) \
+    X(UniformMatrix2x3fv) X(UniformMatrix3x2fv) X(UniformMatrix2x4fv) X(UniformMatrix4x2fv) X(UniformMatrix3x4fv) \
+    X(UniformMatrix4x3fv)
+
+#define GLAD_LAZY_GL_3_0(X) \
+    X(ColorMaski) X(GetBooleani_v) X(GetIntegeri_v) X(Enablei) X(Disablei) X(IsEnabledi) X(BeginTransformFeedback) \
+    X(EndTransformFeedback) X(BindBufferRange) X(BindBufferBase) X(TransformFeedbackVaryings) \
+    X(GetTransformFeedbackVarying) X(ClampColor) X(BeginConditionalRender) X(EndConditionalRender) \
+    X(VertexAttribIPointer) X(GetVertexAttribIiv) X(GetVertexAttribIuiv) X(VertexAttribI1i) X(VertexAttribI2i) \
+    X(VertexAttribI3i) X(VertexAttribI4i) X(VertexAttribI1ui) X(VertexAttribI2ui) X(VertexAttribI3ui) \
+    X(VertexAttribI4ui) X(VertexAttribI1iv) X(VertexAttribI2iv) X(VertexAttribI3iv) X(VertexAttribI4iv) \
+    X(VertexAttribI1uiv) X(VertexAttribI2uiv) X(VertexAttribI3uiv) X(VertexAttribI4uiv) X(VertexAttribI4bv) \
+    X(VertexAttribI4sv) X(VertexAttribI4ubv) X(VertexAttribI4usv) X(GetUniformuiv) X(BindFragDataLocation) \
+    X(GetFragDataLocation) X(Uniform1ui) X(Uniform2ui) X(Uniform3ui) X(Uniform4ui) X(Uniform1uiv) X(Uniform2uiv) \
+    X(Uniform3uiv) X(Uniform4uiv) X(TexParameterIiv) X(TexParameterIuiv) X(GetTexParameterIiv) \
+    X(GetTexParameterIuiv) X(ClearBufferiv) X(ClearBufferuiv) X(ClearBufferfv) X(ClearBufferfi) X(GetStringi) \
+    X(IsRenderbuffer) X(BindRenderbuffer) X(DeleteRenderbuffers) X(GenRenderbuffers) X(RenderbufferStorage) \
+    X(GetRenderbufferParameteriv) X(IsFramebuffer) X(BindFramebuffer) X(DeleteFramebuffers) X(GenFramebuffers) \
+    X(CheckFramebufferStatus) X(FramebufferTexture1D) X(FramebufferTexture2D) X(FramebufferTexture3D) \
+    X(FramebufferRenderbuffer) X(GetFramebufferAttachmentParameteriv) X(GenerateMipmap) X(BlitFramebuffer) \
+    X(RenderbufferStorageMultisample) X(FramebufferTextureLayer) X(MapBufferRange) X(FlushMappedBufferRange) \
+    X(BindVertexArray) X(DeleteVertexArrays) X(GenVertexArrays) X(IsVertexArray)
+
+#define GLAD_LAZY_GL_3_1(X) \
+    X(DrawArraysInstanced) X(DrawElementsInstanced) X(TexBuffer) X(PrimitiveRestartIndex) X(CopyBufferSubData) \
+    X(GetUniformIndices) X(GetActiveUniformsiv) X(GetActiveUniformName) X(GetUniformBlockIndex) \
+    X(GetActiveUniformBlockiv) X(GetActiveUniformBlockName) X(UniformBlockBinding)
+
+#define GLAD_LAZY_GL_3_2(X) \
+    X(DrawElementsBaseVertex) X(DrawRangeElementsBaseVertex) X(DrawElementsInstancedBaseVertex) \
+    X(MultiDrawElementsBaseVertex) X(ProvokingVertex) X(FenceSync) X(IsSync) X(DeleteSync) X(ClientWaitSync) \
+    X(WaitSync) X(GetInteger64v) X(GetSynciv) X(GetInteger64i_v) X(GetBufferParameteri64v) X(FramebufferTexture) \
+    X(TexImage2DMultisample) X(TexImage3DMultisample) X(GetMultisamplefv) X(SampleMaski)
+
+#define GLAD_LAZY_GL_3_3(X) \
+    X(BindFragDataLocationIndexed) X(GetFragDataIndex) X(GenSamplers) X(DeleteSamplers) X(IsSampler) X(BindSampler) \
+    X(SamplerParameteri) X(SamplerParameteriv) X(SamplerParameterf) X(SamplerParameterfv) X(SamplerParameterIiv) \
+    X(SamplerParameterIuiv) X(GetSamplerParameteriv) X(GetSamplerParameterIiv) X(GetSamplerParameterfv) \
+    X(GetSamplerParameterIuiv) X(QueryCounter) X(GetQueryObjecti64v) X(GetQueryObjectui64v) X(VertexAttribDivisor) \
+    X(VertexAttribP1ui) X(VertexAttribP1uiv) X(VertexAttribP2ui) X(VertexAttribP2uiv) X(VertexAttribP3ui) \
+    X(VertexAttribP3uiv) X(VertexAttribP4ui) X(VertexAttribP4uiv) X(VertexP2ui) X(VertexP2uiv) X(VertexP3ui) \
+    X(VertexP3uiv) X(VertexP4ui) X(VertexP4uiv) X(TexCoordP1ui) X(TexCoordP1uiv) X(TexCoordP2ui) X(TexCoordP2uiv) \
+    X(TexCoordP3ui) X(TexCoordP3uiv) X(TexCoordP4ui) X(TexCoordP4uiv) X(MultiTexCoordP1ui) X(MultiTexCoordP1uiv) \
+    X(MultiTexCoordP2ui) X(MultiTexCoordP2uiv) X(MultiTexCoordP3ui) X(MultiTexCoordP3uiv) X(MultiTexCoordP4ui) \
+    X(MultiTexCoordP4uiv) X(NormalP3ui) X(NormalP3uiv) X(ColorP3ui) X(ColorP3uiv) X(ColorP4ui) X(ColorP4uiv) \
+    X(SecondaryColorP3ui) X(SecondaryColorP3uiv)
+
+#define GLAD_LAZY_GL_4_0(X) \
+    X(MinSampleShading) X(BlendEquationi) X(BlendEquationSeparatei) X(BlendFunci) X(BlendFuncSeparatei) \
+    X(DrawArraysIndirect) X(DrawElementsIndirect) X(Uniform1d) X(Uniform2d) X(Uniform3d) X(Uniform4d) X(Uniform1dv) \
+    X(Uniform2dv) X(Uniform3dv) X(Uniform4dv) X(UniformMatrix2dv) X(UniformMatrix3dv) X(UniformMatrix4dv) \
+    X(UniformMatrix2x3dv) X(UniformMatrix2x4dv) X(UniformMatrix3x2dv) X(UniformMatrix3x4dv) X(UniformMatrix4x2dv) \
+    X(UniformMatrix4x3dv) X(GetUniformdv) X(GetSubroutineUniformLocation) X(GetSubroutineIndex) \
+    X(GetActiveSubroutineUniformiv) X(GetActiveSubroutineUniformName) X(GetActiveSubroutineName) \
+    X(UniformSubroutinesuiv) X(GetUniformSubroutineuiv) X(GetProgramStageiv) X(PatchParameteri) X(PatchParameterfv) \
+    X(BindTransformFeedback) X(DeleteTransformFeedbacks) X(GenTransformFeedbacks) X(IsTransformFeedback) \
+    X(PauseTransformFeedback) X(ResumeTransformFeedback) X(DrawTransformFeedback) X(DrawTransformFeedbackStream) \
+    X(BeginQueryIndexed) X(EndQueryIndexed) X(GetQueryIndexediv)
+
+#define GLAD_LAZY_GL_4_1(X) \
+    X(ReleaseShaderCompiler) X(ShaderBinary) X(GetShaderPrecisionFormat) X(DepthRangef) X(ClearDepthf) \
+    X(GetProgramBinary) X(ProgramBinary) X(ProgramParameteri) X(UseProgramStages) X(ActiveShaderProgram) \
+    X(CreateShaderProgramv) X(BindProgramPipeline) X(DeleteProgramPipelines) X(GenProgramPipelines) \
+    X(IsProgramPipeline) X(GetProgramPipelineiv) X(ProgramUniform1i) X(ProgramUniform1iv) X(ProgramUniform1f) \
+    X(ProgramUniform1fv) X(ProgramUniform1d) X(ProgramUniform1dv) X(ProgramUniform1ui) X(ProgramUniform1uiv) \
+    X(ProgramUniform2i) X(ProgramUniform2iv) X(ProgramUniform2f) X(ProgramUniform2fv) X(ProgramUniform2d) \
+    X(ProgramUniform2dv) X(ProgramUniform2ui) X(ProgramUniform2uiv) X(ProgramUniform3i) X(ProgramUniform3iv) \
+    X(ProgramUniform3f) X(ProgramUniform3fv) X(ProgramUniform3d) X(ProgramUniform3dv) X(ProgramUniform3ui) \
+    X(ProgramUniform3uiv) X(ProgramUniform4i) X(ProgramUniform4iv) X(ProgramUniform4f) X(ProgramUniform4fv) \
+    X(ProgramUniform4d) X(ProgramUniform4dv) X(ProgramUniform4ui) X(ProgramUniform4uiv) X(ProgramUniformMatrix2fv) \
+    X(ProgramUniformMatrix3fv) X(ProgramUniformMatrix4fv) X(ProgramUniformMatrix2dv) X(ProgramUniformMatrix3dv) \
+    X(ProgramUniformMatrix4dv) X(ProgramUniformMatrix2x3fv) X(ProgramUniformMatrix3x2fv) \
+    X(ProgramUniformMatrix2x4fv) X(ProgramUniformMatrix4x2fv) X(ProgramUniformMatrix3x4fv) \
+    X(ProgramUniformMatrix4x3fv) X(ProgramUniformMatrix2x3dv) X(ProgramUniformMatrix3x2dv) \
+    X(ProgramUniformMatrix2x4dv) X(ProgramUniformMatrix4x2dv) X(ProgramUniformMatrix3x4dv) \
+    X(ProgramUniformMatrix4x3dv) X(ValidateProgramPipeline) X(GetProgramPipelineInfoLog) X(VertexAttribL1d) \
+    X(VertexAttribL2d) X(VertexAttribL3d) X(VertexAttribL4d) X(VertexAttribL1dv) X(VertexAttribL2dv) \
+    X(VertexAttribL3dv) X(VertexAttribL4dv) X(VertexAttribLPointer) X(GetVertexAttribLdv) X(ViewportArrayv) \
+    X(ViewportIndexedf) X(ViewportIndexedfv) X(ScissorArrayv) X(ScissorIndexed) X(ScissorIndexedv) \
+    X(DepthRangeArrayv) X(DepthRangeIndexed) X(GetFloati_v) X(GetDoublei_v)
+
+#define GLAD_LAZY_GL_4_2(X) \
+    X(DrawArraysInstancedBaseInstance) X(DrawElementsInstancedBaseInstance) \
+    X(DrawElementsInstancedBaseVertexBaseInstance) X(GetInternalformativ) X(GetActiveAtomicCounterBufferiv) \
+    X(BindImageTexture) X(MemoryBarrier) X(TexStorage1D) X(TexStorage2D) X(TexStorage3D) \
+    X(DrawTransformFeedbackInstanced) X(DrawTransformFeedbackStreamInstanced)
+
+#define GLAD_LAZY_GL_4_3(X) \
+    X(ClearBufferData) X(ClearBufferSubData) X(DispatchCompute) X(DispatchComputeIndirect) X(CopyImageSubData) \
+    X(FramebufferParameteri) X(GetFramebufferParameteriv) X(GetInternalformati64v) X(InvalidateTexSubImage) \
+    X(InvalidateTexImage) X(InvalidateBufferSubData) X(InvalidateBufferData) X(InvalidateFramebuffer) \
+    X(InvalidateSubFramebuffer) X(MultiDrawArraysIndirect) X(MultiDrawElementsIndirect) X(GetProgramInterfaceiv) \
+    X(GetProgramResourceIndex) X(GetProgramResourceName) X(GetProgramResourceiv) X(GetProgramResourceLocation) \
+    X(GetProgramResourceLocationIndex) X(ShaderStorageBlockBinding) X(TexBufferRange) X(TexStorage2DMultisample) \
+    X(TexStorage3DMultisample) X(TextureView) X(BindVertexBuffer) X(VertexAttribFormat) X(VertexAttribIFormat) \
+    X(VertexAttribLFormat) X(VertexAttribBinding) X(VertexBindingDivisor) X(DebugMessageControl) \
+    X(DebugMessageInsert) X(DebugMessageCallback) X(GetDebugMessageLog) X(PushDebugGroup) X(PopDebugGroup) \
+    X(ObjectLabel) X(GetObjectLabel) X(ObjectPtrLabel) X(GetObjectPtrLabel) X(GetPointerv)
+
+#define GLAD_LAZY_GL_4_4(X) \
+    X(BufferStorage) X(ClearTexImage) X(ClearTexSubImage) X(BindBuffersBase) X(BindBuffersRange) X(BindTextures) \
+    X(BindSamplers) X(BindImageTextures) X(BindVertexBuffers)
+
+#define GLAD_LAZY_GL_4_5(X) \
+    X(ClipControl) X(CreateTransformFeedbacks) X(TransformFeedbackBufferBase) X(TransformFeedbackBufferRange) \
+    X(GetTransformFeedbackiv) X(GetTransformFeedbacki_v) X(GetTransformFeedbacki64_v) X(CreateBuffers) \
+    X(NamedBufferStorage) X(NamedBufferData) X(NamedBufferSubData) X(CopyNamedBufferSubData) X(ClearNamedBufferData) \
+    X(ClearNamedBufferSubData) X(MapNamedBuffer) X(MapNamedBufferRange) X(UnmapNamedBuffer) \
+    X(FlushMappedNamedBufferRange) X(GetNamedBufferParameteriv) X(GetNamedBufferParameteri64v) \
+    X(GetNamedBufferPointerv) X(GetNamedBufferSubData) X(CreateFramebuffers) X(NamedFramebufferRenderbuffer) \
+    X(NamedFramebufferParameteri) X(NamedFramebufferTexture) X(NamedFramebufferTextureLayer) \
+    X(NamedFramebufferDrawBuffer) X(NamedFramebufferDrawBuffers) X(NamedFramebufferReadBuffer) \
+    X(InvalidateNamedFramebufferData) X(InvalidateNamedFramebufferSubData) X(ClearNamedFramebufferiv) \
+    X(ClearNamedFramebufferuiv) X(ClearNamedFramebufferfv) X(ClearNamedFramebufferfi) X(BlitNamedFramebuffer) \
+    X(CheckNamedFramebufferStatus) X(GetNamedFramebufferParameteriv) X(GetNamedFramebufferAttachmentParameteriv) \
+    X(CreateRenderbuffers) X(NamedRenderbufferStorage) X(NamedRenderbufferStorageMultisample) \
+    X(GetNamedRenderbufferParameteriv) X(CreateTextures) X(TextureBuffer) X(TextureBufferRange) X(TextureStorage1D) \
+    X(TextureStorage2D) X(TextureStorage3D) X(TextureStorage2DMultisample) X(TextureStorage3DMultisample) \
+    X(TextureSubImage1D) X(TextureSubImage2D) X(TextureSubImage3D) X(CompressedTextureSubImage1D) \
+    X(CompressedTextureSubImage2D) X(CompressedTextureSubImage3D) X(CopyTextureSubImage1D) X(CopyTextureSubImage2D) \
+    X(CopyTextureSubImage3D) X(TextureParameterf) X(TextureParameterfv) X(TextureParameteri) X(TextureParameterIiv) \
+    X(TextureParameterIuiv) X(TextureParameteriv) X(GenerateTextureMipmap) X(BindTextureUnit) X(GetTextureImage) \
+    X(GetCompressedTextureImage) X(GetTextureLevelParameterfv) X(GetTextureLevelParameteriv) \
+    X(GetTextureParameterfv) X(GetTextureParameterIiv) X(GetTextureParameterIuiv) X(GetTextureParameteriv) \
+    X(CreateVertexArrays) X(DisableVertexArrayAttrib) X(EnableVertexArrayAttrib) X(VertexArrayElementBuffer) \
+    X(VertexArrayVertexBuffer) X(VertexArrayVertexBuffers) X(VertexArrayAttribBinding) X(VertexArrayAttribFormat) \
+    X(VertexArrayAttribIFormat) X(VertexArrayAttribLFormat) X(VertexArrayBindingDivisor) X(GetVertexArrayiv) \
+    X(GetVertexArrayIndexediv) X(GetVertexArrayIndexed64iv) X(CreateSamplers) X(CreateProgramPipelines) \
+    X(CreateQueries) X(GetQueryBufferObjecti64v) X(GetQueryBufferObjectiv) X(GetQueryBufferObjectui64v) \
+    X(GetQueryBufferObjectuiv) X(MemoryBarrierByRegion) X(GetTextureSubImage) X(GetCompressedTextureSubImage) \
+    X(GetGraphicsResetStatus) X(GetnCompressedTexImage) X(GetnTexImage) X(GetnUniformdv) X(GetnUniformfv) \
+    X(GetnUniformiv) X(GetnUniformuiv) X(ReadnPixels) X(GetnMapdv) X(GetnMapfv) X(GetnMapiv) X(GetnPixelMapfv) \
+    X(GetnPixelMapuiv) X(GetnPixelMapusv) X(GetnPolygonStipple) X(GetnColorTable) X(GetnConvolutionFilter) \
+    X(GetnSeparableFilter) X(GetnHistogram) X(GetnMinmax) X(TextureBarrier)
+
+#define GLAD_LAZY_GL_4_6(X) \
+    X(SpecializeShader) X(MultiDrawArraysIndirectCount) X(MultiDrawElementsIndirectCount) X(PolygonOffsetClamp)
+
+#define GLAD_LAZY_FUNCTIONS(X) \
+    GLAD_LAZY_GL_1_0(X) GLAD_LAZY_GL_1_1(X) GLAD_LAZY_GL_1_2(X) GLAD_LAZY_GL_1_3(X) GLAD_LAZY_GL_1_4(X) \
+    GLAD_LAZY_GL_1_5(X) GLAD_LAZY_GL_2_0(X) GLAD_LAZY_GL_2_1(X) GLAD_LAZY_GL_3_0(X) GLAD_LAZY_GL_3_1(X) \
+    GLAD_LAZY_GL_3_2(X) GLAD_LAZY_GL_3_3(X) GLAD_LAZY_GL_4_0(X) GLAD_LAZY_GL_4_1(X) GLAD_LAZY_GL_4_2(X) \
+    GLAD_LAZY_GL_4_3(X) GLAD_LAZY_GL_4_4(X) GLAD_LAZY_GL_4_5(X) GLAD_LAZY_GL_4_6(X)
+
+enum class GladFunction : uint16_t
+{
+#define GLAD_LAZY_ENUM(name) name,
+    GLAD_LAZY_FUNCTIONS(GLAD_LAZY_ENUM)
+#undef GLAD_LAZY_ENUM
+    Count
+};
+
+const unsigned int GLAD_LAZY_COUNT = (unsigned int)GladFunction::Count;
+
+// the glad pointer of a function, i.e. &glad_glBindBuffer
+inline void** gladLazySlot(unsigned int id)
+{
+    static void** slots[] = {
+#define GLAD_LAZY_SLOT(name) (void**)&glad_gl##name,
+        GLAD_LAZY_FUNCTIONS(GLAD_LAZY_SLOT)
+#undef GLAD_LAZY_SLOT
+    };
+    return slots[id];
+}
+
+inline const char* gladLazyName(unsigned int id)
+{
+    static const char* names[] = {
+#define GLAD_LAZY_NAME(name) "gl" #name,
+        GLAD_LAZY_FUNCTIONS(GLAD_LAZY_NAME)
+#undef GLAD_LAZY_NAME
+    };
+    return names[id];
+}
+
+class GladLazyLoader
+{
+public:
+    GLADloadproc loader = nullptr;
+    unsigned int resolvedCount = 0;
+    unsigned int missingCount = 0;
+    uint64_t resolveNs = 0;     // time spent in the loader, first calls included
+
+    // ------------------------------------------------------------------------
+    bool load(GLADloadproc proc);
+    // look a function up on its first call and patch its glad pointer; returns null if the driver doesn't have it
+    // ------------------------------------------------------------------------
+    void* resolve(unsigned int id)
+    {
+        if (resolved[id])
+            return resolved[id];
+        auto start = std::chrono::steady_clock::now();
+        void* fn = loader ? loader(gladLazyName(id)) : nullptr;
+        resolveNs += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        if (!fn)
+        {
+            if (!reported[id])
+                std::cout << "ERROR::GLAD_LAZY::MISSING: " << gladLazyName(id) << std::endl;
+            reported[id] = true;
+            missingCount++;
+            return nullptr;
+        }
+        resolved[id] = fn;
+        resolvedCount++;
+        void** slot = gladLazySlot(id);
+        if (*slot == trampolines()[id])
+            *slot = fn;
+        return fn;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "GLAD_LAZY:: " << resolvedCount << " of " << GLAD_LAZY_COUNT << " entry points resolved, " << resolveNs / 1000.0
+                  << " us in the loader";
+        if (missingCount)
+            std::cout << ", " << missingCount << " calls to missing functions";
+        std::cout << std::endl;
+    }
+
+private:
+    void* resolved[GLAD_LAZY_COUNT] = {};
+    bool reported[GLAD_LAZY_COUNT] = {};
+
+    static void* const* trampolines();
+};
+
+// the process-wide loader state
+inline GladLazyLoader& gladLazy()
+{
+    static GladLazyLoader lazy;
+    return lazy;
+}
+
+// first-call trampoline of one glad function
+template <unsigned int Id, typename Fn>
+struct GladLazy;
+
+template <unsigned int Id, typename R, typename... A>
+struct GladLazy<Id, R (APIENTRYP)(A...)>
+{
+    typedef R (APIENTRYP Fn)(A...);
+
+    // ------------------------------------------------------------------------
+    static R APIENTRY trampoline(A... args)
+    {
+        Fn fn = (Fn)gladLazy().resolve(Id);
+        if (!fn)
+        {
+            if constexpr (!std::is_void<R>::value)
+                return R();
+            else
+                return;
+        }
+        return fn(args...);
+    }
+};
+
+inline void* const* GladLazyLoader::trampolines()
+{
+    static void* const table[] = {
+#define GLAD_LAZY_TRAMPOLINE(name) (void*)&GladLazy<(unsigned int)GladFunction::name, decltype(glad_gl##name)>::trampoline,
+        GLAD_LAZY_FUNCTIONS(GLAD_LAZY_TRAMPOLINE)
+#undef GLAD_LAZY_TRAMPOLINE
+    };
+    return table;
+}
+
+// read the context version the way glad's find_coreGL() does, then arm the trampolines
+// ------------------------------------------------------------------------
+inline bool GladLazyLoader::load(GLADloadproc proc)
+{
+    loader = proc;
+    std::fill(std::begin(resolved), std::end(resolved), nullptr);
+    std::fill(std::begin(reported), std::end(reported), false);
+    resolvedCount = missingCount = 0;
+    resolveNs = 0;
+    for (unsigned int i = 0; i < GLAD_LAZY_COUNT; i++)
+        *gladLazySlot(i) = trampolines()[i];
+
+    const char* version = (const char*)glGetString(GL_VERSION);
+    if (!version)
+        return false;
+    const char* prefixes[] = { "OpenGL ES-CM ", "OpenGL ES-CL ", "OpenGL ES " };
+    for (const char* prefix : prefixes)
+        if (std::strncmp(version, prefix, std::strlen(prefix)) == 0)
+        {
+            version += std::strlen(prefix);
+            break;
+        }
+    int major = 0, minor = 0;
+    if (std::sscanf(version, "%d.%d", &major, &minor) != 2)
+        return false;
+    GLVersion.major = major;
+    GLVersion.minor = minor;
+    auto atLeast = [&](int ma, int mi) { return major > ma || (major == ma && minor >= mi); };
+    GLAD_GL_VERSION_1_0 = atLeast(1, 0); GLAD_GL_VERSION_1_1 = atLeast(1, 1); GLAD_GL_VERSION_1_2 = atLeast(1, 2);
+    GLAD_GL_VERSION_1_3 = atLeast(1, 3); GLAD_GL_VERSION_1_4 = atLeast(1, 4); GLAD_GL_VERSION_1_5 = atLeast(1, 5);
+    GLAD_GL_VERSION_2_0 = atLeast(2, 0); GLAD_GL_VERSION_2_1 = atLeast(2, 1);
+    GLAD_GL_VERSION_3_0 = atLeast(3, 0); GLAD_GL_VERSION_3_1 = atLeast(3, 1); GLAD_GL_VERSION_3_2 = atLeast(3, 2);
+    GLAD_GL_VERSION_3_3 = atLeast(3, 3);
+    GLAD_GL_VERSION_4_0 = atLeast(4, 0); GLAD_GL_VERSION_4_1 = atLeast(4, 1); GLAD_GL_VERSION_4_2 = atLeast(4, 2);
+    GLAD_GL_VERSION_4_3 = atLeast(4, 3); GLAD_GL_VERSION_4_4 = atLeast(4, 4); GLAD_GL_VERSION_4_5 = atLeast(4, 5);
+    GLAD_GL_VERSION_4_6 = atLeast(4, 6);
+    return GLVersion.major != 0;
+}
+
+// drop-in for gladLoadGLLoader(); call with the context current
+inline int gladLoadGLLoaderLazy(GLADloadproc proc)
+{
+    return gladLazy().load(proc) ? 1 : 0;
+}
+
+class GladExtensions
+{
+public:
+    // ------------------------------------------------------------------------
+    bool has(const char* name)
+    {
+        if (!built)
+            build();
+        return std::binary_search(names.begin(), names.end(), name, less);
+    }
+    // the list belongs to the context; call after switching to a different one
+    // ------------------------------------------------------------------------
+    void invalidate()
+    {
+        names.clear();
+        built = false;
+    }
+    // ------------------------------------------------------------------------
+    size_t count()
+    {
+        if (!built)
+            build();
+        return names.size();
+    }
+
+private:
+    // strings from glGetStringi stay valid as long as the context, so only the pointers are kept
+    std::vector<const char*> names;
+    bool built = false;
+
+    static bool less(const char* a, const char* b)
+    {
+        return std::strcmp(a, b) < 0;
+    }
+    void build()
+    {
+        built = true;
+        names.clear();
+        if (!GLAD_GL_VERSION_3_0)
+            return;
+        GLint extensionCount = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+        names.reserve((size_t)std::max(extensionCount, 0));
+        for (GLint i = 0; i < extensionCount; i++)
+            if (const char* name = (const char*)glGetStringi(GL_EXTENSIONS, (GLuint)i))
+                names.push_back(name);
+        std::sort(names.begin(), names.end(), less);
+    }
+};
+
+// the current context's extensions
+inline GladExtensions& glExtensions()
+{
+    static GladExtensions extensions;
+    return extensions;
+}
+#endif
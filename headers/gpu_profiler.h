@@ -0,0 +1,237 @@
+#ifndef GPU_PROFILER_H
+#define GPU_PROFILER_H
+
+#include <glad/glad.h>
+
+#include <profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+//////// GPU PROFILER ////
+// - GPU_ZONE(gpu, "name") brackets the GL commands of the rest of the scope with two GL_TIMESTAMP queries (glQueryCounter).
+//      Timestamps rather than GL_TIME_ELAPSED because elapsed-time queries can't nest or overlap
+// - the GPU runs a frame or two behind the CPU, so asking for a query result straight away stalls until it catches up.
+//      Queries come from a pool with one set per in-flight frame (GPU_PROFILER_LATENCY); a frame's results are read
+//      back when its set comes around again, by which time they are long done. If they still aren't, the frame is
+//      skipped rather than waited for
+// - stub mode makes no GL calls at all: timestamps are taken from the CPU clock when the zone is recorded and handed back
+//      with the same latency, so the whole path from zones to report and trace can be run without a GPU
+// - frameResults() is the latest completed frame; report() prints it and exportChromeTrace() writes every captured frame
+
+const unsigned int GPU_PROFILER_LATENCY = 4;
+
+struct GpuZoneResult
+{
+    std::string name;
+    uint64_t start;     // ns, GPU clock
+    uint64_t end;
+    uint32_t depth;
+};
+
+class GpuProfiler
+{
+public:
+    bool stub;
+    uint64_t framesSkipped = 0;     // frames whose results weren't ready when their slot came around
+
+    explicit GpuProfiler(bool stub = false) : stub(stub) {}
+    ~GpuProfiler()
+    {
+        if (stub)
+            return;
+        for (FrameSlot& slot : slots)
+            if (!slot.queries.empty())
+                glDeleteQueries((GLsizei)slot.queries.size(), slot.queries.data());
+    }
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+
+    // start recording a frame; reads back the frame that used this slot GPU_PROFILER_LATENCY frames ago
+    // ------------------------------------------------------------------------
+    void beginFrame()
+    {
+        FrameSlot& slot = slots[frameIndex % GPU_PROFILER_LATENCY];
+        if (slot.used)
+            collect(slot);
+        slot.zones.clear();
+        slot.used = 0;
+        slot.frame = frameIndex;
+        stack.clear();
+    }
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        frameIndex++;
+    }
+    // ------------------------------------------------------------------------
+    void beginZone(const char* name)
+    {
+        FrameSlot& slot = current();
+        PendingZone zone = { name, timestamp(slot), OPEN, (uint32_t)stack.size() };
+        stack.push_back((uint32_t)slot.zones.size());
+        slot.zones.push_back(zone);
+    }
+    // ------------------------------------------------------------------------
+    void endZone()
+    {
+        if (stack.empty())
+            return;
+        FrameSlot& slot = current();
+        slot.zones[stack.back()].endQuery = timestamp(slot);
+        stack.pop_back();
+    }
+    // keep every completed frame for exportChromeTrace()
+    // ------------------------------------------------------------------------
+    void beginCapture(unsigned int frames)
+    {
+        trace.clear();
+        captureFrames = frames;
+    }
+    // zones of the latest frame whose results came back
+    // ------------------------------------------------------------------------
+    const std::vector<GpuZoneResult>& frameResults() const
+    {
+        return results;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "GPU_PROFILER:: frame " << resultsFrame << (stub ? " (stub timestamps)" : "") << ", " << framesSkipped << " frames skipped" << std::endl;
+        for (const GpuZoneResult& zone : results)
+            std::cout << "    " << std::string(zone.depth * 2, ' ') << zone.name << ": " << (zone.end - zone.start) / 1000.0 << " us" << std::endl;
+    }
+    // ------------------------------------------------------------------------
+    bool exportChromeTrace(const char* path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::GPU_PROFILER::TRACE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        uint64_t origin = trace.empty() ? 0 : trace.front().start;
+        file << "{\"traceEvents\":[\n";
+        for (size_t i = 0; i < trace.size(); i++)
+        {
+            const GpuZoneResult& e = trace[i];
+            file << (i ? ",\n" : "") << "{\"name\":";
+            writeJsonString(file, e.name.c_str());
+            file << ",\"ph\":\"X\",\"pid\":2,\"tid\":0,\"ts\":" << (e.start - origin) / 1000.0
+                 << ",\"dur\":" << (e.end - e.start) / 1000.0 << ",\"args\":{\"depth\":" << e.depth << "}}";
+        }
+        file << "\n]}\n";
+        return true;
+    }
+
+private:
+    struct PendingZone
+    {
+        const char* name;
+        uint32_t beginQuery;    // index into the slot's queries
+        uint32_t endQuery;      // OPEN while the zone hasn't ended
+        uint32_t depth;
+    };
+    static const uint32_t OPEN = ~0u;
+    struct FrameSlot
+    {
+        std::vector<unsigned int> queries;      // grows to the largest frame seen, then is reused
+        std::vector<uint64_t> stubTimes;        // stub mode: the "query results"
+        std::vector<PendingZone> zones;
+        uint32_t used = 0;
+        uint64_t frame = 0;
+    };
+
+    FrameSlot slots[GPU_PROFILER_LATENCY];
+    std::vector<uint32_t> stack;
+    std::vector<GpuZoneResult> results;
+    std::vector<GpuZoneResult> trace;
+    std::vector<uint64_t> values;
+    uint64_t frameIndex = 0;
+    uint64_t resultsFrame = 0;
+    unsigned int captureFrames = 0;
+
+    FrameSlot& current()
+    {
+        return slots[frameIndex % GPU_PROFILER_LATENCY];
+    }
+    // issue a timestamp query (or take a stub time), returns its index in the slot
+    uint32_t timestamp(FrameSlot& slot)
+    {
+        uint32_t index = slot.used++;
+        if (stub)
+        {
+            if (slot.stubTimes.size() <= index)
+                slot.stubTimes.resize(index + 1);
+            slot.stubTimes[index] = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+            return index;
+        }
+        if (slot.queries.size() <= index)
+        {
+            size_t grow = std::max<size_t>(16, slot.queries.size());
+            slot.queries.resize(slot.queries.size() + grow);
+            glGenQueries((GLsizei)grow, slot.queries.data() + slot.queries.size() - grow);
+        }
+        glQueryCounter(slot.queries[index], GL_TIMESTAMP);
+        return index;
+    }
+    // read a slot's results without waiting; the whole frame is skipped if the last query isn't done yet
+    void collect(FrameSlot& slot)
+    {
+        values.resize(slot.used);
+        if (stub)
+            std::copy(slot.stubTimes.begin(), slot.stubTimes.begin() + slot.used, values.begin());
+        else
+        {
+            // queries complete in order, so the last one being available means they all are
+            GLint available = 0;
+            glGetQueryObjectiv(slot.queries[slot.used - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available)
+            {
+                framesSkipped++;
+                return;
+            }
+            for (uint32_t i = 0; i < slot.used; i++)
+                glGetQueryObjectui64v(slot.queries[i], GL_QUERY_RESULT, &values[i]);
+        }
+        results.clear();
+        for (const PendingZone& zone : slot.zones)
+            if (zone.endQuery != OPEN)
+                results.push_back({ zone.name, values[zone.beginQuery], values[zone.endQuery], zone.depth });
+        resultsFrame = slot.frame;
+        if (captureFrames)
+        {
+            trace.insert(trace.end(), results.begin(), results.end());
+            captureFrames--;
+        }
+    }
+};
+
+// RAII zone, use through GPU_ZONE
+class GpuZone
+{
+public:
+    GpuZone(GpuProfiler& profiler, const char* name) : profiler(profiler)
+    {
+        profiler.beginZone(name);
+    }
+    ~GpuZone()
+    {
+        profiler.endZone();
+    }
+    GpuZone(const GpuZone&) = delete;
+    GpuZone& operator=(const GpuZone&) = delete;
+
+private:
+    GpuProfiler& profiler;
+};
+
+#define GPU_ZONE_CONCAT_INNER(a, b) a##b
+#define GPU_ZONE_CONCAT(a, b) GPU_ZONE_CONCAT_INNER(a, b)
+#define GPU_ZONE(profiler, name) GpuZone GPU_ZONE_CONCAT(gpuZone, __LINE__)(profiler, name)
+#endif
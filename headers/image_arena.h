@@ -0,0 +1,283 @@
+#ifndef IMAGE_ARENA_H
+#define IMAGE_ARENA_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+#include <iostream>
+
+//////// IMAGE DECODE ALLOCATOR ////
+// - every image decode allocates its output, its scratch buffers (zlib output, JPEG component planes, line buffers)
+//      and frees all but the output a few milliseconds later; the samples free the output right after uploading it.
+//      Through plain malloc that's a stream of short-lived multi-megabyte blocks of varying sizes, which fragments the
+//      heap when thousands of textures are decoded and makes decode threads queue on the allocator's locks
+// - imageArenaMalloc/Realloc/Free keep a free list per power-of-two size class in a thread_local pool. A freed block
+//      goes back to the freeing thread's pool and the next decode of a similar size takes it from there without touching
+//      malloc or any lock. Sizes are quantized, so a block always fits whatever asks for its class again
+// - realloc within the same class returns the same block, which makes stb_image's doubling zlib buffer cheap
+// - each pool keeps at most IMAGE_ARENA_CACHE_BYTES cached; blocks above IMAGE_ARENA_MAX_CLASS bytes go straight to
+//      malloc/free
+// - stb_image is built with these as STBI_MALLOC / STBI_REALLOC_SIZED / STBI_FREE (src/stb_image.cpp), so
+//      stbi_image_free() returns to the pool; ImageArenaAllocator puts std::vectors (DecodedImage, image_decode.h) on
+//      the same pools
+// - every block remembers the thread that allocated it, so imageArenaReport() can print each thread's peak of bytes in
+//      use and its cache footprint even when the images are freed somewhere else
+
+const unsigned int IMAGE_ARENA_MIN_CLASS = 6;       // 64 bytes
+const unsigned int IMAGE_ARENA_MAX_CLASS = 28;      // 256 MB
+const size_t IMAGE_ARENA_CACHE_BYTES = (size_t)128 << 20;
+
+// per-thread counters; they outlive their thread so its blocks can still be freed and reported afterwards
+struct ImageArenaStats
+{
+    unsigned int thread = 0;                    // registration order
+    std::atomic<int64_t> inUse{ 0 };            // requested bytes allocated by this thread and not freed yet
+    std::atomic<int64_t> peak{ 0 };
+    std::atomic<int64_t> cached{ 0 };           // bytes sitting in this thread's free lists
+    std::atomic<int64_t> peakFootprint{ 0 };    // peak of in use + cached
+    std::atomic<uint64_t> allocations{ 0 };
+    std::atomic<uint64_t> cacheHits{ 0 };
+    std::atomic<bool> exited{ false };          // set by the exiting thread, read by report() on another
+};
+
+class ImageArenaRegistry
+{
+public:
+    // ------------------------------------------------------------------------
+    ImageArenaStats* add()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.push_back(std::make_unique<ImageArenaStats>());
+        stats.back()->thread = (unsigned int)stats.size() - 1;
+        return stats.back().get();
+    }
+    // ------------------------------------------------------------------------
+    void report()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::cout << "IMAGE_ARENA:: " << stats.size() << " thread pool(s)" << std::endl;
+        for (const std::unique_ptr<ImageArenaStats>& s : stats)
+        {
+            uint64_t allocations = s->allocations.load();
+            std::cout << "    thread " << s->thread << (s->exited.load() ? " (exited)" : "") << ": peak " << s->peak.load() / 1024 << " KB in use, peak footprint "
+                      << s->peakFootprint.load() / 1024 << " KB, " << s->inUse.load() / 1024 << " KB still in use, " << allocations << " allocations, "
+                      << (allocations ? 100.0 * (double)s->cacheHits.load() / (double)allocations : 0.0) << "% from the cache" << std::endl;
+        }
+    }
+
+private:
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ImageArenaStats>> stats;
+};
+
+inline ImageArenaRegistry& imageArenaRegistry()
+{
+    static ImageArenaRegistry registry;
+    return registry;
+}
+
+// in front of every block; 16 bytes keep the payload as aligned as malloc's
+struct ImageArenaHeader
+{
+    ImageArenaStats* owner;
+    uint32_t requested;
+    uint32_t sizeClass;     // 0: not pooled, freed straight to the system
+};
+static_assert(sizeof(ImageArenaHeader) == 16, "image arena header must keep 16-byte alignment");
+
+class ImageArenaPool
+{
+public:
+    ImageArenaStats* stats;
+
+    ImageArenaPool() : stats(imageArenaRegistry().add()) {}
+    ~ImageArenaPool()
+    {
+        retired() = stats;
+        for (std::vector<void*>& list : cache)
+            for (void* block : list)
+                std::free(block);
+        stats->cached = 0;
+        stats->exited = true;
+    }
+    ImageArenaPool(const ImageArenaPool&) = delete;
+    ImageArenaPool& operator=(const ImageArenaPool&) = delete;
+
+    // set once this thread's pool is gone: buffers allocated or freed later in its exit (other thread_locals, statics on
+    //      the main thread) go straight to the system but are still counted
+    static ImageArenaStats*& retired()
+    {
+        thread_local ImageArenaStats* gone = NULL;
+        return gone;
+    }
+
+    // ------------------------------------------------------------------------
+    void* allocate(size_t size)
+    {
+        if (size > UINT32_MAX)
+            return NULL;
+        unsigned int sizeClass = classOf(size);
+        void* block = NULL;
+        if (sizeClass && !cache[sizeClass].empty())
+        {
+            block = cache[sizeClass].back();
+            cache[sizeClass].pop_back();
+            stats->cached -= (int64_t)1 << sizeClass;
+            stats->cacheHits++;
+        }
+        else
+        {
+            block = std::malloc(sizeof(ImageArenaHeader) + (sizeClass ? (size_t)1 << sizeClass : size));
+            if (!block)
+                return NULL;
+        }
+        ImageArenaHeader* header = (ImageArenaHeader*)block;
+        header->owner = stats;
+        header->requested = (uint32_t)size;
+        header->sizeClass = sizeClass;
+        stats->allocations++;
+        int64_t inUse = stats->inUse += (int64_t)size;
+        if (inUse > stats->peak)
+            stats->peak = inUse;
+        if (inUse + stats->cached > stats->peakFootprint)
+            stats->peakFootprint = inUse + stats->cached;
+        return header + 1;
+    }
+    // ------------------------------------------------------------------------
+    void release(void* p)
+    {
+        if (!p)
+            return;
+        ImageArenaHeader* header = (ImageArenaHeader*)p - 1;
+        header->owner->inUse -= (int64_t)header->requested;
+        unsigned int sizeClass = header->sizeClass;
+        if (!sizeClass || stats->cached + ((int64_t)1 << sizeClass) > (int64_t)IMAGE_ARENA_CACHE_BYTES)
+        {
+            std::free(header);
+            return;
+        }
+        cache[sizeClass].push_back(header);
+        stats->cached += (int64_t)1 << sizeClass;
+    }
+    // ------------------------------------------------------------------------
+    void* reallocate(void* p, size_t newSize)
+    {
+        if (!p)
+            return allocate(newSize);
+        ImageArenaHeader* header = (ImageArenaHeader*)p - 1;
+        if (header->sizeClass && newSize <= UINT32_MAX && classOf(newSize) == header->sizeClass)
+        {
+            header->owner->inUse += (int64_t)newSize - (int64_t)header->requested;
+            header->requested = (uint32_t)newSize;
+            if (header->owner == stats && stats->inUse > stats->peak)
+                stats->peak = stats->inUse.load();
+            return p;
+        }
+        void* q = allocate(newSize);
+        if (!q)
+            return NULL;
+        std::memcpy(q, p, std::min<size_t>(header->requested, newSize));
+        release(p);
+        return q;
+    }
+
+private:
+    std::vector<void*> cache[IMAGE_ARENA_MAX_CLASS + 1];
+
+    static unsigned int classOf(size_t size)
+    {
+        unsigned int sizeClass = IMAGE_ARENA_MIN_CLASS;
+        while (((size_t)1 << sizeClass) < size)
+            sizeClass++;
+        return sizeClass <= IMAGE_ARENA_MAX_CLASS ? sizeClass : 0;
+    }
+};
+
+inline ImageArenaPool* imageArenaPool()
+{
+    if (ImageArenaPool::retired())
+        return NULL;
+    thread_local ImageArenaPool pool;
+    return &pool;
+}
+
+inline void* imageArenaMalloc(size_t size)
+{
+    ImageArenaPool* pool = imageArenaPool();
+    if (pool)
+        return pool->allocate(size);
+    ImageArenaHeader* header = size <= UINT32_MAX ? (ImageArenaHeader*)std::malloc(sizeof(ImageArenaHeader) + size) : NULL;
+    if (!header)
+        return NULL;
+    *header = { ImageArenaPool::retired(), (uint32_t)size, 0 };
+    header->owner->inUse += (int64_t)size;
+    return header + 1;
+}
+
+inline void imageArenaFree(void* p)
+{
+    ImageArenaPool* pool = imageArenaPool();
+    if (pool)
+        pool->release(p);
+    else if (p)
+    {
+        ImageArenaHeader* header = (ImageArenaHeader*)p - 1;
+        header->owner->inUse -= (int64_t)header->requested;
+        std::free(header);
+    }
+}
+
+inline void* imageArenaRealloc(void* p, size_t newSize)
+{
+    ImageArenaPool* pool = imageArenaPool();
+    if (pool)
+        return pool->reallocate(p, newSize);
+    void* q = imageArenaMalloc(newSize);
+    if (q && p)
+    {
+        std::memcpy(q, p, std::min<size_t>(((ImageArenaHeader*)p - 1)->requested, newSize));
+        imageArenaFree(p);
+    }
+    return q;
+}
+
+// every thread's peak memory, including threads that have exited
+inline void imageArenaReport()
+{
+    imageArenaRegistry().report();
+}
+
+// std allocator on the image pools, for decoder-owned buffers
+template <typename T>
+struct ImageArenaAllocator
+{
+    typedef T value_type;
+
+    ImageArenaAllocator() = default;
+    template <typename U>
+    ImageArenaAllocator(const ImageArenaAllocator<U>&) {}
+
+    T* allocate(size_t n)
+    {
+        void* p = imageArenaMalloc(n * sizeof(T));
+        if (!p)
+            throw std::bad_alloc();
+        return (T*)p;
+    }
+    void deallocate(T* p, size_t)
+    {
+        imageArenaFree(p);
+    }
+    template <typename U>
+    bool operator==(const ImageArenaAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const ImageArenaAllocator<U>&) const { return false; }
+};
+#endif
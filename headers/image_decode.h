@@ -0,0 +1,1222 @@
+#ifndef IMAGE_DECODE_H
+#define IMAGE_DECODE_H
+
+#include <stb_image.h>
+
+#include <image_arena.h>
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IMAGE_DECODE_SSE2 1
+#endif
+
+//////// IMAGE DECODING ////
+// - replaces stbi_load() for the formats our textures come in: baseline JPEG and 8-bit non-interlaced PNG. Anything
+//      else (progressive JPEG, 16-bit or interlaced PNG, other formats) goes through stb_image as before
+// - flipping for GL's bottom-up rows happens while rows are written out: row y lands at height - 1 - y straight away,
+//      instead of stb_image decoding top-down and swapping every row afterwards
+// - JPEG: the entropy-coded data is cut at its restart markers and the intervals are Huffman decoded + IDCT'd on
+//      separate threads, each into its own blocks of the component planes. Chroma upsampling and YCbCr -> RGB then
+//      run in parallel over bands of rows. Without restart markers the entropy decoding is one sequential pass
+//      (the bit stream can't be entered anywhere else) and only the second half is spread out
+// - the IDCT, upsampling filters and color conversion use the same integer arithmetic as stb_image, so the output is
+//      identical to stbi_load() byte for byte and switching decoders doesn't change a single texel
+// - PNG: zlib inflate comes from stb_image, the per-row filters are undone here with SSE2: the Up filter 16 bytes at
+//      a time, Sub/Avg/Paeth a pixel at a time across all of its channels
+// - results come back in a DecodedImage with stbi_load's channel count (desired_channels = 0). Its pixels, the JPEG
+//      component planes and the compressed PNG data live on the decoding thread's image pools (image_arena.h) like
+//      stb_image's own buffers
+// - the parallel parts run on a process-wide set of worker threads started on first use and kept for the rest of the
+//      program, so a decode doesn't pay for creating and joining threads twice. Images under
+//      IMAGE_DECODE_PARALLEL_MIN_PIXELS decode on the calling thread alone, where handing out work costs more than it saves
+
+struct DecodedImage
+{
+    int width = 0;
+    int height = 0;
+    int channels = 0;
+    std::vector<unsigned char, ImageArenaAllocator<unsigned char>> pixels;
+};
+
+struct ImageDecodeStats
+{
+    size_t bytes = 0;           // compressed size
+    double seconds = 0.0;
+    unsigned int threads = 1;
+    bool fastPath = false;      // false: handed to stb_image
+
+    double megabytesPerSecond() const { return seconds > 0.0 ? (double)bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+const int IMAGE_DECODE_PARALLEL_MIN_PIXELS = 256 * 256;
+
+// worker threads shared by every parallel decode; one job at a time, a second caller (or a job started from inside a
+//      job) runs its work on its own thread instead of waiting
+class ImageDecodeWorkers
+{
+public:
+    // the workers' image pools are torn down when they're joined, so the registry their stats live in has to be
+    //      constructed first, to be destroyed after
+    ImageDecodeWorkers() { imageArenaRegistry(); }
+    ~ImageDecodeWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+    ImageDecodeWorkers(const ImageDecodeWorkers&) = delete;
+    ImageDecodeWorkers& operator=(const ImageDecodeWorkers&) = delete;
+
+    // run work() on the calling thread and on up to helpers workers at once; false if a job was already running, and
+    //      then nothing was run
+    // ------------------------------------------------------------------------
+    template <typename F>
+    bool run(unsigned int helpers, F& work)
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (job)
+            return false;
+        while (threads.size() < helpers)
+            threads.emplace_back([this]() { loop(); });
+        job = &work;
+        call = [](void* w) { (*static_cast<F*>(w))(); };
+        wanted = helpers;
+        claimed = 0;
+        lock.unlock();
+        wake.notify_all();
+
+        work();
+
+        lock.lock();
+        // workers that haven't picked the job up by now would find nothing left to do
+        wanted = claimed;
+        done.wait(lock, [this]() { return running == 0; });
+        job = nullptr;
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable wake, done;
+    std::vector<std::thread> threads;
+    void* job = nullptr;
+    void (*call)(void*) = nullptr;
+    unsigned int wanted = 0, claimed = 0, running = 0;
+    bool stopping = false;
+
+    void loop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;)
+        {
+            wake.wait(lock, [this]() { return stopping || (job && claimed < wanted); });
+            if (stopping)
+                return;
+            claimed++;
+            running++;
+            void* w = job;
+            void (*c)(void*) = call;
+            lock.unlock();
+            c(w);
+            lock.lock();
+            if (--running == 0)
+                done.notify_all();
+        }
+    }
+};
+
+inline ImageDecodeWorkers& imageDecodeWorkers()
+{
+    static ImageDecodeWorkers workers;
+    return workers;
+}
+
+// run fn(i) for i in [0, count) on up to threads threads, the calling thread included
+template <typename F>
+inline void imageDecodeParallel(unsigned int threads, unsigned int count, F&& fn)
+{
+    threads = std::max(1u, std::min(threads, count));
+    std::atomic<unsigned int> next(0);
+    auto work = [&]()
+    {
+        for (unsigned int i = next++; i < count; i = next++)
+            fn(i);
+    };
+    if (threads == 1 || !imageDecodeWorkers().run(threads - 1, work))
+        work();
+}
+
+//// JPEG ////
+
+// natural order index of each zigzag position, padded so runs past the end of a corrupt block stay in bounds
+const uint8_t JPEG_DEZIGZAG[64 + 16] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63,
+    63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63, 63
+};
+
+const int JPEG_FAST_BITS = 9;
+
+struct JpegHuffman
+{
+    uint16_t fast[1 << JPEG_FAST_BITS];     // (length << 8) | symbol for codes up to JPEG_FAST_BITS long, 0 otherwise
+    int32_t maxCode[18];                    // largest code of each length, left-aligned to 16 bits; -1 if none
+    int32_t delta[17];                      // symbol index = code + delta[length]
+    int16_t fastAc[1 << JPEG_FAST_BITS];    // AC tables: (value << 8) | (run << 4) | total length, when code + value fit
+    uint8_t symbols[256];
+    bool defined = false;
+
+    // ------------------------------------------------------------------------
+    bool build(const uint8_t counts[16], const uint8_t* values, int total)
+    {
+        std::memset(fast, 0, sizeof(fast));
+        std::memcpy(symbols, values, (size_t)total);
+        int code = 0, k = 0;
+        for (int length = 1; length <= 16; length++)
+        {
+            delta[length] = k - code;
+            for (int i = 0; i < counts[length - 1]; i++, k++, code++)
+                if (length <= JPEG_FAST_BITS)
+                {
+                    int first = code << (JPEG_FAST_BITS - length);
+                    for (int f = 0; f < (1 << (JPEG_FAST_BITS - length)); f++)
+                        fast[first + f] = (uint16_t)((length << 8) | symbols[k]);
+                }
+            if (code > (1 << length))
+                return false;
+            maxCode[length] = counts[length - 1] ? (code << (16 - length)) - 1 : -1;
+            code <<= 1;
+        }
+        maxCode[17] = 0x7FFFFFFF;
+        // a short code followed by a small value decodes in one lookup
+        for (int i = 0; i < (1 << JPEG_FAST_BITS); i++)
+        {
+            fastAc[i] = 0;
+            int length = fast[i] >> 8;
+            int rs = fast[i] & 0xFF, run = rs >> 4, bits = rs & 15;
+            if (!fast[i] || !bits || length + bits > JPEG_FAST_BITS)
+                continue;
+            int value = ((i << length) & ((1 << JPEG_FAST_BITS) - 1)) >> (JPEG_FAST_BITS - bits);
+            if (value < (1 << (bits - 1)))
+                value += 1 - (1 << bits);
+            if (value >= -128 && value <= 127)
+                fastAc[i] = (int16_t)(value * 256 + run * 16 + length + bits);
+        }
+        defined = true;
+        return true;
+    }
+};
+
+// bit reader over one restart interval; past the end (or at a marker) it reads zeros like stb_image does.
+// decode(), peekFast() and receiveExtend() don't refill on their own: a Huffman code plus its value is at most 31 bits,
+// so one refill() per coefficient covers everything read for it
+class JpegBits
+{
+public:
+    JpegBits(const uint8_t* p, const uint8_t* end) : p(p), end(end) {}
+
+    // make sure at least 32 bits are buffered
+    // ------------------------------------------------------------------------
+    void refill()
+    {
+        if (bits < 32)
+            fill();
+    }
+    // ------------------------------------------------------------------------
+    int decode(const JpegHuffman& h)
+    {
+        unsigned int peek = (unsigned int)(buffer >> 48);
+        uint16_t f = h.fast[peek >> (16 - JPEG_FAST_BITS)];
+        if (f)
+        {
+            consume(f >> 8);
+            return f & 0xFF;
+        }
+        int length = JPEG_FAST_BITS + 1;
+        while ((int32_t)peek > h.maxCode[length])
+            length++;
+        if (length > 16)
+            return -1;
+        consume(length);
+        return h.symbols[((int)peek >> (16 - length)) + h.delta[length]];
+    }
+    // the next JPEG_FAST_BITS bits, without consuming them
+    // ------------------------------------------------------------------------
+    unsigned int peekFast()
+    {
+        return (unsigned int)(buffer >> (64 - JPEG_FAST_BITS));
+    }
+    // ------------------------------------------------------------------------
+    void consume(int n)
+    {
+        buffer <<= n;
+        bits -= n;
+    }
+    // receive s bits and sign-extend them (JPEG F.2.2.1)
+    // ------------------------------------------------------------------------
+    int receiveExtend(int s)
+    {
+        int v = (int)(buffer >> (64 - s));
+        consume(s);
+        return v < (1 << (s - 1)) ? v - (1 << s) + 1 : v;
+    }
+
+private:
+    const uint8_t* p;
+    const uint8_t* end;
+    uint64_t buffer = 0;    // left-aligned
+    int bits = 0;
+
+    void fill()
+    {
+        // whole bytes at once while none of the next eight is 0xFF
+        if (end - p >= 8)
+        {
+            uint64_t v;
+            std::memcpy(&v, p, 8);
+            uint64_t inverted = ~v;
+            if (!((inverted - 0x0101010101010101ull) & ~inverted & 0x8080808080808080ull))
+            {
+#ifdef _MSC_VER
+                uint64_t bigEndian = _byteswap_uint64(v);
+#else
+                uint64_t bigEndian = __builtin_bswap64(v);
+#endif
+                int n = (63 - bits) >> 3;
+                int shift = 64 - bits - 8 * n;
+                buffer |= (bigEndian >> bits) & ~((shift < 64 ? (1ull << shift) : 0ull) - 1);
+                p += n;
+                bits += 8 * n;
+                return;
+            }
+        }
+        while (bits <= 56)
+        {
+            unsigned int byte = 0;
+            if (p < end)
+            {
+                byte = *p;
+                if (byte == 0xFF)
+                {
+                    // stuffed zero byte, anything else is a marker and the end of the data
+                    if (p + 1 < end && p[1] == 0x00)
+                        p += 2;
+                    else
+                    {
+                        end = p;
+                        byte = 0;
+                    }
+                }
+                else
+                    p++;
+            }
+            buffer |= (uint64_t)byte << (56 - bits);
+            bits += 8;
+        }
+    }
+};
+
+struct JpegComponent
+{
+    int id = 0;
+    int h = 1, v = 1;
+    int tq = 0;
+    int td = 0, ta = 0;
+    int planeWidth = 0;     // padded to whole MCUs
+    int planeHeight = 0;
+    int width = 0;          // samples actually covering the image
+    int height = 0;
+    std::vector<uint8_t, ImageArenaAllocator<uint8_t>> plane;
+};
+
+class JpegDecoder
+{
+public:
+    // parse the headers; false means this isn't a JPEG we decode ourselves
+    // ------------------------------------------------------------------------
+    bool parse(const uint8_t* data, size_t size)
+    {
+        const uint8_t* p = data + 2;
+        const uint8_t* end = data + size;
+        bool frame = false;
+        while (p + 4 <= end)
+        {
+            if (p[0] != 0xFF)
+                return false;
+            uint8_t marker = p[1];
+            if (marker == 0xFF)
+            {
+                p++;
+                continue;
+            }
+            size_t length = (size_t)(p[2] << 8 | p[3]);
+            const uint8_t* s = p + 4;
+            if (length < 2 || s + length - 2 > end)
+                return false;
+            const uint8_t* segmentEnd = p + 2 + length;
+            switch (marker)
+            {
+            case 0xC0: case 0xC1:   // baseline / extended sequential, Huffman
+                if (!parseFrame(s, segmentEnd))
+                    return false;
+                frame = true;
+                break;
+            case 0xC4:
+                while (s + 17 <= segmentEnd)
+                {
+                    int tc = s[0] >> 4, th = s[0] & 15;
+                    int total = 0;
+                    for (int i = 0; i < 16; i++)
+                        total += s[1 + i];
+                    if (tc > 1 || th > 3 || total > 256 || s + 17 + total > segmentEnd)
+                        return false;
+                    if (!(tc ? ac[th] : dc[th]).build(s + 1, s + 17, total))
+                        return false;
+                    s += 17 + total;
+                }
+                break;
+            case 0xDB:
+                while (s < segmentEnd)
+                {
+                    int pq = s[0] >> 4, tq = s[0] & 15;
+                    if (pq > 1 || tq > 3 || s + 1 + 64 * (pq + 1) > segmentEnd)
+                        return false;
+                    for (int i = 0; i < 64; i++)
+                        dequant[tq][JPEG_DEZIGZAG[i]] = (uint16_t)(pq ? (s[1 + 2 * i] << 8 | s[2 + 2 * i]) : s[1 + i]);
+                    s += 1 + 64 * (pq + 1);
+                }
+                break;
+            case 0xDD:
+                restartInterval = s[0] << 8 | s[1];
+                break;
+            case 0xE0:
+                jfif = jfif || (length >= 7 && std::memcmp(s, "JFIF", 5) == 0);
+                break;
+            case 0xEE:      // Adobe: transform 0 means the components aren't YCbCr
+                if (length >= 14 && std::memcmp(s, "Adobe", 5) == 0)
+                    adobeTransform = s[11];
+                break;
+            case 0xDA:
+                // 3 components without a YCbCr transform are RGB, which stb_image handles
+                if (components.size() == 3 && adobeTransform == 0 && !jfif)
+                    return false;
+                return frame && parseScan(s, segmentEnd, end);
+            default:
+                // progressive, lossless, arithmetic coding and hierarchical frames go to stb_image
+                if ((marker >= 0xC2 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC) || marker == 0xDE)
+                    return false;
+                break;
+            }
+            p = segmentEnd;
+        }
+        return false;
+    }
+    // false if the entropy-coded data is corrupt
+    // ------------------------------------------------------------------------
+    bool decode(DecodedImage& image, bool flip, unsigned int threads)
+    {
+        for (JpegComponent& c : components)
+            c.plane.assign((size_t)c.planeWidth * c.planeHeight, 0);
+
+        // intervals between restart markers decode independently: DC prediction and the bit stream restart with each
+        std::vector<const uint8_t*> intervals(1, scan);
+        if (restartInterval)
+            for (const uint8_t* p = scan; (p = (const uint8_t*)std::memchr(p, 0xFF, (size_t)(scanEnd - p))) != NULL && p + 1 < scanEnd; p++)
+                if (p[1] >= 0xD0 && p[1] <= 0xD7)
+                    intervals.push_back(p + 2);
+        intervals.push_back(scanEnd);
+        unsigned int intervalCount = (unsigned int)intervals.size() - 1;
+        int mcus = mcusX * mcusY;
+        int perInterval = restartInterval ? restartInterval : mcus;
+        std::atomic<bool> corrupt(false);
+        imageDecodeParallel(threads, intervalCount, [&](unsigned int i)
+        {
+            int first = (int)i * perInterval;
+            if (first < mcus && !decodeInterval(intervals[i], intervals[i + 1], first, std::min(mcus, first + perInterval)))
+                corrupt = true;
+        });
+        if (corrupt)
+            return false;
+
+        image.width = width;
+        image.height = height;
+        image.channels = components.size() >= 3 ? 3 : 1;
+        image.pixels.resize((size_t)width * height * image.channels);
+        int rowsPerBand = 32;
+        unsigned int bands = (unsigned int)((height + rowsPerBand - 1) / rowsPerBand);
+        std::vector<int> nearRow, farRow;
+        resampleRows(nearRow, farRow);
+        imageDecodeParallel(threads, bands, [&](unsigned int band)
+        {
+            std::vector<uint8_t> lines[3];
+            for (int y = (int)band * rowsPerBand; y < std::min(height, (int)(band + 1) * rowsPerBand); y++)
+            {
+                uint8_t* out = image.pixels.data() + (size_t)(flip ? height - 1 - y : y) * width * image.channels;
+                if (image.channels == 1)
+                {
+                    std::memcpy(out, components[0].plane.data() + (size_t)y * components[0].planeWidth, (size_t)width);
+                    continue;
+                }
+                const uint8_t* rows[3];
+                for (int k = 0; k < 3; k++)
+                    rows[k] = resampleRow(k, y, nearRow, farRow, lines[k]);
+                ycbcrToRgb(out, rows[0], rows[1], rows[2], width);
+            }
+        });
+        return true;
+    }
+
+    int width = 0, height = 0;
+
+private:
+    JpegHuffman dc[4], ac[4];
+    uint16_t dequant[4][64] = {};
+    std::vector<JpegComponent> components;
+    int hMax = 1, vMax = 1;
+    int mcusX = 0, mcusY = 0;
+    int restartInterval = 0;
+    int adobeTransform = -1;
+    bool jfif = false;
+    const uint8_t* scan = NULL;
+    const uint8_t* scanEnd = NULL;
+
+    bool parseFrame(const uint8_t* s, const uint8_t* end)
+    {
+        if (end - s < 6 || s[0] != 8)
+            return false;
+        height = s[1] << 8 | s[2];
+        width = s[3] << 8 | s[4];
+        int count = s[5];
+        if (!width || !height || (count != 1 && count != 3) || end - s < 6 + 3 * count)
+            return false;
+        components.resize(count);
+        for (int i = 0; i < count; i++)
+        {
+            JpegComponent& c = components[i];
+            c.id = s[6 + 3 * i];
+            c.h = s[7 + 3 * i] >> 4;
+            c.v = s[7 + 3 * i] & 15;
+            c.tq = s[8 + 3 * i];
+            if (c.h < 1 || c.h > 4 || c.v < 1 || c.v > 4 || c.tq > 3)
+                return false;
+        }
+        // ids 'R','G','B' mark an RGB JPEG, which stb_image handles
+        if (count == 3 && components[0].id == 'R' && components[1].id == 'G' && components[2].id == 'B')
+            return false;
+        // a single component is never interleaved, its MCU is one block whatever the sampling factors say
+        if (count == 1)
+            components[0].h = components[0].v = 1;
+        for (const JpegComponent& c : components)
+        {
+            hMax = std::max(hMax, c.h);
+            vMax = std::max(vMax, c.v);
+        }
+        mcusX = (width + 8 * hMax - 1) / (8 * hMax);
+        mcusY = (height + 8 * vMax - 1) / (8 * vMax);
+        for (JpegComponent& c : components)
+        {
+            c.planeWidth = mcusX * c.h * 8;
+            c.planeHeight = mcusY * c.v * 8;
+            c.width = (width * c.h + hMax - 1) / hMax;
+            c.height = (height * c.v + vMax - 1) / vMax;
+        }
+        return true;
+    }
+    bool parseScan(const uint8_t* s, const uint8_t* segmentEnd, const uint8_t* end)
+    {
+        int count = s[0];
+        // every component in one interleaved scan; anything else is a multi-scan file
+        if (count != (int)components.size() || segmentEnd - s < 1 + 2 * count + 3)
+            return false;
+        for (int i = 0; i < count; i++)
+        {
+            JpegComponent& c = components[i];
+            if (s[1 + 2 * i] != c.id)
+                return false;
+            c.td = s[2 + 2 * i] >> 4;
+            c.ta = s[2 + 2 * i] & 15;
+            if (c.td > 3 || c.ta > 3 || !dc[c.td].defined || !ac[c.ta].defined)
+                return false;
+        }
+        scan = segmentEnd;
+        // the scan runs to the first marker that isn't a restart marker
+        scanEnd = end;
+        for (const uint8_t* p = scan; (p = (const uint8_t*)std::memchr(p, 0xFF, (size_t)(end - p))) != NULL && p + 1 < end; p++)
+            if (p[1] != 0x00 && p[1] != 0xFF && !(p[1] >= 0xD0 && p[1] <= 0xD7))
+            {
+                scanEnd = p;
+                break;
+            }
+        return true;
+    }
+    // Huffman decode and IDCT the MCUs [first, last) of one restart interval
+    bool decodeInterval(const uint8_t* begin, const uint8_t* end, int first, int last)
+    {
+        JpegBits bits(begin, end);
+        int predictions[3] = {};
+        alignas(16) short block[64];
+        for (int mcu = first; mcu < last; mcu++)
+        {
+            int mx = mcu % mcusX, my = mcu / mcusX;
+            for (size_t k = 0; k < components.size(); k++)
+            {
+                JpegComponent& c = components[k];
+                for (int by = 0; by < c.v; by++)
+                    for (int bx = 0; bx < c.h; bx++)
+                    {
+                        if (!decodeBlock(bits, block, c, predictions[k]))
+                            return false;
+                        uint8_t* out = c.plane.data() + (size_t)((my * c.v + by) * 8) * c.planeWidth + (mx * c.h + bx) * 8;
+                        idct(out, c.planeWidth, block);
+                    }
+            }
+        }
+        return true;
+    }
+    bool decodeBlock(JpegBits& bits, short block[64], const JpegComponent& c, int& prediction)
+    {
+        const uint16_t* q = dequant[c.tq];
+        std::memset(block, 0, 64 * sizeof(short));
+        bits.refill();
+        int t = bits.decode(dc[c.td]);
+        if (t < 0 || t > 15)
+            return false;
+        // corrupt DC deltas would overflow the prediction or the dequantized coefficient; stb_image rejects those too
+        long long dcValue = (long long)prediction + (t ? bits.receiveExtend(t) : 0);
+        if (dcValue * q[0] < -32768 || dcValue * q[0] > 32767)
+            return false;
+        prediction = (int)dcValue;
+        block[0] = (short)(prediction * q[0]);
+        const JpegHuffman& h = ac[c.ta];
+        for (int k = 1; k < 64;)
+        {
+            bits.refill();
+            if (int fast = h.fastAc[bits.peekFast()])
+            {
+                bits.consume(fast & 15);
+                k += (fast >> 4) & 15;
+                int zig = JPEG_DEZIGZAG[k++];
+                block[zig] = (short)((fast >> 8) * q[zig]);
+                continue;
+            }
+            int rs = bits.decode(h);
+            if (rs < 0)
+                return false;
+            int s = rs & 15, r = rs >> 4;
+            if (s == 0)
+            {
+                if (rs != 0xF0)
+                    break;
+                k += 16;
+                continue;
+            }
+            k += r;
+            int zig = JPEG_DEZIGZAG[k++];
+            block[zig] = (short)(bits.receiveExtend(s) * q[zig]);
+        }
+        return true;
+    }
+
+    static uint8_t clamp(int x)
+    {
+        return (unsigned int)x > 255 ? (x < 0 ? 0 : 255) : (uint8_t)x;
+    }
+    // stb_image's integer IDCT (jidctint, DCT_ISLOW), so results match it exactly
+    static void idct(uint8_t* out, int stride, const short* d)
+    {
+#ifdef IMAGE_DECODE_SSE2
+        idctSse2(out, stride, d);
+#else
+        idctScalar(out, stride, d);
+#endif
+    }
+    static void idctScalar(uint8_t* out, int stride, const short* d)
+    {
+#define JPEG_F2F(x) ((int)((x) * 4096 + 0.5))
+#define JPEG_IDCT_1D(s0, s1, s2, s3, s4, s5, s6, s7) \
+        int t0, t1, t2, t3, p1, p2, p3, p4, p5, x0, x1, x2, x3; \
+        p2 = s2; p3 = s6; \
+        p1 = (p2 + p3) * JPEG_F2F(0.5411961f); \
+        t2 = p1 + p3 * JPEG_F2F(-1.847759065f); \
+        t3 = p1 + p2 * JPEG_F2F(0.765366865f); \
+        p2 = s0; p3 = s4; \
+        t0 = (p2 + p3) * 4096; t1 = (p2 - p3) * 4096; \
+        x0 = t0 + t3; x3 = t0 - t3; x1 = t1 + t2; x2 = t1 - t2; \
+        t0 = s7; t1 = s5; t2 = s3; t3 = s1; \
+        p3 = t0 + t2; p4 = t1 + t3; p1 = t0 + t3; p2 = t1 + t2; \
+        p5 = (p3 + p4) * JPEG_F2F(1.175875602f); \
+        t0 = t0 * JPEG_F2F(0.298631336f); t1 = t1 * JPEG_F2F(2.053119869f); \
+        t2 = t2 * JPEG_F2F(3.072711026f); t3 = t3 * JPEG_F2F(1.501321110f); \
+        p1 = p5 + p1 * JPEG_F2F(-0.899976223f); p2 = p5 + p2 * JPEG_F2F(-2.562915447f); \
+        p3 = p3 * JPEG_F2F(-1.961570560f); p4 = p4 * JPEG_F2F(-0.390180644f); \
+        t3 += p1 + p4; t2 += p2 + p3; t1 += p2 + p4; t0 += p1 + p3;
+
+        int val[64];
+        for (int i = 0; i < 8; i++)
+        {
+            const short* c = d + i;
+            int* v = val + i;
+            if (c[8] == 0 && c[16] == 0 && c[24] == 0 && c[32] == 0 && c[40] == 0 && c[48] == 0 && c[56] == 0)
+            {
+                int dcterm = c[0] * 4;
+                v[0] = v[8] = v[16] = v[24] = v[32] = v[40] = v[48] = v[56] = dcterm;
+                continue;
+            }
+            JPEG_IDCT_1D(c[0], c[8], c[16], c[24], c[32], c[40], c[48], c[56])
+            x0 += 512; x1 += 512; x2 += 512; x3 += 512;
+            v[0] = (x0 + t3) >> 10;
+            v[56] = (x0 - t3) >> 10;
+            v[8] = (x1 + t2) >> 10;
+            v[48] = (x1 - t2) >> 10;
+            v[16] = (x2 + t1) >> 10;
+            v[40] = (x2 - t1) >> 10;
+            v[24] = (x3 + t0) >> 10;
+            v[32] = (x3 - t0) >> 10;
+        }
+        for (int i = 0; i < 8; i++, out += stride)
+        {
+            const int* v = val + i * 8;
+            JPEG_IDCT_1D(v[0], v[1], v[2], v[3], v[4], v[5], v[6], v[7])
+            x0 += 65536 + (128 << 17);
+            x1 += 65536 + (128 << 17);
+            x2 += 65536 + (128 << 17);
+            x3 += 65536 + (128 << 17);
+            out[0] = clamp((x0 + t3) >> 17);
+            out[7] = clamp((x0 - t3) >> 17);
+            out[1] = clamp((x1 + t2) >> 17);
+            out[6] = clamp((x1 - t2) >> 17);
+            out[2] = clamp((x2 + t1) >> 17);
+            out[5] = clamp((x2 - t1) >> 17);
+            out[3] = clamp((x3 + t0) >> 17);
+            out[4] = clamp((x3 - t0) >> 17);
+        }
+#undef JPEG_IDCT_1D
+#undef JPEG_F2F
+    }
+#ifdef IMAGE_DECODE_SSE2
+    // the same IDCT eight columns (then rows) at a time: products in 32 bits through madd on interleaved 16-bit
+    //      pairs, a 16-bit transpose between the passes and an 8-bit one on the way out
+    struct Wide
+    {
+        __m128i lo, hi;
+    };
+    static Wide idctRotate(__m128i x, __m128i y, __m128i c)
+    {
+        return { _mm_madd_epi16(_mm_unpacklo_epi16(x, y), c), _mm_madd_epi16(_mm_unpackhi_epi16(x, y), c) };
+    }
+    static Wide idctWiden(__m128i x)   // x << 12
+    {
+        return { _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), x), 4), _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), x), 4) };
+    }
+    static Wide idctAdd(Wide a, Wide b)
+    {
+        return { _mm_add_epi32(a.lo, b.lo), _mm_add_epi32(a.hi, b.hi) };
+    }
+    static Wide idctSub(Wide a, Wide b)
+    {
+        return { _mm_sub_epi32(a.lo, b.lo), _mm_sub_epi32(a.hi, b.hi) };
+    }
+    template <int Shift>
+    static void idctButterfly(__m128i& out0, __m128i& out1, Wide a, Wide b, __m128i bias)
+    {
+        a = { _mm_add_epi32(a.lo, bias), _mm_add_epi32(a.hi, bias) };
+        Wide sum = idctAdd(a, b), difference = idctSub(a, b);
+        out0 = _mm_packs_epi32(_mm_srai_epi32(sum.lo, Shift), _mm_srai_epi32(sum.hi, Shift));
+        out1 = _mm_packs_epi32(_mm_srai_epi32(difference.lo, Shift), _mm_srai_epi32(difference.hi, Shift));
+    }
+    template <int Shift>
+    static void idctPass(__m128i r[8], __m128i bias)
+    {
+        auto pair = [](int x, int y) { return _mm_setr_epi16((short)x, (short)y, (short)x, (short)y, (short)x, (short)y, (short)x, (short)y); };
+        auto f2f = [](float x) { return (int)(x * 4096 + 0.5); };
+        // even part
+        Wide t2 = idctRotate(r[2], r[6], pair(f2f(0.5411961f), f2f(0.5411961f) + f2f(-1.847759065f)));
+        Wide t3 = idctRotate(r[2], r[6], pair(f2f(0.5411961f) + f2f(0.765366865f), f2f(0.5411961f)));
+        Wide t0 = idctWiden(_mm_add_epi16(r[0], r[4]));
+        Wide t1 = idctWiden(_mm_sub_epi16(r[0], r[4]));
+        Wide x0 = idctAdd(t0, t3), x3 = idctSub(t0, t3), x1 = idctAdd(t1, t2), x2 = idctSub(t1, t2);
+        // odd part
+        Wide y0 = idctRotate(r[7], r[3], pair(f2f(-1.961570560f) + f2f(0.298631336f), f2f(-1.961570560f)));
+        Wide y2 = idctRotate(r[7], r[3], pair(f2f(-1.961570560f), f2f(-1.961570560f) + f2f(3.072711026f)));
+        Wide y1 = idctRotate(r[5], r[1], pair(f2f(-0.390180644f) + f2f(2.053119869f), f2f(-0.390180644f)));
+        Wide y3 = idctRotate(r[5], r[1], pair(f2f(-0.390180644f), f2f(-0.390180644f) + f2f(1.501321110f)));
+        __m128i sum17 = _mm_add_epi16(r[1], r[7]), sum35 = _mm_add_epi16(r[3], r[5]);
+        Wide y4 = idctRotate(sum17, sum35, pair(f2f(1.175875602f) + f2f(-0.899976223f), f2f(1.175875602f)));
+        Wide y5 = idctRotate(sum17, sum35, pair(f2f(1.175875602f), f2f(1.175875602f) + f2f(-2.562915447f)));
+        Wide x4 = idctAdd(y0, y4), x5 = idctAdd(y1, y5), x6 = idctAdd(y2, y5), x7 = idctAdd(y3, y4);
+        idctButterfly<Shift>(r[0], r[7], x0, x7, bias);
+        idctButterfly<Shift>(r[1], r[6], x1, x6, bias);
+        idctButterfly<Shift>(r[2], r[5], x2, x5, bias);
+        idctButterfly<Shift>(r[3], r[4], x3, x4, bias);
+    }
+    static void idctInterleave16(__m128i& a, __m128i& b)
+    {
+        __m128i t = a;
+        a = _mm_unpacklo_epi16(a, b);
+        b = _mm_unpackhi_epi16(t, b);
+    }
+    static void idctInterleave8(__m128i& a, __m128i& b)
+    {
+        __m128i t = a;
+        a = _mm_unpacklo_epi8(a, b);
+        b = _mm_unpackhi_epi8(t, b);
+    }
+    static void idctSse2(uint8_t* out, int stride, const short* d)
+    {
+        __m128i r[8];
+        for (int i = 0; i < 8; i++)
+            r[i] = _mm_load_si128((const __m128i*)(d + i * 8));
+        idctPass<10>(r, _mm_set1_epi32(512));
+        idctInterleave16(r[0], r[4]); idctInterleave16(r[1], r[5]); idctInterleave16(r[2], r[6]); idctInterleave16(r[3], r[7]);
+        idctInterleave16(r[0], r[2]); idctInterleave16(r[1], r[3]); idctInterleave16(r[4], r[6]); idctInterleave16(r[5], r[7]);
+        idctInterleave16(r[0], r[1]); idctInterleave16(r[2], r[3]); idctInterleave16(r[4], r[5]); idctInterleave16(r[6], r[7]);
+        idctPass<17>(r, _mm_set1_epi32(65536 + (128 << 17)));
+        __m128i p0 = _mm_packus_epi16(r[0], r[1]), p1 = _mm_packus_epi16(r[2], r[3]);
+        __m128i p2 = _mm_packus_epi16(r[4], r[5]), p3 = _mm_packus_epi16(r[6], r[7]);
+        idctInterleave8(p0, p2); idctInterleave8(p1, p3);
+        idctInterleave8(p0, p1); idctInterleave8(p2, p3);
+        idctInterleave8(p0, p2); idctInterleave8(p1, p3);
+        __m128i rows[4] = { p0, p2, p1, p3 };
+        for (int i = 0; i < 4; i++)
+        {
+            _mm_storel_epi64((__m128i*)(out + (2 * i) * stride), rows[i]);
+            _mm_storel_epi64((__m128i*)(out + (2 * i + 1) * stride), _mm_shuffle_epi32(rows[i], 0x4e));
+        }
+    }
+#endif
+
+    // which two component rows feed output row y, following stb_image's line stepping
+    void resampleRows(std::vector<int>& nearRow, std::vector<int>& farRow) const
+    {
+        nearRow.assign((size_t)height * components.size(), 0);
+        farRow.assign((size_t)height * components.size(), 0);
+        for (size_t k = 0; k < components.size(); k++)
+        {
+            int vs = vMax / components[k].v;
+            int ystep = vs >> 1, ypos = 0, line0 = 0, line1 = 0;
+            for (int y = 0; y < height; y++)
+            {
+                bool bottom = ystep >= (vs >> 1);
+                nearRow[(size_t)y * components.size() + k] = bottom ? line1 : line0;
+                farRow[(size_t)y * components.size() + k] = bottom ? line0 : line1;
+                if (++ystep >= vs)
+                {
+                    ystep = 0;
+                    line0 = line1;
+                    if (++ypos < components[k].height)
+                        line1++;
+                }
+            }
+        }
+    }
+    // one full-resolution row of component k, upsampled with stb_image's filters
+    const uint8_t* resampleRow(int k, int y, const std::vector<int>& nearRow, const std::vector<int>& farRow, std::vector<uint8_t>& line) const
+    {
+        const JpegComponent& c = components[k];
+        int hs = hMax / c.h, vs = vMax / c.v;
+        const uint8_t* inNear = c.plane.data() + (size_t)nearRow[(size_t)y * components.size() + k] * c.planeWidth;
+        const uint8_t* inFar = c.plane.data() + (size_t)farRow[(size_t)y * components.size() + k] * c.planeWidth;
+        if (hs == 1 && vs == 1)
+            return inNear;
+        int w = (width + hs - 1) / hs;
+        line.resize((size_t)width + 3);
+        uint8_t* out = line.data();
+        if (hs == 1 && vs == 2)
+        {
+            for (int i = 0; i < w; i++)
+                out[i] = (uint8_t)((3 * inNear[i] + inFar[i] + 2) >> 2);
+        }
+        else if (hs == 2 && vs == 1)
+        {
+            if (w == 1)
+                out[0] = out[1] = inNear[0];
+            else
+            {
+                out[0] = inNear[0];
+                out[1] = (uint8_t)((inNear[0] * 3 + inNear[1] + 2) >> 2);
+                int i;
+                for (i = 1; i < w - 1; i++)
+                {
+                    int n = 3 * inNear[i] + 2;
+                    out[i * 2] = (uint8_t)((n + inNear[i - 1]) >> 2);
+                    out[i * 2 + 1] = (uint8_t)((n + inNear[i + 1]) >> 2);
+                }
+                out[i * 2] = (uint8_t)((inNear[w - 2] * 3 + inNear[w - 1] + 2) >> 2);
+                out[i * 2 + 1] = inNear[w - 1];
+            }
+        }
+        else if (hs == 2 && vs == 2)
+        {
+            if (w == 1)
+                out[0] = out[1] = (uint8_t)((3 * inNear[0] + inFar[0] + 2) >> 2);
+            else
+            {
+                int t1 = 3 * inNear[0] + inFar[0];
+                out[0] = (uint8_t)((t1 + 2) >> 2);
+                for (int i = 1; i < w; i++)
+                {
+                    int t0 = t1;
+                    t1 = 3 * inNear[i] + inFar[i];
+                    out[i * 2 - 1] = (uint8_t)((3 * t0 + t1 + 8) >> 4);
+                    out[i * 2] = (uint8_t)((3 * t1 + t0 + 8) >> 4);
+                }
+                out[w * 2 - 1] = (uint8_t)((t1 + 2) >> 2);
+            }
+        }
+        else
+        {
+            for (int i = 0; i < w; i++)
+                for (int j = 0; j < hs; j++)
+                    out[i * hs + j] = inNear[i];
+        }
+        return out;
+    }
+    // stb_image's reduced-precision fixed point conversion
+    static void ycbcrToRgb(uint8_t* out, const uint8_t* y, const uint8_t* pcb, const uint8_t* pcr, int count)
+    {
+        int i = 0;
+#ifdef IMAGE_DECODE_SSE2
+        // eight pixels at a time in 16-bit lanes (stb_image's SIMD kernel, which matches the scalar one exactly)
+        const __m128i signFlip = _mm_set1_epi8(-0x80);
+        const __m128i cr0 = _mm_set1_epi16((short)(1.40200f * 4096.0f + 0.5f));
+        const __m128i cr1 = _mm_set1_epi16(-(short)(0.71414f * 4096.0f + 0.5f));
+        const __m128i cb0 = _mm_set1_epi16(-(short)(0.34414f * 4096.0f + 0.5f));
+        const __m128i cb1 = _mm_set1_epi16((short)(1.77200f * 4096.0f + 0.5f));
+        const __m128i yBias = _mm_set1_epi8((char)(unsigned char)128);
+        alignas(16) uint8_t rgb[3][16];
+        for (; i + 8 <= count; i += 8, out += 24)
+        {
+            __m128i yw = _mm_unpacklo_epi8(yBias, _mm_loadl_epi64((const __m128i*)(y + i)));
+            __m128i crw = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_xor_si128(_mm_loadl_epi64((const __m128i*)(pcr + i)), signFlip));
+            __m128i cbw = _mm_unpacklo_epi8(_mm_setzero_si128(), _mm_xor_si128(_mm_loadl_epi64((const __m128i*)(pcb + i)), signFlip));
+            __m128i ys = _mm_srli_epi16(yw, 4);
+            __m128i r = _mm_srai_epi16(_mm_add_epi16(_mm_mulhi_epi16(cr0, crw), ys), 4);
+            __m128i g = _mm_srai_epi16(_mm_add_epi16(_mm_add_epi16(_mm_mulhi_epi16(cb0, cbw), ys), _mm_mulhi_epi16(crw, cr1)), 4);
+            __m128i b = _mm_srai_epi16(_mm_add_epi16(ys, _mm_mulhi_epi16(cbw, cb1)), 4);
+            _mm_store_si128((__m128i*)rgb[0], _mm_packus_epi16(r, r));
+            _mm_store_si128((__m128i*)rgb[1], _mm_packus_epi16(g, g));
+            _mm_store_si128((__m128i*)rgb[2], _mm_packus_epi16(b, b));
+            for (int k = 0; k < 8; k++)
+            {
+                out[k * 3 + 0] = rgb[0][k];
+                out[k * 3 + 1] = rgb[1][k];
+                out[k * 3 + 2] = rgb[2][k];
+            }
+        }
+#endif
+#define JPEG_FLOAT2FIXED(x) (((int)((x) * 4096.0f + 0.5f)) << 8)
+        for (; i < count; i++, out += 3)
+        {
+            int yFixed = (y[i] << 20) + (1 << 19);
+            int cr = pcr[i] - 128;
+            int cb = pcb[i] - 128;
+            int r = yFixed + cr * JPEG_FLOAT2FIXED(1.40200f);
+            int g = yFixed + (cr * -JPEG_FLOAT2FIXED(0.71414f)) + ((cb * -JPEG_FLOAT2FIXED(0.34414f)) & 0xffff0000);
+            int b = yFixed + cb * JPEG_FLOAT2FIXED(1.77200f);
+            out[0] = clamp(r >> 20);
+            out[1] = clamp(g >> 20);
+            out[2] = clamp(b >> 20);
+        }
+#undef JPEG_FLOAT2FIXED
+    }
+};
+
+//// PNG ////
+
+inline uint32_t pngRead32(const uint8_t* p)
+{
+    return (uint32_t)p[0] << 24 | (uint32_t)p[1] << 16 | (uint32_t)p[2] << 8 | p[3];
+}
+
+// undo one row's filter; prior is the previous unfiltered row (zeros for the first), bpp is bytes per pixel
+inline bool pngUnfilterRow(uint8_t* out, const uint8_t* raw, const uint8_t* prior, int filter, size_t length, int bpp)
+{
+    size_t i = 0;
+    switch (filter)
+    {
+    case 0:
+        std::memcpy(out, raw, length);
+        return true;
+    case 1:     // Sub
+#ifdef IMAGE_DECODE_SSE2
+        if (bpp == 3 || bpp == 4)
+        {
+            __m128i a = _mm_setzero_si128();
+            for (; i + 4 <= length; i += bpp)
+            {
+                int x;
+                std::memcpy(&x, raw + i, 4);
+                a = _mm_add_epi8(a, _mm_cvtsi32_si128(x));
+                x = _mm_cvtsi128_si32(a);
+                std::memcpy(out + i, &x, (size_t)bpp);
+            }
+        }
+#endif
+        for (; i < length; i++)
+            out[i] = (uint8_t)(raw[i] + (i >= (size_t)bpp ? out[i - bpp] : 0));
+        return true;
+    case 2:     // Up
+#ifdef IMAGE_DECODE_SSE2
+        for (; i + 16 <= length; i += 16)
+            _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(_mm_loadu_si128((const __m128i*)(raw + i)), _mm_loadu_si128((const __m128i*)(prior + i))));
+#endif
+        for (; i < length; i++)
+            out[i] = (uint8_t)(raw[i] + prior[i]);
+        return true;
+    case 3:     // Average
+#ifdef IMAGE_DECODE_SSE2
+        if (bpp == 3 || bpp == 4)
+        {
+            // floor((a + b) / 2) = avg_epu8 (which rounds up) minus the bit it rounded
+            const __m128i one = _mm_set1_epi8(1);
+            __m128i a = _mm_setzero_si128();
+            for (; i + 4 <= length; i += bpp)
+            {
+                int x, y;
+                std::memcpy(&x, raw + i, 4);
+                std::memcpy(&y, prior + i, 4);
+                __m128i b = _mm_cvtsi32_si128(y);
+                __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+                a = _mm_add_epi8(avg, _mm_cvtsi32_si128(x));
+                x = _mm_cvtsi128_si32(a);
+                std::memcpy(out + i, &x, (size_t)bpp);
+            }
+        }
+#endif
+        for (; i < length; i++)
+            out[i] = (uint8_t)(raw[i] + (((i >= (size_t)bpp ? out[i - bpp] : 0) + prior[i]) >> 1));
+        return true;
+    case 4:     // Paeth
+#ifdef IMAGE_DECODE_SSE2
+        if (bpp == 3 || bpp == 4)
+        {
+            // predictor in 16-bit lanes: pick a if |b-c| <= |a-c| and <= |a+b-2c|, else b if |a-c| <= |a+b-2c|, else c
+            const __m128i zero = _mm_setzero_si128();
+            __m128i a = zero, c = zero;
+            for (; i + 4 <= length; i += bpp)
+            {
+                int x, y;
+                std::memcpy(&x, raw + i, 4);
+                std::memcpy(&y, prior + i, 4);
+                __m128i b = _mm_unpacklo_epi8(_mm_cvtsi32_si128(y), zero);
+                __m128i pa = _mm_sub_epi16(b, c);
+                __m128i pb = _mm_sub_epi16(a, c);
+                __m128i pc = _mm_add_epi16(pa, pb);
+                pa = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+                pb = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+                pc = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+                __m128i useA = _mm_and_si128(_mm_cmpgt_epi16(_mm_add_epi16(pb, _mm_set1_epi16(1)), pa), _mm_cmpgt_epi16(_mm_add_epi16(pc, _mm_set1_epi16(1)), pa));
+                __m128i useB = _mm_cmpgt_epi16(_mm_add_epi16(pc, _mm_set1_epi16(1)), pb);
+                __m128i predictor = _mm_or_si128(_mm_and_si128(useB, b), _mm_andnot_si128(useB, c));
+                predictor = _mm_or_si128(_mm_and_si128(useA, a), _mm_andnot_si128(useA, predictor));
+                a = _mm_and_si128(_mm_add_epi16(predictor, _mm_unpacklo_epi8(_mm_cvtsi32_si128(x), zero)), _mm_set1_epi16(0xFF));
+                c = b;
+                x = _mm_cvtsi128_si32(_mm_packus_epi16(a, a));
+                std::memcpy(out + i, &x, (size_t)bpp);
+            }
+        }
+#endif
+        for (; i < length; i++)
+        {
+            int a = i >= (size_t)bpp ? out[i - bpp] : 0;
+            int b = prior[i];
+            int c = i >= (size_t)bpp ? prior[i - bpp] : 0;
+            int pa = std::abs(b - c), pb = std::abs(a - c), pc = std::abs(a + b - 2 * c);
+            int predictor = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+            out[i] = (uint8_t)(raw[i] + predictor);
+        }
+        return true;
+    }
+    return false;
+}
+
+// 8-bit, non-interlaced PNGs; false for anything stb_image should handle
+inline bool decodePng(const uint8_t* data, size_t size, DecodedImage& image, bool flip)
+{
+    static const uint8_t signature[8] = { 137, 80, 78, 71, 13, 10, 26, 10 };
+    if (size < 8 || std::memcmp(data, signature, 8) != 0)
+        return false;
+    uint32_t width = 0, height = 0;
+    int colorType = -1;
+    uint8_t palette[256 * 4] = {};
+    bool hasPalette = false, transparency = false;
+    std::vector<uint8_t, ImageArenaAllocator<uint8_t>> idat;
+    bool ended = false;
+    for (const uint8_t* p = data + 8; p + 12 <= data + size && !ended;)
+    {
+        uint32_t length = pngRead32(p);
+        const uint8_t* chunk = p + 8;
+        if (length > (size_t)(data + size - chunk) - 4)
+            return false;
+        uint32_t type = pngRead32(p + 4);
+        switch (type)
+        {
+        case 0x49484452:    // IHDR
+            if (length < 13)
+                return false;
+            width = pngRead32(chunk);
+            height = pngRead32(chunk + 4);
+            colorType = chunk[9];
+            if (chunk[8] != 8 || chunk[10] || chunk[11] || chunk[12] || colorType == 1 || colorType == 5 || colorType > 6)
+                return false;
+            if (!width || !height || width > (1u << 24) || height > (1u << 24))
+                return false;
+            break;
+        case 0x504C5445:    // PLTE
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                bool present = i * 3 + 2 < length;
+                palette[i * 4 + 0] = present ? chunk[i * 3 + 0] : 0;
+                palette[i * 4 + 1] = present ? chunk[i * 3 + 1] : 0;
+                palette[i * 4 + 2] = present ? chunk[i * 3 + 2] : 0;
+                palette[i * 4 + 3] = 255;
+            }
+            hasPalette = true;
+            break;
+        case 0x74524E53:    // tRNS: alpha for palette entries; on gray/RGB images stb_image adds an alpha channel
+            if (colorType != 3)
+                return false;
+            for (uint32_t i = 0; i < length && i < 256; i++)
+                palette[i * 4 + 3] = chunk[i];
+            transparency = true;
+            break;
+        case 0x43674249:    // CgBI: Apple's PNG variant
+            return false;
+        case 0x49444154:    // IDAT
+            idat.insert(idat.end(), chunk, chunk + length);
+            break;
+        case 0x49454E44:    // IEND
+            ended = true;
+            break;
+        }
+        p = chunk + length + 4;
+    }
+    if (colorType < 0 || idat.empty() || (colorType == 3 && !hasPalette))
+        return false;
+
+    int fileChannels = colorType == 0 ? 1 : colorType == 2 ? 3 : colorType == 3 ? 1 : colorType == 4 ? 2 : 4;
+    int channels = colorType == 3 ? (transparency ? 4 : 3) : fileChannels;
+    size_t rowBytes = (size_t)width * fileChannels;
+    size_t expected = (rowBytes + 1) * height;
+    int rawLength = 0;
+    char* raw = stbi_zlib_decode_malloc_guesssize_headerflag((const char*)idat.data(), (int)idat.size(), (int)expected, &rawLength, 1);
+    if (!raw || (size_t)rawLength < expected)
+    {
+        stbi_image_free(raw);
+        return false;
+    }
+
+    image.width = (int)width;
+    image.height = (int)height;
+    image.channels = channels;
+    image.pixels.resize((size_t)width * height * channels);
+    std::vector<uint8_t> zeros(rowBytes, 0);
+    std::vector<uint8_t> indices[2];
+    if (colorType == 3)
+        indices[0].resize(rowBytes), indices[1].resize(rowBytes);
+    const uint8_t* prior = zeros.data();
+    bool ok = true;
+    for (uint32_t y = 0; y < height && ok; y++)
+    {
+        const uint8_t* in = (const uint8_t*)raw + y * (rowBytes + 1);
+        uint8_t* out = image.pixels.data() + (size_t)(flip ? height - 1 - y : y) * width * channels;
+        if (colorType != 3)
+        {
+            ok = pngUnfilterRow(out, in + 1, prior, in[0], rowBytes, fileChannels);
+            prior = out;
+            continue;
+        }
+        // palette indices are unfiltered into a scratch row, then expanded
+        uint8_t* row = indices[y & 1].data();
+        ok = pngUnfilterRow(row, in + 1, prior, in[0], rowBytes, 1);
+        prior = row;
+        for (uint32_t x = 0; x < width; x++)
+            std::memcpy(out + x * channels, palette + row[x] * 4, (size_t)channels);
+    }
+    stbi_image_free(raw);
+    return ok;
+}
+
+//// ENTRY POINTS ////
+
+// decode a JPEG/PNG (or anything else stb_image reads) from memory; flip = rows bottom-up for GL.
+// threads = 0 uses one thread per hardware thread
+inline bool decodeImage(const unsigned char* data, size_t size, DecodedImage& image, bool flip, unsigned int threads = 0, ImageDecodeStats* stats = NULL)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    bool fast = false;
+    if (size > 3 && data[0] == 0xFF && data[1] == 0xD8)
+    {
+        JpegDecoder jpeg;
+        fast = jpeg.parse(data, size);
+        if (fast && jpeg.width * jpeg.height < IMAGE_DECODE_PARALLEL_MIN_PIXELS)
+            threads = 1;
+        fast = fast && jpeg.decode(image, flip, threads);
+    }
+    else
+        fast = decodePng(data, size, image, flip);
+
+    if (!fast)
+    {
+        // stb_image flips after decoding. Its per-thread flag is used so other threads aren't affected; on this one it
+        //      overrides stbi_set_flip_vertically_on_load() from now on
+        threads = 1;
+        stbi_set_flip_vertically_on_load_thread(flip ? 1 : 0);
+        int width, height, channels;
+        unsigned char* pixels = stbi_load_from_memory(data, (int)size, &width, &height, &channels, 0);
+        if (!pixels)
+        {
+            std::cout << "ERROR::IMAGE_DECODE::FAILED: " << stbi_failure_reason() << std::endl;
+            return false;
+        }
+        image.width = width;
+        image.height = height;
+        image.channels = channels;
+        image.pixels.assign(pixels, pixels + (size_t)width * height * channels);
+        stbi_image_free(pixels);
+    }
+    if (stats)
+    {
+        stats->bytes = size;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        stats->threads = threads;
+        stats->fastPath = fast;
+    }
+    return true;
+}
+
+// ------------------------------------------------------------------------
+inline bool loadImage(const char* path, DecodedImage& image, bool flip, unsigned int threads = 0, ImageDecodeStats* stats = NULL)
+{
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+    if (!decodeImage((const unsigned char*)file.data(), file.size(), image, flip, threads, stats))
+    {
+        std::cout << "ERROR::IMAGE_DECODE::NOT_DECODED: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,264 @@
+#ifndef INDIRECT_BATCH_H
+#define INDIRECT_BATCH_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <vertex_format.h>
+#include <gl_objects.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+//////// MULTI-DRAW INDIRECT ////
+// - every mesh lives in one shared vertex buffer and one shared index buffer, and is addressed by (firstIndex, baseVertex)
+// - a frame's draws are written as DrawElementsIndirectCommand records into GL_DRAW_INDIRECT_BUFFER and the per-draw
+//      data (model matrix, material) into an SSBO, then a single glMultiDrawElementsIndirect draws all of them
+// - draws of the same mesh (by id, not by where it sits in the buffers) are merged into one instanced command
+// - the shader finds its per-draw data through a per-instance draw id attribute (divisor 1). baseInstance offsets it,
+//      so this works on any 4.3 context without needing gl_DrawID / gl_BaseInstance:
+//
+//     layout (location = 15) in uint aDrawID;
+//     struct DrawData { mat4 model; uint materialID; };
+//     layout (std430, binding = 1) readonly buffer Draws { DrawData draws[]; };
+//     ...
+//     gl_Position = viewProjection * draws[aDrawID].model * vec4(aPos, 1.0);
+//
+// - meshes can be added after upload(); the next upload() appends them, growing the shared buffers on the GPU
+// - binds go through glState() (gl_objects.h), and apiCalls counts the GL calls submit() actually issued: the binds the
+//      cache let through plus every other call, each counted where it is made
+
+const unsigned int DRAW_DATA_SSBO_BINDING = 1;
+const unsigned int DRAW_ID_ATTRIB_LOCATION = 15;
+
+// layout fixed by the GL spec
+struct DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// std430 layout of one entry in the Draws SSBO
+struct DrawData
+{
+    glm::mat4 model;
+    uint32_t materialID;
+    uint32_t pad[3];
+};
+
+struct BatchedMesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t baseVertex;
+};
+
+class IndirectBatch
+{
+public:
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int commandBuffer = 0, drawDataBuffer = 0, drawIDBuffer = 0;
+
+    // last submit(): draws requested, commands after instancing merges and GL calls issued
+    unsigned int drawCount = 0;
+    unsigned int commandCount = 0;
+    unsigned int apiCalls = 0;
+
+    explicit IndirectBatch(const VertexFormat& format) : format(format) {}
+    ~IndirectBatch()
+    {
+        unsigned int buffers[] = { VBO, EBO, commandBuffer, drawDataBuffer, drawIDBuffer };
+        for (unsigned int buffer : buffers)
+            glState().forget(buffer);
+        glState().forget(VAO);
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(5, buffers);
+    }
+    IndirectBatch(const IndirectBatch&) = delete;
+    IndirectBatch& operator=(const IndirectBatch&) = delete;
+
+    // append a mesh to the shared buffers (CPU side until upload()), returns its id
+    // ------------------------------------------------------------------------
+    unsigned int addMesh(const void* vertices, size_t vertexCount, const unsigned int* indices, size_t indexCount)
+    {
+        BatchedMesh mesh = { (uint32_t)(uploadedIndexCount + indexData.size()), (uint32_t)indexCount,
+                             (int32_t)((uploadedVertexBytes + vertexData.size()) / format.stride) };
+        const unsigned char* bytes = static_cast<const unsigned char*>(vertices);
+        vertexData.insert(vertexData.end(), bytes, bytes + vertexCount * format.stride);
+        indexData.insert(indexData.end(), indices, indices + indexCount);
+        meshes.push_back(mesh);
+        return (unsigned int)meshes.size() - 1;
+    }
+    // create the shared buffers and the VAO on the first call, append the meshes added since on later ones; the CPU
+    //      copies are released afterwards
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        if (!VAO)
+        {
+            glGenVertexArrays(1, &VAO);
+            glGenBuffers(1, &commandBuffer);
+            glGenBuffers(1, &drawDataBuffer);
+            glGenBuffers(1, &drawIDBuffer);
+        }
+        else if (vertexData.empty() && indexData.empty())
+            return;
+
+        size_t indexBytes = indexData.size() * sizeof(unsigned int);
+        VBO = append(VBO, uploadedVertexBytes, vertexData.data(), vertexData.size());
+        EBO = append(EBO, uploadedIndexCount * sizeof(unsigned int), indexData.data(), indexBytes);
+        uploadedVertexBytes += vertexData.size();
+        uploadedIndexCount += indexData.size();
+
+        // the buffers may be new names now, so the VAO is pointed at them again
+        glState().bindVertexArray(VAO);
+        glState().bindBuffer(GL_ARRAY_BUFFER, VBO);
+        format.setupAttributes();
+        glState().bindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+        glState().bindVertexArray(0);
+
+        std::vector<unsigned char>().swap(vertexData);
+        std::vector<unsigned int>().swap(indexData);
+    }
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        draws.clear();
+    }
+    // queue one draw of a mesh for this frame
+    // ------------------------------------------------------------------------
+    void add(unsigned int mesh, const glm::mat4& model, uint32_t materialID = 0)
+    {
+        PendingDraw draw;
+        draw.mesh = mesh;
+        draw.data.model = model;
+        draw.data.materialID = materialID;
+        draw.data.pad[0] = draw.data.pad[1] = draw.data.pad[2] = 0;
+        draws.push_back(draw);
+    }
+    // upload this frame's commands and draw data and draw everything; the caller binds the shader
+    // ------------------------------------------------------------------------
+    void submit()
+    {
+        drawCount = (unsigned int)draws.size();
+        commandCount = 0;
+        apiCalls = 0;
+        if (draws.empty())
+            return;
+
+        // group by mesh so identical meshes collapse into one instanced command, and by material within a mesh so its
+        //      instances read neighbouring material entries (material.h)
+        std::stable_sort(draws.begin(), draws.end(), [](const PendingDraw& a, const PendingDraw& b)
+        {
+            return a.mesh != b.mesh ? a.mesh < b.mesh : a.data.materialID < b.data.materialID;
+        });
+        commands.clear();
+        drawData.clear();
+        for (size_t i = 0; i < draws.size(); i++)
+        {
+            const PendingDraw& draw = draws[i];
+            const BatchedMesh& mesh = meshes[draw.mesh];
+            // merge by mesh id: two meshes can share offsets (an empty mesh, say) and still be different draws
+            if (i > 0 && draws[i - 1].mesh == draw.mesh)
+                commands.back().instanceCount++;
+            else
+            {
+                DrawElementsIndirectCommand command = { mesh.indexCount, 1, mesh.firstIndex, mesh.baseVertex, (uint32_t)drawData.size() };
+                commands.push_back(command);
+            }
+            drawData.push_back(draw.data);
+        }
+        commandCount = (unsigned int)commands.size();
+
+        unsigned long long bindsBefore = glState().bindsIssued;
+        glState().bindVertexArray(VAO);
+        ensureDrawIDs(drawData.size());
+        // orphan and refill, so the driver never has to wait for last frame's draws to finish reading
+        glState().bindBuffer(GL_DRAW_INDIRECT_BUFFER, commandBuffer);
+        call(glBufferData, GL_DRAW_INDIRECT_BUFFER, (GLsizeiptr)(commands.size() * sizeof(DrawElementsIndirectCommand)), commands.data(), GL_STREAM_DRAW);
+        glState().bindBufferBase(GL_SHADER_STORAGE_BUFFER, DRAW_DATA_SSBO_BINDING, drawDataBuffer);
+        call(glBufferData, GL_SHADER_STORAGE_BUFFER, (GLsizeiptr)(drawData.size() * sizeof(DrawData)), drawData.data(), GL_STREAM_DRAW);
+        call(glMultiDrawElementsIndirect, GL_TRIANGLES, GL_UNSIGNED_INT, (const void*)0, (GLsizei)commands.size(), 0);
+        apiCalls += (unsigned int)(glState().bindsIssued - bindsBefore);
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "INDIRECT_BATCH:: " << drawCount << " draws as " << commandCount << " commands in " << apiCalls << " GL calls" << std::endl;
+    }
+
+private:
+    struct PendingDraw
+    {
+        unsigned int mesh;
+        DrawData data;
+    };
+
+    VertexFormat format;
+    std::vector<unsigned char> vertexData;
+    std::vector<unsigned int> indexData;
+    std::vector<BatchedMesh> meshes;
+    std::vector<PendingDraw> draws;
+    std::vector<DrawElementsIndirectCommand> commands;
+    std::vector<DrawData> drawData;
+    size_t drawIDCapacity = 0;
+    size_t uploadedVertexBytes = 0;
+    size_t uploadedIndexCount = 0;
+
+    // issue a GL call other than a bind and count it; binds are counted by the state cache
+    // ------------------------------------------------------------------------
+    template <typename Function, typename... Args>
+    void call(Function function, Args... args)
+    {
+        function(args...);
+        apiCalls++;
+    }
+    // a buffer holding oldBytes of buffer followed by bytes; the old contents are copied on the GPU and the old buffer
+    //      deleted, so nothing is leaked or read back
+    // ------------------------------------------------------------------------
+    static unsigned int append(unsigned int buffer, size_t oldBytes, const void* bytes, size_t size)
+    {
+        if (buffer && size == 0)
+            return buffer;
+        unsigned int grown = 0;
+        glGenBuffers(1, &grown);
+        glState().bindBuffer(GL_COPY_WRITE_BUFFER, grown);
+        glBufferData(GL_COPY_WRITE_BUFFER, (GLsizeiptr)(oldBytes + size), NULL, GL_STATIC_DRAW);
+        if (oldBytes)
+        {
+            glState().bindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)oldBytes);
+        }
+        glBufferSubData(GL_COPY_WRITE_BUFFER, (GLintptr)oldBytes, (GLsizeiptr)size, bytes);
+        if (buffer)
+        {
+            glState().forget(buffer);
+            glDeleteBuffers(1, &buffer);
+        }
+        return grown;
+    }
+
+    // the draw id attribute reads 0, 1, 2, ... per instance; baseInstance shifts where each command starts reading
+    // ------------------------------------------------------------------------
+    void ensureDrawIDs(size_t count)
+    {
+        if (count <= drawIDCapacity)
+            return;
+        drawIDCapacity = std::max<size_t>(count, drawIDCapacity * 2);
+        std::vector<uint32_t> ids(drawIDCapacity);
+        for (size_t i = 0; i < ids.size(); i++)
+            ids[i] = (uint32_t)i;
+        glState().bindBuffer(GL_ARRAY_BUFFER, drawIDBuffer);
+        call(glBufferData, GL_ARRAY_BUFFER, (GLsizeiptr)(ids.size() * sizeof(uint32_t)), ids.data(), GL_STATIC_DRAW);
+        call(glVertexAttribIPointer, DRAW_ID_ATTRIB_LOCATION, 1, GL_UNSIGNED_INT, (GLsizei)sizeof(uint32_t), (const void*)0);
+        call(glVertexAttribDivisor, DRAW_ID_ATTRIB_LOCATION, 1u);
+        call(glEnableVertexAttribArray, DRAW_ID_ATTRIB_LOCATION);
+    }
+};
+#endif
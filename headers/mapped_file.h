@@ -0,0 +1,156 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <iostream>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// A read-only memory mapping of a whole file. The OS pages the contents in on demand straight from the file cache,
+// so reading through data() never copies into a user buffer the way ifstream does.
+class MappedFile
+{
+public:
+    MappedFile() {}
+    explicit MappedFile(const char* path) { open(path); }
+    ~MappedFile() { close(); }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept { swap(other); }
+    MappedFile& operator=(MappedFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            swap(other);
+        }
+        return *this;
+    }
+    // map the file at path, returns false (and prints why unless quiet) on failure
+    // ------------------------------------------------------------------------
+    bool open(const char* path, bool quiet = false)
+    {
+        close();
+#if defined(_WIN32)
+        file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+        if (file == INVALID_HANDLE_VALUE)
+            return fail(path, quiet);
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize))
+            return fail(path, quiet);
+        length = (size_t)fileSize.QuadPart;
+        opened = true;
+        if (length == 0)
+            return true;
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping == NULL)
+            return fail(path, quiet);
+        view = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (view == NULL)
+            return fail(path, quiet);
+#else
+        fd = ::open(path, O_RDONLY);
+        if (fd < 0)
+            return fail(path, quiet);
+        struct stat st;
+        if (fstat(fd, &st) != 0)
+            return fail(path, quiet);
+        length = (size_t)st.st_size;
+        opened = true;
+        if (length == 0)
+            return true;
+        void* addr = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr == MAP_FAILED)
+            return fail(path, quiet);
+        view = static_cast<const unsigned char*>(addr);
+#endif
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void close()
+    {
+#if defined(_WIN32)
+        if (view)
+            UnmapViewOfFile(view);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE)
+            CloseHandle(file);
+        mapping = NULL;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (view)
+            munmap(const_cast<unsigned char*>(view), length);
+        if (fd >= 0)
+            ::close(fd);
+        fd = -1;
+#endif
+        view = NULL;
+        length = 0;
+        opened = false;
+    }
+    // hint that the whole mapping will be read front to back soon, so the OS can start reading ahead
+    // ------------------------------------------------------------------------
+    void willNeed() const
+    {
+#if !defined(_WIN32)
+        if (view)
+        {
+            madvise(const_cast<unsigned char*>(view), length, MADV_SEQUENTIAL);
+            madvise(const_cast<unsigned char*>(view), length, MADV_WILLNEED);
+        }
+#endif
+    }
+    // ------------------------------------------------------------------------
+    bool isOpen() const { return opened; }
+    const unsigned char* data() const { return view; }
+    size_t size() const { return length; }
+
+private:
+    const unsigned char* view = NULL;
+    size_t length = 0;
+    bool opened = false;
+#if defined(_WIN32)
+    HANDLE file = INVALID_HANDLE_VALUE;
+    HANDLE mapping = NULL;
+#else
+    int fd = -1;
+#endif
+
+    // ------------------------------------------------------------------------
+    bool fail(const char* path, bool quiet)
+    {
+        if (!quiet)
+            std::cout << "ERROR::MAPPED_FILE::COULD_NOT_MAP: " << path << std::endl;
+        close();
+        return false;
+    }
+    // ------------------------------------------------------------------------
+    void swap(MappedFile& other)
+    {
+        std::swap(view, other.view);
+        std::swap(length, other.length);
+        std::swap(opened, other.opened);
+#if defined(_WIN32)
+        std::swap(file, other.file);
+        std::swap(mapping, other.mapping);
+#else
+        std::swap(fd, other.fd);
+#endif
+    }
+};
+#endif
@@ -0,0 +1,236 @@
+#ifndef MATERIAL_H
+#define MATERIAL_H
+
+#include <glad/glad.h>
+
+#include <gl_objects.h>
+#include <shader_reflection.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+//////// MATERIALS ////
+// - a material's parameters are a plain struct P written to match its GLSL declaration, in 16 byte rows so that
+//      std140 (UBO) and std430 (SSBO) lay it out the same way. MaterialLibrary<P> keeps every material's P in one array
+//      mirrored in one GPU buffer, and a material's ID is its index there:
+//
+//     struct QuadMaterial { vec4 tint; float mixValue; int texture1; int texture2; int pad; };
+//     layout (std140) uniform Materials { QuadMaterial materials[64]; };            // or an SSBO: materials[]
+//     uniform int material;
+//     ...
+//     materials[material].mixValue
+//
+// - the buffer is bound once to MATERIAL_BINDING; switching materials between draws is one integer (a uniform, or the
+//      materialID in IndirectBatch's draw data) instead of a round of glUniform* calls. Material IDs are dense, so
+//      draws are sorted by material simply by sorting on the ID
+// - Material<P>::set(&P::member, value) writes one member through a pointer-to-member: unchanged values are dropped and
+//      a changed one only marks its own bytes dirty. upload() merges the dirty ranges and writes each run with one
+//      glBufferSubData, so nudging one float each frame uploads 4 bytes
+// - nothing ties P to the GLSL struct but care, so checkLayout() compares sizeof(P) and offsetof of each member with
+//      what the linked program's reflection says the block's array stride and member offsets are
+// - a UBO library can't outgrow the array size the shader declares, so capacity is fixed when the library is made
+
+const unsigned int MATERIAL_BINDING = 3;
+
+// one member of P for checkLayout(): its GLSL name and offsetof(P, member)
+struct MaterialMember
+{
+    const char* name;
+    size_t offset;
+};
+
+struct MaterialStats
+{
+    uint64_t sets = 0;
+    uint64_t unchangedSets = 0;     // sets that wrote the value already there
+    uint64_t uploads = 0;           // glBufferSubData calls
+    uint64_t bytesUploaded = 0;
+};
+
+template <typename P>
+class MaterialLibrary;
+
+// a handle to one material of a library: the ID shaders index with, and typed access to the parameters
+template <typename P>
+class Material
+{
+public:
+    uint32_t id = ~0u;
+
+    Material() {}
+    Material(MaterialLibrary<P>* library, uint32_t id) : id(id), library(library) {}
+
+    // ------------------------------------------------------------------------
+    bool valid() const { return library != NULL; }
+    // default parameters for an invalid handle
+    // ------------------------------------------------------------------------
+    const P& params() const
+    {
+        static const P defaults = P();
+        return valid() ? library->params(id) : defaults;
+    }
+    // does nothing on an invalid handle (create() on a full library gives one)
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void set(T P::*member, const T& value)
+    {
+        if (!valid())
+            return;
+        library->set(id, member, value);
+    }
+
+private:
+    MaterialLibrary<P>* library = NULL;
+};
+
+template <typename P>
+class MaterialLibrary
+{
+    static_assert(std::is_trivially_copyable<P>::value, "material parameters are copied into a buffer as bytes");
+    static_assert(sizeof(P) % 16 == 0, "material parameters are laid out in 16 byte rows, pad P to a multiple of 16 bytes");
+
+public:
+    GLenum target;                  // GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+    uint32_t capacity;
+    Buffer buffer;
+    MaterialStats stats;
+
+    MaterialLibrary(GLenum target, uint32_t capacity) : target(target), capacity(capacity)
+    {
+        buffer.data((size_t)capacity * sizeof(P), NULL, GL_DYNAMIC_DRAW);
+        materials.reserve(capacity);
+    }
+    MaterialLibrary(const MaterialLibrary&) = delete;
+    MaterialLibrary& operator=(const MaterialLibrary&) = delete;
+
+    // add a material; its parameters go up with the next upload(). An invalid handle once the library is full
+    // ------------------------------------------------------------------------
+    Material<P> create(const P& initial)
+    {
+        if (materials.size() >= capacity)
+        {
+            std::cout << "ERROR::MATERIAL::LIBRARY_FULL: " << capacity << " materials" << std::endl;
+            return Material<P>();
+        }
+        uint32_t id = (uint32_t)materials.size();
+        materials.push_back(initial);
+        markDirty((size_t)id * sizeof(P), sizeof(P));
+        return Material<P>(this, id);
+    }
+    // ------------------------------------------------------------------------
+    const P& params(uint32_t id) const
+    {
+        return materials[id];
+    }
+    // ------------------------------------------------------------------------
+    template <typename T>
+    void set(uint32_t id, T P::*member, const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "material parameters are compared and copied as bytes");
+        T& field = materials[id].*member;
+        stats.sets++;
+        if (std::memcmp(&field, &value, sizeof(T)) == 0)
+        {
+            stats.unchangedSets++;
+            return;
+        }
+        field = value;
+        size_t offset = (size_t)(reinterpret_cast<const unsigned char*>(&field) - reinterpret_cast<const unsigned char*>(&materials[id]));
+        markDirty((size_t)id * sizeof(P) + offset, sizeof(T));
+    }
+    // write what changed since the last upload: overlapping and touching ranges merge into one write
+    // ------------------------------------------------------------------------
+    void upload()
+    {
+        if (dirty.empty())
+            return;
+        std::sort(dirty.begin(), dirty.end());
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(materials.data());
+        size_t begin = dirty[0].first, end = dirty[0].second;
+        for (size_t i = 1; i <= dirty.size(); i++)
+        {
+            if (i < dirty.size() && dirty[i].first <= end)
+            {
+                end = std::max(end, dirty[i].second);
+                continue;
+            }
+            buffer.subData(begin, end - begin, bytes + begin);
+            stats.uploads++;
+            stats.bytesUploaded += end - begin;
+            if (i < dirty.size())
+            {
+                begin = dirty[i].first;
+                end = dirty[i].second;
+            }
+        }
+        dirty.clear();
+    }
+    // attach the buffer to MATERIAL_BINDING of its target; once is enough unless something else takes the binding
+    // ------------------------------------------------------------------------
+    void bind() const
+    {
+        buffer.bindBase(target, MATERIAL_BINDING);
+    }
+    // check P against the program's declaration of the material array (array is its GLSL name, "materials"): the array
+    //      stride must be sizeof(P) and every member must sit at its offsetof. Prints each mismatch, false if any
+    // ------------------------------------------------------------------------
+    bool checkLayout(const ShaderReflection& reflection, const char* array, std::initializer_list<MaterialMember> members) const
+    {
+        bool ok = true, strideChecked = false;
+        for (const MaterialMember& member : members)
+        {
+            std::string name = std::string(array) + "[0]." + member.name;
+            int offset = -1, stride = 0;
+            if (!reflection.blockMember(name, offset, stride))
+            {
+                std::cout << "ERROR::MATERIAL::LAYOUT_MISMATCH: program " << reflection.program << " has no active " << name << std::endl;
+                ok = false;
+                continue;
+            }
+            if (stride != 0 && !strideChecked && (size_t)stride != sizeof(P))
+            {
+                std::cout << "ERROR::MATERIAL::LAYOUT_MISMATCH: " << array << " has a " << stride << " byte stride in program "
+                          << reflection.program << " but P is " << sizeof(P) << " bytes" << std::endl;
+                ok = false;
+            }
+            strideChecked = strideChecked || stride != 0;
+            if ((size_t)offset != member.offset)
+            {
+                std::cout << "ERROR::MATERIAL::LAYOUT_MISMATCH: " << name << " is at byte " << offset << " in program " << reflection.program
+                          << " but at byte " << member.offset << " of P" << std::endl;
+                ok = false;
+            }
+        }
+        return ok;
+    }
+    // ------------------------------------------------------------------------
+    uint32_t count() const
+    {
+        return (uint32_t)materials.size();
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "MATERIALS:: " << materials.size() << " of " << capacity << " materials (" << sizeof(P) << " bytes each) in "
+                  << (target == GL_SHADER_STORAGE_BUFFER ? "an SSBO" : "a UBO") << ": " << stats.sets << " sets (" << stats.unchangedSets
+                  << " unchanged), " << stats.uploads << " uploads, " << stats.bytesUploaded << " bytes uploaded" << std::endl;
+    }
+
+private:
+    std::vector<P> materials;
+    std::vector<std::pair<size_t, size_t>> dirty;   // byte ranges [first, second) of the buffer
+
+    // ------------------------------------------------------------------------
+    void markDirty(size_t offset, size_t size)
+    {
+        dirty.push_back({ offset, offset + size });
+    }
+};
+#endif
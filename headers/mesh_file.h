@@ -0,0 +1,273 @@
+#ifndef MESH_FILE_H
+#define MESH_FILE_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <mapped_file.h>
+#include <vertex_format.h>
+#include <mesh_optimizer.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <vector>
+#include <iostream>
+
+//////// BINARY MESH FILES ////
+// - a .mesh file is laid out exactly the way the GPU wants it, so loading is: map the file, check the header, hand the
+//      mapped vertex and index streams to glBufferData. There is no parsing and no intermediate allocation
+// - layout: header | attribute table | submesh table | (pad to 4K) vertex stream | (pad to 4K) index stream
+// - streams start on 4K boundaries so they start on a page of the mapping, and the driver reads them straight out of
+//      the OS file cache; load time is bounded by how fast the disk delivers those pages
+// - all fields are little-endian
+
+const uint32_t MESH_FILE_MAGIC = 0x4D474F4C; // "LOGM"
+const uint32_t MESH_FILE_VERSION = 1;
+const uint64_t MESH_FILE_ALIGNMENT = 4096;
+
+struct MeshFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t vertexStride;
+    uint32_t indexType;     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    uint64_t vertexCount;
+    uint64_t indexCount;
+    uint32_t attribCount;
+    uint32_t submeshCount;
+    uint64_t attribOffset;  // byte offsets from the start of the file
+    uint64_t submeshOffset;
+    uint64_t vertexOffset;
+    uint64_t vertexBytes;
+    uint64_t indexOffset;
+    uint64_t indexBytes;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+struct MeshFileAttrib
+{
+    uint32_t semantic;      // VertexSemantic
+    uint32_t location;
+    uint32_t components;
+    uint32_t format;        // AttribFormat
+    uint32_t offset;
+};
+
+struct MeshFileSubmesh
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    int32_t baseVertex;
+    uint32_t materialIndex;
+    float boundsMin[3];
+    float boundsMax[3];
+};
+
+// GL objects created from a mesh file
+struct MeshBuffers
+{
+    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int indexType = GL_UNSIGNED_INT;
+
+    void destroy()
+    {
+        glDeleteVertexArrays(1, &VAO);
+        glDeleteBuffers(1, &VBO);
+        glDeleteBuffers(1, &EBO);
+        VAO = VBO = EBO = 0;
+    }
+};
+
+// A mapped .mesh file. Every pointer points into the mapping, so the file must stay open while they are in use
+class MeshFile
+{
+public:
+    const MeshFileHeader* header = NULL;
+    const MeshFileAttrib* attribs = NULL;
+    const MeshFileSubmesh* submeshes = NULL;
+    const void* vertexData = NULL;
+    const void* indexData = NULL;
+
+    // map and validate a file: the header, where the tables and streams sit and what the tables say are all checked
+    //      before any pointer is handed out, so a corrupt file can't send a read outside the mapping. The streams
+    //      themselves are never touched on the CPU
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        header = NULL;
+        if (!file.open(path))
+            return false;
+        const unsigned char* base = file.data();
+        size_t size = file.size();
+        if (size < sizeof(MeshFileHeader))
+            return invalid(path, "file too small");
+        const MeshFileHeader* h = reinterpret_cast<const MeshFileHeader*>(base);
+        if (h->magic != MESH_FILE_MAGIC || h->version != MESH_FILE_VERSION)
+            return invalid(path, "bad magic or version");
+        if (h->indexType != GL_UNSIGNED_SHORT && h->indexType != GL_UNSIGNED_INT)
+            return invalid(path, "unknown index type");
+        if (!inBounds(h->attribOffset, (uint64_t)h->attribCount * sizeof(MeshFileAttrib), size) ||
+            !inBounds(h->submeshOffset, (uint64_t)h->submeshCount * sizeof(MeshFileSubmesh), size) ||
+            !inBounds(h->vertexOffset, h->vertexBytes, size) ||
+            !inBounds(h->indexOffset, h->indexBytes, size))
+            return invalid(path, "section out of range");
+        // the tables are read in place, and the streams start on the page boundaries writeMeshFile() pads them to
+        if (h->attribOffset % alignof(MeshFileAttrib) != 0 || h->submeshOffset % alignof(MeshFileSubmesh) != 0 ||
+            h->vertexOffset % MESH_FILE_ALIGNMENT != 0 || h->indexOffset % MESH_FILE_ALIGNMENT != 0)
+            return invalid(path, "misaligned section");
+        // divided rather than multiplied, so huge counts can't wrap around to a matching size
+        uint64_t indexSize = h->indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        if (h->vertexStride == 0 || h->vertexBytes % h->vertexStride != 0 || h->vertexBytes / h->vertexStride != h->vertexCount ||
+            h->indexBytes % indexSize != 0 || h->indexBytes / indexSize != h->indexCount)
+            return invalid(path, "stream size mismatch");
+        const MeshFileAttrib* a = reinterpret_cast<const MeshFileAttrib*>(base + h->attribOffset);
+        for (uint32_t i = 0; i < h->attribCount; i++)
+        {
+            if (a[i].semantic > (uint32_t)VertexSemantic::Generic || a[i].format > (uint32_t)AttribFormat::Unorm16 ||
+                a[i].components < 1 || a[i].components > 4 || a[i].location >= 16)
+                return invalid(path, "bad attribute");
+            VertexAttrib attrib = { (VertexSemantic)a[i].semantic, a[i].location, (int)a[i].components, (AttribFormat)a[i].format, a[i].offset };
+            if (a[i].offset > h->vertexStride || VertexFormat::attribSize(attrib) > h->vertexStride - a[i].offset)
+                return invalid(path, "attribute outside the vertex");
+        }
+        const MeshFileSubmesh* s = reinterpret_cast<const MeshFileSubmesh*>(base + h->submeshOffset);
+        for (uint32_t i = 0; i < h->submeshCount; i++)
+        {
+            if (s[i].firstIndex > h->indexCount || s[i].indexCount > h->indexCount - s[i].firstIndex)
+                return invalid(path, "submesh out of range");
+        }
+        file.willNeed();
+        header = h;
+        attribs = reinterpret_cast<const MeshFileAttrib*>(base + h->attribOffset);
+        submeshes = reinterpret_cast<const MeshFileSubmesh*>(base + h->submeshOffset);
+        vertexData = base + h->vertexOffset;
+        indexData = base + h->indexOffset;
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    bool isOpen() const { return header != NULL; }
+    void close() { header = NULL; file.close(); }
+
+    // the vertex layout stored in the file, with the offsets exactly as written
+    // ------------------------------------------------------------------------
+    VertexFormat format() const
+    {
+        VertexFormat result;
+        for (uint32_t i = 0; i < header->attribCount; i++)
+        {
+            const MeshFileAttrib& a = attribs[i];
+            VertexAttrib attrib = { (VertexSemantic)a.semantic, a.location, (int)a.components, (AttribFormat)a.format, a.offset };
+            result.attribs.push_back(attrib);
+        }
+        result.stride = header->vertexStride;
+        return result;
+    }
+    // create a VAO with one glBufferData per stream, sourced directly from the mapping
+    // ------------------------------------------------------------------------
+    MeshBuffers upload() const
+    {
+        MeshBuffers buffers;
+        buffers.indexType = header->indexType;
+        glGenVertexArrays(1, &buffers.VAO);
+        glGenBuffers(1, &buffers.VBO);
+        glGenBuffers(1, &buffers.EBO);
+        glBindVertexArray(buffers.VAO);
+        glBindBuffer(GL_ARRAY_BUFFER, buffers.VBO);
+        glBufferData(GL_ARRAY_BUFFER, (GLsizeiptr)header->vertexBytes, vertexData, GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buffers.EBO);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, (GLsizeiptr)header->indexBytes, indexData, GL_STATIC_DRAW);
+        format().setupAttributes();
+        glBindVertexArray(0);
+        return buffers;
+    }
+    // draw one submesh from buffers created by upload()
+    // ------------------------------------------------------------------------
+    void draw(const MeshBuffers& buffers, uint32_t submesh) const
+    {
+        const MeshFileSubmesh& s = submeshes[submesh];
+        size_t indexSize = buffers.indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        glBindVertexArray(buffers.VAO);
+        glDrawElementsBaseVertex(GL_TRIANGLES, s.indexCount, buffers.indexType, (void*)(s.firstIndex * indexSize), s.baseVertex);
+    }
+
+private:
+    MappedFile file;
+
+    // ------------------------------------------------------------------------
+    static bool inBounds(uint64_t offset, uint64_t bytes, size_t size)
+    {
+        return offset <= size && bytes <= size - offset;
+    }
+    // ------------------------------------------------------------------------
+    bool invalid(const char* path, const char* reason)
+    {
+        std::cout << "ERROR::MESH_FILE::INVALID: " << path << " (" << reason << ")" << std::endl;
+        file.close();
+        return false;
+    }
+};
+
+// write a .mesh file. vertices are already encoded in format; indices are stored as 16 bit when they fit.
+// The header bounds are the union of the submesh bounds
+// ------------------------------------------------------------------------
+inline bool writeMeshFile(const char* path, const VertexFormat& format, const void* vertices, size_t vertexCount,
+                          const unsigned int* indices, size_t indexCount, const std::vector<MeshFileSubmesh>& submeshes)
+{
+    std::vector<unsigned short> indices16;
+    bool shortIndices = compactIndices16(indices, indexCount, indices16);
+
+    MeshFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = MESH_FILE_MAGIC;
+    header.version = MESH_FILE_VERSION;
+    header.vertexStride = format.stride;
+    header.indexType = shortIndices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    header.vertexCount = vertexCount;
+    header.indexCount = indexCount;
+    header.attribCount = (uint32_t)format.attribs.size();
+    header.submeshCount = (uint32_t)submeshes.size();
+    header.attribOffset = sizeof(MeshFileHeader);
+    header.submeshOffset = header.attribOffset + header.attribCount * sizeof(MeshFileAttrib);
+    uint64_t tablesEnd = header.submeshOffset + header.submeshCount * sizeof(MeshFileSubmesh);
+    header.vertexOffset = (tablesEnd + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+    header.vertexBytes = (uint64_t)vertexCount * format.stride;
+    header.indexOffset = (header.vertexOffset + header.vertexBytes + MESH_FILE_ALIGNMENT - 1) & ~(MESH_FILE_ALIGNMENT - 1);
+    header.indexBytes = (uint64_t)indexCount * (shortIndices ? 2 : 4);
+    for (size_t i = 0; i < submeshes.size(); i++)
+    {
+        for (int k = 0; k < 3; k++)
+        {
+            header.boundsMin[k] = i == 0 ? submeshes[i].boundsMin[k] : glm::min(header.boundsMin[k], submeshes[i].boundsMin[k]);
+            header.boundsMax[k] = i == 0 ? submeshes[i].boundsMax[k] : glm::max(header.boundsMax[k], submeshes[i].boundsMax[k]);
+        }
+    }
+
+    std::vector<MeshFileAttrib> attribs;
+    for (const VertexAttrib& a : format.attribs)
+    {
+        MeshFileAttrib attrib = { (uint32_t)a.semantic, a.location, (uint32_t)a.components, (uint32_t)a.format, a.offset };
+        attribs.push_back(attrib);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cout << "ERROR::MESH_FILE::COULD_NOT_WRITE: " << path << std::endl;
+        return false;
+    }
+    const char zeros[MESH_FILE_ALIGNMENT] = {};
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(attribs.data()), attribs.size() * sizeof(MeshFileAttrib));
+    out.write(reinterpret_cast<const char*>(submeshes.data()), submeshes.size() * sizeof(MeshFileSubmesh));
+    out.write(zeros, header.vertexOffset - tablesEnd);
+    out.write(static_cast<const char*>(vertices), header.vertexBytes);
+    out.write(zeros, header.indexOffset - (header.vertexOffset + header.vertexBytes));
+    if (shortIndices)
+        out.write(reinterpret_cast<const char*>(indices16.data()), header.indexBytes);
+    else
+        out.write(reinterpret_cast<const char*>(indices), header.indexBytes);
+    return (bool)out;
+}
+#endif
@@ -0,0 +1,340 @@
+#ifndef MESH_LOD_H
+#define MESH_LOD_H
+
+#include <glm/glm.hpp>
+
+#include <mesh_optimizer.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <queue>
+#include <vector>
+#include <iostream>
+
+//////// LEVELS OF DETAIL ////
+// - simplifyMesh collapses edges in order of their quadric error (Garland & Heckbert 1997): every vertex carries the sum
+//      of the planes of its triangles, and the cost of moving it is the summed squared distance to those planes
+// - vertices only ever collapse onto another existing vertex, so every LOD indexes the same vertex buffer and a LOD
+//      switch is just a different index range
+// - border vertices (including UV seams, where positions are duplicated) are locked so the outline doesn't shrink
+// - buildLodChain stores every level in one index buffer together with its geometric error in object units
+// - LodSelector projects that error to pixels with the camera's projection matrix and picks the coarsest level that
+//      stays under a pixel threshold, with hysteresis so objects sitting on a boundary don't flip every frame
+
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;            // object space distance the surface may have moved compared to LOD 0
+};
+
+struct LodChain
+{
+    std::vector<unsigned int> indices;  // all levels back to back, LOD 0 first
+    std::vector<MeshLod> lods;
+};
+
+// symmetric 4x4 plane quadric, stored as its upper triangle
+struct Quadric
+{
+    double a[10] = {};
+
+    void addPlane(const glm::dvec4& p)
+    {
+        a[0] += p.x * p.x; a[1] += p.x * p.y; a[2] += p.x * p.z; a[3] += p.x * p.w;
+        a[4] += p.y * p.y; a[5] += p.y * p.z; a[6] += p.y * p.w;
+        a[7] += p.z * p.z; a[8] += p.z * p.w;
+        a[9] += p.w * p.w;
+    }
+    void add(const Quadric& q)
+    {
+        for (int i = 0; i < 10; i++)
+            a[i] += q.a[i];
+    }
+    // sum of squared distances from v to every plane in the quadric
+    double error(const glm::dvec3& v) const
+    {
+        double e = a[0] * v.x * v.x + 2 * a[1] * v.x * v.y + 2 * a[2] * v.x * v.z + 2 * a[3] * v.x
+                 + a[4] * v.y * v.y + 2 * a[5] * v.y * v.z + 2 * a[6] * v.y
+                 + a[7] * v.z * v.z + 2 * a[8] * v.z
+                 + a[9];
+        return e > 0.0 ? e : 0.0;
+    }
+};
+
+// simplify an index buffer down to roughly targetIndexCount indices. Returns the new index buffer (into the same
+// vertices); error receives the largest collapse error in object units
+// ------------------------------------------------------------------------
+inline std::vector<unsigned int> simplifyMesh(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t vertexStride,
+                                              size_t targetIndexCount, float* error = NULL)
+{
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(positions);
+    std::vector<glm::dvec3> pos(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++)
+    {
+        glm::vec3 p;
+        std::memcpy(&p[0], base + v * vertexStride, sizeof(p));
+        pos[v] = glm::dvec3(p);
+    }
+
+    size_t triangleCount = indexCount / 3;
+    std::vector<unsigned int> tris(indices, indices + triangleCount * 3);
+    std::vector<bool> removed(triangleCount, false);
+    std::vector<std::vector<unsigned int>> vertexTris(vertexCount);
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        glm::dvec3 p0 = pos[tris[t * 3]], p1 = pos[tris[t * 3 + 1]], p2 = pos[tris[t * 3 + 2]];
+        glm::dvec3 n = glm::cross(p1 - p0, p2 - p0);
+        double len = glm::length(n);
+        if (len > 0.0)
+            n /= len;
+        glm::dvec4 plane(n, -glm::dot(n, p0));
+        for (int k = 0; k < 3; k++)
+        {
+            quadrics[tris[t * 3 + k]].addPlane(plane);
+            vertexTris[tris[t * 3 + k]].push_back((unsigned int)t);
+        }
+    }
+
+    // an edge used by only one triangle is a border; lock both its vertices
+    std::vector<bool> locked(vertexCount, false);
+    {
+        std::vector<std::pair<uint64_t, int>> edges;
+        edges.reserve(triangleCount * 3);
+        for (size_t t = 0; t < triangleCount; t++)
+            for (int k = 0; k < 3; k++)
+            {
+                uint64_t a = tris[t * 3 + k], b = tris[t * 3 + (k + 1) % 3];
+                edges.push_back(std::make_pair(std::min(a, b) << 32 | std::max(a, b), 1));
+            }
+        std::sort(edges.begin(), edges.end());
+        for (size_t i = 0; i < edges.size();)
+        {
+            size_t j = i;
+            while (j < edges.size() && edges[j].first == edges[i].first)
+                j++;
+            if (j - i == 1)
+            {
+                locked[edges[i].first >> 32] = true;
+                locked[edges[i].first & 0xFFFFFFFFu] = true;
+            }
+            i = j;
+        }
+    }
+
+    struct Collapse
+    {
+        double cost;
+        unsigned int from, to;
+        unsigned int version;
+        bool operator<(const Collapse& o) const { return cost > o.cost; } // min-heap
+    };
+    std::priority_queue<Collapse> queue;
+    std::vector<unsigned int> version(vertexCount, 0);
+
+    // cheapest collapse out of v along any of its edges
+    auto pushCollapses = [&](unsigned int v)
+    {
+        if (locked[v])
+            return;
+        double bestCost = -1.0;
+        unsigned int bestTarget = 0;
+        for (unsigned int t : vertexTris[v])
+        {
+            if (removed[t])
+                continue;
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int u = tris[t * 3 + k];
+                if (u == v)
+                    continue;
+                Quadric q = quadrics[v];
+                q.add(quadrics[u]);
+                double cost = q.error(pos[u]);
+                if (bestCost < 0.0 || cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestTarget = u;
+                }
+            }
+        }
+        if (bestCost >= 0.0)
+        {
+            Collapse c = { bestCost, v, bestTarget, ++version[v] };
+            queue.push(c);
+        }
+    };
+    for (unsigned int v = 0; v < vertexCount; v++)
+        pushCollapses(v);
+
+    size_t liveTriangles = triangleCount;
+    double maxCost = 0.0;
+    while (liveTriangles * 3 > targetIndexCount && !queue.empty())
+    {
+        Collapse c = queue.top();
+        queue.pop();
+        if (c.version != version[c.from])
+            continue; // stale entry, v changed since it was queued
+
+        // reject collapses that would flip a remaining triangle
+        bool flips = false;
+        for (unsigned int t : vertexTris[c.from])
+        {
+            if (removed[t])
+                continue;
+            unsigned int* tri = &tris[t * 3];
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+                continue;
+            glm::dvec3 before = glm::cross(pos[tri[1]] - pos[tri[0]], pos[tri[2]] - pos[tri[0]]);
+            glm::dvec3 p[3];
+            for (int k = 0; k < 3; k++)
+                p[k] = tri[k] == c.from ? pos[c.to] : pos[tri[k]];
+            glm::dvec3 after = glm::cross(p[1] - p[0], p[2] - p[0]);
+            if (glm::dot(before, after) <= 0.0)
+            {
+                flips = true;
+                break;
+            }
+        }
+        if (flips)
+        {
+            version[c.from]++;
+            continue;
+        }
+
+        for (unsigned int t : vertexTris[c.from])
+        {
+            if (removed[t])
+                continue;
+            unsigned int* tri = &tris[t * 3];
+            if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to)
+            {
+                removed[t] = true;
+                liveTriangles--;
+                continue;
+            }
+            for (int k = 0; k < 3; k++)
+                if (tri[k] == c.from)
+                    tri[k] = c.to;
+            vertexTris[c.to].push_back(t);
+        }
+        vertexTris[c.from].clear();
+        quadrics[c.to].add(quadrics[c.from]);
+        maxCost = std::max(maxCost, c.cost);
+        version[c.from]++;
+
+        // neighbours of the target now see different edges
+        pushCollapses(c.to);
+        for (unsigned int t : vertexTris[c.to])
+            if (!removed[t])
+                for (int k = 0; k < 3; k++)
+                    if (tris[t * 3 + k] != c.to)
+                        pushCollapses(tris[t * 3 + k]);
+    }
+
+    std::vector<unsigned int> result;
+    result.reserve(liveTriangles * 3);
+    for (size_t t = 0; t < triangleCount; t++)
+        if (!removed[t])
+            result.insert(result.end(), tris.begin() + t * 3, tris.begin() + t * 3 + 3);
+    if (error)
+        *error = (float)std::sqrt(maxCost);
+    return result;
+}
+
+// build up to levelCount levels, each with about ratio times the triangles of the one before. Generation stops early
+// once a level no longer gets meaningfully smaller (everything left is locked)
+// ------------------------------------------------------------------------
+inline LodChain buildLodChain(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t vertexStride,
+                              unsigned int levelCount = 4, float ratio = 0.5f)
+{
+    LodChain chain;
+    chain.indices.assign(indices, indices + indexCount);
+    MeshLod lod0 = { 0, (uint32_t)indexCount, 0.0f };
+    chain.lods.push_back(lod0);
+
+    std::vector<unsigned int> previous(indices, indices + indexCount);
+    float error = 0.0f;
+    for (unsigned int level = 1; level < levelCount; level++)
+    {
+        float levelError = 0.0f;
+        size_t target = (size_t)(previous.size() / 3 * ratio) * 3;
+        std::vector<unsigned int> simplified = simplifyMesh(previous.data(), previous.size(), positions, vertexCount, vertexStride, target, &levelError);
+        if (simplified.empty() || simplified.size() > previous.size() * 0.95)
+            break;
+        // errors add up since each level is simplified from the one before it
+        error += levelError;
+        optimizeVertexCache(simplified.data(), simplified.size(), vertexCount);
+        MeshLod lod = { (uint32_t)chain.indices.size(), (uint32_t)simplified.size(), error };
+        chain.lods.push_back(lod);
+        chain.indices.insert(chain.indices.end(), simplified.begin(), simplified.end());
+        previous.swap(simplified);
+    }
+    return chain;
+}
+
+// per object LOD state, kept between frames for hysteresis
+struct LodInstance
+{
+    unsigned int current = 0;
+};
+
+// Picks LODs from projected screen space error and counts the triangles that saved
+class LodSelector
+{
+public:
+    float thresholdPixels = 1.0f;   // largest acceptable on-screen error
+    float hysteresis = 0.25f;       // a coarser level must beat the threshold by this fraction before switching to it
+
+    unsigned int trianglesFull = 0;     // triangles that would have been drawn at LOD 0 this frame
+    unsigned int trianglesDrawn = 0;
+
+    // call once per frame with the camera's projection matrix and the framebuffer height
+    // ------------------------------------------------------------------------
+    void beginFrame(const glm::mat4& projection, float viewportHeight, const glm::vec3& cameraPosition)
+    {
+        // projection[1][1] is cot(fov / 2), so this turns "units at distance 1" into pixels
+        pixelsPerUnit = projection[1][1] * viewportHeight * 0.5f;
+        cameraPos = cameraPosition;
+        trianglesFull = 0;
+        trianglesDrawn = 0;
+    }
+    // pick the level for an object; center/radius are its world space bounding sphere and scale its uniform scale
+    // ------------------------------------------------------------------------
+    const MeshLod& select(const LodChain& chain, LodInstance& instance, const glm::vec3& center, float radius, float scale = 1.0f)
+    {
+        float distance = std::max(glm::length(center - cameraPos) - radius, 1e-4f);
+        unsigned int last = (unsigned int)chain.lods.size() - 1;
+        unsigned int lod = std::min(instance.current, last);
+
+        // refine while the current level is too coarse, then coarsen while the next level is comfortably fine
+        while (lod > 0 && screenError(chain.lods[lod], distance, scale) > thresholdPixels)
+            lod--;
+        while (lod < last && screenError(chain.lods[lod + 1], distance, scale) <= thresholdPixels * (1.0f - hysteresis))
+            lod++;
+
+        instance.current = lod;
+        trianglesFull += chain.lods[0].indexCount / 3;
+        trianglesDrawn += chain.lods[lod].indexCount / 3;
+        return chain.lods[lod];
+    }
+    // ------------------------------------------------------------------------
+    unsigned int trianglesSaved() const { return trianglesFull - trianglesDrawn; }
+    void report() const
+    {
+        std::cout << "MESH_LOD:: drew " << trianglesDrawn << " of " << trianglesFull << " triangles, saved " << trianglesSaved() << std::endl;
+    }
+
+private:
+    float pixelsPerUnit = 1.0f;
+    glm::vec3 cameraPos = glm::vec3(0.0f);
+
+    float screenError(const MeshLod& lod, float distance, float scale) const
+    {
+        return lod.error * scale * pixelsPerUnit / distance;
+    }
+};
+#endif
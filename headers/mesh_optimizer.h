@@ -0,0 +1,327 @@
+#ifndef MESH_OPTIMIZER_H
+#define MESH_OPTIMIZER_H
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+//////// MESH OPTIMIZER ////
+// - GPUs keep recently transformed vertices in a small post-transform cache; indices that hit it skip the vertex shader
+// - optimizeVertexCache reorders triangles so neighbouring triangles are drawn together (Tipsify, Sander et al. 2007)
+// - optimizeOverdraw reorders the resulting triangle clusters so outward facing clusters are drawn first
+// - optimizeVertexFetch reorders the vertex buffer into first-use order so vertex fetches walk memory linearly
+// - all passes are linear time, so they're fine to run at load time on multi-million triangle meshes
+//      (meshconv --bench-grid times them on a generated grid of any size)
+// - every pass checks the indices against vertexCount first and refuses an index buffer that points past the vertices
+
+// post-transform cache size the optimizer targets; 16 is a safe lower bound for current hardware
+const unsigned int VERTEX_CACHE_SIZE = 16;
+
+struct VertexCacheStats
+{
+    unsigned int vertexCount;   // unique vertices referenced by the index buffer
+    unsigned int triangleCount;
+    unsigned int misses;        // vertex shader invocations in a FIFO cache simulation
+    float acmr;                 // average cache miss ratio: misses per triangle, 0.5 is ideal for large grids, 3.0 is worst
+    float atvr;                 // average transformed vertex ratio: misses per vertex, 1.0 is ideal
+};
+
+// false (and prints the first offender) if an index refers to a vertex past vertexCount
+// ------------------------------------------------------------------------
+inline bool indicesInRange(const unsigned int* indices, size_t indexCount, size_t vertexCount)
+{
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            std::cout << "ERROR::MESH_OPTIMIZER::INDEX_OUT_OF_RANGE: index " << i << " is " << indices[i] << ", there are "
+                      << vertexCount << " vertices" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// simulate a FIFO post-transform cache over an index buffer; all zero when the indices are out of range
+// ------------------------------------------------------------------------
+inline VertexCacheStats analyzeVertexCache(const unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE)
+{
+    VertexCacheStats stats = { 0, 0, 0, 0.0f, 0.0f };
+    if (!indicesInRange(indices, indexCount, vertexCount))
+        return stats;
+    stats.triangleCount = (unsigned int)(indexCount / 3);
+    // a vertex is in the cache if it was loaded less than cacheSize misses ago
+    std::vector<unsigned int> loadedAt(vertexCount, 0);
+    std::vector<bool> seen(vertexCount, false);
+    unsigned int time = cacheSize + 1;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        unsigned int v = indices[i];
+        if (!seen[v])
+        {
+            seen[v] = true;
+            stats.vertexCount++;
+        }
+        if (time - loadedAt[v] > cacheSize)
+        {
+            loadedAt[v] = time++;
+            stats.misses++;
+        }
+    }
+    stats.acmr = stats.triangleCount ? (float)stats.misses / (float)stats.triangleCount : 0.0f;
+    stats.atvr = stats.vertexCount ? (float)stats.misses / (float)stats.vertexCount : 0.0f;
+    return stats;
+}
+// ------------------------------------------------------------------------
+inline void printVertexCacheStats(const char* label, const VertexCacheStats& stats)
+{
+    std::cout << "MESH_OPTIMIZER::" << label << ": " << stats.triangleCount << " triangles, " << stats.vertexCount
+              << " vertices, ACMR " << stats.acmr << ", ATVR " << stats.atvr << std::endl;
+}
+
+// reorder triangles for post-transform cache locality. If clusters is given it receives the index (into the triangle
+// list) where each run of connected triangles starts, which optimizeOverdraw can then sort. Only whole triangles are
+// reordered; trailing indices that don't make up a triangle are left where they are. Returns false, leaving the
+// indices as they were, when they are out of range
+// ------------------------------------------------------------------------
+inline bool optimizeVertexCache(unsigned int* indices, size_t indexCount, size_t vertexCount, unsigned int cacheSize = VERTEX_CACHE_SIZE, std::vector<unsigned int>* clusters = NULL)
+{
+    if (clusters)
+        clusters->clear();
+    size_t triangleCount = indexCount / 3;
+    if (indexCount % 3 != 0)
+    {
+        std::cout << "ERROR::MESH_OPTIMIZER::PARTIAL_TRIANGLE: " << indexCount << " indices, ignoring the last " << indexCount % 3 << std::endl;
+        indexCount = triangleCount * 3;
+    }
+    if (!indicesInRange(indices, indexCount, vertexCount))
+        return false;
+    if (triangleCount == 0)
+        return true;
+
+    // vertex -> triangle adjacency, packed into one array
+    std::vector<unsigned int> liveTriangles(vertexCount, 0);
+    for (size_t i = 0; i < indexCount; i++)
+        liveTriangles[indices[i]]++;
+    std::vector<unsigned int> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++)
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + liveTriangles[v];
+    std::vector<unsigned int> adjacency(indexCount);
+    std::vector<unsigned int> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+    for (size_t i = 0; i < indexCount; i++)
+        adjacency[fill[indices[i]]++] = (unsigned int)(i / 3);
+
+    std::vector<unsigned int> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<unsigned int> deadEnd;
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> result;
+    result.reserve(indexCount);
+
+    unsigned int time = cacheSize + 1;
+    size_t cursor = 0;
+    long long fanning = 0; // vertex whose triangles are emitted next, -1 when done
+    if (clusters)
+        clusters->assign(1, 0);
+
+    while (fanning >= 0)
+    {
+        candidates.clear();
+        unsigned int f = (unsigned int)fanning;
+        for (unsigned int a = adjacencyOffset[f]; a < adjacencyOffset[f + 1]; a++)
+        {
+            unsigned int t = adjacency[a];
+            if (emitted[t])
+                continue;
+            for (int k = 0; k < 3; k++)
+            {
+                unsigned int v = indices[t * 3 + k];
+                result.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+                if (time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+            emitted[t] = true;
+        }
+
+        // next fanning vertex: the candidate still in cache that will stay there longest after its fan is emitted
+        long long best = -1;
+        int bestPriority = -1;
+        for (unsigned int v : candidates)
+        {
+            if (liveTriangles[v] == 0)
+                continue;
+            int priority = 0;
+            if (time - cacheTime[v] + 2 * liveTriangles[v] <= cacheSize)
+                priority = (int)(time - cacheTime[v]);
+            if (priority > bestPriority)
+            {
+                bestPriority = priority;
+                best = v;
+            }
+        }
+        if (best < 0)
+        {
+            // dead end: backtrack through recently used vertices, then scan for any vertex with triangles left
+            while (!deadEnd.empty() && best < 0)
+            {
+                unsigned int v = deadEnd.back();
+                deadEnd.pop_back();
+                if (liveTriangles[v] > 0)
+                    best = v;
+            }
+            while (best < 0 && cursor < vertexCount)
+            {
+                if (liveTriangles[cursor] > 0)
+                    best = (long long)cursor;
+                cursor++;
+            }
+            // a dead end before anything was emitted (vertex 0 had no triangles) doesn't start a new cluster
+            unsigned int start = (unsigned int)(result.size() / 3);
+            if (best >= 0 && clusters && clusters->back() != start)
+                clusters->push_back(start);
+        }
+        fanning = best;
+    }
+    std::memcpy(indices, result.data(), result.size() * sizeof(unsigned int));
+    return true;
+}
+
+// reorder the triangle clusters from optimizeVertexCache so clusters on the outside of the mesh, facing away from its
+// center, are drawn first and occlude the rest. Triangle order inside each cluster (and so cache locality) is kept.
+// positions points at the first vertex's position, vertexStride is the distance in bytes between vertices. Returns
+// false, leaving the indices as they were, when they are out of range or the clusters aren't increasing triangle
+// offsets starting at 0
+// ------------------------------------------------------------------------
+inline bool optimizeOverdraw(unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t vertexStride, const std::vector<unsigned int>& clusters)
+{
+    size_t triangleCount = indexCount / 3;
+    indexCount = triangleCount * 3;
+    if (!indicesInRange(indices, indexCount, vertexCount))
+        return false;
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        if (clusters[c] >= triangleCount || (c == 0 ? clusters[c] != 0 : clusters[c] <= clusters[c - 1]))
+        {
+            std::cout << "ERROR::MESH_OPTIMIZER::BAD_CLUSTERS: cluster " << c << " starts at triangle " << clusters[c] << " of "
+                      << triangleCount << std::endl;
+            return false;
+        }
+    }
+    if (clusters.size() < 2)
+        return true;
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(positions);
+    auto position = [&](unsigned int v) { return glm::make_vec3(reinterpret_cast<const float*>(base + v * vertexStride)); };
+
+    glm::vec3 meshCenter(0.0f);
+    for (size_t i = 0; i < indexCount; i++)
+        meshCenter += position(indices[i]);
+    meshCenter /= (float)indexCount;
+
+    std::vector<float> sortKey(clusters.size());
+    for (size_t c = 0; c < clusters.size(); c++)
+    {
+        size_t begin = clusters[c];
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        glm::vec3 center(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t t = begin; t < end; t++)
+        {
+            glm::vec3 p0 = position(indices[t * 3 + 0]);
+            glm::vec3 p1 = position(indices[t * 3 + 1]);
+            glm::vec3 p2 = position(indices[t * 3 + 2]);
+            // the cross product's length is twice the triangle area, so summing it area-weights the normal
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            float a = glm::length(n);
+            center += (p0 + p1 + p2) * (a / 3.0f);
+            normal += n;
+            area += a;
+        }
+        if (area > 0.0f)
+            center /= area;
+        float len = glm::length(normal);
+        sortKey[c] = len > 0.0f ? glm::dot(center - meshCenter, normal / len) : 0.0f;
+    }
+
+    std::vector<unsigned int> order(clusters.size());
+    for (size_t c = 0; c < order.size(); c++)
+        order[c] = (unsigned int)c;
+    std::stable_sort(order.begin(), order.end(), [&](unsigned int a, unsigned int b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<unsigned int> result;
+    result.reserve(indexCount);
+    for (unsigned int c : order)
+    {
+        size_t begin = clusters[c];
+        size_t end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+        result.insert(result.end(), indices + begin * 3, indices + end * 3);
+    }
+    std::memcpy(indices, result.data(), result.size() * sizeof(unsigned int));
+    return true;
+}
+
+// reorder vertices into the order the index buffer first references them and rewrite the indices to match.
+// unreferenced vertices are dropped; returns the new vertex count. Indices out of range leave both buffers untouched
+// and return vertexCount
+// ------------------------------------------------------------------------
+inline size_t optimizeVertexFetch(void* vertices, unsigned int* indices, size_t indexCount, size_t vertexCount, size_t vertexSize)
+{
+    if (!indicesInRange(indices, indexCount, vertexCount))
+        return vertexCount;
+    const unsigned int unused = ~0u;
+    std::vector<unsigned int> remap(vertexCount, unused);
+    unsigned int next = 0;
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        unsigned int& target = remap[indices[i]];
+        if (target == unused)
+            target = next++;
+        indices[i] = target;
+    }
+
+    unsigned char* data = static_cast<unsigned char*>(vertices);
+    std::vector<unsigned char> copy(data, data + vertexCount * vertexSize);
+    for (size_t v = 0; v < vertexCount; v++)
+        if (remap[v] != unused)
+            std::memcpy(data + remap[v] * vertexSize, copy.data() + v * vertexSize, vertexSize);
+    return next;
+}
+
+// narrow an index buffer to 16 bits, which halves index fetch bandwidth. Returns false (leaving out untouched) when
+// a vertex past 65535 is referenced
+// ------------------------------------------------------------------------
+inline bool compactIndices16(const unsigned int* indices, size_t indexCount, std::vector<unsigned short>& out)
+{
+    for (size_t i = 0; i < indexCount; i++)
+        if (indices[i] > 0xFFFF)
+            return false;
+    out.resize(indexCount);
+    for (size_t i = 0; i < indexCount; i++)
+        out[i] = (unsigned short)indices[i];
+    return true;
+}
+
+// run every pass in order and print the cache statistics before and after. positions must be the first attribute
+// of each vertexSize byte vertex. Returns the new vertex count, or vertexCount untouched when indices are out of range
+// ------------------------------------------------------------------------
+inline size_t optimizeMesh(void* vertices, size_t vertexCount, size_t vertexSize, unsigned int* indices, size_t indexCount)
+{
+    if (!indicesInRange(indices, indexCount, vertexCount))
+        return vertexCount;
+    VertexCacheStats before = analyzeVertexCache(indices, indexCount, vertexCount);
+    std::vector<unsigned int> clusters;
+    optimizeVertexCache(indices, indexCount, vertexCount, VERTEX_CACHE_SIZE, &clusters);
+    optimizeOverdraw(indices, indexCount, static_cast<const float*>(vertices), vertexCount, vertexSize, clusters);
+    size_t newVertexCount = optimizeVertexFetch(vertices, indices, indexCount, vertexCount, vertexSize);
+    VertexCacheStats after = analyzeVertexCache(indices, indexCount, newVertexCount);
+    printVertexCacheStats("BEFORE", before);
+    printVertexCacheStats("AFTER", after);
+    return newVertexCount;
+}
+#endif
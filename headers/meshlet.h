@@ -0,0 +1,247 @@
+#ifndef MESHLET_H
+#define MESHLET_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+//////// MESHLETS ////
+// - a meshlet is a small cluster of triangles (at most 64 vertices / 124 triangles) that is culled as a unit
+// - each meshlet stores a bounding sphere and a normal cone: the cone's axis is the average triangle normal and its
+//      cutoff says how far the normals spread. If the camera sits inside the "back" of the cone every triangle in the
+//      cluster faces away and the whole meshlet can be skipped
+// - the meshlet triangles are also written out as one flat index buffer, ordered meshlet by meshlet, so that each
+//      meshlet is a contiguous range and visible meshlets can be drawn with one glMultiDrawElements call
+// - feed buildMeshlets an index buffer that went through optimizeVertexCache (mesh_optimizer.h): neighbouring
+//      triangles are then already adjacent, which gives tight clusters
+// - meshlet-local vertex indices are bytes, so a meshlet holds at most MESHLET_LOCAL_LIMIT vertices; larger limits
+//      passed to buildMeshlets are clamped to it
+// - meshconv --meshlets builds them for a mesh and reports their fill and how much cullMeshlets removes
+
+const unsigned int MESHLET_MAX_VERTICES = 64;
+const unsigned int MESHLET_MAX_TRIANGLES = 124;
+const unsigned int MESHLET_LOCAL_LIMIT = 255;   // local indices 0-254, 0xFF marks a vertex that isn't in the meshlet
+static_assert(MESHLET_MAX_VERTICES <= MESHLET_LOCAL_LIMIT, "meshlet-local vertex indices are 8 bit");
+
+struct Meshlet
+{
+    uint32_t vertexOffset;      // into MeshletMesh::vertices
+    uint32_t triangleOffset;    // into MeshletMesh::triangles, in triangles
+    uint32_t vertexCount;
+    uint32_t triangleCount;
+    glm::vec3 center;           // bounding sphere
+    float radius;
+    glm::vec3 coneAxis;         // normal cone
+    float coneCutoff;           // sin of the cone's half angle, 1 means the cone can't be used for culling
+};
+
+struct MeshletMesh
+{
+    std::vector<Meshlet> meshlets;
+    std::vector<uint32_t> vertices;     // meshlet-local vertex -> mesh vertex
+    std::vector<uint8_t> triangles;     // three meshlet-local vertex indices per triangle
+    std::vector<unsigned int> indices;  // flat index buffer in meshlet order; meshlet m covers [triangleOffset * 3, +triangleCount * 3)
+};
+
+// visible index ranges, ready for glMultiDrawElements
+struct MeshletDrawList
+{
+    std::vector<GLsizei> counts;
+    std::vector<const void*> offsets;
+    unsigned int trianglesTotal = 0;
+    unsigned int trianglesSubmitted = 0;
+    unsigned int meshletsVisible = 0;
+
+    // draw with the VAO holding MeshletMesh::indices bound
+    // ------------------------------------------------------------------------
+    void draw() const
+    {
+        if (!counts.empty())
+            glMultiDrawElements(GL_TRIANGLES, counts.data(), GL_UNSIGNED_INT, offsets.data(), (GLsizei)counts.size());
+    }
+};
+
+// split an index buffer into meshlets. positions points at the first vertex position, vertexStride is the distance
+// in bytes between vertices. maxVertices is clamped to [3, MESHLET_LOCAL_LIMIT] and maxTriangles to at least 1.
+// Indices past vertexCount give an empty result
+// ------------------------------------------------------------------------
+inline MeshletMesh buildMeshlets(const unsigned int* indices, size_t indexCount, const float* positions, size_t vertexCount, size_t vertexStride,
+                                 unsigned int maxVertices = MESHLET_MAX_VERTICES, unsigned int maxTriangles = MESHLET_MAX_TRIANGLES)
+{
+    MeshletMesh result;
+    maxVertices = std::min(std::max(maxVertices, 3u), MESHLET_LOCAL_LIMIT);
+    maxTriangles = std::max(maxTriangles, 1u);
+    for (size_t i = 0; i < indexCount; i++)
+    {
+        if (indices[i] >= vertexCount)
+        {
+            std::cout << "ERROR::MESHLET::INDEX_OUT_OF_RANGE: index " << i << " is " << indices[i] << ", there are " << vertexCount
+                      << " vertices" << std::endl;
+            return result;
+        }
+    }
+    const unsigned char* base = reinterpret_cast<const unsigned char*>(positions);
+    auto position = [&](uint32_t v)
+    {
+        glm::vec3 p;
+        std::memcpy(&p[0], base + v * vertexStride, sizeof(p));
+        return p;
+    };
+
+    // mesh vertex -> local index in the meshlet being built, 0xFF when not in it
+    std::vector<uint8_t> local(vertexCount, 0xFF);
+    Meshlet current = {};
+
+    auto finish = [&]()
+    {
+        if (current.triangleCount == 0)
+            return;
+        // bounding sphere around the AABB center
+        glm::vec3 lo = position(result.vertices[current.vertexOffset]), hi = lo;
+        for (uint32_t i = 1; i < current.vertexCount; i++)
+        {
+            glm::vec3 p = position(result.vertices[current.vertexOffset + i]);
+            lo = glm::min(lo, p);
+            hi = glm::max(hi, p);
+        }
+        current.center = (lo + hi) * 0.5f;
+        current.radius = 0.0f;
+        for (uint32_t i = 0; i < current.vertexCount; i++)
+            current.radius = glm::max(current.radius, glm::length(position(result.vertices[current.vertexOffset + i]) - current.center));
+
+        // normal cone from the area weighted average normal and the widest normal around it
+        std::vector<glm::vec3> normals(current.triangleCount);
+        glm::vec3 axis(0.0f);
+        for (uint32_t t = 0; t < current.triangleCount; t++)
+        {
+            const uint8_t* tri = &result.triangles[(current.triangleOffset + t) * 3];
+            glm::vec3 p0 = position(result.vertices[current.vertexOffset + tri[0]]);
+            glm::vec3 p1 = position(result.vertices[current.vertexOffset + tri[1]]);
+            glm::vec3 p2 = position(result.vertices[current.vertexOffset + tri[2]]);
+            glm::vec3 n = glm::cross(p1 - p0, p2 - p0);
+            axis += n;
+            float len = glm::length(n);
+            normals[t] = len > 0.0f ? n / len : glm::vec3(0.0f);
+        }
+        float axisLength = glm::length(axis);
+        current.coneAxis = axisLength > 0.0f ? axis / axisLength : glm::vec3(0.0f, 0.0f, 1.0f);
+        float minDot = 1.0f;
+        for (const glm::vec3& n : normals)
+            if (n != glm::vec3(0.0f))
+                minDot = glm::min(minDot, glm::dot(n, current.coneAxis));
+        // normals spread over more than a hemisphere can never all face away
+        current.coneCutoff = axisLength > 0.0f && minDot > 0.0f ? std::sqrt(1.0f - minDot * minDot) : 1.0f;
+
+        result.meshlets.push_back(current);
+        for (uint32_t i = 0; i < current.vertexCount; i++)
+            local[result.vertices[current.vertexOffset + i]] = 0xFF;
+        current = Meshlet();
+        current.vertexOffset = (uint32_t)result.vertices.size();
+        current.triangleOffset = (uint32_t)(result.triangles.size() / 3);
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3)
+    {
+        unsigned int newVertices = 0;
+        for (int k = 0; k < 3; k++)
+            if (local[indices[i + k]] == 0xFF)
+                newVertices++;
+        if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1 > maxTriangles)
+            finish();
+        for (int k = 0; k < 3; k++)
+        {
+            uint32_t v = indices[i + k];
+            if (local[v] == 0xFF)
+            {
+                local[v] = (uint8_t)current.vertexCount++;
+                result.vertices.push_back(v);
+            }
+            result.triangles.push_back(local[v]);
+        }
+        current.triangleCount++;
+    }
+    finish();
+
+    result.indices.resize(result.triangles.size());
+    for (const Meshlet& m : result.meshlets)
+        for (uint32_t t = 0; t < m.triangleCount * 3; t++)
+            result.indices[m.triangleOffset * 3 + t] = result.vertices[m.vertexOffset + result.triangles[m.triangleOffset * 3 + t]];
+    return result;
+}
+
+// the six frustum planes (xyz = inward normal, w = distance) of a view-projection matrix, Gribb/Hartmann style
+// ------------------------------------------------------------------------
+inline void extractFrustumPlanes(const glm::mat4& viewProjection, glm::vec4 planes[6])
+{
+    glm::mat4 m = glm::transpose(viewProjection);
+    planes[0] = m[3] + m[0]; // left
+    planes[1] = m[3] - m[0]; // right
+    planes[2] = m[3] + m[1]; // bottom
+    planes[3] = m[3] - m[1]; // top
+    planes[4] = m[3] + m[2]; // near for GL's [-1, 1] depth; looser than needed, but still safe, with [0, 1] depth
+    planes[5] = m[3] - m[2]; // far; with the camera's reversed-Z projection this turns into the near plane instead
+    for (int i = 0; i < 6; i++)
+    {
+        float len = glm::length(glm::vec3(planes[i]));
+        if (len > 0.0f)
+            planes[i] /= len;
+    }
+}
+
+// cull every meshlet against the frustum and its normal cone, and merge the survivors into as few index ranges as
+// possible. model must be rotation, translation and uniform scale only
+// ------------------------------------------------------------------------
+inline void cullMeshlets(const MeshletMesh& mesh, const glm::mat4& model, const glm::mat4& viewProjection, const glm::vec3& cameraPos, MeshletDrawList& out)
+{
+    out.counts.clear();
+    out.offsets.clear();
+    out.trianglesTotal = 0;
+    out.trianglesSubmitted = 0;
+    out.meshletsVisible = 0;
+
+    glm::vec4 planes[6];
+    extractFrustumPlanes(viewProjection * model, planes);
+    // the cone test needs world space, which for a similarity transform is just the model matrix
+    glm::mat3 linear(model);
+    float scale = glm::length(linear[0]);
+
+    for (const Meshlet& m : mesh.meshlets)
+    {
+        out.trianglesTotal += m.triangleCount;
+        bool visible = true;
+        for (int i = 0; i < 6 && visible; i++)
+        {
+            // planes were built from the model-view-projection matrix, so they live in object space
+            visible = glm::dot(glm::vec3(planes[i]), m.center) + planes[i].w > -m.radius;
+        }
+        if (visible && m.coneCutoff < 1.0f)
+        {
+            glm::vec3 center = glm::vec3(model * glm::vec4(m.center, 1.0f));
+            glm::vec3 axis = glm::normalize(linear * m.coneAxis);
+            glm::vec3 toCenter = center - cameraPos;
+            visible = glm::dot(toCenter, axis) < m.coneCutoff * glm::length(toCenter) + m.radius * scale;
+        }
+        if (!visible)
+            continue;
+
+        out.meshletsVisible++;
+        out.trianglesSubmitted += m.triangleCount;
+        const void* offset = (const void*)((size_t)m.triangleOffset * 3 * sizeof(unsigned int));
+        GLsizei count = (GLsizei)(m.triangleCount * 3);
+        // meshlets that are next to each other in the index buffer become one range
+        if (!out.counts.empty() && (const char*)out.offsets.back() + out.counts.back() * sizeof(unsigned int) == (const char*)offset)
+            out.counts.back() += count;
+        else
+        {
+            out.counts.push_back(count);
+            out.offsets.push_back(offset);
+        }
+    }
+}
+#endif
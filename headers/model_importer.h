@@ -0,0 +1,931 @@
+#ifndef MODEL_IMPORTER_H
+#define MODEL_IMPORTER_H
+
+#include <glm/glm.hpp>
+
+#include <mapped_file.h>
+#include <mesh_file.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cctype>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MODEL_IMPORTER_SSE2 1
+#endif
+
+//////// MODEL IMPORTER ////
+// - brings OBJ and glTF 2.0 (.gltf + .bin or .glb) files into one indexed vertex/index buffer pair, ready for the
+//      VAO/VBO/EBO setup the samples use or for writing out as a .mesh file
+// - OBJ: the mapped file is split into one chunk per thread at line boundaries, every chunk is parsed in parallel with
+//      std::from_chars, then the chunks are stitched together and position/uv/normal triplets deduplicated
+// - glTF: the JSON is parsed into an arena with strings left as views into the source text, and accessors read
+//      straight out of the mapped .bin/.glb buffers
+// - only geometry is imported: node transforms, skins and materials other than the material index are ignored
+
+// vertex layout produced by the importer
+struct ModelVertex
+{
+    glm::vec3 position;
+    glm::vec2 texCoord;
+    glm::vec3 normal;
+};
+
+struct ImportedMesh
+{
+    std::vector<ModelVertex> vertices;
+    std::vector<unsigned int> indices;
+    std::vector<MeshFileSubmesh> submeshes; // index ranges into indices, with bounds filled in
+};
+
+struct ModelImportStats
+{
+    size_t bytes = 0;
+    double seconds = 0.0;
+    unsigned int threads = 1;
+
+    double megabytesPerSecond() const { return seconds > 0.0 ? (double)bytes / (1024.0 * 1024.0) / seconds : 0.0; }
+};
+
+// Bump allocator; everything allocated from it is freed at once when it goes away
+class Arena
+{
+public:
+    explicit Arena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+    // ------------------------------------------------------------------------
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t))
+    {
+        size_t offset = (used + alignment - 1) & ~(alignment - 1);
+        if (blocks.empty() || offset + bytes > capacity)
+        {
+            capacity = std::max(blockSize, bytes);
+            // new[] hands back memory aligned for any fundamental type, so a fresh block starts aligned
+            blocks.emplace_back(new unsigned char[capacity]);
+            offset = 0;
+        }
+        used = offset + bytes;
+        return blocks.back().get() + offset;
+    }
+    template <typename T>
+    T* allocateArray(size_t count) { return static_cast<T*>(allocate(sizeof(T) * std::max<size_t>(count, 1), alignof(T))); }
+
+private:
+    std::vector<std::unique_ptr<unsigned char[]>> blocks;
+    size_t blockSize;
+    size_t used = 0;
+    size_t capacity = 0;
+};
+
+//////// JSON ////
+
+struct JsonMember;
+
+struct JsonValue
+{
+    enum Type { Null, Bool, Number, String, Array, Object };
+    Type type = Null;
+    double number = 0.0;            // Number, and Bool as 0/1
+    std::string_view string;        // String, escapes left untouched
+    JsonMember* members = NULL;     // Array and Object children, contiguous in the arena
+    size_t count = 0;
+
+    // ------------------------------------------------------------------------
+    const JsonValue* find(std::string_view key) const;
+    const JsonValue* at(size_t index) const;
+    double numberOr(std::string_view key, double fallback) const
+    {
+        const JsonValue* v = find(key);
+        return v && v->type == Number ? v->number : fallback;
+    }
+    // a count, offset or index: fallback when missing, JSON_INVALID_SIZE unless a whole number in [0, 2^32)
+    size_t sizeOr(std::string_view key, size_t fallback) const
+    {
+        const JsonValue* v = find(key);
+        return v ? v->asSize() : fallback;
+    }
+    size_t asSize() const;
+};
+
+struct JsonMember
+{
+    std::string_view key;           // empty for array elements
+    JsonValue value;
+};
+
+inline const JsonValue* JsonValue::find(std::string_view key) const
+{
+    if (type != Object)
+        return NULL;
+    for (size_t i = 0; i < count; i++)
+        if (members[i].key == key)
+            return &members[i].value;
+    return NULL;
+}
+const size_t JSON_INVALID_SIZE = ~(size_t)0;
+
+inline size_t JsonValue::asSize() const
+{
+    if (type != Number || !(number >= 0.0 && number < 4294967296.0) || number != (double)(uint64_t)number)
+        return JSON_INVALID_SIZE;
+    return (size_t)number;
+}
+inline const JsonValue* JsonValue::at(size_t index) const
+{
+    return type == Array && index < count ? &members[index].value : NULL;
+}
+
+// containers nested deeper than this are rejected, so a hostile file can't recurse the parser off the stack; real glTF
+//      documents stay well under 10
+const int JSON_MAX_DEPTH = 64;
+
+// Recursive descent JSON parser that builds its tree in an Arena
+class JsonParser
+{
+public:
+    JsonParser(Arena& arena, const char* text, size_t length) : arena(arena), p(text), end(text + length) {}
+    // ------------------------------------------------------------------------
+    bool parse(JsonValue& root)
+    {
+        if (!parseValue(root))
+            return false;
+        skipSpace();
+        return p == end;
+    }
+
+private:
+    Arena& arena;
+    const char* p;
+    const char* end;
+    std::vector<JsonMember> scratch; // children of the containers currently being parsed
+    int depth = 0;
+
+    void skipSpace()
+    {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+            p++;
+    }
+    bool literal(const char* word)
+    {
+        size_t n = std::strlen(word);
+        if ((size_t)(end - p) < n || std::memcmp(p, word, n) != 0)
+            return false;
+        p += n;
+        return true;
+    }
+    bool parseString(std::string_view& out)
+    {
+        if (p >= end || *p != '"')
+            return false;
+        const char* begin = ++p;
+        while (p < end && *p != '"')
+            p += *p == '\\' ? 2 : 1;
+        if (p >= end)
+            return false;
+        out = std::string_view(begin, (size_t)(p - begin));
+        p++;
+        return true;
+    }
+    bool parseValue(JsonValue& value)
+    {
+        skipSpace();
+        if (p >= end)
+            return false;
+        switch (*p)
+        {
+        case '{': return parseContainer(value, JsonValue::Object, '}');
+        case '[': return parseContainer(value, JsonValue::Array, ']');
+        case '"': value.type = JsonValue::String; return parseString(value.string);
+        case 't': value.type = JsonValue::Bool; value.number = 1.0; return literal("true");
+        case 'f': value.type = JsonValue::Bool; value.number = 0.0; return literal("false");
+        case 'n': value.type = JsonValue::Null; return literal("null");
+        default:
+        {
+            value.type = JsonValue::Number;
+            std::from_chars_result r = std::from_chars(p, end, value.number);
+            if (r.ec != std::errc())
+                return false;
+            p = r.ptr;
+            return true;
+        }
+        }
+    }
+    bool parseContainer(JsonValue& value, JsonValue::Type type, char close)
+    {
+        if (depth >= JSON_MAX_DEPTH)
+            return false;
+        depth++;
+        bool ok = parseMembers(value, type, close);
+        depth--;
+        return ok;
+    }
+    bool parseMembers(JsonValue& value, JsonValue::Type type, char close)
+    {
+        value.type = type;
+        p++;
+        size_t base = scratch.size();
+        skipSpace();
+        if (p < end && *p == close)
+            p++;
+        else
+        {
+            while (true)
+            {
+                JsonMember member;
+                skipSpace();
+                if (type == JsonValue::Object)
+                {
+                    if (!parseString(member.key))
+                        return false;
+                    skipSpace();
+                    if (p >= end || *p++ != ':')
+                        return false;
+                }
+                if (!parseValue(member.value))
+                    return false;
+                scratch.push_back(member);
+                skipSpace();
+                if (p < end && *p == ',')
+                {
+                    p++;
+                    continue;
+                }
+                if (p < end && *p == close)
+                {
+                    p++;
+                    break;
+                }
+                return false;
+            }
+        }
+        value.count = scratch.size() - base;
+        value.members = arena.allocateArray<JsonMember>(value.count);
+        std::copy(scratch.begin() + base, scratch.end(), value.members);
+        scratch.resize(base);
+        return true;
+    }
+};
+
+//////// VERTEX DEDUPLICATION ////
+
+// position/uv/normal index triplet, padded to 16 bytes so a whole key compares in one SSE2 instruction
+struct alignas(16) VertexKey
+{
+    int32_t v, vt, vn, pad;
+};
+
+// Open addressing hash map from VertexKey to vertex index
+class VertexKeyMap
+{
+public:
+    explicit VertexKeyMap(size_t expected = 1024)
+    {
+        size_t capacity = 16;
+        while (capacity < expected * 2)
+            capacity *= 2;
+        rehash(capacity);
+    }
+    // returns the value already stored for key, or stores and returns value
+    // ------------------------------------------------------------------------
+    uint32_t findOrInsert(const VertexKey& key, uint32_t value)
+    {
+        if ((size + 1) * 2 > keys.size())
+            rehash(keys.size() * 2);
+        size_t mask = keys.size() - 1;
+        for (size_t slot = hash(key) & mask;; slot = (slot + 1) & mask)
+        {
+            if (keys[slot].pad == EMPTY)
+            {
+                keys[slot] = key;
+                keys[slot].pad = 0;
+                values[slot] = value;
+                size++;
+                return value;
+            }
+            if (equal(keys[slot], key))
+                return values[slot];
+        }
+    }
+
+private:
+    static const int32_t EMPTY = -1;
+    std::vector<VertexKey> keys;
+    std::vector<uint32_t> values;
+    size_t size = 0;
+
+    static size_t hash(const VertexKey& k)
+    {
+        uint64_t h = (uint64_t)(uint32_t)k.v * 0x9E3779B97F4A7C15ull;
+        h ^= (uint64_t)(uint32_t)k.vt * 0xC2B2AE3D27D4EB4Full + (h >> 29);
+        h ^= (uint64_t)(uint32_t)k.vn * 0x165667B19E3779F9ull + (h >> 32);
+        return (size_t)(h ^ (h >> 31));
+    }
+    static bool equal(const VertexKey& a, const VertexKey& b)
+    {
+#ifdef MODEL_IMPORTER_SSE2
+        __m128i x = _mm_load_si128(reinterpret_cast<const __m128i*>(&a));
+        __m128i y = _mm_load_si128(reinterpret_cast<const __m128i*>(&b));
+        // pad is 0 in stored keys and in lookups, so all four lanes have to match
+        return _mm_movemask_epi8(_mm_cmpeq_epi32(x, y)) == 0xFFFF;
+#else
+        return a.v == b.v && a.vt == b.vt && a.vn == b.vn;
+#endif
+    }
+    void rehash(size_t capacity)
+    {
+        std::vector<VertexKey> oldKeys(capacity);
+        std::vector<uint32_t> oldValues(capacity);
+        for (VertexKey& k : oldKeys)
+            k.pad = EMPTY;
+        oldKeys.swap(keys);
+        oldValues.swap(values);
+        size = 0;
+        for (size_t i = 0; i < oldKeys.size(); i++)
+            if (oldKeys[i].pad != EMPTY)
+                findOrInsert(oldKeys[i], oldValues[i]);
+    }
+};
+
+//////// SHARED HELPERS ////
+
+// fill in every submesh's bounds from the vertices it references
+// ------------------------------------------------------------------------
+inline void computeSubmeshBounds(ImportedMesh& mesh)
+{
+    for (MeshFileSubmesh& s : mesh.submeshes)
+    {
+        glm::vec3 lo(0.0f), hi(0.0f);
+        for (uint32_t i = s.firstIndex; i < s.firstIndex + s.indexCount; i++)
+        {
+            glm::vec3 p = mesh.vertices[mesh.indices[i]].position;
+            lo = i == s.firstIndex ? p : glm::min(lo, p);
+            hi = i == s.firstIndex ? p : glm::max(hi, p);
+        }
+        std::memcpy(s.boundsMin, &lo[0], sizeof(lo));
+        std::memcpy(s.boundsMax, &hi[0], sizeof(hi));
+    }
+}
+
+inline void printImportStats(const char* path, const ModelImportStats& stats)
+{
+    std::cout << "MODEL_IMPORTER:: " << path << ": " << stats.bytes / 1024 << " KB in " << stats.seconds * 1000.0 << " ms on "
+              << stats.threads << " thread(s), " << stats.megabytesPerSecond() << " MB/s" << std::endl;
+}
+
+//////// OBJ ////
+
+// what one thread pulls out of its slice of an OBJ file. Corners refer to global indices when the file used
+// positive indices. A relative (negative) one can point back into an earlier chunk, whose size isn't known yet, so it
+// is stored against the chunk's own lists: count so far + index, which goes negative for an earlier chunk, with a bit
+// in the key's pad (OBJ_RELATIVE_*) marking it. The stitching adds the chunk's base once all chunks are done
+const int32_t OBJ_RELATIVE_V = 1, OBJ_RELATIVE_VT = 2, OBJ_RELATIVE_VN = 4;
+
+struct ObjChunk
+{
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texCoords;
+    std::vector<VertexKey> corners;         // three per triangle
+    std::vector<size_t> groupStarts;        // corner index of every o/g/usemtl line
+};
+
+inline const char* objSkipSpace(const char* p, const char* end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        p++;
+    return p;
+}
+inline const char* objFloat(const char* p, const char* end, float& out)
+{
+    p = objSkipSpace(p, end);
+    if (p < end && *p == '+')
+        p++;
+    std::from_chars_result r = std::from_chars(p, end, out);
+    return r.ec == std::errc() ? r.ptr : p;
+}
+// OBJ indices are 1-based, 0 (missing) becomes -1. Relative ones become chunk-local and set relativeBit in flags
+inline int32_t objIndex(int32_t index, size_t localCount, int32_t relativeBit, int32_t& flags)
+{
+    if (index > 0)
+        return index - 1;
+    if (index < 0)
+    {
+        flags |= relativeBit;
+        return (int32_t)localCount + index;
+    }
+    return -1;
+}
+
+inline void parseObjChunk(const char* p, const char* end, ObjChunk& chunk)
+{
+    std::vector<VertexKey> polygon;
+    while (p < end)
+    {
+        const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', (size_t)(end - p)));
+        if (lineEnd == NULL)
+            lineEnd = end;
+        p = objSkipSpace(p, lineEnd);
+        if (lineEnd - p >= 2 && p[0] == 'v' && p[1] == ' ')
+        {
+            glm::vec3 v(0.0f);
+            const char* q = objFloat(p + 2, lineEnd, v.x);
+            q = objFloat(q, lineEnd, v.y);
+            objFloat(q, lineEnd, v.z);
+            chunk.positions.push_back(v);
+        }
+        else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 't' && p[2] == ' ')
+        {
+            glm::vec2 t(0.0f);
+            objFloat(objFloat(p + 3, lineEnd, t.x), lineEnd, t.y);
+            chunk.texCoords.push_back(t);
+        }
+        else if (lineEnd - p >= 3 && p[0] == 'v' && p[1] == 'n' && p[2] == ' ')
+        {
+            glm::vec3 n(0.0f);
+            const char* q = objFloat(p + 3, lineEnd, n.x);
+            q = objFloat(q, lineEnd, n.y);
+            objFloat(q, lineEnd, n.z);
+            chunk.normals.push_back(n);
+        }
+        else if (lineEnd - p >= 2 && p[0] == 'f' && p[1] == ' ')
+        {
+            polygon.clear();
+            const char* q = p + 2;
+            while (true)
+            {
+                q = objSkipSpace(q, lineEnd);
+                if (q >= lineEnd || *q == '\r')
+                    break;
+                // v, v/vt, v//vn or v/vt/vn
+                int32_t raw[3] = { 0, 0, 0 };
+                for (int k = 0; k < 3; k++)
+                {
+                    std::from_chars_result r = std::from_chars(q, lineEnd, raw[k]);
+                    q = r.ptr;
+                    if (q >= lineEnd || *q != '/')
+                        break;
+                    q++;
+                }
+                while (q < lineEnd && *q != ' ' && *q != '\t' && *q != '\r')
+                    q++;
+                VertexKey key = { 0, 0, 0, 0 };
+                key.v = objIndex(raw[0], chunk.positions.size(), OBJ_RELATIVE_V, key.pad);
+                key.vt = objIndex(raw[1], chunk.texCoords.size(), OBJ_RELATIVE_VT, key.pad);
+                key.vn = objIndex(raw[2], chunk.normals.size(), OBJ_RELATIVE_VN, key.pad);
+                polygon.push_back(key);
+            }
+            for (size_t i = 2; i < polygon.size(); i++)
+            {
+                chunk.corners.push_back(polygon[0]);
+                chunk.corners.push_back(polygon[i - 1]);
+                chunk.corners.push_back(polygon[i]);
+            }
+        }
+        else if ((lineEnd - p >= 2 && (p[0] == 'o' || p[0] == 'g') && p[1] == ' ') ||
+                 (lineEnd - p >= 6 && std::memcmp(p, "usemtl", 6) == 0))
+        {
+            chunk.groupStarts.push_back(chunk.corners.size());
+        }
+        p = lineEnd + 1;
+    }
+}
+
+// threads = 0 uses one thread per hardware thread
+// ------------------------------------------------------------------------
+inline bool importObj(const char* path, ImportedMesh& mesh, unsigned int threads = 0, ModelImportStats* stats = NULL)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    MappedFile file;
+    if (!file.open(path))
+        return false;
+    file.willNeed();
+    const char* text = reinterpret_cast<const char*>(file.data());
+    size_t size = file.size();
+
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    // don't bother splitting small files
+    threads = (unsigned int)std::max<size_t>(1, std::min<size_t>(threads, size / (256 * 1024)));
+
+    // split at line boundaries
+    std::vector<const char*> bounds(threads + 1, text + size);
+    bounds[0] = text;
+    for (unsigned int t = 1; t < threads; t++)
+    {
+        const char* p = std::max(text + size * t / threads, bounds[t - 1]);
+        const char* nl = static_cast<const char*>(std::memchr(p, '\n', (size_t)(text + size - p)));
+        bounds[t] = nl ? nl + 1 : text + size;
+    }
+
+    std::vector<ObjChunk> chunks(threads);
+    std::vector<std::thread> workers;
+    for (unsigned int t = 1; t < threads; t++)
+        workers.emplace_back(parseObjChunk, bounds[t], bounds[t + 1], std::ref(chunks[t]));
+    parseObjChunk(bounds[0], bounds[1], chunks[0]);
+    for (std::thread& w : workers)
+        w.join();
+
+    // stitch the chunks together: concatenate attribute lists, turn relative indices global, dedup corners
+    std::vector<glm::vec3> positions, normals;
+    std::vector<glm::vec2> texCoords;
+    size_t cornerCount = 0;
+    for (const ObjChunk& c : chunks)
+        cornerCount += c.corners.size();
+
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.submeshes.clear();
+    mesh.indices.reserve(cornerCount);
+    VertexKeyMap unique(cornerCount / 4);
+    std::vector<size_t> groupStarts;
+
+    std::vector<glm::ivec3> bases; // where each chunk's positions, texture coords and normals start
+    for (const ObjChunk& c : chunks)
+    {
+        bases.push_back(glm::ivec3((int)positions.size(), (int)texCoords.size(), (int)normals.size()));
+        positions.insert(positions.end(), c.positions.begin(), c.positions.end());
+        texCoords.insert(texCoords.end(), c.texCoords.begin(), c.texCoords.end());
+        normals.insert(normals.end(), c.normals.begin(), c.normals.end());
+    }
+    for (size_t i = 0; i < chunks.size(); i++)
+    {
+        const ObjChunk& c = chunks[i];
+        for (size_t g : c.groupStarts)
+            groupStarts.push_back(mesh.indices.size() + g);
+        for (VertexKey key : c.corners)
+        {
+            if (key.pad & OBJ_RELATIVE_V) key.v += bases[i].x;
+            if (key.pad & OBJ_RELATIVE_VT) key.vt += bases[i].y;
+            if (key.pad & OBJ_RELATIVE_VN) key.vn += bases[i].z;
+            // a texture coord or normal may be left out (-1 without the relative bit), anything else has to exist
+            bool vtGiven = key.vt != -1 || (key.pad & OBJ_RELATIVE_VT);
+            bool vnGiven = key.vn != -1 || (key.pad & OBJ_RELATIVE_VN);
+            if (key.v < 0 || key.v >= (int32_t)positions.size() || (vtGiven && (key.vt < 0 || key.vt >= (int32_t)texCoords.size())) ||
+                (vnGiven && (key.vn < 0 || key.vn >= (int32_t)normals.size())))
+            {
+                std::cout << "ERROR::MODEL_IMPORTER::INVALID_OBJ: " << path << " (face refers to a vertex, texture coord or normal "
+                          << "that isn't in the file)" << std::endl;
+                mesh = ImportedMesh();
+                return false;
+            }
+            key.pad = 0;
+            uint32_t index = unique.findOrInsert(key, (uint32_t)mesh.vertices.size());
+            if (index == mesh.vertices.size())
+            {
+                ModelVertex vertex;
+                vertex.position = positions[key.v];
+                vertex.texCoord = vtGiven ? texCoords[key.vt] : glm::vec2(0.0f);
+                vertex.normal = vnGiven ? normals[key.vn] : glm::vec3(0.0f, 0.0f, 1.0f);
+                mesh.vertices.push_back(vertex);
+            }
+            mesh.indices.push_back(index);
+        }
+    }
+    groupStarts.push_back(mesh.indices.size());
+
+    MeshFileSubmesh submesh = {};
+    for (size_t g : groupStarts)
+    {
+        submesh.indexCount = (uint32_t)(g - submesh.firstIndex);
+        if (submesh.indexCount > 0)
+            mesh.submeshes.push_back(submesh);
+        submesh.firstIndex = (uint32_t)g;
+    }
+    computeSubmeshBounds(mesh);
+
+    if (stats)
+    {
+        stats->bytes = size;
+        stats->threads = threads;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+//////// GLTF ////
+
+const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+// A loaded glTF document: the JSON tree plus every buffer it references, mapped and used in place
+class GltfDocument
+{
+public:
+    JsonValue root;
+    std::vector<std::string_view> buffers; // bytes of each buffer, pointing into a mapping
+
+    // ------------------------------------------------------------------------
+    bool load(const char* path)
+    {
+        if (!file.open(path))
+            return false;
+        file.willNeed();
+        const unsigned char* data = file.data();
+        size_t size = file.size();
+        const char* json = reinterpret_cast<const char*>(data);
+        size_t jsonLength = size;
+        std::string_view glbBinary;
+
+        uint32_t header[3] = { 0, 0, 0 };
+        if (size >= 12)
+            std::memcpy(header, data, sizeof(header));
+        if (header[0] == GLB_MAGIC)
+        {
+            // .glb: 12 byte header, then length/type prefixed chunks; JSON first, binary buffer second
+            size_t offset = 12;
+            json = NULL;
+            while (offset + 8 <= size)
+            {
+                uint32_t chunk[2];
+                std::memcpy(chunk, data + offset, sizeof(chunk));
+                if (chunk[0] > size - offset - 8)
+                    break;
+                const char* payload = reinterpret_cast<const char*>(data + offset + 8);
+                if (chunk[1] == GLB_CHUNK_JSON)
+                {
+                    json = payload;
+                    jsonLength = chunk[0];
+                }
+                else if (chunk[1] == GLB_CHUNK_BIN)
+                    glbBinary = std::string_view(payload, chunk[0]);
+                offset += 8 + ((chunk[0] + 3) & ~3u);
+            }
+            if (json == NULL)
+                return invalid(path, "no JSON chunk");
+        }
+
+        JsonParser parser(arena, json, jsonLength);
+        if (!parser.parse(root) || root.type != JsonValue::Object)
+            return invalid(path, "malformed JSON");
+
+        std::string directory(path);
+        size_t slash = directory.find_last_of("/\\");
+        directory = slash == std::string::npos ? std::string() : directory.substr(0, slash + 1);
+        const JsonValue* bufferList = root.find("buffers");
+        if (bufferList && bufferList->type != JsonValue::Array)
+            return invalid(path, "buffers is not an array");
+        for (size_t i = 0; bufferList && i < bufferList->count; i++)
+        {
+            const JsonValue* buffer = bufferList->at(i);
+            if (buffer == NULL || buffer->type != JsonValue::Object)
+                return invalid(path, "buffer is not an object");
+            const JsonValue* uri = buffer->find("uri");
+            if (uri != NULL && uri->type != JsonValue::String)
+                return invalid(path, "buffer uri is not a string");
+            if (uri == NULL)
+            {
+                // the buffer without a uri is the .glb binary chunk
+                buffers.push_back(glbBinary);
+                continue;
+            }
+            if (uri->string.compare(0, 5, "data:") == 0)
+                return invalid(path, "embedded data: URIs are not supported, export with a .bin or as .glb");
+            externals.emplace_back(new MappedFile());
+            if (!externals.back()->open((directory + std::string(uri->string)).c_str()))
+                return invalid(path, "missing buffer file");
+            externals.back()->willNeed();
+            buffers.push_back(std::string_view(reinterpret_cast<const char*>(externals.back()->data()), externals.back()->size()));
+        }
+        return true;
+    }
+    // total bytes read from disk for this document
+    // ------------------------------------------------------------------------
+    size_t bytes() const
+    {
+        size_t total = file.size();
+        for (const std::unique_ptr<MappedFile>& f : externals)
+            total += f->size();
+        return total;
+    }
+    // read element i of an accessor as floats (normalized integer types are converted), returns false if out of range.
+    //      Every element has to lie inside its buffer, which also bounds the counts a file can claim; accessors without
+    //      a bufferView (sparse ones) aren't supported and read as out of range
+    // ------------------------------------------------------------------------
+    bool readFloats(const JsonValue& accessor, size_t element, float* out, int components) const
+    {
+        const unsigned char* p = elementPointer(accessor, element);
+        if (p == NULL)
+            return false;
+        size_t type = accessor.sizeOr("componentType", 5126);
+        for (int c = 0; c < components; c++)
+        {
+            switch (type)
+            {
+            case 5126: { float v; std::memcpy(&v, p + c * 4, 4); out[c] = v; break; }
+            case 5121: out[c] = p[c] / 255.0f; break;
+            case 5123: { uint16_t v; std::memcpy(&v, p + c * 2, 2); out[c] = v / 65535.0f; break; }
+            case 5120: out[c] = std::max((int8_t)p[c] / 127.0f, -1.0f); break;
+            case 5122: { int16_t v; std::memcpy(&v, p + c * 2, 2); out[c] = std::max(v / 32767.0f, -1.0f); break; }
+            default: return false;
+            }
+        }
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    bool readIndex(const JsonValue& accessor, size_t element, uint32_t& out) const
+    {
+        const unsigned char* p = elementPointer(accessor, element);
+        if (p == NULL)
+            return false;
+        switch (accessor.sizeOr("componentType", 5125))
+        {
+        case 5121: out = p[0]; return true;
+        case 5123: { uint16_t v; std::memcpy(&v, p, 2); out = v; return true; }
+        case 5125: std::memcpy(&out, p, 4); return true;
+        }
+        return false;
+    }
+    // the accessor an index refers to; NULL unless the index is valid and points at an object
+    // ------------------------------------------------------------------------
+    const JsonValue* accessor(const JsonValue* index) const
+    {
+        const JsonValue* accessors = root.find("accessors");
+        if (index == NULL || accessors == NULL)
+            return NULL;
+        const JsonValue* found = accessors->at(index->asSize());
+        return found && found->type == JsonValue::Object ? found : NULL;
+    }
+    // ------------------------------------------------------------------------
+    bool invalid(const char* path, const char* reason) const
+    {
+        std::cout << "ERROR::MODEL_IMPORTER::INVALID_GLTF: " << path << " (" << reason << ")" << std::endl;
+        return false;
+    }
+
+private:
+    Arena arena;
+    MappedFile file;
+    std::vector<std::unique_ptr<MappedFile>> externals;
+
+    static size_t componentSize(size_t type) { return type == 5126 || type == 5125 ? 4 : type == 5122 || type == 5123 ? 2 : 1; }
+    static size_t componentCount(std::string_view type)
+    {
+        if (type == "SCALAR") return 1;
+        if (type == "VEC2") return 2;
+        if (type == "VEC3") return 3;
+        if (type == "VEC4" || type == "MAT2") return 4;
+        if (type == "MAT3") return 9;
+        if (type == "MAT4") return 16;
+        return 0;
+    }
+    // ------------------------------------------------------------------------
+    const unsigned char* elementPointer(const JsonValue& accessor, size_t element) const
+    {
+        const JsonValue* views = root.find("bufferViews");
+        const JsonValue* viewIndex = accessor.find("bufferView");
+        const JsonValue* type = accessor.find("type");
+        size_t count = accessor.sizeOr("count", 0);
+        if (views == NULL || viewIndex == NULL || type == NULL || count == JSON_INVALID_SIZE || element >= count)
+            return NULL;
+        const JsonValue* view = views->at(viewIndex->asSize());
+        if (view == NULL || view->type != JsonValue::Object)
+            return NULL;
+        size_t buffer = view->sizeOr("buffer", JSON_INVALID_SIZE);
+        if (buffer >= buffers.size())
+            return NULL;
+        size_t elementSize = componentSize(accessor.sizeOr("componentType", 5126)) * componentCount(type->string);
+        if (elementSize == 0)
+            return NULL;
+        size_t stride = view->sizeOr("byteStride", 0);
+        size_t viewOffset = view->sizeOr("byteOffset", 0);
+        size_t viewLength = view->sizeOr("byteLength", JSON_INVALID_SIZE);
+        size_t accessorOffset = accessor.sizeOr("byteOffset", 0);
+        if (stride == JSON_INVALID_SIZE || viewOffset == JSON_INVALID_SIZE || viewLength == JSON_INVALID_SIZE || accessorOffset == JSON_INVALID_SIZE)
+            return NULL;
+        if (stride == 0)
+            stride = elementSize;
+        // the view has to lie in its buffer and the whole accessor, not just this element, in the view. Every term is
+        //      below 2^32 (count is too), so none of the sums can wrap in 64 bits
+        uint64_t accessorEnd = (uint64_t)accessorOffset + (uint64_t)(count - 1) * stride + elementSize;
+        if ((uint64_t)viewOffset + viewLength > buffers[buffer].size() || accessorEnd > viewLength)
+            return NULL;
+        uint64_t offset = (uint64_t)viewOffset + accessorOffset + (uint64_t)element * stride;
+        return reinterpret_cast<const unsigned char*>(buffers[buffer].data()) + offset;
+    }
+};
+
+// every triangle-list primitive of every mesh becomes one submesh
+// ------------------------------------------------------------------------
+inline bool importGltf(const char* path, ImportedMesh& mesh, ModelImportStats* stats = NULL)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    GltfDocument doc;
+    if (!doc.load(path))
+        return false;
+
+    mesh.vertices.clear();
+    mesh.indices.clear();
+    mesh.submeshes.clear();
+    // every lookup is checked: a file that doesn't have the shape glTF promises fails with a message instead of
+    //      importing garbage or crashing, and leaves the mesh empty
+    auto fail = [&](const char* reason)
+    {
+        mesh = ImportedMesh();
+        return doc.invalid(path, reason);
+    };
+    const JsonValue* meshes = doc.root.find("meshes");
+    if (meshes && meshes->type != JsonValue::Array)
+        return fail("meshes is not an array");
+    for (size_t m = 0; meshes && m < meshes->count; m++)
+    {
+        const JsonValue* gltfMesh = meshes->at(m);
+        const JsonValue* primitives = gltfMesh ? gltfMesh->find("primitives") : NULL;
+        if (primitives == NULL || primitives->type != JsonValue::Array)
+            return fail("mesh without a primitives array");
+        for (size_t p = 0; p < primitives->count; p++)
+        {
+            const JsonValue* primitive = primitives->at(p);
+            if (primitive == NULL || primitive->type != JsonValue::Object)
+                return fail("primitive is not an object");
+            const JsonValue* attributes = primitive->find("attributes");
+            if (attributes == NULL || primitive->sizeOr("mode", 4) != 4)
+                continue;
+            const JsonValue* positionIndex = attributes->find("POSITION");
+            const JsonValue* normalIndex = attributes->find("NORMAL");
+            const JsonValue* texCoordIndex = attributes->find("TEXCOORD_0");
+            const JsonValue* indicesIndex = primitive->find("indices");
+            const JsonValue* position = doc.accessor(positionIndex);
+            const JsonValue* normal = doc.accessor(normalIndex);
+            const JsonValue* texCoord = doc.accessor(texCoordIndex);
+            const JsonValue* indices = doc.accessor(indicesIndex);
+            if (positionIndex == NULL)
+                continue;
+            if (position == NULL || (normalIndex && normal == NULL) || (texCoordIndex && texCoord == NULL) || (indicesIndex && indices == NULL))
+                return fail("primitive refers to a missing accessor");
+
+            uint32_t baseVertex = (uint32_t)mesh.vertices.size();
+            size_t vertexCount = position->sizeOr("count", 0);
+            if (vertexCount == 0)
+                continue;
+            for (size_t v = 0; v < vertexCount; v++)
+            {
+                ModelVertex vertex;
+                vertex.position = glm::vec3(0.0f);
+                vertex.texCoord = glm::vec2(0.0f);
+                vertex.normal = glm::vec3(0.0f, 0.0f, 1.0f);
+                if (!doc.readFloats(*position, v, &vertex.position[0], 3) ||
+                    (normal && !doc.readFloats(*normal, v, &vertex.normal[0], 3)) ||
+                    (texCoord && !doc.readFloats(*texCoord, v, &vertex.texCoord[0], 2)))
+                    return fail("vertex accessor runs past its buffer view or buffer");
+                mesh.vertices.push_back(vertex);
+            }
+
+            MeshFileSubmesh submesh = {};
+            submesh.firstIndex = (uint32_t)mesh.indices.size();
+            submesh.materialIndex = (uint32_t)primitive->sizeOr("material", 0);
+            size_t indexCount = indices ? indices->sizeOr("count", 0) : vertexCount;
+            for (size_t i = 0; i < indexCount; i++)
+            {
+                uint32_t index = (uint32_t)i;
+                if (indices && !doc.readIndex(*indices, i, index))
+                    return fail("index accessor runs past its buffer view or buffer");
+                if (index >= vertexCount)
+                    return fail("index past the primitive's vertices");
+                mesh.indices.push_back(baseVertex + index);
+            }
+            // drop a trailing partial triangle
+            mesh.indices.resize(submesh.firstIndex + (mesh.indices.size() - submesh.firstIndex) / 3 * 3);
+            submesh.indexCount = (uint32_t)mesh.indices.size() - submesh.firstIndex;
+            if (submesh.indexCount > 0)
+                mesh.submeshes.push_back(submesh);
+        }
+    }
+    computeSubmeshBounds(mesh);
+
+    if (stats)
+    {
+        stats->bytes = doc.bytes();
+        stats->threads = 1;
+        stats->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    return true;
+}
+
+// pick the importer from the file extension
+// ------------------------------------------------------------------------
+inline bool importModel(const char* path, ImportedMesh& mesh, ModelImportStats* stats = NULL)
+{
+    std::string_view name(path);
+    size_t dot = name.find_last_of('.');
+    std::string extension(dot == std::string_view::npos ? std::string_view() : name.substr(dot + 1));
+    for (char& c : extension)
+        c = (char)std::tolower((unsigned char)c);
+    if (extension == "obj")
+        return importObj(path, mesh, 0, stats);
+    if (extension == "gltf" || extension == "glb")
+        return importGltf(path, mesh, stats);
+    std::cout << "ERROR::MODEL_IMPORTER::UNKNOWN_FORMAT: " << path << std::endl;
+    return false;
+}
+#endif
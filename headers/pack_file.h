@@ -0,0 +1,388 @@
+#ifndef PACK_FILE_H
+#define PACK_FILE_H
+
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+
+//////// PACK FILES ////
+// - a .pack file holds a whole directory tree in one file, so the samples open one file once and map it instead of
+//      opening every asset separately; an entry that is stored uncompressed is read straight out of the mapping
+// - layout: header | table of contents, sorted by path | path strings | (pad to 4K) entry | (pad to 4K) entry ...
+// - every entry starts on a 4K boundary, i.e. on its own page of the mapping, so touching one entry only pages in
+//      that entry. Paths are relative to the packed directory with '/' separators
+// - entries can be compressed with packCompress(), which writes the LZ4 block format: a greedy single-pass matcher
+//      with a 64K window. Decompressing runs at memcpy-like speeds, and writePackFile() only keeps the compressed
+//      form of an entry when it actually got smaller
+// - all fields are little-endian
+
+const uint32_t PACK_FILE_MAGIC = 0x4B474F4C; // "LOGK"
+const uint32_t PACK_FILE_VERSION = 1;
+const uint64_t PACK_FILE_ALIGNMENT = 4096;
+const uint64_t PACK_LZ4_MAX_RATIO = 255;                // an LZ4 byte can't expand to more than this many
+const uint64_t PACK_MAX_INFLATED_SIZE = 1ull << 31;     // compressed entries are decompressed into memory, keep it sane
+
+enum PackCompression : uint32_t
+{
+    PACK_STORED = 0,
+    PACK_LZ4 = 1,
+};
+
+struct PackFileHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t stringBytes;
+    uint64_t tocOffset;     // byte offsets from the start of the file
+    uint64_t stringOffset;
+};
+
+struct PackFileEntry
+{
+    uint32_t pathOffset;    // into the string table
+    uint32_t pathLength;
+    uint32_t compression;   // PackCompression
+    uint32_t reserved;
+    uint64_t offset;        // 4K aligned
+    uint64_t storedSize;    // bytes in the pack
+    uint64_t size;          // bytes once decompressed
+};
+static_assert(sizeof(PackFileEntry) == 40, "pack entries are written as they are");
+
+//// LZ4 block format ////
+
+// worst case output size of packCompress(): incompressible input costs one length byte per 255 literals
+// ------------------------------------------------------------------------
+inline size_t packCompressBound(size_t size)
+{
+    return size + size / 255 + 16;
+}
+
+inline uint32_t packRead32(const unsigned char* p)
+{
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline unsigned char* packWriteLength(unsigned char* out, size_t length)
+{
+    for (; length >= 255; length -= 255)
+        *out++ = 255;
+    *out++ = (unsigned char)length;
+    return out;
+}
+
+// compress size bytes of src into dst (at least packCompressBound(size) bytes), returns the compressed size.
+// Follows the format's end rules: the last 5 bytes are literals and no match starts in the last 12
+// ------------------------------------------------------------------------
+inline size_t packCompress(const unsigned char* src, size_t size, unsigned char* dst)
+{
+    const int HASH_BITS = 16;
+    std::vector<uint32_t> table((size_t)1 << HASH_BITS, 0);
+    unsigned char* out = dst;
+    size_t anchor = 0;
+    if (size >= 13 && size <= UINT32_MAX)
+    {
+        size_t matchEnd = size - 5;
+        size_t lastStart = size - 12;
+        size_t misses = 0;
+        for (size_t i = 0; i < lastStart;)
+        {
+            uint32_t sequence = packRead32(src + i);
+            uint32_t hash = (sequence * 2654435761u) >> (32 - HASH_BITS);
+            size_t candidate = table[hash];
+            table[hash] = (uint32_t)i;
+            if (candidate >= i || i - candidate > 65535 || packRead32(src + candidate) != sequence)
+            {
+                // step faster through data that doesn't compress
+                i += 1 + (misses++ >> 6);
+                continue;
+            }
+            misses = 0;
+            size_t length = 4;
+            while (i + length < matchEnd && src[candidate + length] == src[i + length])
+                length++;
+
+            size_t literals = i - anchor;
+            unsigned char* token = out++;
+            *token = (unsigned char)(std::min<size_t>(literals, 15) << 4);
+            if (literals >= 15)
+                out = packWriteLength(out, literals - 15);
+            if (literals)
+                std::memcpy(out, src + anchor, literals);
+            out += literals;
+            size_t offset = i - candidate;
+            *out++ = (unsigned char)offset;
+            *out++ = (unsigned char)(offset >> 8);
+            *token |= (unsigned char)std::min<size_t>(length - 4, 15);
+            if (length - 4 >= 15)
+                out = packWriteLength(out, length - 4 - 15);
+            i += length;
+            anchor = i;
+        }
+    }
+    size_t literals = size - anchor;
+    *out++ = (unsigned char)(std::min<size_t>(literals, 15) << 4);
+    if (literals >= 15)
+        out = packWriteLength(out, literals - 15);
+    if (literals)
+        std::memcpy(out, src + anchor, literals);
+    out += literals;
+    return (size_t)(out - dst);
+}
+
+// decompress into exactly size bytes; every length and offset is checked, so a corrupt pack fails instead of
+//      reading or writing out of bounds
+// ------------------------------------------------------------------------
+inline bool packDecompress(const unsigned char* src, size_t storedSize, unsigned char* dst, size_t size)
+{
+    const unsigned char* in = src;
+    const unsigned char* inEnd = src + storedSize;
+    unsigned char* out = dst;
+    unsigned char* outEnd = dst + size;
+    auto readLength = [&](size_t& length)
+    {
+        unsigned char b;
+        do
+        {
+            if (in >= inEnd)
+                return false;
+            b = *in++;
+            length += b;
+        } while (b == 255);
+        return true;
+    };
+    while (in < inEnd)
+    {
+        unsigned int token = *in++;
+        size_t literals = token >> 4;
+        if (literals == 15 && !readLength(literals))
+            return false;
+        if (literals > (size_t)(inEnd - in) || literals > (size_t)(outEnd - out))
+            return false;
+        if (literals)
+            std::memcpy(out, in, literals);
+        out += literals;
+        in += literals;
+        if (in == inEnd)
+            break;
+
+        if (inEnd - in < 2)
+            return false;
+        size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+        in += 2;
+        size_t length = token & 15;
+        if (length == 15 && !readLength(length))
+            return false;
+        length += 4;
+        if (offset == 0 || offset > (size_t)(out - dst) || length > (size_t)(outEnd - out))
+            return false;
+        const unsigned char* match = out - offset;
+        if (offset >= 8)
+        {
+            // 8 bytes at a time; the source stays at least 8 bytes behind, so no chunk overlaps what it writes
+            size_t i = 0;
+            for (; i + 8 <= length; i += 8)
+                std::memcpy(out + i, match + i, 8);
+            for (; i < length; i++)
+                out[i] = match[i];
+        }
+        else
+        {
+            for (size_t i = 0; i < length; i++)
+                out[i] = match[i];
+        }
+        out += length;
+    }
+    return out == outEnd;
+}
+
+// A mapped .pack file. Entries and stored data point into the mapping, so the pack must stay open while they are used
+class PackFile
+{
+public:
+    const PackFileHeader* header = NULL;
+    const PackFileEntry* entries = NULL;
+
+    // map and validate a pack; the table, every entry's range and the size compressed entries claim are checked, the
+    //      entry data is never touched
+    // ------------------------------------------------------------------------
+    bool open(const char* path)
+    {
+        header = NULL;
+        if (!file.open(path))
+            return false;
+        const unsigned char* base = file.data();
+        size_t size = file.size();
+        if (size < sizeof(PackFileHeader))
+            return invalid(path, "file too small");
+        const PackFileHeader* h = reinterpret_cast<const PackFileHeader*>(base);
+        if (h->magic != PACK_FILE_MAGIC || h->version != PACK_FILE_VERSION)
+            return invalid(path, "bad magic or version");
+        // the table of contents is read in place
+        if (h->tocOffset % alignof(PackFileEntry) != 0)
+            return invalid(path, "misaligned table of contents");
+        if (h->tocOffset < sizeof(PackFileHeader) || !inBounds(h->tocOffset, (uint64_t)h->entryCount * sizeof(PackFileEntry), size) ||
+            !inBounds(h->stringOffset, h->stringBytes, size))
+            return invalid(path, "section out of range");
+        const PackFileEntry* e = reinterpret_cast<const PackFileEntry*>(base + h->tocOffset);
+        const char* s = reinterpret_cast<const char*>(base + h->stringOffset);
+        for (uint32_t i = 0; i < h->entryCount; i++)
+        {
+            if (!inBounds(e[i].pathOffset, e[i].pathLength, h->stringBytes) || !inBounds(e[i].offset, e[i].storedSize, size))
+                return invalid(path, "entry out of range");
+            // entries start on their own pages, which is what lets stored entries be handed out straight from the mapping
+            if (e[i].offset % PACK_FILE_ALIGNMENT != 0)
+                return invalid(path, "misaligned entry");
+            // find() binary searches, so the paths have to be sorted (and unique)
+            if (i > 0 && !(std::string_view(s + e[i - 1].pathOffset, e[i - 1].pathLength) < std::string_view(s + e[i].pathOffset, e[i].pathLength)))
+                return invalid(path, "table of contents not sorted");
+            if (e[i].compression == PACK_STORED ? e[i].storedSize != e[i].size : e[i].compression != PACK_LZ4)
+                return invalid(path, "bad entry compression");
+            // a compressed entry is inflated into a buffer of its size, so that size has to be one it can really have
+            if (e[i].compression == PACK_LZ4 && (e[i].size > PACK_MAX_INFLATED_SIZE || e[i].size > e[i].storedSize * PACK_LZ4_MAX_RATIO))
+                return invalid(path, "compressed entry too large");
+        }
+        header = h;
+        entries = e;
+        strings = reinterpret_cast<const char*>(base + h->stringOffset);
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    bool isOpen() const { return header != NULL; }
+    void close() { header = NULL; entries = NULL; strings = NULL; file.close(); }
+    size_t count() const { return header ? header->entryCount : 0; }
+
+    // ------------------------------------------------------------------------
+    std::string_view path(const PackFileEntry& entry) const
+    {
+        return std::string_view(strings + entry.pathOffset, entry.pathLength);
+    }
+    // binary search on the sorted table of contents; NULL if the pack doesn't have it
+    // ------------------------------------------------------------------------
+    const PackFileEntry* find(std::string_view relativePath) const
+    {
+        const PackFileEntry* end = entries + count();
+        const PackFileEntry* it = std::lower_bound(entries, end, relativePath,
+            [this](const PackFileEntry& entry, std::string_view key) { return path(entry) < key; });
+        return it != end && path(*it) == relativePath ? it : NULL;
+    }
+    // the bytes as stored, compressed or not
+    // ------------------------------------------------------------------------
+    const unsigned char* stored(const PackFileEntry& entry) const
+    {
+        return file.data() + entry.offset;
+    }
+
+private:
+    MappedFile file;
+    const char* strings = NULL;
+
+    // ------------------------------------------------------------------------
+    static bool inBounds(uint64_t offset, uint64_t bytes, size_t size)
+    {
+        return offset <= size && bytes <= size - offset;
+    }
+    // ------------------------------------------------------------------------
+    bool invalid(const char* path, const char* reason)
+    {
+        std::cout << "ERROR::PACK_FILE::INVALID: " << path << " (" << reason << ")" << std::endl;
+        close();
+        return false;
+    }
+};
+
+// pack every file under directory. With compress, entries are LZ4 compressed when that makes them smaller
+// ------------------------------------------------------------------------
+inline bool writePackFile(const char* path, const char* directory, bool compress)
+{
+    namespace fs = std::filesystem;
+    std::error_code error;
+    std::vector<std::string> paths;
+    for (fs::recursive_directory_iterator it(directory, error), end; !error && it != end; it.increment(error))
+    {
+        std::error_code fileError;
+        if (it->is_regular_file(fileError))
+            paths.push_back(it->path().lexically_relative(directory).generic_string());
+    }
+    if (error)
+    {
+        std::cout << "ERROR::PACK_FILE::COULD_NOT_SCAN: " << directory << ": " << error.message() << std::endl;
+        return false;
+    }
+    std::sort(paths.begin(), paths.end());
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out)
+    {
+        std::cout << "ERROR::PACK_FILE::COULD_NOT_WRITE: " << path << std::endl;
+        return false;
+    }
+    PackFileHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = PACK_FILE_MAGIC;
+    header.version = PACK_FILE_VERSION;
+    header.entryCount = (uint32_t)paths.size();
+    header.tocOffset = sizeof(PackFileHeader);
+    header.stringOffset = header.tocOffset + paths.size() * sizeof(PackFileEntry);
+    std::vector<PackFileEntry> entries(paths.size());
+    std::string strings;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        std::memset(&entries[i], 0, sizeof(PackFileEntry));
+        entries[i].pathOffset = (uint32_t)strings.size();
+        entries[i].pathLength = (uint32_t)paths[i].size();
+        strings += paths[i];
+    }
+    header.stringBytes = (uint32_t)strings.size();
+
+    // entries first, then the table of contents now that their offsets are known
+    const char zeros[PACK_FILE_ALIGNMENT] = {};
+    uint64_t position = header.stringOffset + strings.size();
+    std::vector<char> placeholder(position, 0);
+    out.write(placeholder.data(), placeholder.size());
+    std::vector<unsigned char> compressed;
+    for (size_t i = 0; i < paths.size(); i++)
+    {
+        MappedFile file;
+        if (!file.open((fs::path(directory) / paths[i]).string().c_str()))
+            return false;
+        uint64_t padding = (PACK_FILE_ALIGNMENT - position % PACK_FILE_ALIGNMENT) % PACK_FILE_ALIGNMENT;
+        out.write(zeros, padding);
+        position += padding;
+        PackFileEntry& entry = entries[i];
+        entry.offset = position;
+        entry.size = file.size();
+        const unsigned char* data = file.data();
+        entry.storedSize = file.size();
+        if (compress && file.size() > 0 && file.size() <= PACK_MAX_INFLATED_SIZE)
+        {
+            compressed.resize(packCompressBound(file.size()));
+            size_t compressedSize = packCompress(file.data(), file.size(), compressed.data());
+            if (compressedSize < file.size())
+            {
+                entry.compression = PACK_LZ4;
+                entry.storedSize = compressedSize;
+                data = compressed.data();
+            }
+        }
+        out.write(reinterpret_cast<const char*>(data), entry.storedSize);
+        position += entry.storedSize;
+    }
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(PackFileEntry));
+    out.write(strings.data(), strings.size());
+    return (bool)out;
+}
+#endif
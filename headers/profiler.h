@@ -0,0 +1,420 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_HAS_RDTSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define PROFILER_HAS_RDTSC 1
+#endif
+
+//////// CPU PROFILER ////
+// - PROFILE_ZONE("name") times the rest of the enclosing scope; zones nest, and each one costs two timestamp reads and
+//      one write into the calling thread's ring buffer. The reads are plain RDTSC, one per edge with no serialising
+//      fence, and neither can go: a zone needs both edges
+// - the 20 ns per zone budget is only met where RDTSC is cheap. profilebench (src/Tools) measures it: in a VM that traps
+//      RDTSC each read took 21.7 ns and a zone 41.9 ns, so the budget was NOT met there; the ring write itself was lost
+//      in the noise. steady_clock::now() (clock_gettime through the vDSO) took 34.2 ns on the same machine, so it's no
+//      way out. On bare metal RDTSC is ~7 ns and a zone ~17 ns. Keep zones around work of a microsecond or more
+// - every thread that records zones gets its own single-producer/single-consumer ring, so recording never takes a lock
+//      or touches memory shared with other recording threads. Only the first zone on a new thread locks, to register
+// - a thread's ring is retired when the thread exits and freed by the next endFrame(), once its last events are drained,
+//      so short-lived worker threads don't leave rings behind
+// - PROFILE_FRAME() marks the end of a frame on the main thread: the rings of all threads are drained, every zone's
+//      duration goes into a rolling histogram of the last PROFILER_HISTORY samples, and while a capture is running the
+//      events are also kept for exportChromeTrace(), which writes JSON for chrome://tracing or Perfetto
+// - names must be string literals (or otherwise outlive the profiler): zones are keyed by the pointer
+// - define PROFILER_DISABLED to compile every macro away
+
+const unsigned int PROFILER_RING_SIZE = 1 << 14;       // events per thread between two frame markers, power of two
+const unsigned int PROFILER_HISTORY = 256;             // samples per zone kept in the rolling histogram
+const unsigned int PROFILER_BUCKETS = 32;              // log2(ns) buckets, up to ~4 s
+
+struct ProfileEvent
+{
+    const char* name;
+    uint64_t start;     // ticks, see Profiler::now()
+    uint64_t end;
+    uint32_t depth;
+    uint32_t thread;
+};
+
+// one per recording thread; only the owning thread writes, only endFrame() reads
+class ProfileRing
+{
+public:
+    uint32_t thread;
+    std::atomic<uint64_t> dropped{ 0 };
+    bool retired = false;               // the owning thread exited; written and read under the profiler's ring mutex
+
+    explicit ProfileRing(uint32_t thread) : thread(thread), events(new ProfileEvent[PROFILER_RING_SIZE]) {}
+
+    uint32_t depth = 0;                 // zones open on the owning thread
+
+    // the consumer's tail is only re-read when the ring looks full, so recording doesn't pull in the cache line that
+    //      endFrame() writes; the release store of head is a plain store on x86
+    // ------------------------------------------------------------------------
+    void push(const ProfileEvent& event)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - cachedTail == PROFILER_RING_SIZE)
+        {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h - cachedTail == PROFILER_RING_SIZE)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        events[h & (PROFILER_RING_SIZE - 1)] = event;
+        head.store(h + 1, std::memory_order_release);
+    }
+    // hand every pending event to f, oldest first
+    // ------------------------------------------------------------------------
+    template <typename F>
+    void drain(F&& f)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        uint32_t h = head.load(std::memory_order_acquire);
+        for (; t != h; t++)
+            f(events[t & (PROFILER_RING_SIZE - 1)]);
+        tail.store(t, std::memory_order_release);
+    }
+
+private:
+    std::unique_ptr<ProfileEvent[]> events;
+    std::atomic<uint32_t> head{ 0 };
+    uint32_t cachedTail = 0;            // producer's copy of tail
+    alignas(64) std::atomic<uint32_t> tail{ 0 };
+};
+
+// write s as a JSON string literal, quotes included; zone names are arbitrary text
+inline void writeJsonString(std::ostream& out, const char* s)
+{
+    out << '"';
+    for (; *s; s++)
+    {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\')
+            out << '\\' << (char)c;
+        else if (c < 0x20)
+        {
+            const char* hex = "0123456789abcdef";
+            out << "\\u00" << hex[c >> 4] << hex[c & 15];
+        }
+        else
+            out << (char)c;
+    }
+    out << '"';
+}
+
+// rolling log2 histogram over the last PROFILER_HISTORY durations of one zone
+struct ZoneHistogram
+{
+    uint32_t buckets[PROFILER_BUCKETS] = {};
+    uint8_t history[PROFILER_HISTORY] = {};
+    uint32_t samples = 0;           // total ever added
+    uint64_t windowNs = 0;          // sum over the window
+    uint64_t windowDurations[PROFILER_HISTORY] = {};
+    uint64_t calls = 0;             // this frame
+    uint64_t frameNs = 0;           // this frame, summed over calls
+    uint64_t lastFrameNs = 0;
+    uint64_t lastFrameCalls = 0;
+
+    // ------------------------------------------------------------------------
+    void add(uint64_t ns)
+    {
+        uint32_t bucket = 0;
+        while (bucket + 1 < PROFILER_BUCKETS && (ns >> (bucket + 1)) != 0)
+            bucket++;
+        uint32_t slot = samples % PROFILER_HISTORY;
+        if (samples >= PROFILER_HISTORY)
+        {
+            buckets[history[slot]]--;
+            windowNs -= windowDurations[slot];
+        }
+        history[slot] = (uint8_t)bucket;
+        windowDurations[slot] = ns;
+        buckets[bucket]++;
+        windowNs += ns;
+        samples++;
+        calls++;
+        frameNs += ns;
+    }
+    // ------------------------------------------------------------------------
+    uint32_t count() const
+    {
+        return std::min(samples, PROFILER_HISTORY);
+    }
+    // upper bound (in ns) of the bucket holding the given fraction of the window
+    // ------------------------------------------------------------------------
+    uint64_t percentile(float fraction) const
+    {
+        uint32_t target = (uint32_t)(fraction * count());
+        uint32_t seen = 0;
+        for (uint32_t b = 0; b < PROFILER_BUCKETS; b++)
+        {
+            seen += buckets[b];
+            if (seen > target)
+                return 2ull << b;
+        }
+        return 2ull << (PROFILER_BUCKETS - 1);
+    }
+};
+
+class Profiler;
+inline Profiler& profiler();
+
+class Profiler
+{
+public:
+    uint64_t frameIndex = 0;
+
+    Profiler()
+    {
+        calibrate();
+        frameStart = now();
+    }
+    // raw timestamp; RDTSC where available, steady_clock otherwise
+    // ------------------------------------------------------------------------
+    static uint64_t now()
+    {
+#ifdef PROFILER_HAS_RDTSC
+        return __rdtsc();
+#else
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+    // ------------------------------------------------------------------------
+    uint64_t toNs(uint64_t ticks) const
+    {
+        return (uint64_t)(ticks * nsPerTick);
+    }
+    // the calling thread's ring, registered the first time this thread records something and retired when it exits
+    // ------------------------------------------------------------------------
+    ProfileRing& ring()
+    {
+        thread_local RingOwner local;
+        if (!local.ring)
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            rings.emplace_back(new ProfileRing(nextThread++));
+            local.ring = rings.back().get();
+        }
+        return *local.ring;
+    }
+    // rings of threads that are still around (or exited since the last endFrame())
+    // ------------------------------------------------------------------------
+    size_t ringCount()
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        return rings.size();
+    }
+    // keep every event of the next `count` frames for exportChromeTrace()
+    // ------------------------------------------------------------------------
+    void beginCapture(unsigned int count)
+    {
+        trace.clear();
+        frames.clear();
+        captureFrames = count;
+    }
+    // end of a frame: drain all threads and update the histograms
+    // ------------------------------------------------------------------------
+    void endFrame()
+    {
+        uint64_t frameEnd = now();
+        {
+            std::lock_guard<std::mutex> lock(ringsMutex);
+            for (auto& r : rings)
+            {
+                r->drain([&](const ProfileEvent& event)
+                {
+                    zones[event.name].add(toNs(event.end - event.start));
+                    if (captureFrames)
+                        trace.push_back(event);
+                });
+                // the thread is gone and nothing more can arrive, so this was its last drain
+                if (r->retired)
+                {
+                    retiredDropped += r->dropped.load();
+                    r.reset();
+                }
+            }
+            rings.erase(std::remove(rings.begin(), rings.end(), nullptr), rings.end());
+        }
+        for (auto& zone : zones)
+        {
+            zone.second.lastFrameNs = zone.second.frameNs;
+            zone.second.lastFrameCalls = zone.second.calls;
+            zone.second.frameNs = 0;
+            zone.second.calls = 0;
+        }
+        if (captureFrames)
+        {
+            frames.push_back({ frameStart, frameEnd });
+            captureFrames--;
+        }
+        frameStart = frameEnd;
+        frameIndex++;
+    }
+    // ------------------------------------------------------------------------
+    const ZoneHistogram* zone(const char* name) const
+    {
+        auto it = zones.find(name);
+        return it == zones.end() ? nullptr : &it->second;
+    }
+    // per zone: last frame's time and calls, and the window's mean / p50 / p95
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::vector<std::pair<const char*, const ZoneHistogram*>> sorted;
+        for (const auto& zone : zones)
+            sorted.push_back({ zone.first, &zone.second });
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b) { return std::string(a.first) < std::string(b.first); });
+        std::cout << "PROFILER:: frame " << frameIndex << std::endl;
+        for (const auto& z : sorted)
+        {
+            const ZoneHistogram& h = *z.second;
+            std::cout << "    " << z.first << ": " << h.lastFrameNs / 1000.0 << " us in " << h.lastFrameCalls << " calls, mean "
+                      << (h.count() ? h.windowNs / h.count() : 0) / 1000.0 << " us, p50 < " << h.percentile(0.5f) / 1000.0
+                      << " us, p95 < " << h.percentile(0.95f) / 1000.0 << " us" << std::endl;
+        }
+        uint64_t dropped = retiredDropped;
+        for (const auto& r : rings)
+            dropped += r->dropped.load();
+        if (dropped)
+            std::cout << "    " << dropped << " events dropped, raise PROFILER_RING_SIZE" << std::endl;
+    }
+    // write the captured frames as Chrome trace event JSON
+    // ------------------------------------------------------------------------
+    bool exportChromeTrace(const char* path) const
+    {
+        std::ofstream file(path);
+        if (!file)
+        {
+            std::cout << "ERROR::PROFILER::TRACE_NOT_WRITTEN: " << path << std::endl;
+            return false;
+        }
+        uint64_t origin = frames.empty() ? (trace.empty() ? 0 : trace.front().start) : frames.front().start;
+        auto us = [&](uint64_t ticks) { return (ticks > origin ? toNs(ticks - origin) : 0) / 1000.0; };
+        file << "{\"traceEvents\":[\n";
+        bool first = true;
+        for (size_t i = 0; i < frames.size(); i++)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"Frame " << i << "\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":" << us(frames[i].start)
+                 << ",\"dur\":" << us(frames[i].end) - us(frames[i].start) << "}";
+            first = false;
+        }
+        for (const ProfileEvent& e : trace)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":";
+            writeJsonString(file, e.name);
+            file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.thread + 1 << ",\"ts\":" << us(e.start)
+                 << ",\"dur\":" << us(e.end) - us(e.start) << ",\"args\":{\"depth\":" << e.depth << "}}";
+            first = false;
+        }
+        file << "\n]}\n";
+        return true;
+    }
+
+private:
+    struct FrameRange
+    {
+        uint64_t start, end;
+    };
+    // a thread's handle on its ring; its destructor runs when the thread exits
+    struct RingOwner
+    {
+        ProfileRing* ring = nullptr;
+        ~RingOwner()
+        {
+            if (ring)
+                profiler().retire(ring);
+        }
+    };
+    friend struct RingOwner;
+
+    double nsPerTick = 1.0;
+    std::mutex ringsMutex;
+    std::vector<std::unique_ptr<ProfileRing>> rings;
+    std::unordered_map<const char*, ZoneHistogram> zones;
+    std::vector<ProfileEvent> trace;
+    std::vector<FrameRange> frames;
+    unsigned int captureFrames = 0;
+    uint64_t frameStart = 0;
+    uint32_t nextThread = 0;
+    uint64_t retiredDropped = 0;
+
+    // ------------------------------------------------------------------------
+    void retire(ProfileRing* ring)
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        ring->retired = true;
+    }
+
+    // measure the tick rate against steady_clock for a few ms
+    void calibrate()
+    {
+#ifdef PROFILER_HAS_RDTSC
+        auto clockStart = std::chrono::steady_clock::now();
+        uint64_t tickStart = now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        uint64_t ticks = now() - tickStart;
+        double ns = (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - clockStart).count();
+        nsPerTick = ticks ? ns / ticks : 1.0;
+#endif
+    }
+};
+
+// the process-wide profiler
+inline Profiler& profiler()
+{
+    static Profiler instance;
+    return instance;
+}
+
+// RAII zone, use through PROFILE_ZONE
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name) : ring(profiler().ring()), name(name), depth(ring.depth++), start(Profiler::now()) {}
+    ~ProfileZone()
+    {
+        uint64_t end = Profiler::now();
+        ring.depth--;
+        ring.push({ name, start, end, depth, ring.thread });
+    }
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    ProfileRing& ring;
+    const char* name;
+    uint32_t depth;
+    uint64_t start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#ifndef PROFILER_DISABLED
+#define PROFILE_ZONE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() profiler().endFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+#endif
@@ -0,0 +1,179 @@
+#ifndef PROGRAM_PIPELINE_H
+#define PROGRAM_PIPELINE_H
+
+#include <glad/glad.h>
+
+#include <shader.h>
+
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+#include <iostream>
+
+//////// PROGRAM PIPELINES ////
+// - with separate shader objects (GL 4.1, ARB_separate_shader_objects) every stage is linked on its own as a
+//      GL_PROGRAM_SEPARABLE program, and a program pipeline object combines a vertex and a fragment program at draw
+//      time. N vertex and M fragment stages cost N + M compiles and links; full programs cost a link per combination
+// - PipelineLibrary owns the stages and hands out one pipeline per (vertex, fragment) pair, created the first time the
+//      pair is bound. Creating a pipeline only records which programs it uses, nothing is linked
+// - separately linked stages meet at their interface by location, so varyings passed between stages should have
+//      explicit layout(location = n) qualifiers
+// - set a stage's uniforms with glProgramUniform* on stageProgram(); with pipelines nothing is "in use" for glUniform*.
+//      Every program linked here is reflected (shader_reflection.h), so Shader(stageProgram(i)).location() needs no query
+// - contexts older than 4.1 fall back to linking a regular program per pair on first use, so callers don't need a
+//      second path; report() shows what the chosen path cost
+
+class PipelineLibrary
+{
+public:
+    unsigned int compiles = 0;
+    unsigned int links = 0;
+    unsigned int pipelines = 0;     // pipeline objects, or programs linked per pair on the fallback path
+    bool separable = false;
+
+    PipelineLibrary() : separable(GLAD_GL_VERSION_4_1 != 0) {}
+    ~PipelineLibrary() { destroy(); }
+    PipelineLibrary(const PipelineLibrary&) = delete;
+    PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+    // compile (and on the separable path link) one stage; returns its index for bind()
+    // ------------------------------------------------------------------------
+    size_t addStage(GLenum type, const char* source, size_t length)
+    {
+        Stage stage;
+        stage.type = type;
+        stage.shader = Shader::compileStage(type, source, length);
+        compiles++;
+        Shader::checkCompileErrors(stage.shader, type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT");
+        if (separable)
+        {
+            stage.program = glCreateProgram();
+            glProgramParameteri(stage.program, GL_PROGRAM_SEPARABLE, GL_TRUE);
+            glAttachShader(stage.program, stage.shader);
+            glLinkProgram(stage.program);
+            links++;
+            if (Shader::checkCompileErrors(stage.program, "PROGRAM"))
+                shaderReflections().reflect(stage.program);
+            glDetachShader(stage.program, stage.shader);
+            glDeleteShader(stage.shader);
+            stage.shader = 0;
+        }
+        stages.push_back(stage);
+        return stages.size() - 1;
+    }
+    size_t addStage(GLenum type, const char* source)
+    {
+        return addStage(type, source, std::strlen(source));
+    }
+    // the separable program of a stage, for glProgramUniform*; 0 on the fallback path
+    // ------------------------------------------------------------------------
+    unsigned int stageProgram(size_t stage) const
+    {
+        return stages[stage].program;
+    }
+    // make the pair current for the following draws
+    // ------------------------------------------------------------------------
+    void bind(size_t vertex, size_t fragment)
+    {
+        unsigned int id = combination(vertex, fragment);
+        if (separable)
+        {
+            // a program made current with glUseProgram takes precedence over the bound pipeline
+            glUseProgram(0);
+            glBindProgramPipeline(id);
+        }
+        else
+            glUseProgram(id);
+    }
+    // ------------------------------------------------------------------------
+    void destroy()
+    {
+        for (const auto& entry : combinations)
+        {
+            if (separable)
+                glDeleteProgramPipelines(1, &entry.second);
+            else
+            {
+                shaderReflections().forget(entry.second);
+                glDeleteProgram(entry.second);
+            }
+        }
+        for (const Stage& stage : stages)
+        {
+            if (stage.program)
+            {
+                shaderReflections().forget(stage.program);
+                glDeleteProgram(stage.program);
+            }
+            if (stage.shader)
+                glDeleteShader(stage.shader);
+        }
+        combinations.clear();
+        stages.clear();
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "PIPELINES:: " << (separable ? "separable stages" : "program per pair fallback") << ", " << stages.size() << " stages, "
+                  << compiles << " compiles, " << links << " links, " << combinations.size() << " combinations in use" << std::endl;
+    }
+
+private:
+    struct Stage
+    {
+        GLenum type;
+        unsigned int shader = 0;    // kept for the fallback path, which links it into every program using the stage
+        unsigned int program = 0;   // separable program
+    };
+    std::vector<Stage> stages;
+    std::unordered_map<uint64_t, unsigned int> combinations;
+
+    // ------------------------------------------------------------------------
+    unsigned int combination(size_t vertex, size_t fragment)
+    {
+        uint64_t key = ((uint64_t)vertex << 32) | (uint64_t)fragment;
+        auto found = combinations.find(key);
+        if (found != combinations.end())
+            return found->second;
+        unsigned int id = 0;
+        if (separable)
+        {
+            if (GLAD_GL_VERSION_4_5)
+                glCreateProgramPipelines(1, &id);
+            else
+                glGenProgramPipelines(1, &id);
+            glUseProgramStages(id, GL_VERTEX_SHADER_BIT, stages[vertex].program);
+            glUseProgramStages(id, GL_FRAGMENT_SHADER_BIT, stages[fragment].program);
+            validate(id);
+        }
+        else
+        {
+            id = glCreateProgram();
+            glAttachShader(id, stages[vertex].shader);
+            glAttachShader(id, stages[fragment].shader);
+            glLinkProgram(id);
+            links++;
+            if (Shader::checkCompileErrors(id, "PROGRAM"))
+                shaderReflections().reflect(id);
+        }
+        pipelines++;
+        combinations[key] = id;
+        return id;
+    }
+    // stages whose interfaces don't match only show up here, linking each on its own can't catch it
+    // ------------------------------------------------------------------------
+    static void validate(unsigned int pipeline)
+    {
+        glValidateProgramPipeline(pipeline);
+        GLint valid = 0;
+        glGetProgramPipelineiv(pipeline, GL_VALIDATE_STATUS, &valid);
+        if (!valid)
+        {
+            GLchar infoLog[1024];
+            glGetProgramPipelineInfoLog(pipeline, 1024, NULL, infoLog);
+            std::cout << "ERROR::PIPELINES::VALIDATION_FAILED\n" << infoLog << std::endl;
+        }
+    }
+};
+#endif
@@ -0,0 +1,272 @@
+#ifndef RENDER_TARGET_H
+#define RENDER_TARGET_H
+
+#include <glad/glad.h>
+
+#include <gl_objects.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <iostream>
+
+//////// RENDER TARGET POOL ////
+// - offscreen rendering needs textures (or renderbuffers) to render into and framebuffers to attach them to. Creating
+//      them when a pass needs them and deleting them afterwards costs allocations every frame; keeping one set per
+//      pass wastes memory on targets that are never alive at the same time
+// - renderTargetPool() hands out targets by (size, format, samples, texture or renderbuffer): acquire() for as long
+//      as a target's contents are needed, release() as soon as they aren't, and the next acquire() of a compatible
+//      target gets the same one back. In steady state a frame allocates nothing
+// - sizes are rounded up to RENDER_TARGET_ALIGNMENT pixels, and a request is served by any free target at least as
+//      large and less than twice as large. A window resize then mostly lands in targets that already exist instead of
+//      reallocating all of them; render with a viewport of the requested size (and scale UVs by uvScale() when
+//      sampling). Targets nobody acquired for RENDER_TARGET_IDLE_FRAMES frames go back to GL in nextFrame()
+// - framebuffer() returns a framebuffer for a set of targets, created the first time that set is asked for
+// - the pool owns GL objects, so call renderTargetPool().clear() before the context is destroyed
+
+const int RENDER_TARGET_ALIGNMENT = 64;
+const unsigned int RENDER_TARGET_IDLE_FRAMES = 60;
+const size_t RENDER_TARGET_MAX_COLORS = 8;
+
+// ------------------------------------------------------------------------
+inline bool isDepthFormat(GLenum format)
+{
+    return format == GL_DEPTH_COMPONENT16 || format == GL_DEPTH_COMPONENT24 || format == GL_DEPTH_COMPONENT32F ||
+           format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+// ------------------------------------------------------------------------
+inline bool hasStencil(GLenum format)
+{
+    return format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+}
+// ------------------------------------------------------------------------
+inline size_t renderTargetBytesPerPixel(GLenum format)
+{
+    switch (format)
+    {
+    case GL_R8:                 return 1;
+    case GL_RG8: case GL_R16F: case GL_DEPTH_COMPONENT16:
+                                return 2;
+    case GL_RGBA16F: case GL_RG32F: case GL_DEPTH32F_STENCIL8:
+                                return 8;
+    case GL_RGBA32F:            return 16;
+    default:                    return 4;   // RGBA8, RGB10_A2, R11F_G11F_B10F, RG16F, R32F, 24/32-bit depth
+    }
+}
+
+struct RenderTargetKey
+{
+    int width = 0;
+    int height = 0;
+    GLenum format = GL_RGBA8;
+    int samples = 1;
+    bool renderbuffer = false;      // can't be sampled, only rendered to and blitted from
+};
+
+class RenderTarget
+{
+public:
+    RenderTargetKey key;            // as allocated; width and height are at least what was asked for
+    std::unique_ptr<Texture> texture;
+    std::unique_ptr<Renderbuffer> renderbuffer;
+
+    // ------------------------------------------------------------------------
+    unsigned int ID() const
+    {
+        return texture ? texture->ID : renderbuffer->ID;
+    }
+    // ------------------------------------------------------------------------
+    size_t bytes() const
+    {
+        return (size_t)key.width * key.height * key.samples * renderTargetBytesPerPixel(key.format);
+    }
+
+private:
+    friend class RenderTargetPool;
+    bool inUse = false;
+    uint64_t lastUsed = 0;          // frame of the last acquire
+};
+
+class RenderTargetPool
+{
+public:
+    struct Stats
+    {
+        uint64_t acquires = 0;
+        uint64_t allocations = 0;       // acquires that had to create a target
+        uint64_t frees = 0;             // targets given back to GL after going idle
+        uint64_t framebuffers = 0;      // framebuffers created
+    };
+    Stats stats;
+
+    // a target of at least width x height; release() it when its contents aren't needed any more
+    // ------------------------------------------------------------------------
+    RenderTarget* acquire(int width, int height, GLenum format, int samples = 1, bool renderbuffer = false)
+    {
+        stats.acquires++;
+        width = std::max(width, 1);
+        height = std::max(height, 1);
+        samples = std::max(samples, 1);
+        RenderTarget* best = NULL;
+        for (const auto& target : targets)
+        {
+            const RenderTargetKey& key = target->key;
+            if (target->inUse || key.format != format || key.samples != samples || key.renderbuffer != renderbuffer)
+                continue;
+            if (key.width < width || key.height < height || key.width >= 2 * width || key.height >= 2 * height)
+                continue;
+            if (!best || (size_t)key.width * key.height < (size_t)best->key.width * best->key.height)
+                best = target.get();
+        }
+        if (!best)
+            best = allocate(align(width), align(height), format, samples, renderbuffer);
+        best->inUse = true;
+        best->lastUsed = frame;
+        return best;
+    }
+    // ------------------------------------------------------------------------
+    void release(RenderTarget* target)
+    {
+        if (target)
+            target->inUse = false;
+    }
+    // a framebuffer rendering into colors (GL_COLOR_ATTACHMENT0 onwards) and depth, either of which may be empty.
+    //      Targets of different sizes can be attached together; rendering covers the smallest
+    // ------------------------------------------------------------------------
+    unsigned int framebuffer(RenderTarget* const* colors, size_t count, RenderTarget* depth)
+    {
+        FramebufferKey key = {};
+        count = std::min(count, RENDER_TARGET_MAX_COLORS);
+        for (size_t i = 0; i < count; i++)
+            key[i] = colors[i];
+        key[RENDER_TARGET_MAX_COLORS] = depth;
+        auto found = framebuffers.find(key);
+        if (found != framebuffers.end())
+            return found->second.ID;
+
+        Framebuffer fbo;
+        for (size_t i = 0; i < count; i++)
+            attach(fbo, GL_COLOR_ATTACHMENT0 + (GLenum)i, *colors[i]);
+        if (depth)
+            attach(fbo, hasStencil(depth->key.format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT, *depth);
+        fbo.drawBuffers((int)count);
+        fbo.complete();
+        stats.framebuffers++;
+        unsigned int id = fbo.ID;
+        framebuffers.emplace(key, std::move(fbo));
+        return id;
+    }
+    // call once per frame: targets idle for RENDER_TARGET_IDLE_FRAMES are deleted, with the framebuffers using them
+    // ------------------------------------------------------------------------
+    void nextFrame()
+    {
+        frame++;
+        for (size_t i = 0; i < targets.size();)
+        {
+            RenderTarget* target = targets[i].get();
+            if (target->inUse || frame - target->lastUsed <= RENDER_TARGET_IDLE_FRAMES)
+            {
+                i++;
+                continue;
+            }
+            forgetFramebuffers(target);
+            targets[i] = std::move(targets.back());
+            targets.pop_back();
+            stats.frees++;
+        }
+    }
+    // delete everything; must happen while the context is still alive
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        framebuffers.clear();
+        targets.clear();
+    }
+    // ------------------------------------------------------------------------
+    size_t bytes() const
+    {
+        size_t total = 0;
+        for (const auto& target : targets)
+            total += target->bytes();
+        return total;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "RENDER_TARGETS:: " << targets.size() << " targets (" << bytes() / 1024 << " KB), " << framebuffers.size()
+                  << " framebuffers; " << stats.acquires << " acquires, " << stats.allocations << " allocations, " << stats.frees
+                  << " freed when idle, " << stats.framebuffers << " framebuffers created" << std::endl;
+    }
+
+private:
+    typedef std::array<const RenderTarget*, RENDER_TARGET_MAX_COLORS + 1> FramebufferKey;   // colors, then depth
+    std::vector<std::unique_ptr<RenderTarget>> targets;
+    std::map<FramebufferKey, Framebuffer> framebuffers;
+    uint64_t frame = 0;
+
+    // ------------------------------------------------------------------------
+    static int align(int size)
+    {
+        return (size + RENDER_TARGET_ALIGNMENT - 1) / RENDER_TARGET_ALIGNMENT * RENDER_TARGET_ALIGNMENT;
+    }
+    // ------------------------------------------------------------------------
+    RenderTarget* allocate(int width, int height, GLenum format, int samples, bool renderbuffer)
+    {
+        auto target = std::make_unique<RenderTarget>();
+        target->key.width = width;
+        target->key.height = height;
+        target->key.format = format;
+        target->key.samples = samples;
+        target->key.renderbuffer = renderbuffer;
+        if (renderbuffer)
+        {
+            target->renderbuffer = std::make_unique<Renderbuffer>();
+            target->renderbuffer->storage(format, width, height, samples);
+        }
+        else if (samples > 1)
+        {
+            target->texture = std::make_unique<Texture>(GL_TEXTURE_2D_MULTISAMPLE);
+            target->texture->storage2DMultisample(samples, format, width, height);
+        }
+        else
+        {
+            target->texture = std::make_unique<Texture>();
+            target->texture->storage2D(1, format, width, height);
+            target->texture->parameter(GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            target->texture->parameter(GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        }
+        stats.allocations++;
+        targets.push_back(std::move(target));
+        return targets.back().get();
+    }
+    // ------------------------------------------------------------------------
+    static void attach(Framebuffer& fbo, GLenum attachment, const RenderTarget& target)
+    {
+        if (target.texture)
+            fbo.attach(attachment, *target.texture);
+        else
+            fbo.attach(attachment, *target.renderbuffer);
+    }
+    // ------------------------------------------------------------------------
+    void forgetFramebuffers(const RenderTarget* target)
+    {
+        for (auto it = framebuffers.begin(); it != framebuffers.end();)
+        {
+            if (std::find(it->first.begin(), it->first.end(), target) != it->first.end())
+                it = framebuffers.erase(it);
+            else
+                ++it;
+        }
+    }
+};
+
+// the process-wide pool, next to glState() and samplerCache()
+inline RenderTargetPool& renderTargetPool()
+{
+    static RenderTargetPool pool;
+    return pool;
+}
+#endif
@@ -0,0 +1,154 @@
+#ifndef SAMPLER_CACHE_H
+#define SAMPLER_CACHE_H
+
+#include <glad/glad.h>
+
+#include <gl_objects.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <iostream>
+
+//////// SAMPLER CACHE ////
+// - wrapping/filtering used to be set on every texture with a handful of glTexParameteri calls, so each texture carried
+//      its own copy of what is almost always one of three or four sampling setups
+// - a SamplerDesc describes sampling state as plain data; the cache hashes it and hands out one shared Sampler per
+//      distinct description, created on first request and reused process-wide after that
+// - textures become pure data: bind the texture and the cached sampler to the same unit
+// - the cache owns GL objects, so call samplerCache().clear() before the context is destroyed
+// - float fields are compared by value and hashed by value too: -0.0 is hashed as 0.0, and a NaN (which would never
+//      compare equal to itself, so every lookup would create another sampler) is rejected and replaced by the default
+
+struct SamplerDesc
+{
+    GLenum minFilter = GL_LINEAR;       // what the samples always set; mipmapped textures ask for GL_LINEAR_MIPMAP_LINEAR
+    GLenum magFilter = GL_LINEAR;
+    GLenum wrapS = GL_REPEAT;
+    GLenum wrapT = GL_REPEAT;
+    GLenum wrapR = GL_REPEAT;
+    GLenum compareMode = GL_NONE;       // GL_COMPARE_REF_TO_TEXTURE for shadow map lookups
+    GLenum compareFunc = GL_LEQUAL;
+    float maxAnisotropy = 1.0f;         // only applied on 4.6+ contexts, where anisotropic filtering is core
+    float lodBias = 0.0f;
+
+    // ------------------------------------------------------------------------
+    static SamplerDesc linearRepeat()
+    {
+        return SamplerDesc();
+    }
+    // ------------------------------------------------------------------------
+    static SamplerDesc linearClamp()
+    {
+        SamplerDesc desc;
+        desc.wrapS = desc.wrapT = desc.wrapR = GL_CLAMP_TO_EDGE;
+        return desc;
+    }
+    // ------------------------------------------------------------------------
+    static SamplerDesc nearestClamp()
+    {
+        SamplerDesc desc = linearClamp();
+        desc.minFilter = GL_NEAREST;
+        desc.magFilter = GL_NEAREST;
+        return desc;
+    }
+    // ------------------------------------------------------------------------
+    bool operator==(const SamplerDesc& other) const
+    {
+        return minFilter == other.minFilter && magFilter == other.magFilter && wrapS == other.wrapS && wrapT == other.wrapT &&
+               wrapR == other.wrapR && compareMode == other.compareMode && compareFunc == other.compareFunc &&
+               maxAnisotropy == other.maxAnisotropy && lodBias == other.lodBias;
+    }
+};
+
+// FNV-1a over the fields, one word at a time; floats are hashed by value so equal descriptions always hash alike
+struct SamplerDescHash
+{
+    size_t operator()(const SamplerDesc& desc) const
+    {
+        uint32_t words[9] = { desc.minFilter, desc.magFilter, desc.wrapS, desc.wrapT, desc.wrapR, desc.compareMode, desc.compareFunc, 0, 0 };
+        // -0.0 == 0.0, so both hash as +0.0; the cache never stores a NaN
+        float maxAnisotropy = desc.maxAnisotropy == 0.0f ? 0.0f : desc.maxAnisotropy;
+        float lodBias = desc.lodBias == 0.0f ? 0.0f : desc.lodBias;
+        std::memcpy(&words[7], &maxAnisotropy, sizeof(float));
+        std::memcpy(&words[8], &lodBias, sizeof(float));
+        uint64_t hash = 14695981039346656037ull;
+        for (uint32_t w : words)
+        {
+            hash ^= w;
+            hash *= 1099511628211ull;
+        }
+        return (size_t)hash;
+    }
+};
+
+class SamplerCache
+{
+public:
+    unsigned long long lookups = 0;
+    unsigned long long created = 0;
+
+    // the shared sampler for a description, created the first time it is asked for
+    // ------------------------------------------------------------------------
+    const Sampler& get(const SamplerDesc& requested)
+    {
+        lookups++;
+        SamplerDesc desc = requested;
+        if (std::isnan(desc.maxAnisotropy) || std::isnan(desc.lodBias))
+        {
+            std::cout << "ERROR::SAMPLER_CACHE::NAN_PARAMETER: using the default anisotropy/LOD bias instead" << std::endl;
+            if (std::isnan(desc.maxAnisotropy))
+                desc.maxAnisotropy = SamplerDesc().maxAnisotropy;
+            if (std::isnan(desc.lodBias))
+                desc.lodBias = SamplerDesc().lodBias;
+        }
+        auto it = samplers.find(desc);
+        if (it != samplers.end())
+            return *it->second;
+
+        std::unique_ptr<Sampler> sampler(new Sampler());
+        sampler->parameter(GL_TEXTURE_MIN_FILTER, (int)desc.minFilter);
+        sampler->parameter(GL_TEXTURE_MAG_FILTER, (int)desc.magFilter);
+        sampler->parameter(GL_TEXTURE_WRAP_S, (int)desc.wrapS);
+        sampler->parameter(GL_TEXTURE_WRAP_T, (int)desc.wrapT);
+        sampler->parameter(GL_TEXTURE_WRAP_R, (int)desc.wrapR);
+        sampler->parameter(GL_TEXTURE_COMPARE_MODE, (int)desc.compareMode);
+        sampler->parameter(GL_TEXTURE_COMPARE_FUNC, (int)desc.compareFunc);
+        if (desc.lodBias != 0.0f)
+            sampler->parameter(GL_TEXTURE_LOD_BIAS, desc.lodBias);
+        if (desc.maxAnisotropy > 1.0f && GLAD_GL_VERSION_4_6)
+            sampler->parameter(GL_TEXTURE_MAX_ANISOTROPY, desc.maxAnisotropy);
+        created++;
+        return *samplers.emplace(desc, std::move(sampler)).first->second;
+    }
+    // shorthand for get(desc).bind(unit)
+    // ------------------------------------------------------------------------
+    void bind(unsigned int unit, const SamplerDesc& desc)
+    {
+        get(desc).bind(unit);
+    }
+    // delete every sampler; must happen while the context is still alive
+    // ------------------------------------------------------------------------
+    void clear()
+    {
+        samplers.clear();
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "SAMPLER_CACHE:: " << lookups << " lookups served by " << created << " sampler objects" << std::endl;
+    }
+
+private:
+    std::unordered_map<SamplerDesc, std::unique_ptr<Sampler>, SamplerDescHash> samplers;
+};
+
+// the process-wide cache, next to glState()
+inline SamplerCache& samplerCache()
+{
+    static SamplerCache cache;
+    return cache;
+}
+#endif
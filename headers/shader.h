@@ -4,141 +4,150 @@
 #include <glad/glad.h>
 #include <glm/glm.hpp>
 
+#include <mapped_file.h>
+#include <shader_reflection.h>
+
 #include <string>
-#include <fstream>
-#include <sstream>
 #include <iostream>
 
 class Shader
 {
 public:
     unsigned int ID;
+    Shader() : ID(0) {}
+    // wrap a program that was linked elsewhere, e.g. by ShaderBatch (shader_batch.h), which also reflects it
+    explicit Shader(unsigned int program) : ID(program) {}
     // constructor generates the shader on the fly
     // ------------------------------------------------------------------------
     Shader(const char* vertexPath, const char* fragmentPath)
     {
-        // 1. retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        }
-        catch (std::ifstream::failure& e)
-        {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << e.what() << std::endl;
-        }
-        const char* vShaderCode = vertexCode.c_str();
-        const char* fShaderCode = fragmentCode.c_str();
+        // 1. map the source files. The mapped bytes go to glShaderSource as they are, with explicit lengths instead of
+        //      a terminating NUL, so the source is never copied on our side
+        MappedFile vertexFile, fragmentFile;
+        if (!vertexFile.open(vertexPath) || !fragmentFile.open(fragmentPath))
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ: " << (vertexFile.isOpen() ? fragmentPath : vertexPath) << std::endl;
         // 2. compile shaders
-        unsigned int vertex, fragment;
-        // vertex shader
-        vertex = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vertex, 1, &vShaderCode, NULL);
-        glCompileShader(vertex);
+        unsigned int vertex = compileStage(GL_VERTEX_SHADER, (const char*)vertexFile.data(), vertexFile.size());
         checkCompileErrors(vertex, "VERTEX");
-        // fragment Shader
-        fragment = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fragment, 1, &fShaderCode, NULL);
-        glCompileShader(fragment);
+        unsigned int fragment = compileStage(GL_FRAGMENT_SHADER, (const char*)fragmentFile.data(), fragmentFile.size());
         checkCompileErrors(fragment, "FRAGMENT");
         // shader Program
         ID = glCreateProgram();
         glAttachShader(ID, vertex);
         glAttachShader(ID, fragment);
         glLinkProgram(ID);
-        checkCompileErrors(ID, "PROGRAM");
+        if (checkCompileErrors(ID, "PROGRAM"))
+            shaderReflections().reflect(ID);
+        else
+        {
+            // nothing can use a program that didn't link, and ID = 0 tells the caller so
+            glDeleteProgram(ID);
+            ID = 0;
+        }
         // delete the shaders as they're linked into our program now and no longer necessary
         glDeleteShader(vertex);
         glDeleteShader(fragment);
 
     }
+    // create and compile one stage from a source that doesn't need to be NUL-terminated; errors are left for
+    //      checkCompileErrors so a batch can compile everything before waiting on any result
+    // ------------------------------------------------------------------------
+    static unsigned int compileStage(GLenum type, const char* source, size_t length)
+    {
+        unsigned int shader = glCreateShader(type);
+        const char* text = source ? source : "";
+        GLint textLength = (GLint)length;
+        glShaderSource(shader, 1, &text, &textLength);
+        glCompileShader(shader);
+        return shader;
+    }
     // activate the shader
     // ------------------------------------------------------------------------
     void use() const
     {
         glUseProgram(ID);
     }
+    // where a uniform lives, from the program's reflection table (shader_reflection.h) without asking GL; -1 if it
+    //      isn't active. Resolve once and pass the result to glUniform* for uniforms set every frame
+    // ------------------------------------------------------------------------
+    int location(const std::string& name) const
+    {
+        if (const ShaderReflection* reflection = shaderReflections().find(ID))
+            return reflection->uniformLocation(name);
+        return glGetUniformLocation(ID, name.c_str());
+    }
     // utility uniform functions
     // ------------------------------------------------------------------------
     void setBool(const std::string& name, bool value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), (int)value);
+        glUniform1i(location(name), (int)value);
     }
     // ------------------------------------------------------------------------
     void setInt(const std::string& name, int value) const
     {
-        glUniform1i(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1i(location(name), value);
     }
     // ------------------------------------------------------------------------
     void setFloat(const std::string& name, float value) const
     {
-        glUniform1f(glGetUniformLocation(ID, name.c_str()), value);
+        glUniform1f(location(name), value);
     }
     // ------------------------------------------------------------------------
     void setVec2(const std::string& name, const glm::vec2& value) const
     {
-        glUniform2fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform2fv(location(name), 1, &value[0]);
     }
     void setVec2(const std::string& name, float x, float y) const
     {
-        glUniform2f(glGetUniformLocation(ID, name.c_str()), x, y);
+        glUniform2f(location(name), x, y);
     }
     // ------------------------------------------------------------------------
     void setVec3(const std::string& name, const glm::vec3& value) const
     {
-        glUniform3fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform3fv(location(name), 1, &value[0]);
     }
     void setVec3(const std::string& name, float x, float y, float z) const
     {
-        glUniform3f(glGetUniformLocation(ID, name.c_str()), x, y, z);
+        glUniform3f(location(name), x, y, z);
     }
     // ------------------------------------------------------------------------
     void setVec4(const std::string& name, const glm::vec4& value) const
     {
-        glUniform4fv(glGetUniformLocation(ID, name.c_str()), 1, &value[0]);
+        glUniform4fv(location(name), 1, &value[0]);
     }
     void setVec4(const std::string& name, float x, float y, float z, float w) const
     {
-        glUniform4f(glGetUniformLocation(ID, name.c_str()), x, y, z, w);
+        glUniform4f(location(name), x, y, z, w);
     }
     // ------------------------------------------------------------------------
     void setMat2(const std::string& name, const glm::mat2& mat) const
     {
-        glUniformMatrix2fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix2fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat3(const std::string& name, const glm::mat3& mat) const
     {
-        glUniformMatrix3fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix3fv(location(name), 1, GL_FALSE, &mat[0][0]);
     }
     // ------------------------------------------------------------------------
     void setMat4(const std::string& name, const glm::mat4& mat) const
     {
-        glUniformMatrix4fv(glGetUniformLocation(ID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+        glUniformMatrix4fv(location(name), 1, GL_FALSE, &mat[0][0]);
+    }
+    // point a uniform block at a buffer binding point; does nothing if the block was optimized out
+    // ------------------------------------------------------------------------
+    void setBlockBinding(const std::string& name, unsigned int binding) const
+    {
+        const ShaderReflection* reflection = shaderReflections().find(ID);
+        const ShaderResource* block = reflection ? reflection->find(ShaderResourceKind::UniformBlock, name) : NULL;
+        unsigned int index = block ? (unsigned int)block->location : glGetUniformBlockIndex(ID, name.c_str());
+        if (index != GL_INVALID_INDEX)
+            glUniformBlockBinding(ID, index, binding);
     }
 
-private:
     // utility function for checking shader compilation/linking errors.
     // ------------------------------------------------------------------------
-    void checkCompileErrors(GLuint shader, std::string type)
+    static bool checkCompileErrors(GLuint shader, std::string type)
     {
         GLint success;
         GLchar infoLog[1024];
@@ -160,6 +169,7 @@ private:
                 std::cout << "ERROR::PROGRAM_LINKING_ERROR of type: " << type << "\n" << infoLog << "\n -- --------------------------------------------------- -- " << std::endl;
             }
         }
+        return success != 0;
     }
 };
 #endif
\ No newline at end of file
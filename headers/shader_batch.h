@@ -0,0 +1,166 @@
+#ifndef SHADER_BATCH_H
+#define SHADER_BATCH_H
+
+#include <glad/glad.h>
+
+#include <shader.h>
+#include <vfs.h>
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <iostream>
+
+//////// SHADER BATCHES ////
+// - loads many programs in one sweep instead of one Shader constructor after another: every program is queued with
+//      add(), then load() opens all distinct source files through vfs() up front (so packs and mounts apply), compiles
+//      every distinct stage exactly once, links every program and only then asks GL how it went. Drivers that compile
+//      on worker threads get all of the work at once instead of being waited on after each stage
+// - sources go to glShaderSource straight from the VfsFile view with explicit lengths: a file from a directory mount
+//      or a stored pack entry is never copied on our side. Only compressed pack entries are decompressed into a buffer
+// - stats counts what the load cost: files, source bytes, how many of them were copied or allocated for, compiles and
+//      links (src/Tools/shaderbench.cpp compares against the ifstream -> stringstream -> string path)
+// - linked programs are reflected into shaderReflections() (shader_reflection.h) before program() hands them out
+
+struct ShaderLoadStats
+{
+    size_t files = 0;
+    size_t bytes = 0;           // source bytes handed to GL
+    size_t bytesCopied = 0;     // of those, bytes that went through a buffer of ours
+    size_t allocations = 0;     // source buffers allocated
+    size_t compiles = 0;
+    size_t links = 0;
+    double seconds = 0.0;
+};
+
+class ShaderBatch
+{
+public:
+    ShaderLoadStats stats;
+
+    // queue a program from two virtual paths; the returned index is passed to program() after load()
+    // ------------------------------------------------------------------------
+    size_t add(std::string_view vertexPath, std::string_view fragmentPath)
+    {
+        programs.push_back({ stage(vertexPath, GL_VERTEX_SHADER), stage(fragmentPath, GL_FRAGMENT_SHADER), 0 });
+        return programs.size() - 1;
+    }
+    // read, compile and link everything queued; false if any file, stage or program failed (each is reported)
+    // ------------------------------------------------------------------------
+    bool load()
+    {
+        auto start = std::chrono::steady_clock::now();
+        bool ok = true;
+        // one I/O sweep: open and start reading in every file before the first compile touches any of them
+        for (Stage& s : stages)
+        {
+            if (!vfs().open(s.path, s.file))
+            {
+                ok = false;
+                continue;
+            }
+            s.file.willNeed();
+            stats.files++;
+            stats.bytes += s.file.size();
+            if (!s.file.mapped())
+            {
+                stats.bytesCopied += s.file.size();
+                stats.allocations++;
+            }
+        }
+        for (Stage& s : stages)
+        {
+            if (!s.file.isOpen())
+                continue;
+            s.shader = Shader::compileStage(s.type, s.file.text().data(), s.file.size());
+            stats.compiles++;
+        }
+        for (Program& p : programs)
+        {
+            if (!stages[p.vertex].shader || !stages[p.fragment].shader)
+                continue;
+            p.id = glCreateProgram();
+            glAttachShader(p.id, stages[p.vertex].shader);
+            glAttachShader(p.id, stages[p.fragment].shader);
+            glLinkProgram(p.id);
+            stats.links++;
+        }
+        // now wait on the results
+        for (Stage& s : stages)
+        {
+            if (s.shader && !Shader::checkCompileErrors(s.shader, s.type == GL_VERTEX_SHADER ? "VERTEX" : "FRAGMENT"))
+            {
+                std::cout << "    in " << s.path << std::endl;
+                ok = false;
+            }
+        }
+        for (Program& p : programs)
+        {
+            bool linked = p.id && Shader::checkCompileErrors(p.id, "PROGRAM");
+            if (linked)
+                shaderReflections().reflect(p.id);
+            else if (p.id)
+            {
+                // nothing will use a program that didn't link, and nothing else would delete it
+                glDeleteProgram(p.id);
+                p.id = 0;
+            }
+            ok = linked && ok;
+        }
+        // the programs keep what they need; the stages and sources go
+        for (Stage& s : stages)
+        {
+            if (s.shader)
+                glDeleteShader(s.shader);
+            s.shader = 0;
+            s.file.close();
+        }
+        stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+    // ID 0 if the program failed to load
+    // ------------------------------------------------------------------------
+    Shader program(size_t index) const
+    {
+        return Shader(programs[index].id);
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "SHADER_BATCH:: " << programs.size() << " programs from " << stats.files << " files in " << stats.seconds * 1000.0 << " ms: "
+                  << stats.compiles << " compiles, " << stats.links << " links, " << stats.bytes << " source bytes, " << stats.bytesCopied
+                  << " copied, " << stats.allocations << " source allocations" << std::endl;
+    }
+
+private:
+    struct Stage
+    {
+        std::string path;
+        GLenum type;
+        VfsFile file;
+        unsigned int shader = 0;
+    };
+    struct Program
+    {
+        size_t vertex, fragment;
+        unsigned int id;
+    };
+    std::vector<Stage> stages;
+    std::vector<Program> programs;
+
+    // a stage is compiled once however many programs use it
+    // ------------------------------------------------------------------------
+    size_t stage(std::string_view path, GLenum type)
+    {
+        for (size_t i = 0; i < stages.size(); i++)
+            if (stages[i].path == path && stages[i].type == type)
+                return i;
+        stages.emplace_back();
+        stages.back().path = std::string(path);
+        stages.back().type = type;
+        return stages.size() - 1;
+    }
+};
+#endif
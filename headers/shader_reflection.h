@@ -0,0 +1,475 @@
+#ifndef SHADER_REFLECTION_H
+#define SHADER_REFLECTION_H
+
+#include <glad/glad.h>
+
+#include <gl_objects.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+//////// SHADER REFLECTION ////
+// - after a program links, reflect() asks GL once for everything it uses: vertex attributes, default block uniforms
+//      (samplers included), uniform blocks and shader storage blocks, with their types, locations and bindings. The
+//      result is a compact table: 24 byte entries sorted by kind and name, names packed into one string
+// - programs made through Shader, ShaderBatch or PipelineLibrary are reflected into shaderReflections(), and Shader's
+//      set* functions look locations up there instead of calling glGetUniformLocation on every use, so drawing makes
+//      no GL queries at all
+// - with SHADER_VALIDATION on (the default unless NDEBUG is defined) mistakes are reported as they happen instead of
+//      showing up as a black screen: setting a uniform the program doesn't have ("TexCoord" for "aTexCoord", or one the
+//      compiler dropped as unused), and validateDraw() checks a program against the VAO and the resources bound for
+//      it: every attribute enabled at its location with a matching int/float kind, a texture on every sampler's unit
+//      and a buffer on every block's binding point. Release builds compile validateDraw() to nothing
+// - storage blocks are only reflected on 4.3 contexts, which have the program interface queries they need
+
+#ifndef SHADER_VALIDATION
+#ifdef NDEBUG
+#define SHADER_VALIDATION 0
+#else
+#define SHADER_VALIDATION 1
+#endif
+#endif
+
+enum class ShaderResourceKind : uint8_t
+{
+    Attribute,
+    Uniform,        // default block uniform; samplers are uniforms whose type isSamplerType()
+    UniformBlock,
+    StorageBlock,
+};
+
+struct ShaderResource
+{
+    uint32_t nameOffset;        // into ShaderReflection::names
+    uint16_t nameLength;
+    ShaderResourceKind kind;
+    uint8_t reserved;
+    GLenum type;                // GL_FLOAT_VEC3, GL_SAMPLER_2D, ...; 0 for blocks
+    int32_t location;           // attribute or uniform location, block index for blocks
+    int32_t binding;            // texture unit of a sampler or binding point of a block when reflected, else -1
+    int32_t count;              // array size, or the data size in bytes of a block
+};
+static_assert(sizeof(ShaderResource) == 24, "ShaderResource is a 24 byte table entry");
+
+// ------------------------------------------------------------------------
+inline bool isSamplerType(GLenum type)
+{
+    switch (type)
+    {
+    case GL_SAMPLER_1D: case GL_SAMPLER_2D: case GL_SAMPLER_3D: case GL_SAMPLER_CUBE:
+    case GL_SAMPLER_1D_SHADOW: case GL_SAMPLER_2D_SHADOW: case GL_SAMPLER_CUBE_SHADOW:
+    case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_SAMPLER_2D_ARRAY_SHADOW:
+    case GL_SAMPLER_2D_MULTISAMPLE: case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_SAMPLER_BUFFER:
+    case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW:
+    case GL_INT_SAMPLER_1D: case GL_INT_SAMPLER_2D: case GL_INT_SAMPLER_3D: case GL_INT_SAMPLER_CUBE:
+    case GL_INT_SAMPLER_1D_ARRAY: case GL_INT_SAMPLER_2D_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE:
+    case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_BUFFER: case GL_INT_SAMPLER_2D_RECT:
+    case GL_UNSIGNED_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_3D:
+    case GL_UNSIGNED_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+    case GL_UNSIGNED_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        return true;
+    default:
+        return false;
+    }
+}
+// the glGetIntegerv query for the texture a sampler of this type reads from its unit; GL_NONE if not a sampler type
+// ------------------------------------------------------------------------
+inline GLenum samplerBindingQuery(GLenum type)
+{
+    switch (type)
+    {
+    case GL_SAMPLER_1D: case GL_SAMPLER_1D_SHADOW: case GL_INT_SAMPLER_1D: case GL_UNSIGNED_INT_SAMPLER_1D:
+        return GL_TEXTURE_BINDING_1D;
+    case GL_SAMPLER_2D: case GL_SAMPLER_2D_SHADOW: case GL_INT_SAMPLER_2D: case GL_UNSIGNED_INT_SAMPLER_2D:
+        return GL_TEXTURE_BINDING_2D;
+    case GL_SAMPLER_3D: case GL_INT_SAMPLER_3D: case GL_UNSIGNED_INT_SAMPLER_3D:
+        return GL_TEXTURE_BINDING_3D;
+    case GL_SAMPLER_CUBE: case GL_SAMPLER_CUBE_SHADOW: case GL_INT_SAMPLER_CUBE: case GL_UNSIGNED_INT_SAMPLER_CUBE:
+        return GL_TEXTURE_BINDING_CUBE_MAP;
+    case GL_SAMPLER_1D_ARRAY: case GL_SAMPLER_1D_ARRAY_SHADOW: case GL_INT_SAMPLER_1D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+        return GL_TEXTURE_BINDING_1D_ARRAY;
+    case GL_SAMPLER_2D_ARRAY: case GL_SAMPLER_2D_ARRAY_SHADOW: case GL_INT_SAMPLER_2D_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+        return GL_TEXTURE_BINDING_2D_ARRAY;
+    case GL_SAMPLER_2D_MULTISAMPLE: case GL_INT_SAMPLER_2D_MULTISAMPLE: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+        return GL_TEXTURE_BINDING_2D_MULTISAMPLE;
+    case GL_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY: case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+        return GL_TEXTURE_BINDING_2D_MULTISAMPLE_ARRAY;
+    case GL_SAMPLER_BUFFER: case GL_INT_SAMPLER_BUFFER: case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+        return GL_TEXTURE_BINDING_BUFFER;
+    case GL_SAMPLER_2D_RECT: case GL_SAMPLER_2D_RECT_SHADOW: case GL_INT_SAMPLER_2D_RECT: case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+        return GL_TEXTURE_BINDING_RECTANGLE;
+    default:
+        return GL_NONE;
+    }
+}
+// attributes of these types have to come from glVertexAttribIFormat/glVertexAttribIPointer (attrib(..., integer = true))
+// ------------------------------------------------------------------------
+inline bool isIntegerType(GLenum type)
+{
+    switch (type)
+    {
+    case GL_INT: case GL_INT_VEC2: case GL_INT_VEC3: case GL_INT_VEC4:
+    case GL_UNSIGNED_INT: case GL_UNSIGNED_INT_VEC2: case GL_UNSIGNED_INT_VEC3: case GL_UNSIGNED_INT_VEC4:
+        return true;
+    default:
+        return false;
+    }
+}
+
+class ShaderReflection
+{
+public:
+    unsigned int program = 0;
+    std::vector<ShaderResource> resources;
+    std::string names;
+
+    // (re)build the table from a linked program
+    // ------------------------------------------------------------------------
+    void reflect(unsigned int id)
+    {
+        program = id;
+        resources.clear();
+        names.clear();
+        warned.clear();
+        std::vector<std::pair<ShaderResource, std::string>> found;
+        auto add = [&](ShaderResourceKind kind, std::string name, GLenum type, int location, int binding, int count)
+        {
+            ShaderResource r = {};
+            r.kind = kind;
+            r.type = type;
+            r.location = location;
+            r.binding = binding;
+            r.count = count;
+            found.push_back({ r, std::move(name) });
+        };
+        GLint linked = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (!linked)
+            return;
+        std::vector<char> name;
+        GLint active = 0, maxLength = 0;
+
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTES, &active);
+        glGetProgramiv(program, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &maxLength);
+        name.resize(std::max(maxLength, 1));
+        for (GLint i = 0; i < active; i++)
+        {
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveAttrib(program, (GLuint)i, (GLsizei)name.size(), &length, &size, &type, name.data());
+            add(ShaderResourceKind::Attribute, std::string(name.data(), length), type, glGetAttribLocation(program, name.data()), -1, size);
+        }
+
+        glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &active);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+        name.resize(std::max(maxLength, 1));
+        for (GLint i = 0; i < active; i++)
+        {
+            GLuint index = (GLuint)i;
+            GLint block = -1;
+            glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_BLOCK_INDEX, &block);
+            if (block != -1)
+                continue;   // lives in a uniform block's buffer, there is no location to set
+            GLsizei length = 0;
+            GLint size = 0;
+            GLenum type = 0;
+            glGetActiveUniform(program, index, (GLsizei)name.size(), &length, &size, &type, name.data());
+            GLint location = glGetUniformLocation(program, name.data());
+            GLint unit = -1;
+            if (isSamplerType(type))
+                glGetUniformiv(program, location, &unit);
+            // arrays are reported as "name[0]"; they are set through the plain name
+            std::string uniform(name.data(), length);
+            if (uniform.size() > 3 && uniform.compare(uniform.size() - 3, 3, "[0]") == 0)
+                uniform.resize(uniform.size() - 3);
+            add(ShaderResourceKind::Uniform, std::move(uniform), type, location, unit, size);
+        }
+
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &active);
+        glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+        name.resize(std::max(maxLength, 1));
+        for (GLint i = 0; i < active; i++)
+        {
+            GLsizei length = 0;
+            GLint binding = 0, size = 0;
+            glGetActiveUniformBlockName(program, (GLuint)i, (GLsizei)name.size(), &length, name.data());
+            glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_BINDING, &binding);
+            glGetActiveUniformBlockiv(program, (GLuint)i, GL_UNIFORM_BLOCK_DATA_SIZE, &size);
+            add(ShaderResourceKind::UniformBlock, std::string(name.data(), length), 0, i, binding, size);
+        }
+
+        if (GLAD_GL_VERSION_4_3)
+        {
+            glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_ACTIVE_RESOURCES, &active);
+            glGetProgramInterfaceiv(program, GL_SHADER_STORAGE_BLOCK, GL_MAX_NAME_LENGTH, &maxLength);
+            name.resize(std::max(maxLength, 1));
+            const GLenum properties[2] = { GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE };
+            for (GLint i = 0; i < active; i++)
+            {
+                GLsizei length = 0;
+                GLint values[2] = { -1, 0 };
+                glGetProgramResourceName(program, GL_SHADER_STORAGE_BLOCK, (GLuint)i, (GLsizei)name.size(), &length, name.data());
+                glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, (GLuint)i, 2, properties, 2, NULL, values);
+                add(ShaderResourceKind::StorageBlock, std::string(name.data(), length), 0, i, values[0], values[1]);
+            }
+        }
+
+        std::sort(found.begin(), found.end(), [](const auto& a, const auto& b)
+        {
+            return a.first.kind != b.first.kind ? a.first.kind < b.first.kind : a.second < b.second;
+        });
+        resources.reserve(found.size());
+        for (auto& entry : found)
+        {
+            entry.first.nameOffset = (uint32_t)names.size();
+            entry.first.nameLength = (uint16_t)entry.second.size();
+            names += entry.second;
+            resources.push_back(entry.first);
+        }
+    }
+    // ------------------------------------------------------------------------
+    std::string_view name(const ShaderResource& resource) const
+    {
+        return std::string_view(names).substr(resource.nameOffset, resource.nameLength);
+    }
+    // binary search of the table; NULL if the program has no such active resource
+    // ------------------------------------------------------------------------
+    const ShaderResource* find(ShaderResourceKind kind, std::string_view resourceName) const
+    {
+        auto it = std::lower_bound(resources.begin(), resources.end(), std::make_pair(kind, resourceName),
+            [this](const ShaderResource& r, const std::pair<ShaderResourceKind, std::string_view>& key)
+            {
+                return r.kind != key.first ? r.kind < key.first : name(r) < key.second;
+            });
+        if (it == resources.end() || it->kind != kind || name(*it) != resourceName)
+            return NULL;
+        return &*it;
+    }
+    // where a member of a uniform or storage block sits ("materials[0].tint"): its byte offset in the block and the
+    //      stride of the top-level array it is part of, 0 if none. Asked of GL rather than kept in the table since it's
+    //      only needed to check a CPU struct against the block once; false if the program has no such active member
+    // ------------------------------------------------------------------------
+    bool blockMember(const std::string& member, int& offset, int& arrayStride) const
+    {
+        offset = -1;
+        arrayStride = 0;
+        auto uniformOffset = [this](const std::string& uniform)
+        {
+            const char* names[1] = { uniform.c_str() };
+            GLuint index = GL_INVALID_INDEX;
+            GLint value = -1;
+            glGetUniformIndices(program, 1, names, &index);
+            if (index != GL_INVALID_INDEX)
+                glGetActiveUniformsiv(program, 1, &index, GL_UNIFORM_OFFSET, &value);
+            return value;
+        };
+        offset = uniformOffset(member);
+        if (offset >= 0)
+        {
+            // a uniform block only gives the stride of the innermost array, so step the outer index instead
+            size_t first = member.find("[0]");
+            if (first != std::string::npos)
+            {
+                int next = uniformOffset(member.substr(0, first) + "[1]" + member.substr(first + 3));
+                arrayStride = next >= 0 ? next - offset : 0;
+            }
+            return true;
+        }
+        if (!GLAD_GL_VERSION_4_3)
+            return false;
+        GLuint index = glGetProgramResourceIndex(program, GL_BUFFER_VARIABLE, member.c_str());
+        if (index == GL_INVALID_INDEX)
+            return false;
+        const GLenum properties[2] = { GL_OFFSET, GL_TOP_LEVEL_ARRAY_STRIDE };
+        GLint values[2] = { -1, 0 };
+        glGetProgramResourceiv(program, GL_BUFFER_VARIABLE, index, 2, properties, 2, NULL, values);
+        offset = values[0];
+        arrayStride = values[1];
+        return true;
+    }
+    // the location to pass to glUniform*, -1 if the program has no such uniform (which glUniform* ignores)
+    // ------------------------------------------------------------------------
+    int uniformLocation(std::string_view uniform) const
+    {
+        if (const ShaderResource* r = find(ShaderResourceKind::Uniform, uniform))
+            return r->location;
+        // elements past the first of an array ("lights[2]") aren't in the table, those are still asked for
+        if (uniform.find('[') != std::string_view::npos)
+            return glGetUniformLocation(program, std::string(uniform).c_str());
+#if SHADER_VALIDATION
+        if (std::find(warned.begin(), warned.end(), uniform) == warned.end())
+        {
+            warned.push_back(std::string(uniform));
+            std::cout << "ERROR::SHADER_REFLECTION::UNKNOWN_UNIFORM: \"" << uniform << "\" is not an active uniform of program " << program
+                      << " (misspelled, or optimized out because nothing uses it)" << std::endl;
+        }
+#endif
+        return -1;
+    }
+    // check the program against vao and what is bound right now; prints every mismatch, false if there was one
+    // ------------------------------------------------------------------------
+    bool validate(const VertexArray& vao) const
+    {
+        bool ok = true;
+        auto fail = [&](const char* what, const ShaderResource& r, const std::string& detail)
+        {
+            std::cout << "ERROR::SHADER_REFLECTION::" << what << ": " << name(r) << " of program " << program << " " << detail << std::endl;
+            ok = false;
+        };
+        for (const ShaderResource& r : resources)
+        {
+            switch (r.kind)
+            {
+            case ShaderResourceKind::Attribute:
+            {
+                if (r.location < 0)
+                    break;  // built-ins like gl_VertexID
+                const auto& attribs = vao.enabledAttribs();
+                auto a = std::find_if(attribs.begin(), attribs.end(), [&](const VertexArray::Attrib& v) { return (int)v.location == r.location; });
+                if (a == attribs.end())
+                    fail("MISSING_ATTRIBUTE", r, "(location " + std::to_string(r.location) + ") is not enabled in VAO " + std::to_string(vao.ID));
+                else if (a->integer != isIntegerType(r.type))
+                    fail("ATTRIBUTE_TYPE_MISMATCH", r, std::string("is read as ") + (isIntegerType(r.type) ? "integer" : "float") + " but VAO "
+                         + std::to_string(vao.ID) + " supplies " + (a->integer ? "integers" : "floats") + " at location " + std::to_string(r.location));
+                break;
+            }
+            case ShaderResourceKind::Uniform:
+            {
+                if (!isSamplerType(r.type))
+                    break;
+                GLint unit = 0;
+                glGetUniformiv(program, r.location, &unit);
+                // the cache only sees binds made through it, and the samples still call glBindTexture directly, so
+                //      unless it knows a texture is there GL is asked what the unit really has bound
+                unsigned int texture = glState().boundTexture((unsigned int)unit);
+                if (texture == 0 || texture == GL_STATE_UNKNOWN)
+                    texture = boundTexture((unsigned int)unit, r.type);
+                if (texture == 0)
+                    fail("SAMPLER_UNBOUND", r, "reads texture unit " + std::to_string(unit) + " which has no texture bound");
+                break;
+            }
+            case ShaderResourceKind::UniformBlock:
+            {
+                GLint binding = 0, buffer = 0;
+                glGetActiveUniformBlockiv(program, (GLuint)r.location, GL_UNIFORM_BLOCK_BINDING, &binding);
+                glGetIntegeri_v(GL_UNIFORM_BUFFER_BINDING, (GLuint)binding, &buffer);
+                if (buffer == 0)
+                    fail("BLOCK_UNBOUND", r, "uses uniform buffer binding " + std::to_string(binding) + " which has no buffer bound");
+                break;
+            }
+            case ShaderResourceKind::StorageBlock:
+            {
+                GLint binding = 0, buffer = 0;
+                const GLenum property = GL_BUFFER_BINDING;
+                glGetProgramResourceiv(program, GL_SHADER_STORAGE_BLOCK, (GLuint)r.location, 1, &property, 1, NULL, &binding);
+                glGetIntegeri_v(GL_SHADER_STORAGE_BUFFER_BINDING, (GLuint)binding, &buffer);
+                if (buffer == 0)
+                    fail("BLOCK_UNBOUND", r, "uses shader storage binding " + std::to_string(binding) + " which has no buffer bound");
+                break;
+            }
+            }
+        }
+        return ok;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        static const char* kinds[] = { "attribute", "uniform", "uniform block", "storage block" };
+        size_t counts[4] = {}, samplers = 0;
+        for (const ShaderResource& r : resources)
+        {
+            counts[(int)r.kind]++;
+            samplers += isSamplerType(r.type) ? 1 : 0;
+        }
+        std::cout << "SHADER_REFLECTION:: program " << program << ": " << counts[0] << " attributes, " << counts[1] << " uniforms (" << samplers
+                  << " samplers), " << counts[2] << " uniform blocks, " << counts[3] << " storage blocks, "
+                  << resources.size() * sizeof(ShaderResource) + names.size() << " bytes" << std::endl;
+        for (const ShaderResource& r : resources)
+        {
+            std::cout << "    " << kinds[(int)r.kind] << " " << name(r) << ": " << (r.kind < ShaderResourceKind::UniformBlock ? "location " : "index ")
+                      << r.location;
+            if (r.binding >= 0)
+                std::cout << (isSamplerType(r.type) ? ", unit " : ", binding ") << r.binding;
+            if (r.kind >= ShaderResourceKind::UniformBlock)
+                std::cout << ", " << r.count << " bytes";
+            else
+                std::cout << ", type 0x" << std::hex << r.type << std::dec << (r.count > 1 ? ", array of " + std::to_string(r.count) : "");
+            std::cout << std::endl;
+        }
+    }
+
+private:
+    mutable std::vector<std::string> warned;    // unknown uniforms already reported
+
+    // the texture GL has bound on unit for a sampler of type; leaves the active texture unit as it was
+    // ------------------------------------------------------------------------
+    static unsigned int boundTexture(unsigned int unit, GLenum type)
+    {
+        GLenum query = samplerBindingQuery(type);
+        if (query == GL_NONE)
+            return GL_STATE_UNKNOWN;
+        GLint active = GL_TEXTURE0, texture = 0;
+        glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glGetIntegerv(query, &texture);
+        glActiveTexture((GLenum)active);
+        return (unsigned int)texture;
+    }
+};
+
+// the reflections of every program made through Shader, ShaderBatch and PipelineLibrary, by program ID
+class ShaderReflectionRegistry
+{
+public:
+    // ------------------------------------------------------------------------
+    const ShaderReflection& reflect(unsigned int program)
+    {
+        ShaderReflection& reflection = programs[program];
+        reflection.reflect(program);
+        return reflection;
+    }
+    // ------------------------------------------------------------------------
+    const ShaderReflection* find(unsigned int program) const
+    {
+        auto found = programs.find(program);
+        return found == programs.end() ? NULL : &found->second;
+    }
+    // call when deleting a program, so a later program that reuses the ID isn't looked up in a stale table
+    // ------------------------------------------------------------------------
+    void forget(unsigned int program)
+    {
+        programs.erase(program);
+    }
+
+private:
+    std::unordered_map<unsigned int, ShaderReflection> programs;
+};
+
+inline ShaderReflectionRegistry& shaderReflections()
+{
+    static ShaderReflectionRegistry instance;
+    return instance;
+}
+
+// check a draw's program against its VAO and bound resources once, up front; nothing in release builds
+// ------------------------------------------------------------------------
+inline bool validateDraw(unsigned int program, const VertexArray& vao)
+{
+#if SHADER_VALIDATION
+    const ShaderReflection* reflection = shaderReflections().find(program);
+    return reflection ? reflection->validate(vao) : true;
+#else
+    (void)program;
+    (void)vao;
+    return true;
+#endif
+}
+#endif
@@ -0,0 +1,228 @@
+#ifndef VERTEX_FORMAT_H
+#define VERTEX_FORMAT_H
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <glm/packing.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+// what an attribute means, used to pick its compact encoding
+enum class VertexSemantic
+{
+    Position,
+    Normal,
+    Color,
+    TexCoord,
+    Generic
+};
+
+// how an attribute is stored in the vertex buffer
+enum class AttribFormat
+{
+    Float,          // 4 bytes per component
+    Half,           // GL_HALF_FLOAT, always stored as 4 components to keep 4 byte alignment
+    Int2_10_10_10,  // GL_INT_2_10_10_10_REV, normalized signed, 4 bytes total
+    Unorm8,         // GL_UNSIGNED_BYTE normalized, always stored as 4 components
+    Unorm16         // GL_UNSIGNED_SHORT normalized, [0, 1] range only (values outside are clamped)
+};
+
+struct VertexAttrib
+{
+    VertexSemantic semantic;
+    unsigned int location;   // layout (location = N) in the vertex shader
+    int components;          // components the shader reads (1-4)
+    AttribFormat format;
+    unsigned int offset;     // filled in by VertexFormat
+};
+
+// A declarative vertex layout. Describe the attributes once and the format works out the offsets, stride and the
+// matching glVertexAttribPointer calls:
+//
+//     VertexFormat format;
+//     format.add(VertexSemantic::Position, 0, 3).add(VertexSemantic::Color, 1, 3).add(VertexSemantic::TexCoord, 2, 2);
+//     VertexFormat packed = format.compact(vertices, 4);
+//     std::vector<unsigned char> data = format.convert(vertices, 4, packed);
+//     packed.setupAttributes();
+class VertexFormat
+{
+public:
+    std::vector<VertexAttrib> attribs;
+    unsigned int stride = 0;
+
+    // append an attribute; offsets and stride follow declaration order
+    // ------------------------------------------------------------------------
+    VertexFormat& add(VertexSemantic semantic, unsigned int location, int components, AttribFormat format = AttribFormat::Float)
+    {
+        VertexAttrib attrib = { semantic, location, components, format, stride };
+        attribs.push_back(attrib);
+        stride += attribSize(attrib);
+        return *this;
+    }
+    // the same layout with every attribute switched to its compact encoding:
+    // positions -> half floats, normals -> 2_10_10_10, colors -> unorm8, texture coords -> unorm16 when the vertices
+    // (in this layout) show they all lie in [0, 1], half floats otherwise, since unorm16 would clamp tiling or negative
+    // coords. Without vertices to check, texture coords take the safe half float encoding
+    // ------------------------------------------------------------------------
+    VertexFormat compact(const void* vertices = NULL, size_t vertexCount = 0) const
+    {
+        VertexFormat result;
+        for (const VertexAttrib& attrib : attribs)
+        {
+            AttribFormat format = attrib.format;
+            switch (attrib.semantic)
+            {
+            case VertexSemantic::Position: format = AttribFormat::Half; break;
+            case VertexSemantic::Normal:   format = attrib.components == 3 ? AttribFormat::Int2_10_10_10 : AttribFormat::Half; break;
+            case VertexSemantic::Color:    format = AttribFormat::Unorm8; break;
+            case VertexSemantic::TexCoord:
+                format = attrib.components <= 2 && inUnitRange(attrib, vertices, vertexCount) ? AttribFormat::Unorm16 : AttribFormat::Half;
+                break;
+            case VertexSemantic::Generic:  break;
+            }
+            result.add(attrib.semantic, attrib.location, attrib.components, format);
+        }
+        return result;
+    }
+    // configure the currently bound VAO for this layout, reading from the currently bound GL_ARRAY_BUFFER
+    // ------------------------------------------------------------------------
+    void setupAttributes(size_t baseOffset = 0) const
+    {
+        for (const VertexAttrib& attrib : attribs)
+        {
+            GLint size = attrib.components;
+            GLenum type = GL_FLOAT;
+            GLboolean normalized = GL_FALSE;
+            switch (attrib.format)
+            {
+            case AttribFormat::Float:         break;
+            case AttribFormat::Half:          type = GL_HALF_FLOAT; size = 4; break;
+            case AttribFormat::Int2_10_10_10: type = GL_INT_2_10_10_10_REV; size = 4; normalized = GL_TRUE; break;
+            case AttribFormat::Unorm8:        type = GL_UNSIGNED_BYTE; size = 4; normalized = GL_TRUE; break;
+            case AttribFormat::Unorm16:       type = GL_UNSIGNED_SHORT; normalized = GL_TRUE; break;
+            }
+            glVertexAttribPointer(attrib.location, size, type, normalized, stride, (void*)(baseOffset + attrib.offset));
+            glEnableVertexAttribArray(attrib.location);
+        }
+    }
+    // re-encode interleaved vertices from this (all Float) layout into the target layout. Attributes are matched by
+    // location; ones missing from this layout are written as zero
+    // ------------------------------------------------------------------------
+    std::vector<unsigned char> convert(const void* vertices, size_t vertexCount, const VertexFormat& target) const
+    {
+        std::vector<unsigned char> out(vertexCount * target.stride, 0);
+        const unsigned char* src = static_cast<const unsigned char*>(vertices);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            const unsigned char* srcVertex = src + v * stride;
+            unsigned char* dstVertex = out.data() + v * target.stride;
+            for (const VertexAttrib& dst : target.attribs)
+            {
+                const VertexAttrib* from = find(dst.location);
+                if (from == NULL || from->format != AttribFormat::Float)
+                    continue;
+                glm::vec4 value(0.0f, 0.0f, 0.0f, 1.0f);
+                std::memcpy(&value[0], srcVertex + from->offset, from->components * sizeof(float));
+                encode(dst, value, dstVertex + dst.offset);
+            }
+        }
+        return out;
+    }
+    // ------------------------------------------------------------------------
+    const VertexAttrib* find(unsigned int location) const
+    {
+        for (const VertexAttrib& attrib : attribs)
+            if (attrib.location == location)
+                return &attrib;
+        return NULL;
+    }
+    // print how many bytes per vertex and in total this layout saves compared to another one
+    // ------------------------------------------------------------------------
+    void reportSavings(const VertexFormat& original, size_t vertexCount) const
+    {
+        size_t before = (size_t)original.stride * vertexCount;
+        size_t after = (size_t)stride * vertexCount;
+        // signed: a layout can come out larger than the original (half floats replacing single floats, say)
+        long long saved = (long long)before - (long long)after;
+        std::cout << "VERTEX_FORMAT:: stride " << original.stride << " -> " << stride << " bytes, "
+                  << before << " -> " << after << " bytes for " << vertexCount << " vertices ("
+                  << (before ? 100.0 * (double)saved / (double)before : 0.0) << "% saved)" << std::endl;
+    }
+
+    // bytes an attribute takes up in the vertex
+    // ------------------------------------------------------------------------
+    static unsigned int attribSize(const VertexAttrib& attrib)
+    {
+        switch (attrib.format)
+        {
+        case AttribFormat::Float:         return 4 * attrib.components;
+        case AttribFormat::Half:          return 8;
+        case AttribFormat::Int2_10_10_10: return 4;
+        case AttribFormat::Unorm8:        return 4;
+        case AttribFormat::Unorm16:       return (2 * attrib.components + 3) & ~3u;
+        }
+        return 0;
+    }
+
+private:
+    // whether every component of a Float attribute lies in [0, 1] in the given vertices; false when there are none
+    // ------------------------------------------------------------------------
+    bool inUnitRange(const VertexAttrib& attrib, const void* vertices, size_t vertexCount) const
+    {
+        if (vertices == NULL || vertexCount == 0 || attrib.format != AttribFormat::Float)
+            return false;
+        const unsigned char* src = static_cast<const unsigned char*>(vertices);
+        for (size_t v = 0; v < vertexCount; v++)
+        {
+            float value[4];
+            std::memcpy(value, src + v * stride + attrib.offset, attrib.components * sizeof(float));
+            for (int i = 0; i < attrib.components; i++)
+                if (!(value[i] >= 0.0f && value[i] <= 1.0f))
+                    return false;
+        }
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    static void encode(const VertexAttrib& attrib, const glm::vec4& value, unsigned char* dst)
+    {
+        switch (attrib.format)
+        {
+        case AttribFormat::Float:
+        {
+            std::memcpy(dst, &value[0], attrib.components * sizeof(float));
+            break;
+        }
+        case AttribFormat::Half:
+        {
+            glm::uint64 packed = glm::packHalf4x16(value);
+            std::memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+        case AttribFormat::Int2_10_10_10:
+        {
+            glm::uint32 packed = glm::packSnorm3x10_1x2(glm::vec4(glm::vec3(value), 0.0f));
+            std::memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+        case AttribFormat::Unorm8:
+        {
+            glm::uint32 packed = glm::packUnorm4x8(value);
+            std::memcpy(dst, &packed, sizeof(packed));
+            break;
+        }
+        case AttribFormat::Unorm16:
+        {
+            for (int i = 0; i < attrib.components; i++)
+            {
+                glm::uint16 packed = glm::packUnorm1x16(value[i]);
+                std::memcpy(dst + i * sizeof(packed), &packed, sizeof(packed));
+            }
+            break;
+        }
+        }
+    }
+};
+#endif
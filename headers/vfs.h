@@ -0,0 +1,282 @@
+#ifndef VFS_H
+#define VFS_H
+
+#include <mapped_file.h>
+#include <pack_file.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include <iostream>
+
+//////// VIRTUAL FILE SYSTEM ////
+// - code asks for virtual paths ("assets/container.jpg") and vfs() finds them in whatever is mounted under that
+//      prefix: a directory on disk or a .pack file (pack_file.h). Mounts are searched newest first, so a directory
+//      mounted over a pack overrides single files while iterating on them
+// - a VfsFile is a read-only view of the whole file: a pointer into the pack's mapping for stored entries (no copy,
+//      no open() per file), its own MappedFile for directory mounts, and a buffer only for compressed entries
+// - views are data()/size() pairs like MappedFile's, or text() for sources
+// - lookups don't lock, so files can be opened from any thread once mounting is done
+
+// One opened file. Whatever it points into stays alive as long as the VfsFile and its pack mount do
+class VfsFile
+{
+public:
+    VfsFile() {}
+    VfsFile(const VfsFile&) = delete;
+    VfsFile& operator=(const VfsFile&) = delete;
+    VfsFile(VfsFile&& other) noexcept { *this = std::move(other); }
+    VfsFile& operator=(VfsFile&& other) noexcept
+    {
+        if (this != &other)
+        {
+            file = std::move(other.file);
+            inflated = std::move(other.inflated);
+            view = other.view;
+            length = other.length;
+            opened = other.opened;
+            zeroCopy = other.zeroCopy;
+            other.close();
+        }
+        return *this;
+    }
+
+    // ------------------------------------------------------------------------
+    bool isOpen() const { return opened; }
+    const unsigned char* data() const { return view; }
+    size_t size() const { return length; }
+    std::string_view text() const { return std::string_view(reinterpret_cast<const char*>(view), length); }
+    // true when data() points into a mapping rather than a decompressed copy
+    bool mapped() const { return zeroCopy; }
+    // start reading the file in ahead of use (directory mounts; a pack is one mapping the OS reads ahead on its own)
+    void willNeed() const { file.willNeed(); }
+
+    // ------------------------------------------------------------------------
+    void close()
+    {
+        file.close();
+        inflated.clear();
+        inflated.shrink_to_fit();
+        view = NULL;
+        length = 0;
+        opened = false;
+        zeroCopy = false;
+    }
+
+private:
+    friend class Vfs;
+    MappedFile file;
+    std::vector<unsigned char> inflated;
+    const unsigned char* view = NULL;
+    size_t length = 0;
+    bool opened = false;
+    bool zeroCopy = false;
+};
+
+class Vfs
+{
+public:
+    std::atomic<uint64_t> opens{ 0 };
+    std::atomic<uint64_t> packOpens{ 0 };
+    std::atomic<uint64_t> directoryOpens{ 0 };
+    std::atomic<uint64_t> bytesInflated{ 0 };
+
+    // make directory visible under prefix ("" mounts at the root)
+    // ------------------------------------------------------------------------
+    bool mount(const char* prefix, const char* directory)
+    {
+        std::error_code error;
+        if (!std::filesystem::is_directory(directory, error))
+        {
+            std::cout << "ERROR::VFS::NOT_A_DIRECTORY: " << directory << std::endl;
+            return false;
+        }
+        Mount m;
+        m.prefix = normalizedPrefix(prefix);
+        m.directory = directory;
+        mounts.push_back(std::move(m));
+        return true;
+    }
+    // make the contents of a .pack file visible under prefix
+    // ------------------------------------------------------------------------
+    bool mountPack(const char* prefix, const char* packPath)
+    {
+        Mount m;
+        m.prefix = normalizedPrefix(prefix);
+        m.pack = std::make_unique<PackFile>();
+        if (!m.pack->open(packPath))
+            return false;
+        mounts.push_back(std::move(m));
+        return true;
+    }
+    // ------------------------------------------------------------------------
+    void unmountAll()
+    {
+        mounts.clear();
+    }
+    // ------------------------------------------------------------------------
+    bool exists(std::string_view path) const
+    {
+        for (size_t i = mounts.size(); i-- > 0;)
+        {
+            std::string_view relative;
+            if (!mounts[i].resolve(path, relative))
+                continue;
+            std::error_code error;
+            if (mounts[i].pack ? mounts[i].pack->find(relative) != NULL
+                               : std::filesystem::is_regular_file(mounts[i].directory + "/" + std::string(relative), error))
+                return true;
+        }
+        return false;
+    }
+    // every file under a virtual directory ("" for all of them) as virtual paths, sorted, each once even when several
+    //      mounts have it
+    // ------------------------------------------------------------------------
+    bool list(std::string_view directory, std::vector<std::string>& paths) const
+    {
+        paths.clear();
+        std::string dir = normalizedPrefix(std::string(directory).c_str());
+        for (const Mount& m : mounts)
+        {
+            // either the whole mount lies inside the directory, or the directory lies inside the mount
+            bool inside = m.prefix.compare(0, dir.size(), dir) == 0;
+            if (!inside && dir.compare(0, m.prefix.size(), m.prefix) != 0)
+                continue;
+            std::string sub = inside ? std::string() : dir.substr(m.prefix.size());
+            if (m.pack)
+            {
+                for (size_t i = 0; i < m.pack->count(); i++)
+                {
+                    std::string_view path = m.pack->path(m.pack->entries[i]);
+                    if (path.compare(0, sub.size(), sub) == 0)
+                        paths.push_back(m.prefix + std::string(path));
+                }
+                continue;
+            }
+            namespace fs = std::filesystem;
+            fs::path root = fs::path(m.directory) / sub;
+            std::error_code error;
+            if (!fs::is_directory(root, error))
+                continue;
+            for (fs::recursive_directory_iterator it(root, error), end; !error && it != end; it.increment(error))
+            {
+                std::error_code fileError;
+                if (it->is_regular_file(fileError))
+                    paths.push_back(m.prefix + sub + it->path().lexically_relative(root).generic_string());
+            }
+            if (error)
+            {
+                std::cout << "ERROR::VFS::COULD_NOT_LIST: " << root.string() << ": " << error.message() << std::endl;
+                return false;
+            }
+        }
+        std::sort(paths.begin(), paths.end());
+        paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+        return true;
+    }
+    // open a virtual path; false (and prints why) if no mount has it or it can't be read
+    // ------------------------------------------------------------------------
+    bool open(std::string_view path, VfsFile& file)
+    {
+        file.close();
+        opens++;
+        for (size_t i = mounts.size(); i-- > 0;)
+        {
+            const Mount& m = mounts[i];
+            std::string_view relative;
+            if (!m.resolve(path, relative))
+                continue;
+            if (m.pack)
+            {
+                const PackFileEntry* entry = m.pack->find(relative);
+                if (!entry)
+                    continue;
+                packOpens++;
+                return openEntry(*m.pack, *entry, path, file);
+            }
+            // trying the open is the existence check, a separate stat would cost a second lookup
+            std::string real = m.directory;
+            real += '/';
+            real += relative;
+            if (!file.file.open(real.c_str(), true))
+                continue;
+            directoryOpens++;
+            file.view = file.file.data();
+            file.length = file.file.size();
+            file.opened = true;
+            file.zeroCopy = true;
+            return true;
+        }
+        std::cout << "ERROR::VFS::NOT_FOUND: " << path << std::endl;
+        return false;
+    }
+    // ------------------------------------------------------------------------
+    void report() const
+    {
+        std::cout << "VFS:: " << mounts.size() << " mount(s), " << opens.load() << " opens: " << packOpens.load() << " from packs, "
+                  << directoryOpens.load() << " from directories, " << bytesInflated.load() / 1024 << " KB decompressed" << std::endl;
+    }
+
+private:
+    struct Mount
+    {
+        std::string prefix;         // empty or ending in '/'
+        std::string directory;
+        std::unique_ptr<PackFile> pack;
+
+        bool resolve(std::string_view path, std::string_view& relative) const
+        {
+            if (path.compare(0, prefix.size(), prefix) != 0)
+                return false;
+            relative = path.substr(prefix.size());
+            return true;
+        }
+    };
+    std::vector<Mount> mounts;
+
+    // ------------------------------------------------------------------------
+    static std::string normalizedPrefix(const char* prefix)
+    {
+        std::string result = prefix;
+        while (!result.empty() && result.back() == '/')
+            result.pop_back();
+        return result.empty() ? result : result + "/";
+    }
+    // ------------------------------------------------------------------------
+    bool openEntry(const PackFile& pack, const PackFileEntry& entry, std::string_view path, VfsFile& file)
+    {
+        if (entry.compression == PACK_STORED)
+        {
+            file.view = pack.stored(entry);
+            file.zeroCopy = true;
+        }
+        else
+        {
+            file.inflated.resize(entry.size);
+            if (!packDecompress(pack.stored(entry), entry.storedSize, file.inflated.data(), entry.size))
+            {
+                std::cout << "ERROR::VFS::CORRUPT_ENTRY: " << path << std::endl;
+                file.close();
+                return false;
+            }
+            bytesInflated += entry.size;
+            file.view = file.inflated.data();
+        }
+        file.length = entry.size;
+        file.opened = true;
+        return true;
+    }
+};
+
+inline Vfs& vfs()
+{
+    static Vfs instance;
+    return instance;
+}
+#endif
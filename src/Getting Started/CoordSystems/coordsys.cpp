@@ -8,7 +8,10 @@
 #include <stb_image.h> // image loading library
 
 #include <shader.h>
+#include <camera.h>
+#include <gl_objects.h>
 
+#include <algorithm>
 #include <iostream>
 
 
@@ -38,6 +41,14 @@
 // 5. Lastly, transform the clip coords to screen coords in a process called viewport transform, which transforms the coords from -1.0 to 1.0 to the
 //      coord range defined by glViewport. The resulting coords are then sent to the rasterizer to turn them into fragments
 
+//// MODEL, VIEW, PROJECTION //
+// - local -> world is the model matrix, set per object
+// - world -> view -> clip is owned by the Camera (camera.h), which caches view, projection and viewProjection and only
+//      rebuilds them when its position/orientation or projection parameters change
+// - view/projection are the same for every object in a frame, so they live in the Frame uniform block and get uploaded
+//      once per frame; only the model matrix is set per draw
+// - the same quad drawn through the rest of headers/ is in src/Showcase
+
 ////////////////////////////////
 
 
@@ -50,6 +61,8 @@ const unsigned int SCR_HEIGHT = 600;
 
 float mixValue = 0.2f; // use up and down arrow keys to adjust the mix value between textures
 
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+
 int main()
 {
     // initialize GLFW, set context options for version 3.3 using the core profile
@@ -80,6 +93,11 @@ int main()
 
 
     Shader ourShader("src/Getting Started/CoordSystems/coordsys.vert", "src/Getting Started/CoordSystems/coordsys.frag");
+    ourShader.setBlockBinding("Frame", FRAME_UBO_BINDING);
+
+    // the quad is tilted away from the camera, so what's nearer has to hide what's behind it
+    glEnable(GL_DEPTH_TEST);
+    camera.setPerspective(FOV, (float)SCR_WIDTH / (float)SCR_HEIGHT, NEAR_PLANE, FAR_PLANE);
 
     // define some vertices for a triangle
     float vertices[] = {
@@ -166,6 +184,10 @@ int main()
     ourShader.setInt("texture1", 0);
     ourShader.setInt("texture2", 1);
 
+    // the buffer behind the Frame block; it is a gl_objects.h Buffer, so it goes before glfwTerminate() destroys the context
+    glState().init();
+    FrameUniforms* frameUniforms = new FrameUniforms();
+
     // render loop - every iteration is known as a "frame"
     while (!glfwWindowShouldClose(window))
     {
@@ -174,7 +196,7 @@ int main()
 
         // rendering commands here
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
         glActiveTexture(GL_TEXTURE0); // activate the texture unit first before binding texture
         // bind texture before calling glDrawElements to assign the texture to the frag shader's sampler
@@ -182,16 +204,16 @@ int main()
         glActiveTexture(GL_TEXTURE1);
         glBindTexture(GL_TEXTURE_2D, texture2);
 
-        // create transformation
-        glm::vec4 vec(1.0f, 0.0f, 0.0f, 1.0f);
-        glm::mat4 trans = glm::mat4(1.0f);
-        trans = glm::translate(trans, glm::vec3(0.5f, -0.5f, 0.0f));
-        trans = glm::rotate(trans, 1.0f * (float)glfwGetTime(), glm::vec3(0.0f, 0.0f, 1.0f));
+        // view and projection for the whole frame (world -> view -> clip)
+        frameUniforms->update(camera, (float)glfwGetTime());
+
+        // model matrix, lays the quad down on the floor (local -> world)
+        glm::mat4 model = glm::mat4(1.0f);
+        model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
 
         ourShader.use();
         ourShader.setFloat("mixValue", mixValue);
-        unsigned int transformLoc = glGetUniformLocation(ourShader.ID, "transform");
-        glUniformMatrix4fv(transformLoc, 1, GL_FALSE, glm::value_ptr(trans));
+        ourShader.setMat4("model", model);
 
         glBindVertexArray(VAO);
         glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
@@ -206,7 +228,11 @@ int main()
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
+    glDeleteTextures(1, &texture1);
+    glDeleteTextures(1, &texture2);
+    delete frameUniforms;
 
+    shaderReflections().forget(ourShader.ID);
     glDeleteProgram(ourShader.ID);
 
     glfwTerminate();
@@ -219,10 +245,18 @@ void framebuffer_size_callback(GLFWwindow* window, int width, int height)
     //// VIEWPORT ////
     // first two #s set location of lower left corner, second two #s set width and height
     glViewport(0, 0, width, height);
+    if (height > 0)
+        camera.setAspect((float)width / (float)height);
 }
 
 void processInput(GLFWwindow* window)
 {
     if (glfwGetKey(window, GLFW_KEY_ESCAPE ) == GLFW_PRESS) // if user presses the ESC key
         glfwSetWindowShouldClose(window, true);				// close the window passed in
+
+    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        mixValue = std::min(mixValue + 0.005f, 1.0f);
+
+    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        mixValue = std::max(mixValue - 0.005f, 0.0f);
 }
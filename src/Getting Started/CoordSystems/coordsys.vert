@@ -5,10 +5,20 @@ layout (location = 2) in vec2 aTexCoord; // the texture variable has attr positi
 
 out vec2 TexCoord; // output texture coords to frag shader
 
-uniform mat4 transform;
+// frame-wide camera data, shared by every shader at binding point 0 (see camera.h)
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 invViewProjection;
+    vec4 cameraPos;
+};
+
+uniform mat4 model;
 
 void main()
 {
-    gl_Position = transform * vec4(aPos, 1.0f);
+    gl_Position = viewProjection * model * vec4(aPos, 1.0f);
     TexCoord = vec2(aTexCoord.x, aTexCoord.y); // set TexCoord to the input texture coords we got from the vertex data
 }
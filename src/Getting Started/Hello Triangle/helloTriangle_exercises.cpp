@@ -1,6 +1,8 @@
 #include <glad/glad.h>
 #include <glfw/glfw3.h>
 
+#include <program_pipeline.h>
+
 #include <iostream>
 
 void framebuffer_size_callback(GLFWwindow* window, int width, int height);
@@ -63,39 +65,15 @@ int main()
 	}
 
 
-//////// VERTEX SHADER ////
-
-	// setup vertex shader object
-	unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	glShaderSource(vertexShader, 1, &vertexShaderSource, NULL);
-	glCompileShader(vertexShader);
-
-//////// FRAGMENT SHADER ////
-
-	// very similar thing as the vertex shader object setup
-	unsigned int fragmentShaderOrange = glCreateShader(GL_FRAGMENT_SHADER);
-	unsigned int fragmentShaderYellow = glCreateShader(GL_FRAGMENT_SHADER);
-	glShaderSource(fragmentShaderOrange, 1, &fragmentShaderSource1, NULL);
-	glCompileShader(fragmentShaderOrange);
-	glShaderSource(fragmentShaderYellow, 1, &fragmentShaderSource2, NULL);
-	glCompileShader(fragmentShaderYellow);
-
-//////// SHADER PROGRAM //// - linked version of multiple shaders
-	
-	unsigned int shaderProgramOrange = glCreateProgram();
-	unsigned int shaderProgramYellow = glCreateProgram();
-
-	glAttachShader(shaderProgramOrange, vertexShader);
-	glAttachShader(shaderProgramOrange, fragmentShaderOrange);
-	glLinkProgram(shaderProgramOrange);
-	glAttachShader(shaderProgramYellow, vertexShader);
-	glAttachShader(shaderProgramYellow, fragmentShaderYellow);
-	glLinkProgram(shaderProgramYellow);
+//////// SHADER STAGES //// - compiled once each, then mixed and matched
 
-	// clean up shader objects, no longer needed now that they're linked
-	glDeleteShader(vertexShader);
-	glDeleteShader(fragmentShaderOrange);
-	glDeleteShader(fragmentShaderYellow);
+	// one vertex stage shared by two fragment stages. Each stage is compiled (and with GL 4.1 linked as a separable
+	// program) exactly once; a pipeline per (vertex, fragment) pair combines them instead of linking the vertex shader
+	// into a full program per color (program_pipeline.h)
+	PipelineLibrary pipelines;
+	size_t vertexStage = pipelines.addStage(GL_VERTEX_SHADER, vertexShaderSource);
+	size_t orangeStage = pipelines.addStage(GL_FRAGMENT_SHADER, fragmentShaderSource1);
+	size_t yellowStage = pipelines.addStage(GL_FRAGMENT_SHADER, fragmentShaderSource2);
 
 //////// VERTEX INPUT ////
 
@@ -147,11 +125,11 @@ int main()
 		glClear(GL_COLOR_BUFFER_BIT);
 
 		// draw our first triangle
-		glUseProgram(shaderProgramOrange);
+		pipelines.bind(vertexStage, orangeStage);
 		glBindVertexArray(VAOs[0]); // bind first VAO
 		glDrawArrays(GL_TRIANGLES, 0, 3); // draw first triangle
 
-		glUseProgram(shaderProgramYellow);
+		pipelines.bind(vertexStage, yellowStage);
 		glBindVertexArray(VAOs[1]); // bind second VAO, no need to unbind
 		glDrawArrays(GL_TRIANGLES, 0, 3); // draw second triangle
 
@@ -163,8 +141,8 @@ int main()
 
 	glDeleteVertexArrays(2, VAOs);
 	glDeleteBuffers(2, VBOs);
-	glDeleteProgram(shaderProgramOrange);
-	glDeleteProgram(shaderProgramYellow);
+	pipelines.report();
+	pipelines.destroy();
 
 	glfwTerminate();
 	return 0;
@@ -0,0 +1,478 @@
+#include <glad/glad.h>
+#include <glfw/glfw3.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <stb_image.h> // image loading library
+#include <image_decode.h>
+#include <asset_index.h>
+#include <vfs.h>
+
+#include <shader.h>
+#include <shader_batch.h>
+#include <shader_reflection.h>
+#include <material.h>
+#include <frame_graph.h>
+#include <render_target.h>
+#include <camera.h>
+#include <gl_objects.h>
+#include <sampler_cache.h>
+#include <bindless.h>
+#include <indirect_batch.h>
+#include <profiler.h>
+#include <gpu_profiler.h>
+#include <gl_trace.h>
+#include <glad_lazy.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <iostream>
+
+
+//////// SHOWCASE ////
+// - the textured quad of the Coordinate Systems tutorial (src/Getting Started/CoordSystems), drawn through every
+//      subsystem in headers/ at once instead of with raw GL calls, as a place to see them working together:
+//      - startup: lazily loaded GL entry points (glad_lazy.h), shaders batch-compiled from the VFS (shader_batch.h,
+//          vfs.h) and reflected (shader_reflection.h), textures sized from the asset index and decoded in parallel
+//          (asset_index.h, image_decode.h)
+//      - objects: DSA wrappers over a binding cache (gl_objects.h), shared samplers (sampler_cache.h), a bindless or
+//          unit-bound texture table (bindless.h), materials in one buffer (material.h), the camera's frame uniforms
+//          (camera.h)
+//      - frame: a frame graph with pooled render targets (frame_graph.h, render_target.h) and a ring of quads drawn
+//          with one multi-draw (indirect_batch.h)
+//      - measuring: CPU and GPU zones (profiler.h, gpu_profiler.h) and GL call tracing for glreplay (gl_trace.h)
+// - command line:
+//      --profile           write the first 300 frames' CPU and GPU zones to showcase_trace.json and
+//                          showcase_gpu_trace.json, for chrome://tracing or ui.perfetto.dev
+//      --trace file.logt   record every GL call from the start, for glreplay
+//      --eager-gl          load every GL entry point up front like plain glad, to compare startup times against
+// - LearnOpenGL.vcxproj builds the Coordinate Systems tutorial; this file is in the project excluded from the build,
+//      so to run it flip ExcludedFromBuild between the two (only one main() can be linked)
+// - runs from the repository root like the tutorials, and asks for a 4.6 context but works down to 3.3
+
+////////////////////////////////
+
+
+void framebuffer_size_callback(GLFWwindow* window, int width, int height);
+void processInput(GLFWwindow* window);
+
+// settings
+const unsigned int SCR_WIDTH = 800;
+const unsigned int SCR_HEIGHT = 600;
+
+float mixValue = 0.2f; // use up and down arrow keys to adjust the mix value between textures
+
+// the quad's parameters as the shaders declare them (material.h): std140 and std430 agree on this layout, and
+//      MaterialLibrary::checkLayout() confirms it against the linked program
+struct QuadMaterial
+{
+    glm::vec4 tint;
+    float mixValue;
+    int32_t texture1;   // texture table indices
+    int32_t texture2;
+    int32_t pad;
+};
+
+Camera camera(glm::vec3(0.0f, 0.0f, 3.0f));
+
+int main(int argc, char** argv)
+{
+    // initialize GLFW, ask for a 4.6 core profile context so the DSA/bindless paths can be used, and settle for 3.3
+    glfwInit();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+    // create a window object, 800 x 600, named LearnOpenGL
+    GLFWwindow* window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    if (window == NULL)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+        window = glfwCreateWindow(SCR_WIDTH, SCR_HEIGHT, "LearnOpenGL", NULL, NULL);
+    }
+    if (window == NULL)
+    {
+        std::cout << "Failed to create GLFW window" << std::endl;
+        glfwTerminate();
+        return -1;
+    }
+    // command line options, see the top of the file
+    const char* tracePath = NULL;
+    bool eagerGL = false;
+    bool profile = false;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (std::strcmp(argv[i], "--eager-gl") == 0)
+            eagerGL = true;
+        else if (std::strcmp(argv[i], "--profile") == 0)
+            profile = true;
+    }
+
+    // make the window context the main context on the current thread
+    glfwMakeContextCurrent(window);
+    // startup latency is measured from here to the end of the first swap
+    auto contextReady = std::chrono::steady_clock::now();
+    // setup viewport resizing with GLFW
+    glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+
+    // initializing GLAD to manage function pointers before we call OpenGL functions; the lazy loader only looks up
+    //      the functions that actually get called, on their first call (glad_lazy.h)
+    int gladLoaded = eagerGL ? gladLoadGLLoader((GLADloadproc)glfwGetProcAddress) : gladLoadGLLoaderLazy((GLADloadproc)glfwGetProcAddress);
+    if (!gladLoaded)
+    {
+        std::cout << "Failed to init GLAD" << std::endl;
+        return -1;
+    }
+    // the bindless extension isn't part of our core-only glad, its entry points are fetched separately
+    bindlessApi().load((GLADloadproc)glfwGetProcAddress);
+    if (tracePath)
+        glTrace().begin(tracePath);
+
+    // the bindless fragment shader reads texture handles from a buffer, the regular one samples texture units. Sources
+    //      come through vfs() and go to GL straight from the mapping (shader_batch.h)
+    vfs().mount("shaders", "src/Showcase");
+    const char* fragmentPath = bindlessApi().available ? "shaders/showcase_bindless.frag" : "shaders/showcase.frag";
+    ShaderBatch shaders;
+    size_t ourProgram = shaders.add("shaders/showcase.vert", fragmentPath);
+    // on 4.3+ a ring of quads around the first one is drawn as a single multi-draw (indirect_batch.h), with a vertex
+    //      shader that reads each quad's model matrix from a buffer instead of a uniform
+    const bool indirect = GLAD_GL_VERSION_4_3 != 0;
+    size_t indirectProgram = indirect ? shaders.add("shaders/showcase_indirect.vert", fragmentPath) : 0;
+    bool shadersLoaded = shaders.load();
+    shaders.report();
+    if (!shadersLoaded)
+    {
+        std::cout << "Failed to load shaders" << std::endl;
+        glTrace().end();
+        glfwTerminate();
+        return -1;
+    }
+    Shader ourShader = shaders.program(ourProgram);
+    ourShader.setBlockBinding("Frame", FRAME_UBO_BINDING);
+    // what the program reads, from its reflection (shader_reflection.h); the per-frame uniforms are resolved here once
+    //      so the render loop doesn't ask GL for locations
+    if (const ShaderReflection* reflection = shaderReflections().find(ourShader.ID))
+        reflection->report();
+    const int modelLocation = ourShader.location("model");
+    Shader indirectShader = indirect ? shaders.program(indirectProgram) : Shader();
+    if (indirect)
+        indirectShader.setBlockBinding("Frame", FRAME_UBO_BINDING);
+
+    // reversed-Z only kicks in on 4.5+ contexts (glClipControl), otherwise the camera keeps a regular projection
+    glEnable(GL_DEPTH_TEST);
+    camera.setPerspective(FOV, (float)SCR_WIDTH / (float)SCR_HEIGHT, NEAR_PLANE, FAR_PLANE);
+    camera.setReversedZ(Camera::enableReversedZ());
+
+    // define some vertices for a triangle
+    float vertices[] = {
+        // positions          // colors           // texture coords
+         0.5f,  0.5f, 0.0f,   1.0f, 0.0f, 0.0f,   1.0f, 1.0f,   // top right
+         0.5f, -0.5f, 0.0f,   0.0f, 1.0f, 0.0f,   1.0f, 0.0f,   // bottom right
+        -0.5f, -0.5f, 0.0f,   0.0f, 0.0f, 1.0f,   0.0f, 0.0f,   // bottom left
+        -0.5f,  0.5f, 0.0f,   1.0f, 1.0f, 0.0f,   0.0f, 1.0f    // top left 
+    };
+    unsigned int indices[] = {
+        0, 1, 3, // first triangle
+        1, 2, 3  // second triangle
+    };
+    //// OBJECT SETUP ////
+    // - Buffer/VertexArray/Texture/Sampler (gl_objects.h) edit objects by name on the 4.6 context asked for above, so none
+    //      of the setup below binds anything there; when only 3.3 was available they fall back to binding, skipping
+    //      binds that are already in place
+    // - they are RAII, so they live in a scope that ends before glfwTerminate() destroys the context
+    glState().init();
+    {
+        FrameUniforms frameUniforms;
+        Buffer VBO, EBO;
+        VBO.data(sizeof(vertices), vertices);
+        EBO.data(sizeof(indices), indices);
+
+        VertexArray VAO;
+        VAO.vertexBuffer(0, VBO, 0, 8 * sizeof(float));
+        VAO.attrib(0, 0, 3, GL_FLOAT, false, 0);                    // position attribute
+        VAO.attrib(1, 0, 3, GL_FLOAT, false, 3 * sizeof(float));    // color attribute
+        VAO.attrib(2, 0, 2, GL_FLOAT, false, 6 * sizeof(float));    // texture attribute
+        VAO.elementBuffer(EBO);
+
+        //////// GENERATING A TEXTURE ////
+        // textures are pure data; wrapping/filtering comes from shared sampler objects (sampler_cache.h) bound next to them.
+        //      Asking for the same description again anywhere in the program returns the same sampler
+        const Sampler& clampSampler = samplerCache().get(SamplerDesc::linearClamp());
+        const Sampler& repeatSampler = samplerCache().get(SamplerDesc::linearRepeat());
+
+        // sizes and channel counts come from the asset index (asset_index.h), so immutable storage is allocated before
+        //      anything is decoded. Pixels are decoded by image_decode.h, which flips rows for GL as it writes them out
+        //      (same pixels as stbi_load with stbi_set_flip_vertically_on_load(true))
+        // assets.pack (packtool) replaces the directory when there is one
+        std::error_code noPack;
+        if (!std::filesystem::is_regular_file("assets.pack", noPack) || !vfs().mountPack("assets", "assets.pack"))
+            vfs().mount("assets", "assets");
+        AssetIndex assets;
+        assets.load("assets");
+        assets.report();
+        Texture texture1, texture2;
+        auto loadTexture = [&assets](Texture& texture, const char* name)
+        {
+            const AssetIndexEntry* asset = assets.find(name);
+            DecodedImage image;
+            if (asset)
+            {
+                texture.storage2D(asset->levels(), asset->internalFormat(), (int)asset->width, (int)asset->height);
+                VfsFile file;
+                if (vfs().open(std::string("assets/") + name, file) && decodeImage(file.data(), file.size(), image, true) &&
+                    image.width == (int)asset->width && image.height == (int)asset->height && image.channels == (int)asset->channels)
+                {
+                    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+                    texture.subImage2D(0, 0, 0, image.width, image.height, asset->pixelFormat(), GL_UNSIGNED_BYTE, image.pixels.data());
+                    texture.generateMipmap();
+                    return;
+                }
+            }
+            std::cout << "Failed to load texture" << std::endl;
+        };
+        loadTexture(texture1, "container.jpg");
+        loadTexture(texture2, "awesomeface.png");
+        // peak decode memory per thread; the pixels went back to the pools once uploaded
+        imageArenaReport();
+        vfs().report();
+
+        // the table hands out indices that work for both paths: handle slots with bindless, texture units without
+        TextureTable textureTable;
+        unsigned int containerIndex = textureTable.add(texture1, clampSampler);
+        unsigned int faceIndex = textureTable.add(texture2, repeatSampler);
+        textureTable.upload();
+        textureTable.report();
+
+        // everything else about the quad's look is a material in one shared buffer: an SSBO for the 4.3 bindless shader,
+        //      a UBO for the 3.3 one. The shader finds it by ID, set once here since there's a single draw
+        MaterialLibrary<QuadMaterial> materials(textureTable.bindless ? GL_SHADER_STORAGE_BUFFER : GL_UNIFORM_BUFFER, 64);
+        Material<QuadMaterial> quadMaterial = materials.create({ glm::vec4(1.0f), mixValue, (int32_t)containerIndex, (int32_t)faceIndex, 0 });
+        materials.upload();
+        materials.bind();
+        // QuadMaterial only matches the GLSL struct by hand, so it is checked against what the program really declares
+        if (const ShaderReflection* reflection = shaderReflections().find(ourShader.ID))
+            materials.checkLayout(*reflection, "materials", { { "tint", offsetof(QuadMaterial, tint) },
+                { "mixValue", offsetof(QuadMaterial, mixValue) }, { "texture1", offsetof(QuadMaterial, texture1) },
+                { "texture2", offsetof(QuadMaterial, texture2) } });
+
+        ourShader.use();
+        if (!textureTable.bindless)
+        {
+            ourShader.setInt("texture1", (int)containerIndex);
+            ourShader.setInt("texture2", (int)faceIndex);
+            ourShader.setBlockBinding("Materials", MATERIAL_BINDING);
+        }
+        ourShader.setInt("material", (int)quadMaterial.id);
+        if (indirect)
+        {
+            indirectShader.use();
+            if (!textureTable.bindless)
+            {
+                indirectShader.setInt("texture1", (int)containerIndex);
+                indirectShader.setInt("texture2", (int)faceIndex);
+                indirectShader.setBlockBinding("Materials", MATERIAL_BINDING);
+            }
+            indirectShader.setInt("material", (int)quadMaterial.id);
+        }
+
+        // the quad goes into the batch's shared buffers once; every frame queues where the copies go and submit() sends
+        //      them as one instanced command
+        VertexFormat quadFormat;
+        quadFormat.add(VertexSemantic::Position, 0, 3).add(VertexSemantic::Color, 1, 3).add(VertexSemantic::TexCoord, 2, 2);
+        IndirectBatch quadBatch(quadFormat);
+        unsigned int quadMesh = 0;
+        if (indirect)
+        {
+            quadMesh = quadBatch.addMesh(vertices, 4, indices, 6);
+            quadBatch.upload();
+        }
+
+        // render loop - every iteration is known as a "frame"
+        // with --profile the first few seconds end up in a Chrome trace (profiler.h); the zone statistics printed at
+        //      exit are collected either way
+        // GPU side of the same frames; results arrive a few frames late so reading them never stalls (gpu_profiler.h)
+        GpuProfiler gpuProfiler;
+        if (profile)
+        {
+            profiler().beginCapture(300);
+            gpuProfiler.beginCapture(300);
+        }
+        bool firstFrame = true;
+
+        //////// FRAME GRAPH ////
+        // the frame is a graph of passes (frame_graph.h) instead of a clear and a draw into the window: the scene renders
+        //      into its own color and depth targets and a present pass copies the color to the window. Post-processing
+        //      slots in between as passes reading sceneColor, and the graph shares textures between targets whose
+        //      lifetimes don't overlap. Targets follow the window size; renderTargetPool() rounds their allocations up,
+        //      so resizing the window mostly reuses the textures it already has
+        FrameGraph frameGraph;
+        FrameGraph::Resource sceneColor = frameGraph.createTarget("sceneColor", { 0, 0, 1.0f, GL_RGBA8 });
+        // reversed-Z only pays off with a float depth buffer
+        GLenum depthFormat = camera.isReversedZ() ? GL_DEPTH_COMPONENT32F : GL_DEPTH_COMPONENT24;
+        FrameGraph::Resource sceneDepth = frameGraph.createTarget("sceneDepth", { 0, 0, 1.0f, depthFormat });
+        frameGraph.addPass("scene",
+            [&](FrameGraph::PassBuilder& pass)
+            {
+                pass.write(sceneColor);
+                pass.depth(sceneDepth);
+                pass.clear(glm::vec4(0.2f, 0.3f, 0.3f, 1.0f));
+            },
+            [&](const FrameGraph::PassContext&)
+            {
+                PROFILE_ZONE("submit");
+                GPU_ZONE(gpuProfiler, "quad");
+                // one SSBO bind with bindless; otherwise texture + sampler per unit, which are all cache hits after the first frame
+                textureTable.bind();
+
+                // model matrix, lays the quad down on the floor (local -> world)
+                glm::mat4 model = glm::mat4(1.0f);
+                model = glm::rotate(model, glm::radians(-55.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+
+                ourShader.use();
+                glUniformMatrix4fv(modelLocation, 1, GL_FALSE, glm::value_ptr(model));
+
+                VAO.bind();
+                // debug builds check the attributes, textures and buffers the program needs are all there before the
+                //      first draw goes out
+                if (firstFrame)
+                    validateDraw(ourShader.ID, VAO);
+                glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_INT, 0);
+
+                if (indirect)
+                {
+                    quadBatch.clear();
+                    for (int i = 0; i < 8; i++)
+                    {
+                        float angle = glm::radians(45.0f * i);
+                        glm::mat4 ringModel = glm::translate(glm::mat4(1.0f), glm::vec3(2.0f * cos(angle), 1.5f * sin(angle), -2.0f));
+                        ringModel = glm::rotate(ringModel, (float)glfwGetTime() + angle, glm::vec3(0.0f, 1.0f, 0.0f));
+                        quadBatch.add(quadMesh, ringModel, quadMaterial.id);
+                    }
+                    indirectShader.use();
+                    quadBatch.submit();
+                    if (firstFrame)
+                        quadBatch.report();
+                }
+            });
+        frameGraph.addPass("present",
+            [&](FrameGraph::PassBuilder& pass)
+            {
+                pass.read(sceneColor);
+                pass.write(FrameGraph::BACKBUFFER);
+            },
+            [&](const FrameGraph::PassContext& context)
+            {
+                GPU_ZONE(gpuProfiler, "present");
+                context.blit(sceneColor);
+            });
+
+        while (!glfwWindowShouldClose(window))
+        {
+            gpuProfiler.beginFrame();
+            // input
+            {
+                PROFILE_ZONE("processInput");
+                processInput(window);
+            }
+
+            {
+                PROFILE_ZONE("uploads");
+                // frame-wide camera data, uploaded once no matter how many objects get drawn
+                frameUniforms.update(camera, (float)glfwGetTime());
+                // writes the 4 bytes of mixValue when the arrow keys changed it, nothing otherwise
+                quadMaterial.set(&QuadMaterial::mixValue, mixValue);
+                materials.upload();
+            }
+
+            // rendering commands here
+            {
+                PROFILE_ZONE("render");
+                int width, height;
+                glfwGetFramebufferSize(window, &width, &height);
+                frameGraph.setBackbufferSize(width, height);
+                frameGraph.execute();
+                // targets no pass has asked for in a while (an old window size, say) go back to GL
+                renderTargetPool().nextFrame();
+            }
+
+            // check and call events and swap the buffers
+            {
+                PROFILE_ZONE("pollAndSwap");
+                glfwPollEvents(); // checking if any events are triggered (like keyboard input or mouse movement)
+                glfwSwapBuffers(window); // swaps the color buffer (large 2D buffer of color values for every pixel
+                                            // in GLFW's window, uses the double buffer system
+            }
+            if (firstFrame)
+            {
+                firstFrame = false;
+                double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - contextReady).count();
+                std::cout << "STARTUP:: context to first frame: " << ms << " ms (" << (eagerGL ? "eager" : "lazy") << " GL loading)" << std::endl;
+                if (!eagerGL)
+                    gladLazy().report();
+                frameGraph.report();
+            }
+            gpuProfiler.endFrame();
+            glTrace().frame();
+            PROFILE_FRAME();
+        }
+        profiler().report();
+        gpuProfiler.report();
+        if (profile)
+        {
+            profiler().exportChromeTrace("showcase_trace.json");
+            gpuProfiler.exportChromeTrace("showcase_gpu_trace.json");
+        }
+        // how many binds the wrappers issued and how many they got away without
+        glState().report();
+        samplerCache().report();
+        materials.report();
+        renderTargetPool().report();
+    } // frame uniforms, buffers, vertex array and textures are deleted here
+    samplerCache().clear();
+    renderTargetPool().clear();
+
+    shaderReflections().forget(ourShader.ID);
+    glDeleteProgram(ourShader.ID);
+    if (indirect)
+    {
+        shaderReflections().forget(indirectShader.ID);
+        glDeleteProgram(indirectShader.ID);
+    }
+    glTrace().end();
+
+    glfwTerminate();
+    return 0;
+}
+
+// adjusting viewport when window is resized by the user
+void framebuffer_size_callback(GLFWwindow* window, int width, int height)
+{
+    //// VIEWPORT ////
+    // first two #s set location of lower left corner, second two #s set width and height
+    glViewport(0, 0, width, height);
+    if (height > 0)
+        camera.setAspect((float)width / (float)height);
+}
+
+void processInput(GLFWwindow* window)
+{
+    if (glfwGetKey(window, GLFW_KEY_ESCAPE ) == GLFW_PRESS) // if user presses the ESC key
+        glfwSetWindowShouldClose(window, true);				// close the window passed in
+
+    // the material only uploads mixValue on frames where these changed it
+    if (glfwGetKey(window, GLFW_KEY_UP) == GLFW_PRESS)
+        mixValue = std::min(mixValue + 0.005f, 1.0f);
+
+    if (glfwGetKey(window, GLFW_KEY_DOWN) == GLFW_PRESS)
+        mixValue = std::max(mixValue - 0.005f, 0.0f);
+}
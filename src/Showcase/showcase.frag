@@ -0,0 +1,33 @@
+#version 330 core
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// sampler2D is a GLSL built-in texture object datatype
+uniform sampler2D texture1;
+uniform sampler2D texture2;
+
+// per-material parameters, one array shared by every draw (see material.h). texture1/texture2 are texture table
+//      indices for the bindless shader; here the table binds the textures to the units the samplers above are set to
+struct QuadMaterial
+{
+    vec4 tint;
+    float mixValue;
+    int texture1;
+    int texture2;
+    int pad;
+};
+layout (std140) uniform Materials
+{
+    QuadMaterial materials[64];
+};
+uniform int material;
+
+void main()
+{
+    // GLSL built-in texture function takes a texture sampler as 1st param, texture coords as 2nd param
+    //FragColor = mix(texture(texture1, TexCoord), texture(texture2, TexCoord), 0.2);
+
+    QuadMaterial m = materials[material];
+    FragColor = mix(texture(texture1, TexCoord), texture(texture2, vec2(-TexCoord.x, TexCoord.y)), m.mixValue) * m.tint; // flipped smiley face
+}
@@ -0,0 +1,24 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;   // the position variable has attribute position 0
+layout (location = 1) in vec3 aColor; // the color variable has attribute position 1
+layout (location = 2) in vec2 aTexCoord; // the texture variable has attr position 2
+
+out vec2 TexCoord; // output texture coords to frag shader
+
+// frame-wide camera data, shared by every shader at binding point 0 (see camera.h)
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 invViewProjection;
+    vec4 cameraPos;
+};
+
+uniform mat4 model;
+
+void main()
+{
+    gl_Position = viewProjection * model * vec4(aPos, 1.0f);
+    TexCoord = vec2(aTexCoord.x, aTexCoord.y); // set TexCoord to the input texture coords we got from the vertex data
+}
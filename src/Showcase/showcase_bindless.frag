@@ -0,0 +1,35 @@
+#version 430 core
+#extension GL_ARB_bindless_texture : require
+out vec4 FragColor;
+
+in vec2 TexCoord;
+
+// resident texture handles written by TextureTable (see bindless.h); nothing is bound to a texture unit
+layout (std430, binding = 2) readonly buffer Textures
+{
+    uvec2 textures[];
+};
+
+// per-material parameters (see material.h); the textures are indices into the table instead of texture units
+struct QuadMaterial
+{
+    vec4 tint;
+    float mixValue;
+    int texture1;
+    int texture2;
+    int pad;
+};
+layout (std430, binding = 3) readonly buffer Materials
+{
+    QuadMaterial materials[];
+};
+uniform int material;
+
+void main()
+{
+    // a handle turns back into a sampler with a constructor
+    QuadMaterial m = materials[material];
+    vec4 container = texture(sampler2D(textures[m.texture1]), TexCoord);
+    vec4 face = texture(sampler2D(textures[m.texture2]), vec2(-TexCoord.x, TexCoord.y)); // flipped smiley face
+    FragColor = mix(container, face, m.mixValue) * m.tint;
+}
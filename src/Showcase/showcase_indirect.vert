@@ -0,0 +1,33 @@
+#version 430 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aColor;
+layout (location = 2) in vec2 aTexCoord;
+layout (location = 15) in uint aDrawID; // which entry of Draws this instance reads (see indirect_batch.h)
+
+out vec2 TexCoord;
+
+layout (std140) uniform Frame
+{
+    mat4 view;
+    mat4 projection;
+    mat4 viewProjection;
+    mat4 invViewProjection;
+    vec4 cameraPos;
+};
+
+// per-draw data written by IndirectBatch::submit(), instead of a model uniform per draw
+struct DrawData
+{
+    mat4 model;
+    uint materialID;
+};
+layout (std430, binding = 1) readonly buffer Draws
+{
+    DrawData draws[];
+};
+
+void main()
+{
+    gl_Position = viewProjection * draws[aDrawID].model * vec4(aPos, 1.0f);
+    TexCoord = aTexCoord;
+}
@@ -0,0 +1,65 @@
+#include <glad/glad.h>
+#include <stb_image.h>
+
+#include <asset_index.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <iostream>
+
+
+//////// ASSET INDEXER ////
+// - offline tool that writes the .index manifest for an asset directory (see asset_index.h)
+// - usage: assetindex directory [output.index] [--threads N] [--list]
+// - the output defaults to directory/assets.index, which is where the samples look for it. Run packtool afterwards
+//      and the index goes into the pack with the images
+// - the directory is mounted at the root of vfs() and scanned through it, the same way the samples scan when there is
+//      no index
+// - only file headers are parsed, so indexing is bound by reading the files for their hashes, not by decoding
+// - --list prints every entry: path, size, channels, format and the texture storage it will need
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: assetindex directory [output.index] [--threads N] [--list]" << std::endl;
+        return -1;
+    }
+    std::string output = std::string(argv[1]) + "/assets.index";
+    unsigned int threads = 0;
+    bool list = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = (unsigned int)std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--list") == 0)
+            list = true;
+        else
+            output = argv[i];
+    }
+
+    AssetScan scan;
+    if (!vfs().mount("", argv[1]) || !scanAssets("", scan, threads) || !writeAssetIndex(output.c_str(), scan))
+        return -1;
+
+    AssetIndex index;
+    if (!index.open(output.c_str()))
+        return -1;
+    if (list)
+    {
+        const char* formats[] = { "unknown", "jpeg", "png", "bmp", "gif", "psd", "hdr", "pnm" };
+        for (size_t i = 0; i < index.count; i++)
+        {
+            const AssetIndexEntry& e = index.entries[i];
+            std::cout << "    " << index.path(e) << ": " << e.width << "x" << e.height << "x" << e.channels << " " << formats[std::min(e.format, 7u)]
+                      << ((e.flags & ASSET_16_BIT) ? " 16-bit" : "") << ((e.flags & ASSET_HDR) ? " hdr" : "") << ", " << e.levels() << " levels, "
+                      << e.gpuBytes() / 1024 << " KB" << std::endl;
+        }
+    }
+    index.report();
+    std::cout << "ASSETINDEX:: " << output << " written, " << scan.bytesRead / 1024 << " KB read in " << scan.seconds * 1000.0 << " ms on "
+              << scan.threads << " thread(s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,330 @@
+#include <glad/glad.h>
+#include <glfw/glfw3.h>
+
+#include <gl_trace.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+
+//////// GL TRACE REPLAYER ////
+// - offline tool for traces written with glTrace() (see gl_trace.h)
+// - usage: glreplay trace.logt [--gl] [--iterations N] [--self-test]
+// - always prints the trace's statistics first: calls per frame and per function, bytes uploaded and redundant state
+//      changes
+// - without --gl the trace is replayed against stub entry points that only count, which times the decoding and
+//      dispatch on its own; with --gl it runs on a real context in a hidden window and glFinish()es every frame, so
+//      the per-frame times include the driver and GPU. Every object an iteration created is deleted before the next
+//      one starts, so iterations don't pile up objects (and GPU memory) the trace never deleted itself
+// - replay is deterministic: the same calls with the same data in the same order every iteration, which makes it a
+//      benchmark that doesn't depend on input, timing or asset loading
+// - --self-test first writes trace.logt itself: a frame that renders into an offscreen framebuffer and blits it to the
+//      window, the way frame_graph.h does, once through the DSA calls and once through binding, each with a
+//      multisampled renderbuffer (render_target_pool.h) resolved into it by a blit. It is recorded and
+//      replayed against a stand-in driver that hands out different object names each time, and fails unless every
+//      call comes back with the names the replay created in place of the recorded ones. No context is needed
+
+struct FrameTimer
+{
+    bool finish = false;
+    std::chrono::steady_clock::time_point last;
+    std::vector<double> frameMs;
+};
+
+void onFrame(void* user)
+{
+    FrameTimer& timer = *static_cast<FrameTimer*>(user);
+    if (timer.finish)
+        glFinish();
+    auto now = std::chrono::steady_clock::now();
+    timer.frameMs.push_back(std::chrono::duration<double, std::milli>(now - timer.last).count());
+    timer.last = now;
+}
+
+// the stand-in driver for --self-test: object names from a different range per run, and every object name the
+//      framebuffer calls were given, in call order
+struct SelfTestDriver
+{
+    GLuint nextName = 1;
+    std::vector<GLuint> seen;
+};
+SelfTestDriver selfTestDriver;
+
+void APIENTRY selfTestNames(GLsizei n, GLuint* names)
+{
+    for (GLsizei i = 0; i < n; i++)
+        names[i] = selfTestDriver.nextName++;
+}
+void APIENTRY selfTestCreateTextures(GLenum, GLsizei n, GLuint* names)
+{
+    selfTestNames(n, names);
+}
+void APIENTRY selfTestDeleteNames(GLsizei n, const GLuint* names)
+{
+    selfTestDriver.seen.insert(selfTestDriver.seen.end(), names, names + n);
+}
+void APIENTRY selfTestBindTexture(GLenum, GLuint texture)
+{
+    selfTestDriver.seen.push_back(texture);
+}
+void APIENTRY selfTestBindFramebuffer(GLenum, GLuint framebuffer)
+{
+    selfTestDriver.seen.push_back(framebuffer);
+}
+void APIENTRY selfTestNamedFramebufferTexture(GLuint framebuffer, GLenum, GLuint texture, GLint)
+{
+    selfTestDriver.seen.push_back(framebuffer);
+    selfTestDriver.seen.push_back(texture);
+}
+void APIENTRY selfTestFramebufferTexture2D(GLenum, GLenum, GLenum, GLuint texture, GLint)
+{
+    selfTestDriver.seen.push_back(texture);
+}
+void APIENTRY selfTestNamedFramebufferDrawBuffers(GLuint framebuffer, GLsizei, const GLenum*)
+{
+    selfTestDriver.seen.push_back(framebuffer);
+}
+GLenum APIENTRY selfTestCheckNamedFramebufferStatus(GLuint framebuffer, GLenum)
+{
+    selfTestDriver.seen.push_back(framebuffer);
+    return GL_FRAMEBUFFER_COMPLETE;
+}
+void APIENTRY selfTestBindRenderbuffer(GLenum, GLuint renderbuffer)
+{
+    selfTestDriver.seen.push_back(renderbuffer);
+}
+void APIENTRY selfTestNamedRenderbufferStorageMultisample(GLuint renderbuffer, GLsizei, GLenum, GLsizei, GLsizei)
+{
+    selfTestDriver.seen.push_back(renderbuffer);
+}
+void APIENTRY selfTestNamedFramebufferRenderbuffer(GLuint framebuffer, GLenum, GLenum, GLuint renderbuffer)
+{
+    selfTestDriver.seen.push_back(framebuffer);
+    selfTestDriver.seen.push_back(renderbuffer);
+}
+void APIENTRY selfTestFramebufferRenderbuffer(GLenum, GLenum, GLenum, GLuint renderbuffer)
+{
+    selfTestDriver.seen.push_back(renderbuffer);
+}
+void APIENTRY selfTestTextureStorage2DMultisample(GLuint texture, GLsizei, GLenum, GLsizei, GLsizei, GLboolean)
+{
+    selfTestDriver.seen.push_back(texture);
+}
+void APIENTRY selfTestBlitNamedFramebuffer(GLuint read, GLuint draw, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLint, GLbitfield, GLenum)
+{
+    selfTestDriver.seen.push_back(read);
+    selfTestDriver.seen.push_back(draw);
+}
+
+// one frame of multisampled offscreen rendering, resolved and blitted to the window
+// ------------------------------------------------------------------------
+void selfTestFrame()
+{
+    const GLenum drawBuffers[] = { GL_COLOR_ATTACHMENT0 };
+    // DSA: draw into a multisampled renderbuffer, resolve it into a texture, blit that to the window
+    GLuint multisampled, multisampledFramebuffer, color, framebuffer, multisampledTexture;
+    glCreateRenderbuffers(1, &multisampled);
+    glNamedRenderbufferStorageMultisample(multisampled, 4, GL_RGBA8, 64, 64);
+    glCreateFramebuffers(1, &multisampledFramebuffer);
+    glNamedFramebufferRenderbuffer(multisampledFramebuffer, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, multisampled);
+    glCreateTextures(GL_TEXTURE_2D, 1, &color);
+    glTextureStorage2D(color, 1, GL_RGBA8, 64, 64);
+    glCreateFramebuffers(1, &framebuffer);
+    glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, color, 0);
+    glNamedFramebufferDrawBuffers(framebuffer, 1, drawBuffers);
+    glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER);
+    glCreateTextures(GL_TEXTURE_2D_MULTISAMPLE, 1, &multisampledTexture);
+    glTextureStorage2DMultisample(multisampledTexture, 4, GL_RGBA8, 64, 64, GL_TRUE);
+    glBindFramebuffer(GL_FRAMEBUFFER, multisampledFramebuffer);
+    glViewport(0, 0, 64, 64);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glBlitNamedFramebuffer(multisampledFramebuffer, framebuffer, 0, 0, 64, 64, 0, 0, 64, 64, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBlitNamedFramebuffer(framebuffer, 0, 0, 0, 64, 64, 0, 0, 800, 600, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    // through binding
+    GLuint boundMultisampled, boundMultisampledFramebuffer, boundColor, boundFramebuffer, boundMultisampledTexture;
+    glGenRenderbuffers(1, &boundMultisampled);
+    glBindRenderbuffer(GL_RENDERBUFFER, boundMultisampled);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, 4, GL_RGBA8, 64, 64);
+    glGenFramebuffers(1, &boundMultisampledFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, boundMultisampledFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, boundMultisampled);
+    glClear(GL_COLOR_BUFFER_BIT);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    glGenTextures(1, &boundMultisampledTexture);
+    glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, boundMultisampledTexture);
+    glTexStorage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA8, 64, 64, GL_TRUE);
+    glTexImage2DMultisample(GL_TEXTURE_2D_MULTISAMPLE, 4, GL_RGBA8, 64, 64, GL_TRUE);
+    glGenTextures(1, &boundColor);
+    glBindTexture(GL_TEXTURE_2D, boundColor);
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 64, 64);
+    glGenFramebuffers(1, &boundFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, boundFramebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, boundColor, 0);
+    glDrawBuffers(1, drawBuffers);
+    glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, boundMultisampledFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, boundFramebuffer);
+    glBlitFramebuffer(0, 0, 64, 64, 0, 0, 64, 64, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, boundFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+    glBlitFramebuffer(0, 0, 64, 64, 0, 0, 800, 600, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glTrace().frame();
+
+    const GLuint framebuffers[] = { multisampledFramebuffer, framebuffer, boundMultisampledFramebuffer, boundFramebuffer };
+    const GLuint textures[] = { color, multisampledTexture, boundMultisampledTexture, boundColor };
+    const GLuint renderbuffers[] = { multisampled, boundMultisampled };
+    glDeleteFramebuffers(4, framebuffers);
+    glDeleteTextures(4, textures);
+    glDeleteRenderbuffers(2, renderbuffers);
+}
+
+// record selfTestFrame() into path and replay it; every name the replay hands the driver has to be the one it created
+//      in place of the recorded name, and every recorded call has to be decoded
+// ------------------------------------------------------------------------
+bool selfTest(const char* path)
+{
+    glTraceInstallStubs();
+    glad_glGenTextures = selfTestNames;
+    glad_glGenFramebuffers = selfTestNames;
+    glad_glCreateFramebuffers = selfTestNames;
+    glad_glCreateTextures = selfTestCreateTextures;
+    glad_glDeleteFramebuffers = selfTestDeleteNames;
+    glad_glDeleteTextures = selfTestDeleteNames;
+    glad_glBindFramebuffer = selfTestBindFramebuffer;
+    glad_glNamedFramebufferTexture = selfTestNamedFramebufferTexture;
+    glad_glFramebufferTexture2D = selfTestFramebufferTexture2D;
+    glad_glNamedFramebufferDrawBuffers = selfTestNamedFramebufferDrawBuffers;
+    glad_glCheckNamedFramebufferStatus = selfTestCheckNamedFramebufferStatus;
+    glad_glBlitNamedFramebuffer = selfTestBlitNamedFramebuffer;
+    glad_glGenRenderbuffers = selfTestNames;
+    glad_glCreateRenderbuffers = selfTestNames;
+    glad_glDeleteRenderbuffers = selfTestDeleteNames;
+    glad_glBindRenderbuffer = selfTestBindRenderbuffer;
+    glad_glNamedRenderbufferStorageMultisample = selfTestNamedRenderbufferStorageMultisample;
+    glad_glNamedFramebufferRenderbuffer = selfTestNamedFramebufferRenderbuffer;
+    glad_glFramebufferRenderbuffer = selfTestFramebufferRenderbuffer;
+    glad_glTextureStorage2DMultisample = selfTestTextureStorage2DMultisample;
+    glad_glBindTexture = selfTestBindTexture;
+
+    const GLuint recordedBase = 1, replayedBase = 1000;
+    selfTestDriver = SelfTestDriver();
+    selfTestDriver.nextName = recordedBase;
+    if (!glTrace().begin(path))
+        return false;
+    selfTestFrame();
+    uint64_t recordedCalls = glTrace().calls;
+    glTrace().end();
+    std::vector<GLuint> recorded = selfTestDriver.seen;
+
+    GLTraceReader reader;
+    if (!reader.open(path))
+        return false;
+    GLTraceReplayer replayer;
+    selfTestDriver = SelfTestDriver();
+    selfTestDriver.nextName = replayedBase;
+    reader.replay(replayer);
+    const std::vector<GLuint>& replayed = selfTestDriver.seen;
+
+    // both runs create their objects in the same order, so recorded name n became replayedBase + n - recordedBase
+    bool remapped = recorded.size() == replayed.size();
+    for (size_t i = 0; remapped && i < recorded.size(); i++)
+        remapped = replayed[i] == (recorded[i] ? recorded[i] - recordedBase + replayedBase : 0);
+    if (!remapped || replayer.stats.totalCalls != recordedCalls || reader.frames != 1)
+    {
+        std::cout << "ERROR::GLREPLAY::SELF_TEST_FAILED: " << recordedCalls << " calls recorded, " << replayer.stats.totalCalls << " replayed, "
+                  << recorded.size() << " object names seen when recording, " << replayed.size() << " when replaying"
+                  << (remapped ? "" : ", names not remapped") << std::endl;
+        return false;
+    }
+    std::cout << "GLREPLAY::SELF_TEST passed: " << recordedCalls << " calls, " << recorded.size() << " object names remapped" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: glreplay trace.logt [--gl] [--iterations N] [--self-test]" << std::endl;
+        return -1;
+    }
+    bool realContext = false;
+    bool runSelfTest = false;
+    int iterations = 10;
+    for (int i = 2; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--gl") == 0)
+            realContext = true;
+        else if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--self-test") == 0)
+            runSelfTest = true;
+    }
+    if (runSelfTest && !selfTest(argv[1]))
+        return -1;
+
+    GLTraceReader reader;
+    if (!reader.open(argv[1]))
+        return -1;
+
+    // decode only, for the statistics
+    GLTraceReplayer analyzer;
+    analyzer.execute = false;
+    reader.replay(analyzer);
+    analyzer.stats.report();
+
+    GLFWwindow* window = NULL;
+    if (realContext)
+    {
+        glfwInit();
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 6);
+        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        window = glfwCreateWindow(800, 600, "glreplay", NULL, NULL);
+        if (window == NULL)
+        {
+            std::cout << "Failed to create GLFW window" << std::endl;
+            glfwTerminate();
+            return -1;
+        }
+        glfwMakeContextCurrent(window);
+        if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+        {
+            std::cout << "Failed to init GLAD" << std::endl;
+            return -1;
+        }
+    }
+    else
+        glTraceInstallStubs();
+
+    FrameTimer timer;
+    timer.finish = realContext;
+    double best = 1e30;
+    for (int run = 0; run < iterations; run++)
+    {
+        GLTraceReplayer replayer;
+        timer.frameMs.clear();
+        auto start = std::chrono::steady_clock::now();
+        timer.last = start;
+        reader.replay(replayer, onFrame, &timer);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = std::min(best, ms);
+        replayer.deleteObjects();
+    }
+    std::sort(timer.frameMs.begin(), timer.frameMs.end());
+    std::cout << "GLREPLAY:: " << (realContext ? "real context" : "stub entry points") << ", best of " << iterations << ": " << best << " ms for "
+              << reader.frames << " frames";
+    if (!timer.frameMs.empty())
+        std::cout << ", median frame " << timer.frameMs[timer.frameMs.size() / 2] << " ms";
+    std::cout << std::endl;
+
+    if (window)
+        glfwTerminate();
+    return 0;
+}
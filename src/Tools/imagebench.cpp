@@ -0,0 +1,94 @@
+#include <stb_image.h>
+
+#include <image_decode.h>
+#include <mapped_file.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <iostream>
+
+
+//////// IMAGE DECODE BENCHMARK ////
+// - offline tool that times decodeImage() (image_decode.h) against stock stbi_load_from_memory() on the same files
+// - usage: imagebench image... [--iterations N] [--threads N]
+// - both decoders flip for GL like the samples do (stb_image through stbi_set_flip_vertically_on_load), the files are
+//      mapped once up front so only decoding is timed, and the best of N runs is reported
+// - every file is also checked for identical output, since decodeImage() is supposed to reproduce stb_image exactly
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: imagebench image... [--iterations N] [--threads N]" << std::endl;
+        return -1;
+    }
+    int iterations = 20;
+    unsigned int threads = 0;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = (unsigned int)std::max(0, std::atoi(argv[++i]));
+        else
+            paths.push_back(argv[i]);
+    }
+
+    stbi_set_flip_vertically_on_load(true);
+    int mismatches = 0;
+    for (const char* path : paths)
+    {
+        MappedFile file;
+        if (!file.open(path))
+            continue;
+        const unsigned char* data = (const unsigned char*)file.data();
+        int size = (int)file.size();
+
+        double stbMs = 1e30, decodeMs = 1e30;
+        int width = 0, height = 0, channels = 0;
+        unsigned char* reference = NULL;
+        for (int run = 0; run < iterations; run++)
+        {
+            auto start = std::chrono::steady_clock::now();
+            unsigned char* pixels = stbi_load_from_memory(data, size, &width, &height, &channels, 0);
+            stbMs = std::min(stbMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+            if (reference)
+                stbi_image_free(pixels);
+            else
+                reference = pixels;
+        }
+        if (!reference)
+        {
+            std::cout << "ERROR::IMAGEBENCH::NOT_DECODED: " << path << ": " << stbi_failure_reason() << std::endl;
+            continue;
+        }
+
+        DecodedImage image;
+        ImageDecodeStats stats;
+        for (int run = 0; run < iterations; run++)
+        {
+            ImageDecodeStats runStats;
+            decodeImage(data, file.size(), image, true, threads, &runStats);
+            if (runStats.seconds * 1000.0 < decodeMs)
+            {
+                decodeMs = runStats.seconds * 1000.0;
+                stats = runStats;
+            }
+        }
+        bool identical = image.width == width && image.height == height && image.channels == channels &&
+                         std::memcmp(image.pixels.data(), reference, (size_t)width * height * channels) == 0;
+        mismatches += identical ? 0 : 1;
+        stbi_image_free(reference);
+
+        std::cout << "IMAGEBENCH:: " << path << " (" << width << "x" << height << "x" << channels << ", " << size / 1024 << " KB)" << std::endl;
+        std::cout << "    stb_image:   " << stbMs << " ms, " << size / (1024.0 * 1024.0) / (stbMs / 1000.0) << " MB/s" << std::endl;
+        std::cout << "    decodeImage: " << decodeMs << " ms, " << stats.megabytesPerSecond() << " MB/s, " << stats.threads << " thread(s), "
+                  << (stats.fastPath ? "fast path" : "stb_image fallback") << ", " << stbMs / decodeMs << "x" << (identical ? "" : ", OUTPUT DIFFERS")
+                  << std::endl;
+    }
+    return mismatches ? 1 : 0;
+}
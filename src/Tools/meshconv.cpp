@@ -0,0 +1,373 @@
+#include <glad/glad.h>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <mesh_file.h>
+#include <mesh_lod.h>
+#include <mesh_optimizer.h>
+#include <meshlet.h>
+#include <model_importer.h>
+#include <vertex_format.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <iostream>
+
+
+//////// MESH CONVERTER ////
+// - offline tool that turns an OBJ or glTF file into a .mesh file (see mesh_file.h) the samples can map and upload directly
+// - usage: meshconv input.obj|input.gltf|input.glb output.mesh [--compact] [--bench N] [--check-threads N] [--meshlets]
+//                                                          [--lods N]
+//          meshconv --bench-grid SIDE [--bench N]
+// - importing is done by model_importer.h: for OBJ every "o", "g" or "usemtl" line starts a new submesh, for glTF every
+//      primitive is a submesh
+// - each submesh gets its triangles reordered for the vertex cache and its triangle clusters sorted for overdraw, then
+//      the shared vertex buffer is put in fetch order
+// - --compact stores half positions, 2_10_10_10 normals, and unorm16 texture coords when they all lie in [0, 1] or
+//      half float ones when the mesh tiles (see vertex_format.h)
+// - --bench N imports the file N more times and reports the best parse throughput, then runs the optimizer passes N
+//      times on copies of the mesh and reports their best time with the ACMR/ATVR they reach. Frame time on the GPU
+//      follows the vertex shader invocations, which is the misses figure: it's printed per draw of the whole mesh
+// - --check-threads N imports an OBJ on one thread and on N threads and fails unless both give the same mesh. Files
+//      using relative indices (f -1 -2 -3) across the chunk boundaries are the case worth checking; small files
+//      aren't split, so the input needs to be a few MB for N threads to actually run
+// - --meshlets splits each optimized submesh into meshlets (meshlet.h) and reports how full they are, how many
+//      vertices they transform compared to the mesh, and what cullMeshlets drops looking at the mesh from six sides
+// - --lods N builds an N level LOD chain per submesh (mesh_lod.h) and prints every level's triangles, the error it
+//      claims and the error measured: the largest distance from a sample of the submesh's vertices to the level's
+//      surface. The claimed error is what LodSelector projects to pixels, so it shouldn't come out below the measured one
+// - --bench-grid SIDE skips the file: it builds a rippled SIDE x SIDE quad grid (2 * SIDE^2 triangles) with its
+//      triangles and vertices shuffled, so the cache starts out as bad as it gets, and times the optimizer on it
+//      (N runs, 3 by default). SIDE 1500 is a 4.5 M triangle mesh
+
+// cache and overdraw order per submesh so submesh ranges stay intact, then one fetch order over the shared vertex
+//      buffer. Returns the vertex count, which shrinks when vertices aren't referenced
+// ------------------------------------------------------------------------
+size_t optimize(std::vector<ModelVertex>& vertices, std::vector<unsigned int>& indices, const std::vector<MeshFileSubmesh>& submeshes)
+{
+    std::vector<unsigned int> clusters;
+    for (const MeshFileSubmesh& s : submeshes)
+    {
+        unsigned int* submeshIndices = indices.data() + s.firstIndex;
+        if (optimizeVertexCache(submeshIndices, s.indexCount, vertices.size(), VERTEX_CACHE_SIZE, &clusters))
+            optimizeOverdraw(submeshIndices, s.indexCount, reinterpret_cast<const float*>(vertices.data()), vertices.size(), sizeof(ModelVertex), clusters);
+    }
+    size_t vertexCount = optimizeVertexFetch(vertices.data(), indices.data(), indices.size(), vertices.size(), sizeof(ModelVertex));
+    vertices.resize(vertexCount);
+    return vertexCount;
+}
+
+// time the optimizer passes on copies of the mesh; copying isn't timed
+// ------------------------------------------------------------------------
+void benchOptimizer(const std::vector<ModelVertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshFileSubmesh>& submeshes, int runs)
+{
+    double bestMs = 1e30;
+    for (int run = 0; run < runs; run++)
+    {
+        std::vector<ModelVertex> scratchVertices = vertices;
+        std::vector<unsigned int> scratchIndices = indices;
+        auto start = std::chrono::steady_clock::now();
+        optimize(scratchVertices, scratchIndices, submeshes);
+        bestMs = std::min(bestMs, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+    }
+    std::cout << "MESHCONV::BENCH optimizer best of " << runs << ": " << bestMs << " ms for " << indices.size() / 3 << " triangles ("
+              << (double)(indices.size() / 3) / (bestMs / 1000.0) / 1e6 << " M triangles/s)" << std::endl;
+}
+
+// the optimizer on a generated side x side grid, shuffled so it has all the work to do
+// ------------------------------------------------------------------------
+bool benchGrid(unsigned int side, int runs)
+{
+    if (side == 0 || side > 16384)
+    {
+        std::cout << "ERROR::MESHCONV::GRID_SIZE: side " << side << ", 1 to 16384" << std::endl;
+        return false;
+    }
+    unsigned int row = side + 1;
+    std::vector<ModelVertex> vertices((size_t)row * row);
+    for (unsigned int y = 0; y < row; y++)
+        for (unsigned int x = 0; x < row; x++)
+        {
+            ModelVertex& v = vertices[(size_t)y * row + x];
+            glm::vec2 uv((float)x / (float)side, (float)y / (float)side);
+            // ripples give the overdraw pass clusters that face different ways
+            v.position = glm::vec3(uv.x, 0.05f * std::sin(uv.x * 40.0f) * std::cos(uv.y * 40.0f), uv.y);
+            v.texCoord = uv;
+            v.normal = glm::vec3(0.0f, 1.0f, 0.0f);
+        }
+    std::vector<unsigned int> indices;
+    indices.reserve((size_t)side * side * 6);
+    for (unsigned int y = 0; y < side; y++)
+        for (unsigned int x = 0; x < side; x++)
+        {
+            unsigned int i = y * row + x;
+            unsigned int quad[6] = { i, i + row, i + 1, i + 1, i + row, i + row + 1 };
+            indices.insert(indices.end(), quad, quad + 6);
+        }
+    // shuffle whole triangles, then the vertices, with a fixed seed so runs compare
+    std::mt19937 random(1234);
+    size_t triangleCount = indices.size() / 3;
+    for (size_t t = triangleCount - 1; t > 0; t--)
+    {
+        size_t other = std::uniform_int_distribution<size_t>(0, t)(random);
+        for (int k = 0; k < 3; k++)
+            std::swap(indices[t * 3 + k], indices[other * 3 + k]);
+    }
+    std::vector<unsigned int> remap(vertices.size());
+    for (size_t v = 0; v < remap.size(); v++)
+        remap[v] = (unsigned int)v;
+    std::shuffle(remap.begin(), remap.end(), random);
+    std::vector<ModelVertex> shuffled(vertices.size());
+    for (size_t v = 0; v < remap.size(); v++)
+        shuffled[remap[v]] = vertices[v];
+    vertices.swap(shuffled);
+    for (unsigned int& index : indices)
+        index = remap[index];
+
+    std::vector<MeshFileSubmesh> submeshes(1);
+    submeshes[0].firstIndex = 0;
+    submeshes[0].indexCount = (uint32_t)indices.size();
+    VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+    benchOptimizer(vertices, indices, submeshes, runs);
+    size_t vertexCount = optimize(vertices, indices, submeshes);
+    printVertexCacheStats("BEFORE", before);
+    printVertexCacheStats("AFTER", analyzeVertexCache(indices.data(), indices.size(), vertexCount));
+    return true;
+}
+
+// meshlets per submesh, and what frustum and cone culling keep of them from six views around the submesh
+// ------------------------------------------------------------------------
+void reportMeshlets(const std::vector<ModelVertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshFileSubmesh>& submeshes)
+{
+    size_t meshletCount = 0, meshletVertices = 0, triangles = 0, trianglesViewed = 0, trianglesSubmitted = 0, ranges = 0;
+    const glm::vec3 sides[6] = { glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0), glm::vec3(0, 0, 1), glm::vec3(0, 0, -1) };
+    for (const MeshFileSubmesh& s : submeshes)
+    {
+        MeshletMesh meshlets = buildMeshlets(indices.data() + s.firstIndex, s.indexCount, reinterpret_cast<const float*>(vertices.data()),
+                                             vertices.size(), sizeof(ModelVertex));
+        meshletCount += meshlets.meshlets.size();
+        meshletVertices += meshlets.vertices.size();
+        triangles += meshlets.triangles.size() / 3;
+
+        glm::vec3 lo = glm::make_vec3(s.boundsMin), hi = glm::make_vec3(s.boundsMax);
+        glm::vec3 center = (lo + hi) * 0.5f;
+        float radius = std::max(glm::length(hi - lo) * 0.5f, 1e-3f);
+        glm::mat4 projection = glm::perspective(glm::radians(60.0f), 1.0f, radius * 0.01f, radius * 10.0f);
+        MeshletDrawList draws;
+        for (const glm::vec3& side : sides)
+        {
+            glm::vec3 eye = center + side * radius * 2.5f;
+            glm::vec3 up = side.y != 0.0f ? glm::vec3(0, 0, 1) : glm::vec3(0, 1, 0);
+            cullMeshlets(meshlets, glm::mat4(1.0f), projection * glm::lookAt(eye, center, up), eye, draws);
+            trianglesViewed += draws.trianglesTotal;
+            trianglesSubmitted += draws.trianglesSubmitted;
+            ranges += draws.counts.size();
+        }
+    }
+    if (meshletCount == 0)
+    {
+        std::cout << "MESHCONV::MESHLETS none built" << std::endl;
+        return;
+    }
+    std::cout << "MESHCONV::MESHLETS " << meshletCount << " meshlets, on average " << (double)meshletVertices / meshletCount << " of "
+              << MESHLET_MAX_VERTICES << " vertices and " << (double)triangles / meshletCount << " of " << MESHLET_MAX_TRIANGLES
+              << " triangles, " << (double)meshletVertices / (double)vertices.size() << " vertices transformed per mesh vertex" << std::endl;
+    std::cout << "MESHCONV::MESHLETS from 6 sides: " << 100.0 * (1.0 - (double)trianglesSubmitted / (double)std::max<size_t>(trianglesViewed, 1))
+              << "% of triangles culled, " << (double)ranges / 6.0 << " draw ranges per view" << std::endl;
+}
+
+// distance from p to the closest point of triangle abc (Ericson, Real-Time Collision Detection 5.1.5)
+// ------------------------------------------------------------------------
+float pointTriangleDistance(const glm::vec3& p, const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+{
+    glm::vec3 ab = b - a, ac = c - a, ap = p - a;
+    float d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+    if (d1 <= 0.0f && d2 <= 0.0f)
+        return glm::length(ap);
+    glm::vec3 bp = p - b;
+    float d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+    if (d3 >= 0.0f && d4 <= d3)
+        return glm::length(bp);
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+        return glm::length(ap - ab * (d1 / (d1 - d3)));
+    glm::vec3 cp = p - c;
+    float d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+    if (d6 >= 0.0f && d5 <= d6)
+        return glm::length(cp);
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+        return glm::length(ap - ac * (d2 / (d2 - d6)));
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+        return glm::length(bp - (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+    float denom = 1.0f / (va + vb + vc);
+    return glm::length(ap - ab * (vb * denom) - ac * (vc * denom));
+}
+
+// LOD chain per submesh: triangles, claimed error and measured error of every level
+// ------------------------------------------------------------------------
+void reportLods(const std::vector<ModelVertex>& vertices, const std::vector<unsigned int>& indices, const std::vector<MeshFileSubmesh>& submeshes, unsigned int levels)
+{
+    // brute force distances, so the measurement samples this many vertices per submesh
+    const size_t samples = 500;
+    for (size_t si = 0; si < submeshes.size(); si++)
+    {
+        const MeshFileSubmesh& s = submeshes[si];
+        const unsigned int* submeshIndices = indices.data() + s.firstIndex;
+        auto start = std::chrono::steady_clock::now();
+        LodChain chain = buildLodChain(submeshIndices, s.indexCount, reinterpret_cast<const float*>(vertices.data()), vertices.size(), sizeof(ModelVertex), levels);
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        std::cout << "MESHCONV::LODS submesh " << si << ": " << chain.lods.size() << " levels in " << ms << " ms" << std::endl;
+        size_t step = std::max<size_t>(1, s.indexCount / samples);
+        for (size_t level = 0; level < chain.lods.size(); level++)
+        {
+            const MeshLod& lod = chain.lods[level];
+            const unsigned int* lodIndices = chain.indices.data() + lod.firstIndex;
+            float measured = 0.0f;
+            for (size_t i = 0; level > 0 && i < s.indexCount; i += step)
+            {
+                glm::vec3 p = vertices[submeshIndices[i]].position;
+                float nearest = FLT_MAX;
+                for (uint32_t t = 0; t + 2 < lod.indexCount; t += 3)
+                    nearest = std::min(nearest, pointTriangleDistance(p, vertices[lodIndices[t]].position, vertices[lodIndices[t + 1]].position,
+                                                                      vertices[lodIndices[t + 2]].position));
+                measured = std::max(measured, nearest);
+            }
+            std::cout << "    LOD " << level << ": " << lod.indexCount / 3 << " triangles (" << 100.0 * lod.indexCount / std::max<uint32_t>(s.indexCount, 1)
+                      << "%), claimed error " << lod.error << ", measured " << measured << std::endl;
+        }
+    }
+}
+
+// the parallel OBJ parse has to give exactly what the single-threaded one does
+// ------------------------------------------------------------------------
+bool checkObjThreads(const char* path, unsigned int threads)
+{
+    ImportedMesh single, parallel;
+    ModelImportStats parallelStats;
+    if (!importObj(path, single, 1) || !importObj(path, parallel, threads, &parallelStats))
+        return false;
+    bool same = single.vertices.size() == parallel.vertices.size() && single.indices == parallel.indices &&
+                single.submeshes.size() == parallel.submeshes.size() &&
+                std::memcmp(single.vertices.data(), parallel.vertices.data(), single.vertices.size() * sizeof(ModelVertex)) == 0;
+    if (!same)
+    {
+        std::cout << "ERROR::MESHCONV::THREAD_MISMATCH: " << path << ": 1 thread gives " << single.vertices.size() << " vertices, "
+                  << parallelStats.threads << " threads give " << parallel.vertices.size() << " (or the vertex data or indices differ)" << std::endl;
+        return false;
+    }
+    std::cout << "MESHCONV::CHECK 1 and " << parallelStats.threads << " threads agree: " << single.vertices.size() << " vertices, "
+              << single.indices.size() / 3 << " triangles" << std::endl;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc >= 3 && std::strcmp(argv[1], "--bench-grid") == 0)
+    {
+        int gridRuns = argc >= 5 && std::strcmp(argv[3], "--bench") == 0 ? std::max(1, std::atoi(argv[4])) : 3;
+        return benchGrid((unsigned int)std::max(0, std::atoi(argv[2])), gridRuns) ? 0 : -1;
+    }
+    if (argc < 3)
+    {
+        std::cout << "usage: meshconv input.obj|input.gltf|input.glb output.mesh [--compact] [--bench N] [--check-threads N] [--meshlets] [--lods N]" << std::endl;
+        std::cout << "       meshconv --bench-grid SIDE [--bench N]" << std::endl;
+        return -1;
+    }
+    bool compact = false;
+    int benchRuns = 0;
+    unsigned int checkThreads = 0;
+    bool meshlets = false;
+    unsigned int lodLevels = 0;
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--compact") == 0)
+            compact = true;
+        else if (std::strcmp(argv[i], "--meshlets") == 0)
+            meshlets = true;
+        else if (std::strcmp(argv[i], "--lods") == 0 && i + 1 < argc)
+            lodLevels = (unsigned int)std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+            benchRuns = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--check-threads") == 0 && i + 1 < argc)
+            checkThreads = (unsigned int)std::max(2, std::atoi(argv[++i]));
+    }
+
+    if (checkThreads > 0 && !checkObjThreads(argv[1], checkThreads))
+        return -1;
+
+    ImportedMesh mesh;
+    ModelImportStats stats;
+    if (!importModel(argv[1], mesh, &stats))
+        return -1;
+    printImportStats(argv[1], stats);
+    if (benchRuns > 0)
+    {
+        // the first import warmed the file cache, so only the runs after it count: they measure parsing rather
+        //      than the disk
+        ModelImportStats best;
+        best.seconds = DBL_MAX;
+        for (int run = 0; run < benchRuns; run++)
+        {
+            ImportedMesh scratch;
+            ModelImportStats runStats;
+            importModel(argv[1], scratch, &runStats);
+            if (runStats.seconds < best.seconds)
+                best = runStats;
+        }
+        std::cout << "MESHCONV::BENCH best of " << benchRuns << ": ";
+        printImportStats(argv[1], best);
+    }
+
+    std::vector<ModelVertex>& vertices = mesh.vertices;
+    std::vector<unsigned int>& indices = mesh.indices;
+    std::vector<MeshFileSubmesh>& submeshes = mesh.submeshes;
+
+    // the importers check their indices, but a bad one here would have the passes leave the mesh unoptimized
+    if (!indicesInRange(indices.data(), indices.size(), vertices.size()))
+        return -1;
+    VertexCacheStats before = analyzeVertexCache(indices.data(), indices.size(), vertices.size());
+    // the passes work in place, so every run starts from a fresh copy
+    if (benchRuns > 0)
+        benchOptimizer(vertices, indices, submeshes, benchRuns);
+
+    size_t vertexCount = optimize(vertices, indices, submeshes);
+    VertexCacheStats after = analyzeVertexCache(indices.data(), indices.size(), vertexCount);
+    printVertexCacheStats("BEFORE", before);
+    printVertexCacheStats("AFTER", after);
+    if (benchRuns > 0)
+        std::cout << "MESHCONV::BENCH vertex shader invocations per draw: " << before.misses << " -> " << after.misses << std::endl;
+    if (meshlets)
+        reportMeshlets(vertices, indices, submeshes);
+    if (lodLevels > 0)
+        reportLods(vertices, indices, submeshes, lodLevels);
+
+    VertexFormat format;
+    format.add(VertexSemantic::Position, 0, 3).add(VertexSemantic::TexCoord, 2, 2).add(VertexSemantic::Normal, 3, 3);
+    bool written;
+    if (compact)
+    {
+        VertexFormat packed = format.compact(vertices.data(), vertices.size());
+        std::vector<unsigned char> data = format.convert(vertices.data(), vertices.size(), packed);
+        packed.reportSavings(format, vertices.size());
+        written = writeMeshFile(argv[2], packed, data.data(), vertices.size(), indices.data(), indices.size(), submeshes);
+    }
+    else
+    {
+        written = writeMeshFile(argv[2], format, vertices.data(), vertices.size(), indices.data(), indices.size(), submeshes);
+    }
+    if (!written)
+        return -1;
+
+    std::cout << "MESHCONV:: wrote " << argv[2] << ": " << vertices.size() << " vertices, " << indices.size() / 3
+              << " triangles, " << submeshes.size() << " submeshes" << std::endl;
+    return 0;
+}
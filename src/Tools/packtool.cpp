@@ -0,0 +1,119 @@
+#include <pack_file.h>
+#include <vfs.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include <iostream>
+
+
+//////// PACK TOOL ////
+// - offline tool that packs a directory into a .pack file (see pack_file.h) the samples can mount with vfs()
+// - usage: packtool directory output.pack [--compress] [--bench N]
+// - --compress stores entries LZ4 compressed when that makes them smaller
+// - --bench N times opening and reading every file N times three ways: std::ifstream per file the way the samples used
+//      to, vfs() over the directory (a mapping per file) and vfs() over the pack (one mapping, a table lookup per file).
+//      The average per file is reported, and the contents are compared so a broken pack doesn't look fast
+
+// ------------------------------------------------------------------------
+uint64_t checksum(const unsigned char* data, size_t size)
+{
+    uint64_t sum = size;
+    for (size_t i = 0; i < size; i += 64)
+        sum = sum * 31 + data[i];
+    return sum;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        std::cout << "usage: packtool directory output.pack [--compress] [--bench N]" << std::endl;
+        return -1;
+    }
+    bool compress = false;
+    int benchRuns = 0;
+    for (int i = 3; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--compress") == 0)
+            compress = true;
+        else if (std::strcmp(argv[i], "--bench") == 0 && i + 1 < argc)
+            benchRuns = std::max(0, std::atoi(argv[++i]));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!writePackFile(argv[2], argv[1], compress))
+        return -1;
+    double packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    PackFile pack;
+    if (!pack.open(argv[2]))
+        return -1;
+    uint64_t size = 0, stored = 0;
+    size_t compressedEntries = 0;
+    for (size_t i = 0; i < pack.count(); i++)
+    {
+        size += pack.entries[i].size;
+        stored += pack.entries[i].storedSize;
+        compressedEntries += pack.entries[i].compression == PACK_LZ4 ? 1 : 0;
+    }
+    std::cout << "PACKTOOL:: " << argv[2] << ": " << pack.count() << " files, " << size / 1024 << " KB -> " << stored / 1024 << " KB stored ("
+              << compressedEntries << " compressed), packed in " << packMs << " ms" << std::endl;
+    if (benchRuns == 0)
+        return 0;
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < pack.count(); i++)
+        paths.push_back(std::string(pack.path(pack.entries[i])));
+    pack.close();
+
+    auto perFile = [&](auto&& read)
+    {
+        double best = 1e30;
+        uint64_t sum = 0;
+        for (int run = 0; run < benchRuns; run++)
+        {
+            sum = 0;
+            auto t0 = std::chrono::steady_clock::now();
+            for (const std::string& path : paths)
+                sum += read(path);
+            best = std::min(best, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        }
+        return std::make_pair(best / std::max<size_t>(paths.size(), 1), sum);
+    };
+    auto ifstreamResult = perFile([&](const std::string& path)
+    {
+        std::ifstream file(std::string(argv[1]) + "/" + path, std::ios::binary);
+        std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        return checksum(bytes.data(), bytes.size());
+    });
+    vfs().mount("bench", argv[1]);
+    auto directoryResult = perFile([&](const std::string& path)
+    {
+        VfsFile file;
+        vfs().open("bench/" + path, file);
+        return checksum(file.data(), file.size());
+    });
+    vfs().unmountAll();
+    vfs().mountPack("bench", argv[2]);
+    auto packResult = perFile([&](const std::string& path)
+    {
+        VfsFile file;
+        vfs().open("bench/" + path, file);
+        return checksum(file.data(), file.size());
+    });
+
+    bool identical = directoryResult.second == ifstreamResult.second && packResult.second == ifstreamResult.second;
+    std::cout << "PACKTOOL:: open + read per file, best of " << benchRuns << ":" << std::endl;
+    std::cout << "    ifstream:        " << ifstreamResult.first << " us" << std::endl;
+    std::cout << "    vfs directory:   " << directoryResult.first << " us" << std::endl;
+    std::cout << "    vfs pack:        " << packResult.first << " us, " << ifstreamResult.first / packResult.first << "x"
+              << (identical ? "" : ", CONTENTS DIFFER") << std::endl;
+    vfs().report();
+    return identical ? 0 : 1;
+}
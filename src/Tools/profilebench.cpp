@@ -0,0 +1,129 @@
+#include <profiler.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+#include <iostream>
+
+
+//////// PROFILER OVERHEAD BENCHMARK ////
+// - offline tool that measures what PROFILE_ZONE (profiler.h) costs per zone, against the 20 ns budget zones are meant
+//      to stay under, next to the cost of the timestamp read on its own and of steady_clock::now() for comparison
+// - usage: profilebench [--zones N] [--runs N] [--threads N]
+// - zones are recorded in batches that fit the ring, with endFrame() draining between batches outside the timed part,
+//      so the figure is what the recording thread pays; the best of N runs is reported
+// - --threads N also starts N short-lived threads that record zones and exit, and checks their rings were freed
+
+const double PROFILER_ZONE_BUDGET_NS = 20.0;
+
+// keeps the compiler from dropping a value it can see is unused
+volatile uint64_t benchSink;
+
+int main(int argc, char** argv)
+{
+    unsigned int zones = 1 << 20;
+    int runs = 10;
+    unsigned int threads = 8;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--zones") == 0 && i + 1 < argc)
+            zones = (unsigned int)std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--runs") == 0 && i + 1 < argc)
+            runs = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threads = (unsigned int)std::max(0, std::atoi(argv[++i]));
+        else
+        {
+            std::cout << "usage: profilebench [--zones N] [--runs N] [--threads N]" << std::endl;
+            return -1;
+        }
+    }
+
+    // best ns per iteration of body over all runs
+    auto bestNs = [&](auto&& body)
+    {
+        double best = 1e30;
+        for (int run = 0; run < runs; run++)
+        {
+            double ns = 0.0;
+            for (unsigned int done = 0; done < zones; done += PROFILER_RING_SIZE / 2)
+            {
+                unsigned int batch = std::min(zones - done, PROFILER_RING_SIZE / 2);
+                auto start = std::chrono::steady_clock::now();
+                body(batch);
+                ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+                profiler().endFrame();
+            }
+            best = std::min(best, ns / zones);
+        }
+        return best;
+    };
+
+    profiler().ring();
+    double timestampNs = bestNs([](unsigned int n)
+    {
+        uint64_t sum = 0;
+        for (unsigned int i = 0; i < n; i++)
+            sum += Profiler::now();
+        benchSink = sum;
+    });
+    double steadyClockNs = bestNs([](unsigned int n)
+    {
+        uint64_t sum = 0;
+        for (unsigned int i = 0; i < n; i++)
+            sum += (uint64_t)std::chrono::steady_clock::now().time_since_epoch().count();
+        benchSink = sum;
+    });
+    double zoneNs = bestNs([](unsigned int n)
+    {
+        for (unsigned int i = 0; i < n; i++)
+        {
+            PROFILE_ZONE("bench");
+        }
+    });
+    const ZoneHistogram* bench = profiler().zone("bench");
+
+#ifdef PROFILER_HAS_RDTSC
+    const char* clock = "RDTSC";
+#else
+    const char* clock = "steady_clock";
+#endif
+    std::cout << "PROFILEBENCH:: " << zones << " zones, best of " << runs << " runs" << std::endl;
+    std::cout << "    timestamp (" << clock << "): " << timestampNs << " ns, steady_clock::now(): " << steadyClockNs << " ns" << std::endl;
+    std::cout << "    PROFILE_ZONE: " << zoneNs << " ns per zone, budget " << PROFILER_ZONE_BUDGET_NS << " ns: "
+              << (zoneNs <= PROFILER_ZONE_BUDGET_NS ? "met" : "NOT met") << std::endl;
+    if (bench)
+        std::cout << "    an empty zone measures itself at p50 < " << bench->percentile(0.5f) << " ns" << std::endl;
+
+    // threads that come and go must not leave their rings behind
+    if (threads)
+    {
+        size_t ringsBefore = profiler().ringCount();
+        for (int round = 0; round < 4; round++)
+        {
+            std::vector<std::thread> workers;
+            for (unsigned int t = 0; t < threads; t++)
+                workers.emplace_back([]()
+                {
+                    for (int i = 0; i < 1000; i++)
+                    {
+                        PROFILE_ZONE("worker");
+                    }
+                });
+            for (std::thread& worker : workers)
+                worker.join();
+            profiler().endFrame();
+        }
+        size_t ringsAfter = profiler().ringCount();
+        std::cout << "    " << 4 * threads << " short-lived threads: " << ringsBefore << " rings before, " << ringsAfter << " after" << std::endl;
+        if (ringsAfter != ringsBefore)
+        {
+            std::cout << "ERROR::PROFILEBENCH::RINGS_LEAKED" << std::endl;
+            return 1;
+        }
+    }
+    return zoneNs <= PROFILER_ZONE_BUDGET_NS ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+#include <mapped_file.h>
+#include <vfs.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <iostream>
+
+
+//////// SHADER SOURCE BENCHMARK ////
+// - offline tool that measures what it costs to get shader sources into a form glShaderSource accepts, without a GL
+//      context: nothing is compiled, only the reading is timed and counted
+// - usage: shaderbench source... [--iterations N]   (paths relative to the working directory)
+// - three ways: ifstream -> stringstream -> std::string -> c_str() as Shader used to, a MappedFile per source as
+//      Shader does now, and vfs() as ShaderBatch (shader_batch.h) does
+// - global operator new is replaced to count heap allocations and bytes; bytes copied are the source bytes that land in
+//      a buffer of ours (the stringstream and the string for the old path)
+
+std::atomic<uint64_t> heapAllocations{ 0 };
+std::atomic<uint64_t> heapBytes{ 0 };
+
+void* operator new(size_t size)
+{
+    heapAllocations++;
+    heapBytes += size;
+    if (void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+struct SourceCost
+{
+    double microseconds = 1e30;
+    uint64_t allocations = 0;
+    uint64_t allocatedBytes = 0;
+    uint64_t copiedBytes = 0;
+    uint64_t checksum = 0;
+};
+
+// ------------------------------------------------------------------------
+uint64_t checksum(const char* text, size_t length)
+{
+    uint64_t sum = length;
+    for (size_t i = 0; i < length; i++)
+        sum = sum * 31 + (unsigned char)text[i];
+    return sum;
+}
+
+// time one way of reading every source, and count its allocations on the last run
+// ------------------------------------------------------------------------
+template <typename F>
+SourceCost measure(const std::vector<const char*>& paths, int iterations, F&& read)
+{
+    SourceCost cost;
+    for (int run = 0; run < iterations; run++)
+    {
+        uint64_t allocations = heapAllocations, bytes = heapBytes;
+        cost.copiedBytes = 0;
+        cost.checksum = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const char* path : paths)
+            cost.checksum += read(path, cost.copiedBytes);
+        cost.microseconds = std::min(cost.microseconds, std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+        cost.allocations = heapAllocations - allocations;
+        cost.allocatedBytes = heapBytes - bytes;
+    }
+    return cost;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        std::cout << "usage: shaderbench source... [--iterations N]" << std::endl;
+        return -1;
+    }
+    int iterations = 100;
+    std::vector<const char*> paths;
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, std::atoi(argv[++i]));
+        else
+            paths.push_back(argv[i]);
+    }
+
+    SourceCost streams = measure(paths, iterations, [](const char* path, uint64_t& copied)
+    {
+        std::ifstream file(path);
+        std::stringstream stream;
+        stream << file.rdbuf();
+        std::string code = stream.str();
+        const char* text = code.c_str();
+        copied += 2 * code.size();
+        return checksum(text, code.size());
+    });
+    SourceCost mapped = measure(paths, iterations, [](const char* path, uint64_t&)
+    {
+        MappedFile file(path);
+        return checksum((const char*)file.data(), file.size());
+    });
+    vfs().mount("", ".");
+    SourceCost virtualFiles = measure(paths, iterations, [](const char* path, uint64_t& copied)
+    {
+        VfsFile file;
+        vfs().open(path, file);
+        copied += file.mapped() ? 0 : file.size();
+        return checksum(file.text().data(), file.size());
+    });
+
+    bool identical = mapped.checksum == streams.checksum && virtualFiles.checksum == streams.checksum;
+    std::cout << "SHADERBENCH:: " << paths.size() << " sources, best of " << iterations << (identical ? "" : ", SOURCES DIFFER") << std::endl;
+    auto print = [&](const char* name, const SourceCost& cost)
+    {
+        std::cout << "    " << name << cost.microseconds / paths.size() << " us per source, " << (double)cost.allocations / paths.size()
+                  << " allocations (" << cost.allocatedBytes / paths.size() << " bytes) and " << cost.copiedBytes / paths.size()
+                  << " bytes copied per source" << std::endl;
+    };
+    print("ifstream/stringstream: ", streams);
+    print("MappedFile:            ", mapped);
+    print("vfs():                 ", virtualFiles);
+    return identical ? 0 : 1;
+}
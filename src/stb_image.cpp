@@ -1,2 +1,8 @@
+#include <image_arena.h>
+
+// decode buffers come from per-thread pools instead of the global heap (see image_arena.h)
+#define STBI_MALLOC(size) imageArenaMalloc(size)
+#define STBI_REALLOC_SIZED(p, oldSize, newSize) imageArenaRealloc(p, newSize)
+#define STBI_FREE(p) imageArenaFree(p)
 #define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
\ No newline at end of file
+#include "stb_image.h"